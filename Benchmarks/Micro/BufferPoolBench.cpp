@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <MR/Memory/BufferPool.hpp>
+
+#include <vector>
+
+namespace {
+
+using MR::Memory::BufferPool;
+
+// One acquire/release pair per iteration, the argument picks the size class
+// (the last one is larger than every class and always allocates)
+void BM_AcquireRelease(benchmark::State& state) {
+    BufferPool pool;
+    const auto size = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        auto buffer = pool.acquire(size);
+        benchmark::DoNotOptimize(buffer->data);
+        pool.release(std::move(buffer));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AcquireRelease)
+    ->Arg(512)
+    ->Arg(BufferPool::MEDIUM_BUFFER_SIZE)
+    ->Arg(BufferPool::LARGE_BUFFER_SIZE)
+    ->Arg(BufferPool::LARGE_BUFFER_SIZE * 4);
+
+// acquire and release from several threads sharing one pool
+void BM_AcquireReleaseContended(benchmark::State& state) {
+    static BufferPool pool;
+
+    for (auto _ : state) {
+        auto buffer = pool.acquire(512);
+        benchmark::DoNotOptimize(buffer->data);
+        pool.release(std::move(buffer));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AcquireReleaseContended)->ThreadRange(1, 16)->UseRealTime();
+
+// Drains a size class and refills it, the cost of a burst that holds many buffers
+void BM_AcquireBurst(benchmark::State& state) {
+    BufferPool pool;
+    const auto burst = static_cast<size_t>(state.range(0));
+    std::vector<std::unique_ptr<MR::Memory::Buffer>> held;
+    held.reserve(burst);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; ++i) held.push_back(pool.acquire(512));
+        for (auto& buffer : held) pool.release(std::move(buffer));
+        held.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(burst));
+}
+BENCHMARK(BM_AcquireBurst)->Arg(BufferPool::SMALL_POOL_SIZE)->Arg(BufferPool::SMALL_POOL_SIZE * 2);
+
+}
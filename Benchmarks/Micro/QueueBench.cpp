@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <MR/Interface/ThreadSafeQueue.hpp>
+#include <MR/Logger/WriteRequest.hpp>
+#include <MR/Queue/CircularQueue.hpp>
+#include <MR/Queue/FixedSizeBlockingQueue.hpp>
+#include <MR/Queue/MPSCRingQueue.hpp>
+#include <MR/Queue/SPSCLaneQueue.hpp>
+#include <MR/Queue/StdQueue.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace {
+
+using MR::Logger::WriteRequest;
+
+constexpr size_t CAPACITY = 65536;
+
+template <typename Queue>
+std::shared_ptr<Queue> makeQueue() {
+    if constexpr (std::is_constructible_v<Queue, size_t>) {
+        return std::make_shared<Queue>(CAPACITY);
+    } else {
+        return std::make_shared<Queue>();
+    }
+}
+
+// Every benchmark thread is a producer, one extra thread drains with tryPopBatch like the
+// logger's worker. Items per second is the producer side throughput
+template <typename Queue>
+void BM_PushPop(benchmark::State& state) {
+    static std::shared_ptr<Queue> queue;
+    static std::atomic<bool> stop;
+    static std::thread consumer;
+
+    // Before the first iteration and after the last one all threads meet in a barrier
+    if (state.thread_index() == 0) {
+        queue = makeQueue<Queue>();
+        stop.store(false);
+        consumer = std::thread([q = queue]() {
+            std::array<WriteRequest, 128> batch;
+            while (!stop.load(std::memory_order_relaxed) || !q->empty()) {
+                if (q->tryPopBatch(batch) == 0) std::this_thread::yield();
+            }
+        });
+    }
+
+    const auto thread_id = std::this_thread::get_id();
+    uint64_t sequence = 0;
+    for (auto _ : state) {
+        queue->push(WriteRequest{
+            .level = MR::Logger::SEVERITY_LEVEL::INFO,
+            .data = "Benchmark message",
+            .threadId = thread_id,
+            .timestamp = {},
+            .sequence_number = ++sequence,
+            .deferred = {}
+        });
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        stop.store(true);
+        consumer.join();
+        queue.reset();
+    }
+}
+
+#define QUEUE_BENCHMARK(Queue) \
+    BENCHMARK_TEMPLATE(BM_PushPop, Queue<WriteRequest>)->ThreadRange(1, 16)->UseRealTime()
+
+QUEUE_BENCHMARK(MR::Queue::StdQueue);
+QUEUE_BENCHMARK(MR::Queue::FixedSizeBlockingQueue);
+QUEUE_BENCHMARK(MR::Queue::CircularQueue);
+QUEUE_BENCHMARK(MR::Queue::MPSCRingQueue);
+QUEUE_BENCHMARK(MR::Queue::SPSCLaneQueue);
+
+}
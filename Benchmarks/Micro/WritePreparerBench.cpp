@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <MR/IO/WritePreparer.hpp>
+#include <MR/Logger/WriteRequest.hpp>
+#include <MR/Memory/BufferPool.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+
+using MR::IO::WritePreparer;
+using MR::Logger::WriteRequest;
+
+WriteRequest makeRequest(const std::string& message, uint64_t sequence) {
+    return WriteRequest{
+        .level = MR::Logger::SEVERITY_LEVEL::INFO,
+        .data = message,
+        .threadId = std::this_thread::get_id(),
+        .timestamp = std::chrono::system_clock::now(),
+        .sequence_number = sequence,
+        .deferred = {}
+    };
+}
+
+// There is no ring: prepared buffers go straight back to the pool where the logger would
+// submit them, so only formatting, staging and pool traffic are measured
+void BM_PrepareWrite(benchmark::State& state) {
+    MR::Memory::BufferPool pool;
+    WritePreparer preparer(
+        WritePreparer::Config{.coalesce_size = static_cast<uint16_t>(state.range(0))},
+        pool,
+        [](const char*, const std::string&) {});
+    const std::string message(static_cast<size_t>(state.range(1)), 'x');
+
+    uint64_t sequence = 0;
+    for (auto _ : state) {
+        auto prepared = preparer.prepareWrite(makeRequest(message, ++sequence));
+        if (prepared.buffer) pool.release(std::move(prepared.buffer));
+    }
+    if (auto staged = preparer.flushStaged()) pool.release(std::move(*staged));
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(1));
+}
+// {coalesce_size, message bytes}, coalesce_size 1 is the individual mode
+BENCHMARK(BM_PrepareWrite)
+    ->ArgNames({"coalesce", "bytes"})
+    ->ArgsProduct({{1, 32, 128}, {32, 256, 2048}});
+
+// The timestamp, level and thread id prefix alone
+void BM_FormatPrefix(benchmark::State& state) {
+    MR::Memory::BufferPool pool;
+    WritePreparer preparer(WritePreparer::Config{.coalesce_size = 0}, pool, [](const char*, const std::string&) {});
+    char line[512];
+
+    uint64_t sequence = 0;
+    for (auto _ : state) {
+        auto request = makeRequest({}, ++sequence);
+        benchmark::DoNotOptimize(preparer.formatInto(request, line, sizeof(line)));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatPrefix);
+
+}
@@ -5,8 +5,11 @@
 #include <MR/Queue/StdQueue.hpp>
 #include <MR/Queue/FixedSizeBlockingQueue.hpp>
 #include <MR/Queue/CircularQueue.hpp>
+#include <MR/Queue/MPSCRingQueue.hpp>
+#include <MR/Queue/SPSCLaneQueue.hpp>
 #include <MR/Logger/WriteRequest.hpp>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 namespace MR::Benchmarks {
@@ -16,6 +19,37 @@ enum class BenchmarkType {
     Spdlog
 };
 
+// Arguments logged next to the payload string
+enum class ArgumentTypes {
+    STRING,    // The payload only
+    INTEGERS,  // Plus two integers
+    FLOATS,    // Plus two doubles
+    MIXED      // Plus an integer, a double and a bool
+};
+
+// Size range of the string argument of every message, drawn uniformly. max_bytes 0 keeps
+// the short "Benchmark message #{}" of the classic benchmarks
+struct PayloadConfig {
+    size_t min_bytes = 0;
+    size_t max_bytes = 0;
+    ArgumentTypes args = ArgumentTypes::STRING;
+
+    std::string label() const {
+        if (max_bytes == 0) return "classic";
+
+        std::string sizes = min_bytes == max_bytes
+            ? std::to_string(max_bytes) + "B"
+            : std::to_string(min_bytes) + "-" + std::to_string(max_bytes) + "B";
+        switch (args) {
+            case ArgumentTypes::STRING: return sizes;
+            case ArgumentTypes::INTEGERS: return sizes + "_int";
+            case ArgumentTypes::FLOATS: return sizes + "_float";
+            case ArgumentTypes::MIXED: return sizes + "_mixed";
+        }
+        return sizes;
+    }
+};
+
 struct BenchmarkConfig {
     BenchmarkType type;
     std::string name;
@@ -24,6 +58,13 @@ struct BenchmarkConfig {
     
     MR::Logger::Config logger_config;
     std::string spdlog_file_name;
+
+    // Time every logging call into a histogram, at offered_rate messages per second
+    // over all threads (0 = as fast as possible)
+    bool measure_latency = false;
+    double offered_rate = 0.0;
+
+    PayloadConfig payload;
     
     BenchmarkConfig(BenchmarkType t, const std::string& n, size_t threads = 1, size_t messages = 1000000)
         : type(t), name(n), thread_count(threads), total_messages(messages) {}
@@ -105,6 +146,60 @@ public:
         return config;
     }
 
+    // Same as the default config on the mmap backend instead of io_uring
+    static BenchmarkConfig get_mmap_config(size_t thread_count = 1) {
+        auto config = get_default_config(thread_count);
+        config.name = "Mmap";
+
+        std::string thread_suffix = thread_count > 1 ? "_MultiThread" : "_SingleThread";
+        config.logger_config.log_file_name = "Bench_Mmap" + thread_suffix + ".log";
+        config.logger_config.backend = MR::IO::Backend::MMAP;
+        return config;
+    }
+
+    // Named presets for mrlogger-bench, throws std::invalid_argument for an unknown name
+    static BenchmarkConfig get_preset(const std::string& preset, size_t thread_count = 1) {
+        if (preset == "default") return get_default_config(thread_count);
+        if (preset == "small") return get_small_config(thread_count);
+        if (preset == "large") return get_large_config(thread_count);
+        if (preset == "nobatch") return get_no_batch_config(thread_count);
+        if (preset == "mmap") return get_mmap_config(thread_count);
+        if (preset == "spdlog") return get_spdlog_config(thread_count);
+        if (preset == "fixed") return get_fixed_default_config(thread_count);
+        if (preset == "fixed-small") return get_fixed_small_config(thread_count);
+        if (preset == "fixed-large") return get_fixed_large_config(thread_count);
+        if (preset == "circular") return get_circular_default_config(thread_count);
+        if (preset == "mpsc") return get_mpsc_default_config(thread_count);
+        if (preset == "lanes") return get_lanes_default_config(thread_count);
+        throw std::invalid_argument("Unknown preset: " + preset);
+    }
+
+    // Queue by name (std, fixed, circular, mpsc, lanes), capacity is ignored by std
+    static std::shared_ptr<MR::Interface::ThreadSafeQueue<MR::Logger::WriteRequest>> make_queue(const std::string& queue, size_t capacity) {
+        using MR::Logger::WriteRequest;
+        if (queue == "std") return std::make_shared<MR::Queue::StdQueue<WriteRequest>>();
+        if (queue == "fixed") return std::make_shared<MR::Queue::FixedSizeBlockingQueue<WriteRequest>>(capacity);
+        if (queue == "circular") return std::make_shared<MR::Queue::CircularQueue<WriteRequest>>(capacity);
+        if (queue == "mpsc") return std::make_shared<MR::Queue::MPSCRingQueue<WriteRequest>>(capacity);
+        if (queue == "lanes") return std::make_shared<MR::Queue::SPSCLaneQueue<WriteRequest>>(capacity);
+        throw std::invalid_argument("Unknown queue type: " + queue);
+    }
+
+    // Caller thread latency of the default config (MRLogger) or spdlog, offered_rate 0 = flat out
+    static BenchmarkConfig get_latency_config(BenchmarkType type, size_t thread_count, double offered_rate, size_t messages) {
+        auto config = type == BenchmarkType::MRLogger ? get_default_config(thread_count) : get_spdlog_config(thread_count);
+        config.total_messages = messages;
+        config.measure_latency = true;
+        config.offered_rate = offered_rate;
+
+        std::string logger_name = type == BenchmarkType::MRLogger ? "MRLogger" : "Spdlog";
+        std::string mode = offered_rate > 0 ? std::to_string(static_cast<size_t>(offered_rate / 1000)) + "k" : "FlatOut";
+        config.name = "Latency_" + logger_name + "_" + mode + "_" + std::to_string(thread_count) + "T";
+        config.logger_config.log_file_name = "Bench_Latency_" + logger_name + ".log";
+        config.spdlog_file_name = "Bench_Latency_" + logger_name + ".log";
+        return config;
+    }
+
     static BenchmarkConfig get_spdlog_config(size_t thread_count = 1) {
         auto config = BenchmarkConfig(BenchmarkType::Spdlog, "Spdlog", thread_count);
         std::string thread_suffix = thread_count > 1 ? "_MultiThread" : "_SingleThread";
@@ -193,6 +288,49 @@ public:
         };
         return config;
     }
+
+    // MPSCRingQueue benchmarks
+    static BenchmarkConfig get_mpsc_default_config(size_t thread_count = 1) {
+        auto config = BenchmarkConfig(BenchmarkType::MRLogger, "MPSCDefault", thread_count);
+        std::string thread_suffix = thread_count > 1 ? "_MultiThread" : "_SingleThread";
+        config.logger_config = MR::Logger::Config{
+            .log_file_name = "Bench_MPSC_Default" + thread_suffix + ".log",
+            .max_log_size_bytes = 200 * 1024 * 1024, // 200MB - prevent rotation during benchmark
+            .batch_size = 64u,
+            .queue_depth = 512u,
+            .small_buffer_pool_size = 256u,
+            .medium_buffer_pool_size = 128u,
+            .large_buffer_pool_size = 64u,
+            .small_buffer_size = 1024u,
+            .medium_buffer_size = 4096u,
+            .large_buffer_size = 16384u,
+            .shutdown_timeout_seconds = 60u,
+            ._queue = std::make_shared<MR::Queue::MPSCRingQueue<MR::Logger::WriteRequest>>(65536),
+        };
+        return config;
+    }
+
+    // SPSCLaneQueue benchmarks
+    static BenchmarkConfig get_lanes_default_config(size_t thread_count = 1) {
+        auto config = BenchmarkConfig(BenchmarkType::MRLogger, "LanesDefault", thread_count);
+        std::string thread_suffix = thread_count > 1 ? "_MultiThread" : "_SingleThread";
+        config.logger_config = MR::Logger::Config{
+            .log_file_name = "Bench_Lanes_Default" + thread_suffix + ".log",
+            .max_log_size_bytes = 200 * 1024 * 1024, // 200MB - prevent rotation during benchmark
+            .batch_size = 64u,
+            .queue_depth = 512u,
+            .small_buffer_pool_size = 256u,
+            .medium_buffer_pool_size = 128u,
+            .large_buffer_pool_size = 64u,
+            .small_buffer_size = 1024u,
+            .medium_buffer_size = 4096u,
+            .large_buffer_size = 16384u,
+            .shutdown_timeout_seconds = 60u,
+            ._queue = std::make_shared<MR::Queue::SPSCLaneQueue<MR::Logger::WriteRequest>>(8192),
+        };
+        return config;
+    }
 };
 
+
 }
\ No newline at end of file
@@ -28,6 +28,18 @@ struct BenchmarkResult {
             bool is_spdlog;
         } spdlog;
     } config_details;
+
+    // Per call latency on the logging threads, see BenchmarkConfig::measure_latency
+    struct {
+        bool measured;
+        double offered_rate;
+        uint64_t p50_ns;
+        uint64_t p99_ns;
+        uint64_t p999_ns;
+        uint64_t max_ns;
+    } latency;
+
+    std::string workload;  // PayloadConfig::label()
 };
 
 BenchmarkResult run_benchmark(const BenchmarkConfig& config);
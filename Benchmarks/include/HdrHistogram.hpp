@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace MR::Benchmarks {
+
+// HDR style latency histogram: exact below 2^SUB_BUCKET_BITS ns, above that every
+// power of two is split into 2^(SUB_BUCKET_BITS - 1) linear buckets (< 1.6% error)
+class HdrHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t LINEAR = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr uint64_t HALF = LINEAR / 2;
+
+    HdrHistogram() : counts_(LINEAR + (64 - SUB_BUCKET_BITS) * HALF, 0) {}
+
+    void record(uint64_t value_ns) {
+        counts_[indexOf(value_ns)]++;
+        total_++;
+        max_ = std::max(max_, value_ns);
+    }
+
+    void merge(const HdrHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+
+    // Highest value of the bucket holding the quantile (0..1), capped at the recorded max
+    uint64_t percentile(double quantile) const {
+        if (total_ == 0) return 0;
+
+        auto rank = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total_)));
+        rank = std::clamp<uint64_t>(rank, 1, total_);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(highestValueAt(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t max_ = 0;
+
+    static size_t indexOf(uint64_t value) {
+        if (value < LINEAR) return static_cast<size_t>(value);
+
+        // value >> shift lands in [HALF, LINEAR)
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - SUB_BUCKET_BITS;
+        return static_cast<size_t>(LINEAR + (shift - 1) * HALF + ((value >> shift) - HALF));
+    }
+
+    static uint64_t highestValueAt(size_t index) {
+        if (index < LINEAR) return index;
+
+        uint64_t shift = (index - LINEAR) / HALF + 1;
+        uint64_t sub = (index - LINEAR) % HALF + HALF;
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+}
@@ -1,5 +1,6 @@
 #include "Benchmark.hpp"
 #include "BenchConfigs.hpp"
+#include "HdrHistogram.hpp"
 #include <MR/Logger/Logger.hpp>
 #include <spdlog/spdlog.h>
 #include <spdlog/logger.h>
@@ -12,6 +13,7 @@
 #include <thread>
 #include <vector>
 #include <barrier>
+#include <random>
 
 using namespace std::chrono;
 
@@ -84,6 +86,17 @@ void save_results_to_json(const BenchmarkResult& result) {
     json_file << "  \"queue_messages_per_second\": " << result.messages_per_second << ",\n";
     json_file << "  \"end_to_end_messages_per_second\": " << result.end_to_end_messages_per_second << ",\n";
     json_file << "  \"log_file_name\": \"" << result.log_file_name << "\",\n";
+    json_file << "  \"workload\": \"" << result.workload << "\",\n";
+
+    if (result.latency.measured) {
+        json_file << "  \"latency\": {\n";
+        json_file << "    \"offered_rate\": " << result.latency.offered_rate << ",\n";
+        json_file << "    \"p50_ns\": " << result.latency.p50_ns << ",\n";
+        json_file << "    \"p99_ns\": " << result.latency.p99_ns << ",\n";
+        json_file << "    \"p999_ns\": " << result.latency.p999_ns << ",\n";
+        json_file << "    \"max_ns\": " << result.latency.max_ns << "\n";
+        json_file << "  },\n";
+    }
 
     if (result.config_details.spdlog.is_spdlog) {
         json_file << "  \"logger_type\": \"spdlog\"\n";
@@ -105,29 +118,79 @@ struct DurationPair {
     nanoseconds end_to_end_time;
 };
 
-nanoseconds measureSingleThreaded(std::shared_ptr<MR::Logger::Logger> logger, size_t msgs_per_thread) {
-    auto start = high_resolution_clock::now();
-    for (size_t i = 1; i <= msgs_per_thread; ++i) {
+constexpr size_t PAYLOAD_VARIANTS = 1024;  // Power of two, indexed by message number
+
+// Payloads drawn from the configured size range, generated before the clock starts
+std::vector<std::string> makePayloads(const PayloadConfig& payload, size_t seed) {
+    if (payload.max_bytes == 0) return {};
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> size(payload.min_bytes, payload.max_bytes);
+    std::uniform_int_distribution<int> letter('a', 'z');
+
+    std::vector<std::string> payloads(PAYLOAD_VARIANTS);
+    for (auto& text : payloads) {
+        text.resize(size(rng));
+        for (auto& c : text) c = static_cast<char>(letter(rng));
+    }
+    return payloads;
+}
+
+template <typename LoggerPtr>
+inline void logMessage(const LoggerPtr& logger, ArgumentTypes args, const std::vector<std::string>& payloads, size_t i) {
+    if (payloads.empty()) {
         logger->info("Benchmark message #{}", i);
+        return;
     }
+
+    const std::string& payload = payloads[i & (PAYLOAD_VARIANTS - 1)];
+    switch (args) {
+        case ArgumentTypes::STRING:
+            logger->info("Benchmark #{} {}", i, payload);
+            break;
+        case ArgumentTypes::INTEGERS:
+            logger->info("Benchmark #{} {} {} {}", i, payload, static_cast<int>(i) * 7, static_cast<int64_t>(i) * -13);
+            break;
+        case ArgumentTypes::FLOATS:
+            logger->info("Benchmark #{} {} {:.3f} {}", i, payload, static_cast<double>(i) * 0.5, static_cast<double>(i) / 3.0);
+            break;
+        case ArgumentTypes::MIXED:
+            logger->info("Benchmark #{} {} id={} ratio={:.2f} ok={}", i, payload, i * 31, static_cast<double>(i) * 0.25, i % 2 == 0);
+            break;
+    }
+}
+
+template <typename LoggerPtr>
+void logMessages(const LoggerPtr& logger, const BenchmarkConfig& config, const std::vector<std::string>& payloads, size_t msgs_per_thread) {
+    for (size_t i = 1; i <= msgs_per_thread; ++i) {
+        logMessage(logger, config.payload.args, payloads, i);
+    }
+}
+
+template <typename LoggerPtr>
+nanoseconds measureSingleThreaded(const LoggerPtr& logger, const BenchmarkConfig& config, size_t msgs_per_thread) {
+    auto payloads = makePayloads(config.payload, 0);
+
+    auto start = high_resolution_clock::now();
+    logMessages(logger, config, payloads, msgs_per_thread);
     auto queue_end = high_resolution_clock::now();
 
     return duration_cast<nanoseconds>(queue_end - start);
 }
 
-nanoseconds measureMultiThreaded(std::shared_ptr<MR::Logger::Logger> logger, size_t msgs_per_thread, size_t thread_count) {
+template <typename LoggerPtr>
+nanoseconds measureMultiThreaded(const LoggerPtr& logger, const BenchmarkConfig& config, size_t msgs_per_thread) {
 
-    std::barrier sync_point(static_cast<std::ptrdiff_t>(thread_count) + 1);
+    std::barrier sync_point(static_cast<std::ptrdiff_t>(config.thread_count) + 1);
     std::vector<std::thread> threads;
-    threads.reserve(thread_count + 1);
+    threads.reserve(config.thread_count);
 
-    for (size_t thread_id = 0; thread_id < thread_count; ++thread_id) {
-        threads.emplace_back([&sync_point, logger, msgs_per_thread]() {
+    for (size_t thread_id = 0; thread_id < config.thread_count; ++thread_id) {
+        threads.emplace_back([&sync_point, &logger, &config, msgs_per_thread, thread_id]() {
+            auto payloads = makePayloads(config.payload, thread_id);
             sync_point.arrive_and_wait();
 
-            for (size_t i = 1; i <= msgs_per_thread; ++i) {
-                logger->info("Benchmark #{}", i);
-            }
+            logMessages(logger, config, payloads, msgs_per_thread);
         });
     }
 
@@ -143,31 +206,55 @@ nanoseconds measureMultiThreaded(std::shared_ptr<MR::Logger::Logger> logger, siz
     return duration_cast<nanoseconds>(queue_end - start);
 }
 
-nanoseconds measureSpdLoggerSingleThreaded(std::shared_ptr<spdlog::logger> logger, size_t msgs_per_thread) {
-    auto start = high_resolution_clock::now();
+template <typename LoggerPtr>
+nanoseconds measureThroughput(const LoggerPtr& logger, const BenchmarkConfig& config) {
+    const size_t msgs_per_thread = config.total_messages / config.thread_count;
+    return config.thread_count == 1
+        ? measureSingleThreaded(logger, config, msgs_per_thread)
+        : measureMultiThreaded(logger, config, msgs_per_thread);
+}
+
+// Times every logging call with steady_clock. At a fixed rate the latency of a call counts from
+// its scheduled send time, so a stall also shows up in the calls it delayed (no coordinated omission)
+template <typename LoggerPtr>
+HdrHistogram measureCallLatency(const LoggerPtr& logger, const BenchmarkConfig& config, const std::vector<std::string>& payloads,
+                                size_t msgs_per_thread, double rate_per_thread) {
+    HdrHistogram histogram;
+    const duration<double, std::nano> interval(rate_per_thread > 0 ? 1e9 / rate_per_thread : 0.0);
+    const auto start = steady_clock::now();
 
     for (size_t i = 1; i <= msgs_per_thread; ++i) {
-        logger->info("Benchmark message #{}", i);
-    }
+        auto begin = steady_clock::now();
+        if (rate_per_thread > 0) {
+            auto scheduled = start + duration_cast<nanoseconds>(interval * static_cast<double>(i - 1));
+            while (begin < scheduled) {
+                begin = steady_clock::now();
+            }
+            begin = scheduled;
+        }
 
-    auto queue_end = high_resolution_clock::now();
+        logMessage(logger, config.payload.args, payloads, i);
+        histogram.record(static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - begin).count()));
+    }
 
-    return duration_cast<nanoseconds>(queue_end - start);
+    return histogram;
 }
 
-nanoseconds measureSpdLoggerMultiThreaded(std::shared_ptr<spdlog::logger> logger, size_t msgs_per_thread, size_t thread_count) {
+template <typename LoggerPtr>
+nanoseconds measureLatency(const LoggerPtr& logger, const BenchmarkConfig& config, HdrHistogram& histogram) {
+    const size_t msgs_per_thread = config.total_messages / config.thread_count;
+    const double rate_per_thread = config.offered_rate / static_cast<double>(config.thread_count);
 
-    std::barrier sync_point(static_cast<std::ptrdiff_t>(thread_count) + 1);
+    std::barrier sync_point(static_cast<std::ptrdiff_t>(config.thread_count) + 1);
+    std::vector<HdrHistogram> histograms(config.thread_count);
     std::vector<std::thread> threads;
-    threads.reserve(thread_count + 1);
+    threads.reserve(config.thread_count);
 
-    for (size_t thread_id = 0; thread_id < thread_count; ++thread_id) {
-        threads.emplace_back([&sync_point, logger, msgs_per_thread]() {
+    for (size_t thread_id = 0; thread_id < config.thread_count; ++thread_id) {
+        threads.emplace_back([&, thread_id]() {
+            auto payloads = makePayloads(config.payload, thread_id);
             sync_point.arrive_and_wait();
-
-            for (size_t i = 1; i <= msgs_per_thread; ++i) {
-                logger->info("Benchmark #{}", i);
-            }
+            histograms[thread_id] = measureCallLatency(logger, config, payloads, msgs_per_thread, rate_per_thread);
         });
     }
 
@@ -180,9 +267,24 @@ nanoseconds measureSpdLoggerMultiThreaded(std::shared_ptr<spdlog::logger> logger
 
     auto queue_end = high_resolution_clock::now();
 
+    for (const auto& thread_histogram : histograms) {
+        histogram.merge(thread_histogram);
+    }
+
     return duration_cast<nanoseconds>(queue_end - start);
 }
 
+void recordLatency(BenchmarkResult& result, const BenchmarkConfig& config, const HdrHistogram& histogram) {
+    result.latency.measured = true;
+    result.latency.offered_rate = config.offered_rate;
+    result.latency.p50_ns = histogram.percentile(0.5);
+    result.latency.p99_ns = histogram.percentile(0.99);
+    result.latency.p999_ns = histogram.percentile(0.999);
+    result.latency.max_ns = histogram.max();
+
+    std::cout << config.name << " (latency): p50=" << result.latency.p50_ns << " ns, p99=" << result.latency.p99_ns
+              << " ns, p99.9=" << result.latency.p999_ns << " ns, max=" << result.latency.max_ns << " ns" << std::endl;
+}
 
 BenchmarkResult run_mrlogger_benchmark(const BenchmarkConfig& config) {
 
@@ -195,12 +297,10 @@ BenchmarkResult run_mrlogger_benchmark(const BenchmarkConfig& config) {
 
     auto measurement_start = high_resolution_clock::now();
 
-    nanoseconds queue_time;
-    if (config.thread_count == 1) {
-        queue_time = measureSingleThreaded(logger, msgs_per_thread);
-    } else {
-        queue_time = measureMultiThreaded(logger, msgs_per_thread, config.thread_count);
-    }
+    HdrHistogram latency;
+    nanoseconds queue_time = config.measure_latency
+        ? measureLatency(logger, config, latency)
+        : measureThroughput(logger, config);
 
     // Flush to ensure all log messages are written to disk
     logger->flush();
@@ -229,12 +329,21 @@ BenchmarkResult run_mrlogger_benchmark(const BenchmarkConfig& config) {
         .benchmark_name = config.name,
         .log_file_name = config.logger_config.log_file_name,
         .thread_count = config.thread_count,
-        .config_details = {}
+        .config_details = {},
+        .latency = {},
+        .workload = config.payload.label()
     };
 
     result.config_details.mrlogger.queue_depth = config.logger_config.queue_depth;
     result.config_details.mrlogger.batch_size = config.logger_config.batch_size;
     result.config_details.mrlogger.max_logs_per_iteration = logger->getMaxLogsPerIteration();
+    if (config.measure_latency) {
+        recordLatency(result, config, latency);
+    }
+
+    // Tear the singleton down so several configurations can run in one process (e.g. scaling sweeps)
+    logger.reset();
+    MR::Logger::Logger::_reset();
 
     return result;
 }
@@ -248,6 +357,7 @@ BenchmarkResult run_spdlog_benchmark(const BenchmarkConfig& config) {
 
     auto measurement_start = high_resolution_clock::now();
 
+    HdrHistogram latency;
     nanoseconds queue_time;
 
     if (config.thread_count == 1) {
@@ -255,7 +365,9 @@ BenchmarkResult run_spdlog_benchmark(const BenchmarkConfig& config) {
         auto logger = spdlog::basic_logger_st("benchmark_logger", config.spdlog_file_name);
         logger->set_level(spdlog::level::info);
 
-        queue_time = measureSpdLoggerSingleThreaded(logger, msgs_per_thread);
+        queue_time = config.measure_latency
+            ? measureLatency(logger, config, latency)
+            : measureThroughput(logger, config);
 
         // Flush to ensure all logs are written
         logger->flush();
@@ -267,7 +379,9 @@ BenchmarkResult run_spdlog_benchmark(const BenchmarkConfig& config) {
         auto logger = spdlog::basic_logger_mt("benchmark_logger_mt", config.spdlog_file_name);
         logger->set_level(spdlog::level::info);
 
-        queue_time = measureSpdLoggerMultiThreaded(logger, msgs_per_thread, config.thread_count);
+        queue_time = config.measure_latency
+            ? measureLatency(logger, config, latency)
+            : measureThroughput(logger, config);
 
         // Flush to ensure all logs are written
         logger->flush();
@@ -303,10 +417,15 @@ BenchmarkResult run_spdlog_benchmark(const BenchmarkConfig& config) {
         .benchmark_name = config.name,
         .log_file_name = config.spdlog_file_name,
         .thread_count = config.thread_count,
-        .config_details = {}
+        .config_details = {},
+        .latency = {},
+        .workload = config.payload.label()
     };
 
     result.config_details.spdlog.is_spdlog = true;
+    if (config.measure_latency) {
+        recordLatency(result, config, latency);
+    }
 
     return result;
 }
@@ -0,0 +1,204 @@
+#include "Benchmark.hpp"
+#include "BenchConfigs.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace MR::Benchmarks;
+
+namespace {
+
+constexpr std::string_view USAGE = R"(Usage: mrlogger-bench [options]
+
+Runs one benchmark per combination of --threads and --payload, results go to
+build/BenchmarkResults like those of the fixed benchmark executables.
+
+  --preset NAME          Starting configuration (default: default). One of default, small,
+                         large, nobatch, mmap, spdlog, fixed, fixed-small, fixed-large,
+                         circular, mpsc, lanes
+  --queue TYPE           std, fixed, circular, mpsc or lanes
+  --queue-capacity N     Capacity of the bounded queues (default: 65536)
+  --batch-size N
+  --queue-depth N
+  --coalesce-size N
+  --messages N           Messages over all threads (default: 1000000)
+  --threads LIST         Thread counts, e.g. 1,2,4,8 (default: 1)
+  --payload LIST         String argument sizes in bytes, N or MIN-MAX (uniform) per entry,
+                         e.g. 16,512,64-4096 (default: the classic short message)
+  --args TYPE            Arguments next to the payload: string, int, float or mixed
+  --latency              Record per call latency percentiles
+  --rate N               Offered messages per second over all threads with --latency
+  --name NAME            Series name of the results (default: the preset name)
+  --help
+)";
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) end = list.size();
+        if (end > begin) items.push_back(list.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return items;
+}
+
+size_t parseSize(const std::string& text) {
+    size_t consumed = 0;
+    unsigned long long value = std::stoull(text, &consumed);
+    if (consumed != text.size()) throw std::invalid_argument("Not a number: " + text);
+    return static_cast<size_t>(value);
+}
+
+uint16_t parseU16(const std::string& text) {
+    size_t value = parseSize(text);
+    if (value == 0 || value > UINT16_MAX) throw std::invalid_argument("Out of range: " + text);
+    return static_cast<uint16_t>(value);
+}
+
+PayloadConfig parsePayload(const std::string& text, ArgumentTypes args) {
+    size_t dash = text.find('-');
+    PayloadConfig payload{.args = args};
+    if (dash == std::string::npos) {
+        payload.min_bytes = payload.max_bytes = parseSize(text);
+    } else {
+        payload.min_bytes = parseSize(text.substr(0, dash));
+        payload.max_bytes = parseSize(text.substr(dash + 1));
+    }
+    if (payload.max_bytes == 0 || payload.min_bytes > payload.max_bytes) {
+        throw std::invalid_argument("Invalid payload size: " + text);
+    }
+    return payload;
+}
+
+ArgumentTypes parseArgs(const std::string& text) {
+    if (text == "string") return ArgumentTypes::STRING;
+    if (text == "int") return ArgumentTypes::INTEGERS;
+    if (text == "float") return ArgumentTypes::FLOATS;
+    if (text == "mixed") return ArgumentTypes::MIXED;
+    throw std::invalid_argument("Unknown argument type: " + text);
+}
+
+struct Options {
+    std::string preset = "default";
+    std::string name;
+    std::string queue;
+    size_t queue_capacity = 65536;
+    uint16_t batch_size = 0;
+    uint16_t queue_depth = 0;
+    uint16_t coalesce_size = 0;
+    size_t messages = 1000000;
+    std::vector<size_t> threads{1};
+    std::vector<std::string> payloads;
+    ArgumentTypes args = ArgumentTypes::STRING;
+    bool latency = false;
+    double rate = 0.0;
+};
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    std::string payload_list;
+    std::string args = "string";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--help") {
+            std::cout << USAGE;
+            std::exit(0);
+        }
+        if (option == "--latency") {
+            options.latency = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + option);
+        std::string value = argv[++i];
+
+        if (option == "--preset") options.preset = value;
+        else if (option == "--name") options.name = value;
+        else if (option == "--queue") options.queue = value;
+        else if (option == "--queue-capacity") options.queue_capacity = parseSize(value);
+        else if (option == "--batch-size") options.batch_size = parseU16(value);
+        else if (option == "--queue-depth") options.queue_depth = parseU16(value);
+        else if (option == "--coalesce-size") options.coalesce_size = parseU16(value);
+        else if (option == "--messages") options.messages = parseSize(value);
+        else if (option == "--payload") payload_list = value;
+        else if (option == "--args") args = value;
+        else if (option == "--rate") options.rate = static_cast<double>(parseSize(value));
+        else if (option == "--threads") {
+            options.threads.clear();
+            for (const auto& item : splitList(value)) {
+                size_t threads = parseSize(item);
+                if (threads == 0) throw std::invalid_argument("Thread count must be positive");
+                options.threads.push_back(threads);
+            }
+        }
+        else throw std::invalid_argument("Unknown option: " + option);
+    }
+
+    options.args = parseArgs(args);
+    options.payloads = splitList(payload_list);
+    if (options.name.empty()) options.name = options.preset;
+    if (options.threads.empty()) throw std::invalid_argument("No thread counts given");
+    return options;
+}
+
+BenchmarkConfig makeConfig(const Options& options, size_t threads, const PayloadConfig& payload) {
+    BenchmarkConfig config = BenchConfigs::get_preset(options.preset, threads);
+
+    // Every thread logs the same number of messages
+    config.total_messages = options.messages / threads * threads;
+    config.payload = payload;
+    config.measure_latency = options.latency;
+    config.offered_rate = options.rate;
+
+    if (!options.queue.empty()) config.logger_config._queue = BenchConfigs::make_queue(options.queue, options.queue_capacity);
+    if (options.batch_size) config.logger_config.batch_size = options.batch_size;
+    if (options.queue_depth) config.logger_config.queue_depth = options.queue_depth;
+    if (options.coalesce_size) config.logger_config.coalesce_size = options.coalesce_size;
+
+    // <Series>_Scaling_<N>T is plotted as a thread scaling curve by benchmark_automation.py
+    std::string series = options.name;
+    if (payload.max_bytes != 0) series += "_" + payload.label();
+    config.name = options.threads.size() > 1
+        ? series + "_Scaling_" + std::to_string(threads) + "T"
+        : series + "_" + std::to_string(threads) + "T";
+    return config;
+}
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        Options options = parseOptions(argc, argv);
+
+        std::vector<PayloadConfig> payloads;
+        for (const auto& item : options.payloads) {
+            payloads.push_back(parsePayload(item, options.args));
+        }
+        if (payloads.empty()) payloads.push_back(PayloadConfig{});
+
+        // Validate every combination before the first (possibly long) run
+        std::vector<BenchmarkConfig> configs;
+        for (const auto& payload : payloads) {
+            for (size_t threads : options.threads) {
+                configs.push_back(makeConfig(options, threads, payload));
+            }
+        }
+
+        for (const auto& config : configs) {
+            run_benchmark(config);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "mrlogger-bench: " << e.what() << "\n\n" << USAGE;
+        return 1;
+    }
+
+    return 0;
+}
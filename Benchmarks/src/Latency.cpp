@@ -0,0 +1,17 @@
+#include "Benchmark.hpp"
+#include "BenchConfigs.hpp"
+
+using MR::Benchmarks::BenchConfigs;
+using MR::Benchmarks::BenchmarkType;
+
+// Caller thread latency percentiles of MRLogger vs spdlog, flat out and at a fixed offered rate
+int main() {
+    for (size_t threads : {1, 4}) {
+        for (auto type : {BenchmarkType::MRLogger, BenchmarkType::Spdlog}) {
+            MR::Benchmarks::run_benchmark(BenchConfigs::get_latency_config(type, threads, 0.0, 1000000));
+            MR::Benchmarks::run_benchmark(BenchConfigs::get_latency_config(type, threads, 100000.0, 200000));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+#include "Benchmark.hpp"
+#include "BenchConfigs.hpp"
+
+int main() {
+    auto config = MR::Benchmarks::BenchConfigs::get_mpsc_default_config(10);
+    config.name = "MPSC_Default_Multithreaded";
+
+    MR::Benchmarks::run_benchmark(config);
+
+    return 0;
+}
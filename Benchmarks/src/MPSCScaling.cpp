@@ -0,0 +1,23 @@
+#include "Benchmark.hpp"
+#include "BenchConfigs.hpp"
+
+#include <string>
+
+// Throughput scaling curve: lock-free MPSCRingQueue and per-thread SPSCLaneQueue vs mutex based CircularQueue
+int main() {
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        auto mpsc = MR::Benchmarks::BenchConfigs::get_mpsc_default_config(threads);
+        mpsc.name = "MPSC_Scaling_" + std::to_string(threads) + "T";
+        MR::Benchmarks::run_benchmark(mpsc);
+
+        auto lanes = MR::Benchmarks::BenchConfigs::get_lanes_default_config(threads);
+        lanes.name = "Lanes_Scaling_" + std::to_string(threads) + "T";
+        MR::Benchmarks::run_benchmark(lanes);
+
+        auto circular = MR::Benchmarks::BenchConfigs::get_circular_default_config(threads);
+        circular.name = "Circular_Scaling_" + std::to_string(threads) + "T";
+        MR::Benchmarks::run_benchmark(circular);
+    }
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+#include "Benchmark.hpp"
+#include "BenchConfigs.hpp"
+
+int main() {
+    auto config = MR::Benchmarks::BenchConfigs::get_mmap_config(1);
+    config.name = "Mmap_SingleThread";
+    
+    MR::Benchmarks::run_benchmark(config);
+    
+    return 0;
+}
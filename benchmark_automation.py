@@ -18,6 +18,7 @@ import sys
 import os
 import json
 import glob
+import re
 import shutil
 import pathlib
 from typing import List, Dict, Any
@@ -65,6 +66,9 @@ def discover_benchmark_executables():
     
     executables = []
     for item in os.listdir(benchmarks_dir):
+        # The parameterized driver needs arguments, sweeps are run by hand
+        if item == "mrlogger-bench":
+            continue
         item_path = os.path.join(benchmarks_dir, item)
         # Check if it's an executable file (not a directory)
         if os.path.isfile(item_path) and os.access(item_path, os.X_OK):
@@ -209,14 +213,30 @@ def calculate_statistics(benchmark_data: Dict[str, List[Dict[str, Any]]]):
             'run_count': len(runs)
         }
 
+        # Median of every latency percentile over the runs
+        latency_runs = [run['latency'] for run in runs if 'latency' in run]
+        if latency_runs:
+            stats[benchmark_name]['latency_ns'] = {
+                key: float(np.median([latency[key] for latency in latency_runs]))
+                for key in LATENCY_PERCENTILES
+            }
+
     return stats
 
+LATENCY_PERCENTILES = ['p50_ns', 'p99_ns', 'p999_ns', 'max_ns']
+LATENCY_PATTERN = re.compile(r'^Latency_(?P<logger>[^_]+)_(?P<mode>.+)$')
+
+SCALING_PATTERN = re.compile(r'^(?P<series>.+)_Scaling_(?P<threads>\d+)T$')
+
 def separate_benchmarks_by_threading(stats: Dict[str, Dict[str, Dict[str, float]]]):
     """Separate benchmark results into single-threaded and multi-threaded categories."""
     single_threaded = {}
     multi_threaded = {}
 
     for benchmark_name, data in stats.items():
+        # Thread sweeps get their own line plot (see create_scaling_plot)
+        if SCALING_PATTERN.match(benchmark_name) or LATENCY_PATTERN.match(benchmark_name):
+            continue
         if data['threads'] > 1:
             multi_threaded[benchmark_name] = data
         else:
@@ -345,6 +365,71 @@ def create_comparison_plot(stats: Dict[str, Dict[str, Dict[str, float]]], plots_
     plt.close()
     print(f"Comparison plot saved to {plot_path}")
 
+def create_scaling_plot(stats: Dict[str, Dict[str, Dict[str, float]]], plots_dir: str):
+    """Plot queue throughput against thread count for every <Series>_Scaling_<N>T benchmark."""
+    series = {}
+    for name, data in stats.items():
+        match = SCALING_PATTERN.match(name)
+        if not match:
+            continue
+        threads = int(match.group('threads'))
+        median_s = data['queue_time_ms']['median'] / 1000.0
+        throughput = data['messages_logged'] / median_s if median_s > 0 else 0
+        series.setdefault(match.group('series'), []).append((threads, throughput))
+
+    if not series:
+        print("No scaling benchmarks found, skipping scaling plot")
+        return
+
+    plt.figure(figsize=(12, 8))
+    for label, points in sorted(series.items()):
+        points.sort()
+        plt.plot([p[0] for p in points], [p[1] / 1e6 for p in points], marker='o', label=label)
+
+    plt.xscale('log', base=2)
+    plt.xlabel('Producer Threads')
+    plt.ylabel('Queue Throughput (M msgs/s, median)')
+    plt.title('Queue Throughput Scaling (More is Better)')
+    plt.legend()
+    plt.grid(True, alpha=0.3)
+    plt.tight_layout()
+
+    plot_path = os.path.join(plots_dir, 'scaling_queue_throughput.png')
+    plt.savefig(plot_path, dpi=300, bbox_inches='tight')
+    plt.close()
+    print(f"Scaling plot saved to {plot_path}")
+
+def create_latency_plot(stats: Dict[str, Dict[str, Dict[str, float]]], plots_dir: str):
+    """Plot the latency percentiles of every Latency_<Logger>_<Mode> benchmark side by side."""
+    names = sorted(name for name, data in stats.items()
+                   if LATENCY_PATTERN.match(name) and 'latency_ns' in data)
+    if not names:
+        print("No latency benchmarks found, skipping latency plot")
+        return
+
+    labels = ['p50', 'p99', 'p99.9', 'max']
+    x_pos = np.arange(len(names))
+    width = 0.2
+
+    plt.figure(figsize=(14, 8))
+    for i, (key, label) in enumerate(zip(LATENCY_PERCENTILES, labels)):
+        values = [stats[name]['latency_ns'][key] for name in names]
+        plt.bar(x_pos + i * width, values, width, label=label, alpha=0.8)
+
+    plt.yscale('log')
+    plt.xlabel('Benchmark (logger, offered rate, threads)')
+    plt.ylabel('Caller Latency per Message (ns, median of runs)')
+    plt.title('Logging Call Latency Percentiles (Less is Better)')
+    plt.xticks(x_pos + width * 1.5, names, rotation=45, ha='right')
+    plt.legend()
+    plt.grid(True, alpha=0.3, which='both')
+    plt.tight_layout()
+
+    plot_path = os.path.join(plots_dir, 'latency_percentiles.png')
+    plt.savefig(plot_path, dpi=300, bbox_inches='tight')
+    plt.close()
+    print(f"Latency plot saved to {plot_path}")
+
 def create_plots(stats: Dict[str, Dict[str, Dict[str, float]]]):
     """Create and save statistical plots separated by threading model."""
     plots_dir = "build/BenchmarkPlots"
@@ -360,6 +445,10 @@ def create_plots(stats: Dict[str, Dict[str, Dict[str, float]]]):
 
     create_comparison_plot(stats, plots_dir)
 
+    create_scaling_plot(stats, plots_dir)
+
+    create_latency_plot(stats, plots_dir)
+
 def analyze_and_plot_results():
     """Parse results, calculate statistics, and generate plots."""
     print("\nAnalyzing benchmark results...")
@@ -385,6 +474,10 @@ def analyze_and_plot_results():
               f"max={stat['queue_time_ms']['max']:.2f}, "
               f"avg={stat['queue_time_ms']['avg']:.2f}, "
               f"median={stat['queue_time_ms']['median']:.2f}")
+        if 'latency_ns' in stat:
+            latency = stat['latency_ns']
+            print(f"  Latency (ns): p50={latency['p50_ns']:.0f}, p99={latency['p99_ns']:.0f}, "
+                  f"p99.9={latency['p999_ns']:.0f}, max={latency['max_ns']:.0f}")
     
     # Create plots
     create_plots(stats)
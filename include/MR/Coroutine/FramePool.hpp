@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace MR::Coroutine {
+
+// Fixed size blocks for coroutine frames, so starting a task does not allocate.
+// WriteTask frames are taken from the pool installed on the calling thread (see
+// TaskList), frames larger than a block or started while the pool is exhausted
+// come from the heap. Not thread safe: only the installing thread allocates, and
+// every frame remembers where it came from, so it is always freed the right way.
+class FramePool {
+public:
+    // Room for the frames of all Logger tasks (a few hundred bytes each)
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 512;
+
+    explicit FramePool(size_t block_count, size_t block_size = DEFAULT_BLOCK_SIZE)
+        : block_size_{(block_size + HEADER_SIZE + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT},
+          storage_{std::make_unique<std::byte[]>(block_count * block_size_)} {
+        // Pushed in reverse so the first frames take the first blocks
+        free_.reserve(block_count);
+        for (size_t i = block_count; i > 0; --i) {
+            free_.push_back(static_cast<uint32_t>(i - 1));
+        }
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // The pool frames of the calling thread are allocated from, nullptr = heap
+    static FramePool*& current() noexcept {
+        thread_local FramePool* pool = nullptr;
+        return pool;
+    }
+
+    static void* allocateFrame(size_t size) {
+        FramePool* pool = current();
+        if (pool && size + HEADER_SIZE <= pool->block_size_ && !pool->free_.empty()) {
+            uint32_t index = pool->free_.back();
+            pool->free_.pop_back();
+            return withHeader(pool->storage_.get() + index * pool->block_size_, pool);
+        }
+        return withHeader(static_cast<std::byte*>(::operator new(size + HEADER_SIZE)), nullptr);
+    }
+
+    static void deallocateFrame(void* frame) noexcept {
+        auto* block = static_cast<std::byte*>(frame) - HEADER_SIZE;
+        FramePool* pool = *reinterpret_cast<FramePool**>(block);
+        if (pool) {
+            pool->free_.push_back(static_cast<uint32_t>((block - pool->storage_.get()) / pool->block_size_));
+        } else {
+            ::operator delete(block);
+        }
+    }
+
+    // Blocks not used by a frame
+    inline size_t available() const noexcept { return free_.size(); }
+
+private:
+    // Frames keep the default new alignment, the header in front of every frame
+    // holds its pool (nullptr for heap frames)
+    static constexpr size_t ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    static constexpr size_t HEADER_SIZE = ALIGNMENT;
+
+    static void* withHeader(std::byte* block, FramePool* pool) noexcept {
+        *reinterpret_cast<FramePool**>(block) = pool;
+        return block + HEADER_SIZE;
+    }
+
+    size_t block_size_;  // Including the header
+    std::unique_ptr<std::byte[]> storage_;
+    std::vector<uint32_t> free_;  // Free block indices, LIFO so recently used blocks are reused
+};
+
+} // namespace MR::Coroutine
@@ -1,4 +1,7 @@
 #pragma once
+#include <MR/Coroutine/FramePool.hpp>
+
+#include <cstddef>
 #include <exception>
 #include <coroutine>
 #include <iostream>
@@ -7,23 +10,41 @@
 
 namespace MR::Coroutine {
 
+class TaskList;
+
 class WriteTask {
   public:
 
     struct promise_type {
       std::exception_ptr exception;
-      
+
+      // Links of the TaskList holding the task (running list, then completed list)
+      TaskList* list = nullptr;
+      promise_type* prev = nullptr;
+      promise_type* next = nullptr;
+
+      // Frames come from the FramePool of the calling thread, if any
+      static void* operator new(size_t size) { return FramePool::allocateFrame(size); }
+      static void operator delete(void* frame) noexcept { FramePool::deallocateFrame(frame); }
+
+      // Moves the finished task to the completed list of its TaskList
+      struct FinalAwaiter {
+        inline bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> h) noexcept;
+        inline void await_resume() noexcept {}
+      };
+
       inline WriteTask get_return_object() {
           return WriteTask{std::coroutine_handle<promise_type>::from_promise(*this)};
       }
       inline std::suspend_never initial_suspend() { return {}; }
-      inline std::suspend_always final_suspend() noexcept { return {}; }
+      inline FinalAwaiter final_suspend() noexcept { return {}; }
       inline void return_void() {}
-      inline void unhandled_exception() { 
+      inline void unhandled_exception() {
           exception = std::current_exception();
       }
     };
-    
+
     inline explicit WriteTask(std::coroutine_handle<promise_type> h) : h_(h) {}
     inline ~WriteTask() {
         if (!h_) return;
@@ -40,7 +61,7 @@ class WriteTask {
 
         h_.destroy();
     }
-    
+
     // Move only
     inline WriteTask(WriteTask&& other) noexcept : h_(std::exchange(other.h_, {})) {}
     inline WriteTask& operator=(WriteTask&& other) noexcept {
@@ -74,8 +95,114 @@ class WriteTask {
     }
 
   private:
+    friend class TaskList;
     std::coroutine_handle<promise_type> h_;
 
 };
 
-}
\ No newline at end of file
+// The running tasks of one thread, linked through their promises. A task moves
+// itself to the completed list when it finishes (usually from inside
+// IOUring::processCompletions), so reap() only visits finished tasks instead of
+// scanning all of them. Installs a FramePool of frame_capacity frames on the
+// constructing thread for as long as it lives, so it must be created, used and
+// destroyed by the same thread.
+class TaskList {
+  public:
+    inline explicit TaskList(size_t frame_capacity)
+      : pool_{frame_capacity}, previous_pool_{std::exchange(FramePool::current(), &pool_)} {}
+
+    inline ~TaskList() {
+        destroyAll(running_);
+        destroyAll(completed_);
+        FramePool::current() = previous_pool_;
+    }
+
+    TaskList(const TaskList&) = delete;
+    TaskList& operator=(const TaskList&) = delete;
+
+    // Takes over the task, one that already finished goes straight to the completed list
+    inline void adopt(WriteTask&& task) {
+        auto handle = std::exchange(task.h_, {});
+        if (!handle) return;
+
+        auto& promise = handle.promise();
+        ++size_;
+        if (handle.done()) {
+            pushCompleted(promise);
+            return;
+        }
+
+        promise.list = this;
+        promise.prev = nullptr;
+        promise.next = running_;
+        if (running_) running_->prev = &promise;
+        running_ = &promise;
+    }
+
+    // Calls on_done(std::exception_ptr) for every finished task and frees it,
+    // returns the number of tasks reaped
+    template <typename F>
+    inline size_t reap(F&& on_done) {
+        size_t reaped = 0;
+        while (completed_) {
+            promise_type* promise = completed_;
+            completed_ = promise->next;
+
+            on_done(promise->exception);
+            std::coroutine_handle<promise_type>::from_promise(*promise).destroy();
+            --size_;
+            ++reaped;
+        }
+        return reaped;
+    }
+
+    inline bool empty() const noexcept { return size_ == 0; }
+    inline size_t size() const noexcept { return size_; }
+
+    inline const FramePool& framePool() const noexcept { return pool_; }
+
+  private:
+    using promise_type = WriteTask::promise_type;
+    friend struct WriteTask::promise_type::FinalAwaiter;
+
+    inline void complete(promise_type& promise) noexcept {
+        if (promise.prev) {
+            promise.prev->next = promise.next;
+        } else {
+            running_ = promise.next;
+        }
+        if (promise.next) promise.next->prev = promise.prev;
+
+        promise.list = nullptr;
+        pushCompleted(promise);
+    }
+
+    inline void pushCompleted(promise_type& promise) noexcept {
+        promise.prev = nullptr;
+        promise.next = completed_;
+        completed_ = &promise;
+    }
+
+    static inline void destroyAll(promise_type* promise) noexcept {
+        while (promise) {
+            promise_type* next = promise->next;
+            std::coroutine_handle<promise_type>::from_promise(*promise).destroy();
+            promise = next;
+        }
+    }
+
+    FramePool pool_;
+    FramePool* previous_pool_;
+    promise_type* running_ = nullptr;    // Doubly linked, unlinked in O(1) on completion
+    promise_type* completed_ = nullptr;  // Singly linked, emptied by reap()
+    size_t size_ = 0;
+};
+
+inline void WriteTask::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+    auto& promise = h.promise();
+    if (promise.list) {
+        promise.list->complete(promise);
+    }
+}
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace MR::IO {
+
+  // Engine that writes the log file (see Config::backend)
+  enum class Backend {
+    // io_uring if the ring can be set up (e.g. not blocked by seccomp), mmap otherwise
+    AUTO,
+
+    // Asynchronous writes through IOUring, setup failures are fatal
+    IO_URING,
+
+    // MappedFile: messages are formatted straight into a shared mapping of the
+    // log file, no syscalls per write. See Config::mmap_chunk_size
+    MMAP
+  };
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <MR/IO/BinaryFormat.hpp>
+#include <MR/IO/PrefixCache.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MR::IO {
+
+/**
+ * Renders a Config::encoding = BINARY log back to the lines text mode writes.
+ *
+ * Streaming: decode() consumes the complete records at the start of its
+ * input and leaves an incomplete trailing record for the next call, so a
+ * file can be fed in chunks (see the mrlogger-decode tool).
+ */
+class BinaryDecoder {
+public:
+    // Appends the rendered lines of the complete records of input to out.
+    // Returns the number of bytes consumed. On malformed input error() is set
+    // and decoding stops at the offending record
+    size_t decode(std::string_view input, std::string& out);
+
+    // Empty unless decode() hit something that is not a valid binary log
+    inline const std::string& error() const noexcept { return error_; }
+
+    // Records rendered so far (EVENT and TEXT)
+    inline uint64_t messages() const noexcept { return messages_; }
+
+private:
+    struct Format {
+        std::string text;
+        std::vector<Binary::ArgType> types;
+        size_t args_size = 0;
+    };
+
+    enum class Status { OK, INCOMPLETE, INVALID };
+
+    Status decodeRecord(std::string_view input, size_t& pos, std::string& out);
+    void render(const Format& format, const char* args, std::string& out) const;
+
+    bool started_ = false;
+    uint8_t flags_ = 0;
+    int64_t last_timestamp_ = 0;
+    std::unordered_map<uint32_t, Format> formats_;
+    std::unordered_map<uint32_t, std::string> threads_;
+
+    PrefixCache prefix_cache_;
+    uint64_t messages_ = 0;
+    std::string error_;
+};
+
+} // namespace MR::IO
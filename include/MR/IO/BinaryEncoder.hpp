@@ -0,0 +1,246 @@
+#pragma once
+
+#include <MR/IO/BinaryFormat.hpp>
+#include <MR/Logger/WriteRequest.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <fmt/format.h>
+#include <fmt/std.h>
+
+namespace MR::IO {
+
+/**
+ * Turns write requests into the records of BinaryFormat.hpp.
+ *
+ * A request captured with an encodable DeferredFormat becomes an EVENT whose
+ * arguments are copied unformatted, anything else a TEXT record holding the
+ * message as it is. The format strings and thread ids are written to the
+ * dictionary the first time they are used, a thread id is the only thing
+ * ever rendered with fmt (once per thread).
+ *
+ * Like WritePreparer::formatTo, encode() returns the untruncated size. A
+ * record only advances the dictionary and timestamp state when it fit, so
+ * a caller retrying into a larger buffer re-emits whatever it depends on.
+ *
+ * Not thread safe - owned by the WritePreparer on the worker thread.
+ */
+class BinaryEncoder {
+public:
+    static constexpr size_t MAX_THREADS = 1024;
+
+    // At most capacity - 1 bytes are written, matching the text formatter's null terminator slot
+    size_t encode(Logger::WriteRequest& request, char* buffer, size_t capacity) {
+        RecordWriter out{buffer, capacity > 0 ? capacity - 1 : 0};
+
+        int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            request.timestamp.time_since_epoch()).count();
+
+        if (!started_) {
+            writeHeader(out, timestamp);
+        }
+        int64_t previous = started_ ? last_timestamp_ : timestamp;
+
+        const Logger::DeferredFormat& deferred = request.deferred;
+        bool event = deferred.isEncodable();
+
+        FormatKey key{};
+        auto format = formats_.end();
+        if (event) {
+            key = FormatKey{deferred.formatString().data(), &deferred.signature()};
+            format = formats_.find(key);
+            if (format == formats_.end()) {
+                writeFormat(out, next_format_, deferred);
+            }
+        }
+
+        auto thread = threads_.find(request.threadId);
+        bool new_thread = thread == threads_.end();
+        if (new_thread && threads_.size() >= MAX_THREADS) {
+            // Indices are handed out again from 0, the decoder overwrites redefined entries
+            threads_.clear();
+            next_thread_ = 0;
+        }
+        uint32_t thread_index = new_thread ? next_thread_ : thread->second;
+        if (new_thread) {
+            writeThread(out, thread_index, request.threadId);
+        }
+
+        if (event) {
+            out.put(static_cast<uint8_t>(Binary::Tag::EVENT));
+            out.varint(format == formats_.end() ? next_format_ : format->second);
+        } else {
+            out.put(static_cast<uint8_t>(Binary::Tag::TEXT));
+        }
+        out.varint(Binary::zigzag(timestamp - previous));
+        out.varint(thread_index);
+        out.put(static_cast<uint8_t>(request.level));
+#ifdef LOGGER_TEST_SEQUENCE_TRACKING
+        out.varint(request.sequence_number);
+#endif
+
+        if (event) {
+            const auto& signature = deferred.signature();
+            if (out.remaining() >= signature.encoded_size) {
+                deferred.encode(out.cursor());
+            }
+            out.total += signature.encoded_size;
+        } else {
+            writeMessage(out, request);
+        }
+
+        if (out.total > out.limit) {
+            return out.total;
+        }
+
+        // The record fit, keep what it emitted
+        started_ = true;
+        last_timestamp_ = timestamp;
+        if (event && format == formats_.end()) {
+            formats_.emplace(key, next_format_++);
+        }
+        if (new_thread) {
+            threads_.emplace(request.threadId, next_thread_++);
+        }
+        return out.total;
+    }
+
+    // The next record starts a new header and dictionary, e.g. at the start of a rotated file
+    void reset() noexcept {
+        started_ = false;
+        formats_.clear();
+        threads_.clear();
+        next_format_ = 0;
+        next_thread_ = 0;
+    }
+
+private:
+    // Bounded appender that keeps counting past the end (format_to_n semantics)
+    struct RecordWriter {
+        char* buffer;
+        size_t limit;
+        size_t total = 0;
+
+        char* cursor() const { return buffer + std::min(total, limit); }
+        size_t remaining() const { return total < limit ? limit - total : 0; }
+
+        void append(const void* data, size_t length) {
+            std::memcpy(cursor(), data, std::min(length, remaining()));
+            total += length;
+        }
+
+        void put(uint8_t byte) {
+            if (total < limit) buffer[total] = static_cast<char>(byte);
+            ++total;
+        }
+
+        void varint(uint64_t value) {
+            while (value >= 0x80) {
+                put(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            put(static_cast<uint8_t>(value));
+        }
+
+        void string(std::string_view text) {
+            varint(text.size());
+            append(text.data(), text.size());
+        }
+    };
+
+    struct FormatKey {
+        const char* text;
+        const Logger::DeferredFormat::Signature* signature;
+
+        bool operator==(const FormatKey&) const = default;
+    };
+
+    struct FormatKeyHash {
+        size_t operator()(const FormatKey& key) const noexcept {
+            size_t hash = std::hash<const void*>{}(key.text);
+            return hash ^ (std::hash<const void*>{}(key.signature) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+        }
+    };
+
+    void writeHeader(RecordWriter& out, int64_t base) {
+        uint8_t flags = 0;
+#ifdef LOGGER_TEST_SEQUENCE_TRACKING
+        flags |= Binary::FLAG_SEQUENCE;
+#endif
+        if constexpr (std::endian::native == std::endian::big) {
+            flags |= Binary::FLAG_BIG_ENDIAN;
+        }
+
+        out.append(Binary::MAGIC, sizeof(Binary::MAGIC));
+        out.put(Binary::VERSION);
+        out.put(flags);
+        out.append(&base, sizeof(base));
+    }
+
+    void writeFormat(RecordWriter& out, uint32_t id, const Logger::DeferredFormat& deferred) {
+        const auto& signature = deferred.signature();
+        out.put(static_cast<uint8_t>(Binary::Tag::FORMAT));
+        out.varint(id);
+        out.put(signature.count);
+        if (signature.count > 0) {
+            out.append(signature.types, signature.count);
+        }
+        auto text = deferred.formatString();
+        out.string(std::string_view{text.data(), text.size()});
+    }
+
+    void writeThread(RecordWriter& out, uint32_t index, std::thread::id id) {
+        auto name = thread_names_.find(id);
+        if (name == thread_names_.end()) {
+            if (thread_names_.size() >= MAX_THREADS) {
+                thread_names_.clear();
+            }
+            name = thread_names_.emplace(id, fmt::format("{}", id)).first;
+        }
+
+        out.put(static_cast<uint8_t>(Binary::Tag::THREAD));
+        out.varint(index);
+        out.string(name->second);
+    }
+
+    // TEXT payload: u32 length followed by the message
+    void writeMessage(RecordWriter& out, const Logger::WriteRequest& request) {
+        uint32_t length = 0;
+        size_t length_at = out.total;
+        out.append(&length, sizeof(length));
+
+        if (request.deferred) {
+            // Deferred with an argument the dictionary can't describe or structured, formatted here instead
+            out.total += request.deferred.format(out.cursor(), out.remaining(), request.data);
+        } else {
+            out.append(request.data.data(), request.data.size());
+        }
+
+        length = static_cast<uint32_t>(out.total - length_at - sizeof(length));
+        if (out.total <= out.limit) {
+            std::memcpy(out.buffer + length_at, &length, sizeof(length));
+        }
+    }
+
+    bool started_ = false;
+    int64_t last_timestamp_ = 0;
+
+    std::unordered_map<FormatKey, uint32_t, FormatKeyHash> formats_;
+    uint32_t next_format_ = 0;
+
+    std::unordered_map<std::thread::id, uint32_t> threads_;
+    uint32_t next_thread_ = 0;
+
+    // Survives reset(), the rendering of an id never changes
+    std::unordered_map<std::thread::id, std::string> thread_names_;
+};
+
+} // namespace MR::IO
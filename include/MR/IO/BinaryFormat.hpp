@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace MR::IO::Binary {
+
+/**
+ * Wire format of Config::encoding = LogEncoding::BINARY, rendered back to
+ * text offline by mrlogger-decode (see BinaryDecoder).
+ *
+ * The file is a sequence of records, each starting with a one byte tag.
+ * Multi byte integers are varints (LEB128, signed ones zigzag encoded),
+ * fixed size fields and arguments are in host byte order (see FLAG_BIG_ENDIAN).
+ *
+ *   HEADER  "MRLB" version:u8 flags:u8 base_ns:i64
+ *           Starts every file (and every logger appending to it), resets
+ *           the dictionaries and the timestamp base
+ *   FORMAT  0x01 id:varint argc:u8 types:u8[argc] length:varint text
+ *           Dictionary entry, emitted once per format string before its first event
+ *   THREAD  0x02 index:varint length:varint name
+ *           Dictionary entry for the thread id as text mode renders it
+ *   EVENT   0x03 format:varint delta_ns:zigzag thread:varint level:u8 [seq:varint] args
+ *           args are the arguments packed back to back, sizes given by the FORMAT types
+ *   TEXT    0x04 delta_ns:zigzag thread:varint level:u8 [seq:varint] length:u32 message
+ *           A message formatted on the caller thread (arguments without an ArgType)
+ *
+ * delta_ns is relative to the previous record of the file (the header base
+ * for the first). seq is only present with FLAG_SEQUENCE. Zero bytes between
+ * records are padding (direct I/O tail blocks) and skipped.
+ */
+
+inline constexpr char MAGIC[4] = {'M', 'R', 'L', 'B'};
+inline constexpr uint8_t VERSION = 1;
+inline constexpr size_t HEADER_SIZE = sizeof(MAGIC) + 2 + sizeof(int64_t);
+
+inline constexpr uint8_t FLAG_SEQUENCE = 1 << 0;    // Events carry LOGGER_TEST_SEQUENCE_TRACKING numbers
+inline constexpr uint8_t FLAG_BIG_ENDIAN = 1 << 1;  // Fixed size fields were written on a big endian host
+
+enum class Tag : uint8_t {
+  PADDING = 0x00,
+  FORMAT = 0x01,
+  THREAD = 0x02,
+  EVENT = 0x03,
+  TEXT = 0x04
+};
+
+// Argument types stored as raw bytes, everything else is formatted on the caller thread
+enum class ArgType : uint8_t {
+  NONE = 0,
+  BOOL, CHAR,
+  I8, U8, I16, U16, I32, U32, I64, U64,
+  F32, F64
+};
+
+template <typename T>
+constexpr ArgType argTypeOf() noexcept {
+  if constexpr (std::is_same_v<T, bool>) {
+    return ArgType::BOOL;
+  } else if constexpr (std::is_same_v<T, char>) {
+    return ArgType::CHAR;
+  } else if constexpr (std::is_same_v<T, wchar_t> || std::is_same_v<T, char8_t> ||
+                       std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>) {
+    return ArgType::NONE;
+  } else if constexpr (std::is_integral_v<T>) {
+    constexpr bool is_signed = std::is_signed_v<T>;
+    if constexpr (sizeof(T) == 1) return is_signed ? ArgType::I8 : ArgType::U8;
+    else if constexpr (sizeof(T) == 2) return is_signed ? ArgType::I16 : ArgType::U16;
+    else if constexpr (sizeof(T) == 4) return is_signed ? ArgType::I32 : ArgType::U32;
+    else if constexpr (sizeof(T) == 8) return is_signed ? ArgType::I64 : ArgType::U64;
+    else return ArgType::NONE;
+  } else if constexpr (std::is_same_v<T, float>) {
+    return ArgType::F32;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return ArgType::F64;
+  } else {
+    return ArgType::NONE;
+  }
+}
+
+template <typename T>
+inline constexpr bool is_encodable_v = argTypeOf<T>() != ArgType::NONE;
+
+// Size of an argument in the packed args of an EVENT, 0 for unknown types
+constexpr size_t argSize(ArgType type) noexcept {
+  switch (type) {
+    case ArgType::BOOL: case ArgType::CHAR: case ArgType::I8: case ArgType::U8: return 1;
+    case ArgType::I16: case ArgType::U16: return 2;
+    case ArgType::I32: case ArgType::U32: case ArgType::F32: return 4;
+    case ArgType::I64: case ArgType::U64: case ArgType::F64: return 8;
+    default: return 0;
+  }
+}
+
+constexpr uint64_t zigzag(int64_t value) noexcept {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+constexpr int64_t unzigzag(uint64_t value) noexcept {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace MR::IO::Binary
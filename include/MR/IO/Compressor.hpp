@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace MR::IO {
+
+  // zstd support is optional (meson option `compression`). Without it everything
+  // below compiles but reports failure, see compressionAvailable()
+  bool compressionAvailable() noexcept;
+
+  // Compresses buffers into independent zstd frames. A file of concatenated
+  // frames decompresses to the concatenated input (`zstd -d` handles it).
+  class FrameCompressor {
+  private:
+    void* ctx_ = nullptr;  // ZSTD_CCtx, reused for every frame
+
+  public:
+    explicit FrameCompressor(int level);
+    ~FrameCompressor();
+
+    FrameCompressor(const FrameCompressor&) = delete;
+    FrameCompressor& operator=(const FrameCompressor&) = delete;
+
+    // Worst case frame size for length input bytes
+    static size_t bound(size_t length) noexcept;
+
+    // Returns the frame size, 0 on failure
+    size_t compress(const void* src, size_t length, void* dst, size_t capacity) noexcept;
+  };
+
+  struct CompressionBacklog {
+    size_t files = 0;  // Rotated files queued or being compressed
+    size_t bytes = 0;  // Their uncompressed size
+  };
+
+  // Streams rotated log files into <path>.zst on a low priority thread (nice 19,
+  // idle I/O class) and unlinks the original once the compressed copy is synced.
+  class BackgroundCompressor {
+  public:
+    using error_handler_t = std::function<void(const char*, const std::string&)>;
+
+    BackgroundCompressor(int level, error_handler_t on_error);
+
+    // Aborts the file in progress, it and every file still queued stay uncompressed
+    ~BackgroundCompressor() = default;
+
+    BackgroundCompressor(const BackgroundCompressor&) = delete;
+    BackgroundCompressor& operator=(const BackgroundCompressor&) = delete;
+
+    void enqueue(std::string path);
+    CompressionBacklog backlog() const noexcept;
+
+    // Compresses path into path + ".zst", then unlinks path. On failure the partial
+    // output is removed and path is kept. Returns the error message, empty on success
+    static std::string compressFile(const std::string& path, int level, std::stop_token st = {});
+
+  private:
+    int level_;
+    error_handler_t on_error_;
+
+    std::mutex mutex_;
+    std::condition_variable_any cv_;
+    std::deque<std::pair<std::string, size_t>> pending_;  // Path and size
+    std::atomic<size_t> backlog_files_{0};
+    std::atomic<size_t> backlog_bytes_{0};
+
+    // Last member, the thread starts once everything above is initialized
+    std::jthread worker_;
+
+    void run(std::stop_token st);
+  };
+
+}
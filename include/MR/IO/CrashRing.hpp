@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MR::IO {
+
+  // Default size of the record area of a CrashRing
+  inline constexpr size_t DEFAULT_CRASH_RING_SIZE = 4 * 1024 * 1024;
+
+  /**
+   * A copy of the log data between the WritePreparer and the completion of its
+   * write, kept in a file mapped MAP_SHARED (Config::crash_ring_file).
+   *
+   * Stores into a shared file mapping are in the page cache as soon as they are
+   * made, so they outlive the process however it dies (SIGKILL and the OOM killer
+   * included, no signal handler is involved). The worker appends every buffer it
+   * hands to io_uring as a record and marks it written when its CQE arrived.
+   * Records still pending when the file is opened again are what the previous
+   * process lost, recovered() hands them out so they can be replayed into the log.
+   *
+   * Not a durability guarantee against power loss, the mapping is never synced.
+   * Not thread safe, the worker is the only user after construction.
+   */
+  class CrashRing {
+  public:
+    static constexpr uint64_t NO_RECORD = UINT64_MAX;
+
+    // A buffer that never completed its write
+    struct Record {
+      uint16_t sink;  // Index into the logger's files, 0 = Config::log_file_name
+      std::string data;
+    };
+
+    // Opens or creates path with capacity bytes of records. Pending records of a
+    // previous run are read first (see recovered()), then the ring starts empty.
+    // Throws std::runtime_error if the file cannot be created or mapped
+    CrashRing(const std::string& path, size_t capacity = DEFAULT_CRASH_RING_SIZE);
+    ~CrashRing();
+
+    CrashRing(const CrashRing&) = delete;
+    CrashRing& operator=(const CrashRing&) = delete;
+
+    // Pending records found when the ring was opened, oldest first
+    inline std::vector<Record>& recovered() noexcept { return recovered_; }
+
+    // Copies size bytes as a pending record, NO_RECORD if they don't fit next to
+    // the records still pending (the data is then not protected)
+    uint64_t append(uint16_t sink, const void* data, size_t size) noexcept;
+
+    // The write of record completed, its space is reused once the records before it completed too
+    void complete(uint64_t record) noexcept;
+
+    inline size_t capacity() const noexcept { return capacity_; }
+
+    // Bytes of the records not completed yet, with their headers
+    size_t pendingBytes() const noexcept;
+
+  private:
+    struct Header;
+    struct RecordHeader;
+
+    int fd_ = -1;
+    char* map_ = nullptr;
+    size_t map_size_ = 0;
+    size_t capacity_ = 0;
+    std::vector<Record> recovered_;
+
+    Header& header() const noexcept;
+    char* records() const noexcept;
+    RecordHeader& recordAt(uint64_t position) const noexcept;
+
+    bool map(size_t size) noexcept;
+    void recover() noexcept;
+  };
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <MR/IO/LineWriter.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace MR::IO {
+
+namespace EscapeDetail {
+
+    constexpr uint64_t ONES = 0x0101010101010101ull;
+    constexpr uint64_t HIGHS = 0x8080808080808080ull;
+
+    // Nonzero if a byte of word is below limit (limit <= 128)
+    constexpr uint64_t anyBelow(uint64_t word, uint8_t limit) {
+        return (word - ONES * limit) & ~word & HIGHS;
+    }
+
+    // Nonzero if a byte of word equals c
+    constexpr uint64_t anyEqual(uint64_t word, uint8_t c) {
+        uint64_t x = word ^ (ONES * c);
+        return (x - ONES) & ~x & HIGHS;
+    }
+
+    // First byte at or after from that JSON needs escaped, text.size() if none. Eight bytes
+    // are tested per step while the text is clean, which it nearly always is
+    inline size_t findJsonSpecial(std::string_view text, size_t from) {
+        size_t i = from;
+        for (; i + 8 <= text.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, text.data() + i, sizeof(word));
+            if (anyBelow(word, 0x20) | anyEqual(word, '"') | anyEqual(word, '\\')) break;
+        }
+        for (; i < text.size(); ++i) {
+            auto c = static_cast<unsigned char>(text[i]);
+            if (c < 0x20 || c == '"' || c == '\\') return i;
+        }
+        return i;
+    }
+
+    // Whether a logfmt value has to be quoted: empty, or holding a space, control, '=', '"' or '\'
+    inline bool needsQuotes(std::string_view text) {
+        if (text.empty()) return true;
+        size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, text.data() + i, sizeof(word));
+            if (anyBelow(word, 0x21) | anyEqual(word, '"') | anyEqual(word, '=') | anyEqual(word, '\\')) return true;
+        }
+        for (; i < text.size(); ++i) {
+            auto c = static_cast<unsigned char>(text[i]);
+            if (c <= 0x20 || c == '"' || c == '=' || c == '\\') return true;
+        }
+        return false;
+    }
+
+    inline void appendEscape(char c, LineWriter& out) {
+        constexpr std::string_view HEX = "0123456789abcdef";
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                out.append("\\u00");
+                out.put(HEX[static_cast<unsigned char>(c) >> 4]);
+                out.put(HEX[static_cast<unsigned char>(c) & 0xf]);
+        }
+    }
+
+}
+
+// Appends text escaped for the inside of a JSON string, clean runs are copied in one go
+inline void appendJsonEscaped(std::string_view text, LineWriter& out) {
+    size_t begin = 0;
+    while (true) {
+        size_t special = EscapeDetail::findJsonSpecial(text, begin);
+        out.append(text.substr(begin, special - begin));
+        if (special == text.size()) return;
+        EscapeDetail::appendEscape(text[special], out);
+        begin = special + 1;
+    }
+}
+
+// Appends a logfmt value, quoted and escaped like a JSON string only when it has to be
+inline void appendLogfmtValue(std::string_view text, LineWriter& out) {
+    if (!EscapeDetail::needsQuotes(text)) {
+        out.append(text);
+        return;
+    }
+    out.put('"');
+    appendJsonEscaped(text, out);
+    out.put('"');
+}
+
+} // namespace MR::IO
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace MR::IO {
+
+// Wakes a sleeping worker thread. signal() may be called from any thread, the
+// worker sleeps in wait(). Registered with an io_uring (IOUring::registerEventFd)
+// the kernel signals it for every CQE as well.
+class EventFd {
+public:
+  inline EventFd() : fd_{::eventfd(0, EFD_CLOEXEC)} {
+    if (fd_ < 0) {
+      throw std::runtime_error("Failed to create the worker wakeup eventfd: " + std::string(std::strerror(errno)));
+    }
+  }
+
+  inline ~EventFd() {
+    ::close(fd_);
+  }
+
+  EventFd(const EventFd&) = delete;
+  EventFd& operator=(const EventFd&) = delete;
+
+  inline int fd() const noexcept { return fd_; }
+
+  inline void signal() noexcept {
+    uint64_t one = 1;
+    // Only fails if the counter would overflow, then a wakeup is pending anyway
+    [[maybe_unused]] ssize_t written = ::write(fd_, &one, sizeof(one));
+  }
+
+  // Sleeps until signalled or timeout_ms passed (-1 = no timeout) and consumes the
+  // signal. Returns false on timeout
+  inline bool wait(int timeout_ms) noexcept {
+    pollfd readiness{fd_, POLLIN, 0};
+    if (::poll(&readiness, 1, timeout_ms) <= 0) return false;
+
+    uint64_t count;
+    [[maybe_unused]] ssize_t consumed = ::read(fd_, &count, sizeof(count));
+    return true;
+  }
+
+private:
+  int fd_;
+};
+
+} // namespace MR::IO
@@ -10,7 +10,10 @@ namespace MR::IO {
     std::string extension_;
     size_t max_size_bytes_;
     size_t current_size_;
+    size_t next_index_ = 1;  // Lowest rotation index that may still be free
     
+    // An index is taken by the rotated file, its compressed archive or its timestamp index
+    static bool isTaken(const std::string& rotated_name);
     std::string getNextRotatedName();
     void extractBaseAndExtension(const std::string& filename);
     
@@ -18,7 +21,19 @@ namespace MR::IO {
     FileRotater(const std::string& filename, size_t max_size_bytes);
     
     bool shouldRotate() const;
-    void rotate();
+    // Renames the current file to the next rotated name (returned, empty if there was no file)
+    std::string rotate();
+
+    // Pipelined rotation: reserves the next rotated name and starts a new size count.
+    // The caller renames getCurrentFilename() to the returned name itself.
+    std::string beginRotation();
+
+    // File pre-opened for the next rotation, renamed to getCurrentFilename() when it happens
+    std::string getStandbyFilename() const;
+
+    // The current file is halfway to the limit, time to pre-open the standby file
+    bool shouldPrepareStandby() const;
+
     void updateCurrentSize(size_t bytes_written);
     std::string getCurrentFilename() const;
     void reset();
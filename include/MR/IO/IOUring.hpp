@@ -1,13 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <liburing.h>
 #include <stdexcept>
 #include <coroutine>
 #include <atomic>
 #include <chrono>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <MR/IO/WriteOnlyFile.hpp>
+#include <MR/IO/RingMode.hpp>
 
 
 namespace MR::IO {
@@ -16,20 +24,34 @@ private:
   std::atomic<bool> is_operational_{true};
 
 public:
-   struct WriteAwaiter {
+  // State shared by every operation awaiter, the CQE user data points at it
+  struct Completion {
+    int result = -1;
+    int sync_result = 0;             // Result of a linked fdatasync, -ECANCELED if the write failed
+    unsigned pending = 0;            // CQEs still outstanding before the coroutine is resumed
+    unsigned failures = 0;           // Operations of the awaiter that completed with an error
+    uint64_t transferred = 0;        // Sum of the positive results of its operations
+    std::coroutine_handle<> handle;  // Store handle directly in awaiter
+  };
+
+   struct WriteAwaiter : Completion {
     IOUring* ring;
     const WriteOnlyFile& file;
-    void* buffer;
+    void* buffer;                    // nullptr for a standalone fdatasync
     size_t len;
-    int result = -1;
-    std::coroutine_handle<> handle;  // Store handle directly in awaiter
+    int buf_index = -1;              // Registered buffer index, -1 for a regular write
+    bool sync = false;               // Link an fdatasync after the write
+    uint64_t offset = (uint64_t)-1;  // File offset, -1 writes at the current position (O_APPEND)
+    bool drain = false;              // IOSQE_IO_DRAIN: start only after every earlier SQE completed
+    const iovec* iovecs = nullptr;   // IORING_OP_WRITEV of iovec_count buffers instead of buffer / len
+    unsigned iovec_count = 0;
 
     bool await_ready() { return false; }
     void await_suspend(std::coroutine_handle<> h) {
       handle = h;  // Store handle for later resumption
 
       try {
-        bool success = ring->enqueueSQE(file, buffer, len, this);
+        bool success = ring->enqueueSQE(*this);
         if (!success) {
           result = -EAGAIN;
           h.resume();
@@ -44,9 +66,96 @@ public:
     }
   };
 
+  // Path based operations used by file rotation, co_await yields the result
+  // (0 for a rename, the new fd for an open, or the negative errno)
+  struct PathAwaiter : Completion {
+    enum class Op { RENAME, OPEN };
+
+    IOUring* ring;
+    Op op;
+    const char* path;
+    const char* new_path = nullptr;  // RENAME target
+    int flags = 0;                   // OPEN flags
+    bool drain = false;              // IOSQE_IO_DRAIN: start only after every earlier SQE completed
+
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+      handle = h;
+      if (!ring->enqueueSQE(*this)) {
+        result = -EAGAIN;
+        h.resume();
+      }
+    }
+    int await_resume() {
+      return result;
+    }
+  };
+
+  // Socket operations of a network sink, co_await yields the result (0 for a connect,
+  // the bytes sent by the last message, or the negative errno). A send of several
+  // messages queues one SQE per message and resumes once all completed, failures
+  // counts those that did not and transferred the bytes of the others. A zero copy
+  // send resumes after the kernel released the buffers (IORING_CQE_F_NOTIF), so they
+  // may be reused right away
+  struct SocketAwaiter : Completion {
+    enum class Op { CONNECT, SEND };
+
+    IOUring* ring;
+    Op op;
+    int fd;
+    const sockaddr* address = nullptr;  // CONNECT
+    socklen_t address_length = 0;
+    const msghdr* messages = nullptr;   // SEND, valid until the awaiter resumes
+    unsigned message_count = 0;
+    int msg_flags = 0;
+    bool zero_copy = false;             // IORING_OP_SENDMSG_ZC, see supportsZeroCopySend()
+    __kernel_timespec timeout{};        // Linked timeout of every operation, zero = none
+
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+      handle = h;
+      if (!ring->enqueueSQE(*this)) {
+        result = -EAGAIN;
+        h.resume();
+      }
+    }
+    int await_resume() {
+      return result;
+    }
+  };
+
+  // sqpoll_idle_ms and sqpoll_cpu only apply to RingMode::SQPOLL (0 = kernel default idle
+  // time, -1 = SQ thread not pinned). If the kernel rejects the requested mode the ring
+  // falls back to RingMode::DEFAULT, see mode() and setupError().
+  inline explicit IOUring(size_t queue_depth, RingMode mode = RingMode::DEFAULT,
+                          uint32_t sqpoll_idle_ms = 0, int sqpoll_cpu = -1)
+    : queue_depth_{queue_depth}, mode_{mode} {
+
+    io_uring_params params{};
+    switch (mode) {
+      case RingMode::SQPOLL:
+        params.flags = IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = sqpoll_idle_ms;
+        if (sqpoll_cpu >= 0) {
+          params.flags |= IORING_SETUP_SQ_AFF;
+          params.sq_thread_cpu = static_cast<uint32_t>(sqpoll_cpu);
+        }
+        break;
+      case RingMode::SINGLE_ISSUER:
+        // Created disabled so the submitter task becomes the worker thread that calls enable()
+        params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN |
+                       IORING_SETUP_TASKRUN_FLAG | IORING_SETUP_R_DISABLED;
+        break;
+      case RingMode::DEFAULT:
+        break;
+    }
 
-  inline explicit IOUring(size_t queue_depth) : queue_depth_{queue_depth} {
-    auto status = io_uring_queue_init(queue_depth, &ring_, 0);
+    auto status = io_uring_queue_init_params(queue_depth, &ring_, &params);
+    if (status < 0 && mode != RingMode::DEFAULT) {
+      setup_error_ = status;
+      mode_ = RingMode::DEFAULT;
+      status = io_uring_queue_init(queue_depth, &ring_, 0);
+    }
     if (status < 0) {
       throw std::runtime_error("error initializing io_uring: " + std::to_string(status));
     }
@@ -63,28 +172,179 @@ public:
 
   inline size_t capacity() const { return queue_depth_; }
 
+  // Mode the ring actually runs in, DEFAULT if the requested one was rejected
+  inline RingMode mode() const { return mode_; }
+
+  // Negative errno of the rejected setup when mode() fell back to DEFAULT, 0 otherwise
+  inline int setupError() const { return setup_error_; }
+
+  // Enables a ring created with IORING_SETUP_R_DISABLED. Must be called from the
+  // thread that submits (SINGLE_ISSUER binds the ring to the enabling thread).
+  inline int enable() noexcept {
+    if (!(ring_.flags & IORING_SETUP_R_DISABLED)) return 0;
+    return io_uring_enable_rings(&ring_);
+  }
+
   inline bool isOperational() const { return is_operational_.load(std::memory_order_acquire); }
   inline void markFailed() noexcept { is_operational_.store(false, std::memory_order_release); }
 
-  inline WriteAwaiter createWriteAwaiter(const WriteOnlyFile& file, void* buffer, size_t len) {
-    return WriteAwaiter{this, file, buffer, len, -1, {}};
+  inline WriteAwaiter createWriteAwaiter(const WriteOnlyFile& file, void* buffer, size_t len, int buf_index = -1, bool sync = false) {
+    WriteAwaiter awaiter{{}, this, file, buffer, len};
+    awaiter.buf_index = buf_index;
+    awaiter.sync = sync;
+    return awaiter;
+  }
+
+  // Gathers several buffers into one write, the iovecs must stay valid until the awaiter resumes.
+  // co_await yields the bytes written by all of them
+  inline WriteAwaiter createVectoredWriteAwaiter(const WriteOnlyFile& file, const iovec* iovecs, unsigned count, bool sync = false) {
+    WriteAwaiter awaiter{{}, this, file, nullptr, 0};
+    awaiter.iovecs = iovecs;
+    awaiter.iovec_count = count;
+    awaiter.sync = sync;
+    return awaiter;
+  }
+
+  // Standalone fdatasync, co_await yields its result
+  inline WriteAwaiter createSyncAwaiter(const WriteOnlyFile& file) {
+    return createWriteAwaiter(file, nullptr, 0, -1, true);
+  }
+
+  // IORING_OP_RENAMEAT, both paths must stay valid until the awaiter resumes
+  inline PathAwaiter createRenameAwaiter(const std::string& from, const std::string& to, bool drain = false) {
+    PathAwaiter awaiter{{}, this, PathAwaiter::Op::RENAME, from.c_str()};
+    awaiter.new_path = to.c_str();
+    awaiter.drain = drain;
+    return awaiter;
+  }
+
+  // IORING_OP_OPENAT, the path must stay valid until the awaiter resumes
+  inline PathAwaiter createOpenAwaiter(const std::string& path, int flags) {
+    PathAwaiter awaiter{{}, this, PathAwaiter::Op::OPEN, path.c_str()};
+    awaiter.flags = flags;
+    return awaiter;
+  }
+
+  // IORING_OP_CONNECT of a socket, the address must stay valid until the awaiter resumes
+  inline SocketAwaiter createConnectAwaiter(int fd, const sockaddr* address, socklen_t length,
+                                            std::chrono::milliseconds timeout = {}) {
+    SocketAwaiter awaiter{{}, this, SocketAwaiter::Op::CONNECT, fd};
+    awaiter.address = address;
+    awaiter.address_length = length;
+    awaiter.timeout = toTimespec(timeout);
+    return awaiter;
+  }
+
+  // IORING_OP_SENDMSG (or SENDMSG_ZC) of every message, see SocketAwaiter
+  inline SocketAwaiter createSendAwaiter(int fd, const msghdr* messages, unsigned count, int msg_flags = 0,
+                                         bool zero_copy = false, std::chrono::milliseconds timeout = {}) {
+    SocketAwaiter awaiter{{}, this, SocketAwaiter::Op::SEND, fd};
+    awaiter.messages = messages;
+    awaiter.message_count = count;
+    awaiter.msg_flags = msg_flags;
+    awaiter.zero_copy = zero_copy && supportsZeroCopySend();
+    awaiter.timeout = toTimespec(timeout);
+    return awaiter;
+  }
+
+  // Whether the kernel knows IORING_OP_SENDMSG_ZC (6.1), probed once
+  inline bool supportsZeroCopySend() noexcept {
+#ifdef IORING_CQE_F_NOTIF
+    if (zero_copy_supported_ < 0) {
+      io_uring_probe* probe = io_uring_get_probe_ring(&ring_);
+      zero_copy_supported_ = probe && io_uring_opcode_supported(probe, IORING_OP_SENDMSG_ZC) ? 1 : 0;
+      if (probe) io_uring_free_probe(probe);
+    }
+    return zero_copy_supported_ > 0;
+#else
+    return false;
+#endif
+  }
+
+  // Registers user buffers as io_uring fixed buffers so writes can use
+  // io_uring_prep_write_fixed and skip per-I/O page pinning.
+  // Returns the negative errno on failure (e.g. -ENOMEM for RLIMIT_MEMLOCK).
+  inline int registerBuffers(const std::vector<iovec>& iovecs) noexcept {
+    if (iovecs.empty()) return 0;
+    return io_uring_register_buffers(&ring_, iovecs.data(), static_cast<unsigned>(iovecs.size()));
+  }
+
+  // Registers fds in the fixed-file slots 0..n-1 (slot i holds fds[i]) so SQEs can use
+  // IOSQE_FIXED_FILE and the kernel skips the fd table lookup on every write.
+  // Returns the negative errno on failure, writes then keep using the raw fds.
+  inline int registerFiles(const std::vector<int>& fds) noexcept {
+    if (fds.empty()) return 0;
+
+    int status = io_uring_register_files(&ring_, fds.data(), static_cast<unsigned>(fds.size()));
+    if (status < 0) return status;
+
+    registered_fds_ = fds;
+    return 0;
+  }
+
+  // Swaps the file held by a fixed-file slot in place (e.g. after rotation).
+  // SQEs already submitted keep the old file, later ones target the new one.
+  // On failure the slot is no longer used and writes fall back to the raw fd.
+  inline int updateRegisteredFile(unsigned slot, int fd) noexcept {
+    if (slot >= registered_fds_.size()) return -EBADF;
+
+    int status = io_uring_register_files_update(&ring_, slot, &fd, 1);
+    registered_fds_[slot] = status < 0 ? -1 : fd;
+    return status < 0 ? status : 0;
+  }
+
+  // Makes the kernel signal event_fd whenever it posts a CQE (IORING_REGISTER_EVENTFD),
+  // so a thread sleeping on that fd also wakes for completions. Returns the negative errno
+  // on failure. With SINGLE_ISSUER only the thread that enabled the ring may register
+  inline int registerEventFd(int event_fd) noexcept {
+    return io_uring_register_eventfd(&ring_, event_fd);
+  }
+
+  // CQEs waiting for processCompletions(). With DEFER_TASKRUN completions pending as
+  // task work count too, they are posted by the next processCompletions()
+  inline bool hasCompletions() const noexcept {
+    if (io_uring_cq_ready(&ring_) > 0) return true;
+    return mode_ == RingMode::SINGLE_ISSUER &&
+      (__atomic_load_n(ring_.sq.kflags, __ATOMIC_ACQUIRE) & IORING_SQ_TASKRUN);
   }
 
   inline void processCompletions() noexcept {
     try {
+      // With DEFER_TASKRUN the completions are only posted once we enter the kernel.
+      // IORING_SQ_TASKRUN tells whether there is any pending work worth the syscall
+      if (mode_ == RingMode::SINGLE_ISSUER &&
+          (__atomic_load_n(ring_.sq.kflags, __ATOMIC_ACQUIRE) & IORING_SQ_TASKRUN)) {
+        io_uring_get_events(&ring_);
+      }
+
       io_uring_cqe* cqe;
       unsigned head;
       unsigned completed = 0;
 
       io_uring_for_each_cqe(&ring_, head, cqe) {
 
-          auto* awaiter = static_cast<WriteAwaiter*>(io_uring_cqe_get_data(cqe));
+          auto tagged = reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe));
+          auto* awaiter = reinterpret_cast<Completion*>(tagged & ~SYNC_TAG);
 
           if (awaiter) {
               // Store the I/O result in the awaiter
-              awaiter->result = cqe->res;
-              // Resume the coroutine
-              awaiter->handle.resume();
+              if (isNotification(cqe)) {
+                // Zero copy send: the kernel is done with the buffers
+              } else if (tagged & SYNC_TAG) {
+                awaiter->sync_result = cqe->res;
+              } else {
+                awaiter->result = cqe->res;
+                if (cqe->res < 0) {
+                  awaiter->failures++;
+                } else {
+                  awaiter->transferred += static_cast<uint64_t>(cqe->res);
+                }
+              }
+              // Resume the coroutine once the write and its linked sync both completed
+              // (a zero copy send posts its notification later, IORING_CQE_F_MORE)
+              if (!(cqe->flags & IORING_CQE_F_MORE) && --awaiter->pending == 0) {
+                awaiter->handle.resume();
+              }
               // No delete needed - awaiter is part of the coroutine frame
           }
           completed++;
@@ -119,13 +379,26 @@ public:
     return false; // timeout or error
   }
 
+  // Operations whose SQE did not fit the submission queue (their awaiter yields -EAGAIN),
+  // safe to read from any thread
+  inline uint64_t sqFullCount() const noexcept { return sq_full_.load(std::memory_order_relaxed); }
+
+  // SQEs prepared but not submitted yet, e.g. by a coroutine resumed from processCompletions()
+  inline bool hasUnsubmittedSQEs() const noexcept { return io_uring_sq_ready(&ring_) > 0; }
+
   inline bool submitPendingSQEs() noexcept {
 
     if (!is_operational_.load(std::memory_order_acquire)) {
       return false;
     }
 
-    int status = io_uring_submit(&ring_);
+    // SQPOLL: io_uring_submit only publishes the SQ tail and enters the kernel
+    // when the SQ thread went idle (IORING_SQ_NEED_WAKEUP), so while it is awake
+    // submitting is syscall free.
+    // SINGLE_ISSUER: the same syscall also runs the deferred completion work.
+    int status = mode_ == RingMode::SINGLE_ISSUER
+      ? io_uring_submit_and_get_events(&ring_)
+      : io_uring_submit(&ring_);
     if (status < 0) {
       markFailed();
       return false;
@@ -135,30 +408,148 @@ public:
   }
 
 private:
+  // Low bit of the CQE user data marks the completion of a linked fdatasync
+  // (awaiters are at least pointer aligned so the bit is otherwise always clear)
+  static constexpr uintptr_t SYNC_TAG = 1;
+
   size_t queue_depth_;
+  RingMode mode_;
+  int setup_error_ = 0;
   io_uring ring_;
+  std::vector<int> registered_fds_;  // fd currently held by each fixed-file slot, -1 if unused
+  int zero_copy_supported_ = -1;      // -1 = not probed yet
+  std::atomic<uint64_t> sq_full_{0};  // SQEs that could not be prepared, the awaiter got -EAGAIN
 
-  inline bool enqueueSQE(const WriteOnlyFile& file, void* buffer, size_t size, void* user_data) noexcept {
+  inline bool enqueueSQE(WriteAwaiter& awaiter) noexcept {
 
     // Check if ring is still operational
     if (!is_operational_.load(std::memory_order_acquire)) {
       return false;
     }
 
-    // GET SUBMISSION QUEUE ENTRY
-    io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
-    if (!sqe) {
+    // A linked write + fdatasync must be queued together
+    bool write = awaiter.buffer != nullptr || awaiter.iovec_count > 0;
+    unsigned needed = (write ? 1u : 0u) + (awaiter.sync ? 1u : 0u);
+    if (io_uring_sq_space_left(&ring_) < needed) {
       // Queue is full - this is normal backpressure, not a failure
       // Return false to signal that the SQE could not be prepared
+      sq_full_.fetch_add(1, std::memory_order_relaxed);
       return false;
     }
 
+    // With a registered file the fd field is the slot index instead of the fd
+    int fd = awaiter.file.fd();
+    auto slot = std::find(registered_fds_.begin(), registered_fds_.end(), fd);
+    bool fixed_file = fd >= 0 && slot != registered_fds_.end();
+    if (fixed_file) fd = static_cast<int>(slot - registered_fds_.begin());
+    unsigned base_flags = fixed_file ? IOSQE_FIXED_FILE : 0;
+    // Drain applies to the head of the (write -> fdatasync) chain only
+    unsigned drain_flag = awaiter.drain ? IOSQE_IO_DRAIN : 0;
+
+    awaiter.pending = needed;
+
     // PREPARE WRITE
-    io_uring_sqe_set_data(sqe, user_data);
-    io_uring_prep_write(sqe, file.fd(), buffer, size, (uint64_t)-1);
+    if (write) {
+      io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+      io_uring_sqe_set_data(sqe, static_cast<Completion*>(&awaiter));
+      if (awaiter.iovec_count > 0) {
+        io_uring_prep_writev(sqe, fd, awaiter.iovecs, awaiter.iovec_count, awaiter.offset);
+      } else if (awaiter.buf_index >= 0) {
+        io_uring_prep_write_fixed(sqe, fd, awaiter.buffer, awaiter.len, awaiter.offset, awaiter.buf_index);
+      } else {
+        io_uring_prep_write(sqe, fd, awaiter.buffer, awaiter.len, awaiter.offset);
+      }
+      // IO_LINK: the fdatasync only starts once the write completed successfully
+      io_uring_sqe_set_flags(sqe, base_flags | drain_flag | (awaiter.sync ? IOSQE_IO_LINK : 0));
+    }
+
+    // PREPARE FDATASYNC
+    if (awaiter.sync) {
+      // Standalone syncs report through result, linked ones through sync_result
+      io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+      uintptr_t tag = write ? SYNC_TAG : 0;
+      io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(static_cast<Completion*>(&awaiter)) | tag));
+      io_uring_prep_fsync(sqe, fd, IORING_FSYNC_DATASYNC);
+      io_uring_sqe_set_flags(sqe, base_flags | (write ? 0 : drain_flag));
+    }
     return true;
   }
 
+  static inline bool isNotification(const io_uring_cqe* cqe) noexcept {
+#ifdef IORING_CQE_F_NOTIF
+    return cqe->flags & IORING_CQE_F_NOTIF;
+#else
+    (void)cqe;
+    return false;
+#endif
+  }
+
+  static inline __kernel_timespec toTimespec(std::chrono::milliseconds timeout) noexcept {
+    __kernel_timespec ts{};
+    ts.tv_sec = timeout.count() / 1000;
+    ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+    return ts;
+  }
+
+  inline bool enqueueSQE(SocketAwaiter& awaiter) noexcept {
+    if (!is_operational_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    bool timed = awaiter.timeout.tv_sec > 0 || awaiter.timeout.tv_nsec > 0;
+    unsigned operations = awaiter.op == SocketAwaiter::Op::CONNECT ? 1u : awaiter.message_count;
+    if (operations == 0 || io_uring_sq_space_left(&ring_) < operations * (timed ? 2u : 1u)) {
+      sq_full_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    awaiter.pending = operations;
+    for (unsigned i = 0; i < operations; ++i) {
+      io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+      io_uring_sqe_set_data(sqe, static_cast<Completion*>(&awaiter));
+      if (awaiter.op == SocketAwaiter::Op::CONNECT) {
+        io_uring_prep_connect(sqe, awaiter.fd, awaiter.address, awaiter.address_length);
+#ifdef IORING_CQE_F_NOTIF
+      } else if (awaiter.zero_copy) {
+        io_uring_prep_sendmsg_zc(sqe, awaiter.fd, &awaiter.messages[i], static_cast<unsigned>(awaiter.msg_flags));
+#endif
+      } else {
+        io_uring_prep_sendmsg(sqe, awaiter.fd, &awaiter.messages[i], static_cast<unsigned>(awaiter.msg_flags));
+      }
+
+      if (timed) {
+        // The timeout cancels the operation it is linked to, its own CQE is ignored
+        io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+        io_uring_sqe* timeout = io_uring_get_sqe(&ring_);
+        io_uring_prep_link_timeout(timeout, &awaiter.timeout, 0);
+        io_uring_sqe_set_data(timeout, nullptr);
+      }
+    }
+    return true;
+  }
+
+  inline bool enqueueSQE(PathAwaiter& awaiter) noexcept {
+    if (!is_operational_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+      sq_full_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    if (awaiter.op == PathAwaiter::Op::RENAME) {
+      io_uring_prep_renameat(sqe, AT_FDCWD, awaiter.path, AT_FDCWD, awaiter.new_path, 0);
+    } else {
+      io_uring_prep_openat(sqe, AT_FDCWD, awaiter.path, awaiter.flags, 0644);
+    }
+    io_uring_sqe_set_data(sqe, static_cast<Completion*>(&awaiter));
+    io_uring_sqe_set_flags(sqe, awaiter.drain ? IOSQE_IO_DRAIN : 0);
+
+    awaiter.pending = 1;
+    return true;
+  }
 
 };
 
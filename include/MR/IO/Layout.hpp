@@ -0,0 +1,197 @@
+#pragma once
+
+#include <MR/Logger/WriteRequest.hpp>
+#include <MR/Logger/SeverityLevel.hpp>
+#include <MR/IO/PrefixCache.hpp>
+#include <MR/IO/LineWriter.hpp>
+#include <MR/IO/Escape.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace MR::IO {
+
+// What a layout renders a message from. Owned by the WritePreparer on the worker thread
+struct LayoutContext {
+    Logger::WriteRequest& request;
+    PrefixCache& prefix_cache;
+    std::string& scratch;  // Deferred messages are formatted into it before they are escaped
+};
+
+/**
+ * A log line layout, compiled from a pattern at compile time (see makeLayout):
+ *
+ *   %T  timestamp, like fmt formats the time_point
+ *   %e  timestamp as nanoseconds since the epoch
+ *   %L  severity name
+ *   %t  thread id
+ *   %q  sequence number (0 unless built with LOGGER_TEST_SEQUENCE_TRACKING)
+ *   %m  message, with the fields of a structured call (kv()) appended as " key=value"
+ *   %j  message escaped for a JSON string, without the fields
+ *   %F  fields of a structured call as JSON members: ,"key":value per field
+ *   %%  a literal %
+ *
+ * The pattern is split into literal runs and fields while compiling, every line
+ * is then rendered by a function doing nothing but those copies and fields, so a
+ * field missing from the pattern costs nothing. A newline is appended to every line.
+ * A default constructed Layout is the classic "[<timestamp>] [<level>] [Thread: <id>]: <message>".
+ */
+class Layout {
+public:
+    using Render = void (*)(LayoutContext&, LineWriter&);
+
+    constexpr Layout() = default;
+    constexpr explicit Layout(Render render) : render_{render} {}
+
+    constexpr bool isClassic() const noexcept { return render_ == nullptr; }
+
+    void render(LayoutContext& context, LineWriter& out) const { render_(context, out); }
+
+    friend constexpr bool operator==(const Layout&, const Layout&) = default;
+
+private:
+    Render render_ = nullptr;
+};
+
+namespace LayoutDetail {
+
+    // A string literal usable as a template argument
+    template<size_t N>
+    struct Pattern {
+        char text[N]{};
+
+        consteval Pattern(const char (&pattern)[N]) {
+            std::copy_n(pattern, N, text);
+        }
+
+        static constexpr size_t size() { return N - 1; }
+    };
+
+    consteval bool isField(char c) {
+        return c == 'T' || c == 'e' || c == 'L' || c == 't' || c == 'q' || c == 'm' || c == 'j' || c == 'F' || c == '%';
+    }
+
+    template<size_t N>
+    consteval bool valid(const Pattern<N>& pattern) {
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern.text[i] != '%') continue;
+            if (i + 1 >= pattern.size() || !isField(pattern.text[i + 1])) return false;
+            ++i;
+        }
+        return true;
+    }
+
+    // End of the literal run starting at begin
+    template<size_t N>
+    consteval size_t literalEnd(const Pattern<N>& pattern, size_t begin) {
+        size_t end = begin;
+        while (end < pattern.size() && pattern.text[end] != '%') ++end;
+        return end;
+    }
+
+    inline void appendMessage(LayoutContext& context, LineWriter& out) {
+        auto& request = context.request;
+        if (request.deferred) {
+            out.total += request.deferred.format(out.cursor(), out.remaining(), request.data);
+        } else {
+            out.append(request.data);
+        }
+    }
+
+    inline void appendJsonMessage(LayoutContext& context, LineWriter& out) {
+        auto& request = context.request;
+        if (!request.deferred) {
+            appendJsonEscaped(request.data, out);
+            return;
+        }
+        if (request.deferred.isStructured()) {
+            appendJsonEscaped(request.deferred.message(request.data), out);
+            return;
+        }
+
+        auto& scratch = context.scratch;
+        scratch.resize(scratch.capacity());
+        size_t size = request.deferred.format(scratch.data(), scratch.size());
+        if (size > scratch.size()) {
+            scratch.resize(size);
+            request.deferred.format(scratch.data(), scratch.size());
+        }
+        appendJsonEscaped(std::string_view(scratch.data(), size), out);
+    }
+
+    inline void appendJsonFields(LayoutContext& context, LineWriter& out) {
+        auto& request = context.request;
+        if (!request.deferred.isStructured()) return;
+
+        Logger::Field fields[Logger::DeferredFormat::MAX_FIELDS];
+        size_t count = request.deferred.fields(request.data, fields);
+        Logger::appendJsonFields(std::span<const Logger::Field>(fields, count), out);
+    }
+
+    template<char Field>
+    inline void appendField(LayoutContext& context, LineWriter& out) {
+        auto& request = context.request;
+        if constexpr (Field == 'T') {
+            out.append(context.prefix_cache.timestamp(request.timestamp));
+        } else if constexpr (Field == 'e') {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(request.timestamp.time_since_epoch());
+            fmt::format_int epoch(ns.count());
+            out.append(std::string_view{epoch.data(), epoch.size()});
+        } else if constexpr (Field == 'L') {
+            out.append(Logger::sevLvlName(request.level));
+        } else if constexpr (Field == 't') {
+            out.append(context.prefix_cache.thread(request.threadId));
+        } else if constexpr (Field == 'q') {
+            fmt::format_int sequence(request.sequence_number);
+            out.append(std::string_view{sequence.data(), sequence.size()});
+        } else if constexpr (Field == 'm') {
+            appendMessage(context, out);
+        } else if constexpr (Field == 'j') {
+            appendJsonMessage(context, out);
+        } else if constexpr (Field == 'F') {
+            appendJsonFields(context, out);
+        } else {
+            out.put('%');
+        }
+    }
+
+    template<Pattern P, size_t I>
+    inline void renderFrom(LayoutContext& context, LineWriter& out) {
+        if constexpr (I >= P.size()) {
+            out.put('\n');
+        } else if constexpr (P.text[I] == '%') {
+            appendField<P.text[I + 1]>(context, out);
+            renderFrom<P, I + 2>(context, out);
+        } else {
+            constexpr size_t END = literalEnd(P, I);
+            out.append(std::string_view(P.text + I, END - I));
+            renderFrom<P, END>(context, out);
+        }
+    }
+
+    template<Pattern P>
+    void render(LayoutContext& context, LineWriter& out) {
+        renderFrom<P, 0>(context, out);
+    }
+
+}
+
+// MR::IO::makeLayout<"%T %L %m">(), an unknown field fails to compile
+template<LayoutDetail::Pattern P>
+constexpr Layout makeLayout() {
+    static_assert(LayoutDetail::valid(P), "unknown field in log layout pattern, see MR/IO/Layout.hpp");
+    return Layout{&LayoutDetail::render<P>};
+}
+
+// One JSON object per line, for log shippers. Fields of structured calls become members
+inline constexpr Layout JSON_LAYOUT =
+    makeLayout<R"({"time":"%T","level":"%L","thread":"%t","message":"%j"%F})">();
+
+} // namespace MR::IO
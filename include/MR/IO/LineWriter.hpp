@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace MR::IO {
+
+// Bounded appender that keeps counting past the end (format_to_n semantics)
+struct LineWriter {
+    char* buffer;
+    size_t limit;
+    size_t total = 0;
+
+    char* cursor() const { return buffer + std::min(total, limit); }
+    size_t remaining() const { return total < limit ? limit - total : 0; }
+
+    void append(std::string_view text) {
+        if (size_t n = std::min(text.size(), remaining())) std::memcpy(cursor(), text.data(), n);
+        total += text.size();
+    }
+
+    void put(char c) {
+        if (total < limit) buffer[total] = c;
+        ++total;
+    }
+};
+
+} // namespace MR::IO
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <MR/IO/WriteOnlyFile.hpp>
+
+#include <cstddef>
+
+namespace MR::IO {
+
+  // Default size of the window MappedFile maps (and preallocates) at a time
+  inline constexpr size_t DEFAULT_MMAP_CHUNK_SIZE = 4 * 1024 * 1024;
+
+  /**
+   * Appends to a file through a shared memory mapping instead of write calls.
+   *
+   * The file is mapped chunk_size bytes at a time. The space of a window is
+   * preallocated with fallocate (which grows the file), so until trim() the
+   * file is longer than the data written. Windows behind the cursor are handed
+   * to writeback with msync(MS_ASYNC) and unmapped.
+   *
+   * Not thread safe, the mmap event loop is the only user.
+   */
+  class MappedFile {
+  private:
+    size_t chunk_size_;
+    size_t page_size_;
+
+    int fd_ = -1;                // Not owned, see open()
+    char* window_ = nullptr;
+    size_t window_offset_ = 0;   // File offset of window_, page aligned
+    size_t window_size_ = 0;
+
+    size_t cursor_ = 0;          // Logical end of the data
+    size_t file_size_ = 0;       // Size on disk, including the preallocated space
+    size_t synced_ = 0;          // Data before this offset was made durable by sync()
+
+    bool remap(size_t length) noexcept;
+    void unmap() noexcept;
+
+  public:
+    explicit MappedFile(size_t chunk_size = DEFAULT_MMAP_CHUNK_SIZE);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Starts appending after the current content of file, opened with FileMode::MAPPED.
+    // file must stay open until close()
+    void open(const WriteOnlyFile& file);
+
+    // Trims the file and drops the mapping, the file itself is left open
+    void close() noexcept;
+
+    // Pointer to at least length writable bytes at the cursor, nullptr if the
+    // file could not be grown or mapped (e.g. disk full)
+    char* reserve(size_t length) noexcept;
+
+    // Appends length bytes written through the last reserve()
+    inline void commit(size_t length) noexcept { cursor_ += length; }
+
+    // Writes everything appended since the last sync to stable storage.
+    // Returns the negative errno on failure
+    int sync() noexcept;
+
+    // Cuts the preallocated space past the logical end, so readers see the real size.
+    // Returns the negative errno on failure
+    int trim() noexcept;
+
+    inline size_t size() const noexcept { return cursor_; }
+    inline size_t chunkSize() const noexcept { return chunk_size_; }
+  };
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+
+namespace MR::IO {
+
+  // Bytes of the big endian length in front of every TCP frame
+  inline constexpr size_t TCP_FRAME_HEADER_SIZE = 4;
+
+  inline std::array<unsigned char, TCP_FRAME_HEADER_SIZE> tcpFrameHeader(uint32_t length) noexcept {
+    return {static_cast<unsigned char>(length >> 24), static_cast<unsigned char>(length >> 16),
+            static_cast<unsigned char>(length >> 8), static_cast<unsigned char>(length)};
+  }
+
+  // "<PRI>" header of a syslog message (RFC 5424), facility * 8 + severity
+  inline std::string syslogPriority(uint8_t facility, uint8_t severity) {
+    return "<" + std::to_string(facility * 8u + severity) + ">";
+  }
+
+  // Calls on_line with every non-empty line of text, without its '\n'
+  template<typename OnLine>
+  inline void forEachLine(std::string_view text, OnLine&& on_line) {
+    while (!text.empty()) {
+      size_t end = text.find('\n');
+      std::string_view line = text.substr(0, end);
+      if (!line.empty()) on_line(line);
+      if (end == std::string_view::npos) break;
+      text.remove_prefix(end + 1);
+    }
+  }
+
+  // Lines forEachLine calls back with
+  inline size_t countLines(std::string_view text) {
+    size_t lines = 0;
+    forEachLine(text, [&lines](std::string_view) { ++lines; });
+    return lines;
+  }
+
+  /**
+   * The address of a remote collector, resolved once when the logger is created so
+   * reconnecting never blocks the worker on a name lookup.
+   */
+  class NetworkTarget {
+  public:
+    // socket_type is SOCK_STREAM or SOCK_DGRAM. Throws std::runtime_error if host does not resolve
+    NetworkTarget(const std::string& host, uint16_t port, int socket_type);
+
+    // A new socket for the address, connected with IORING_OP_CONNECT. The negative errno on failure
+    int openSocket() const noexcept;
+
+    inline const sockaddr* address() const noexcept { return reinterpret_cast<const sockaddr*>(&address_); }
+    inline socklen_t addressLength() const noexcept { return address_length_; }
+    inline bool stream() const noexcept { return socket_type_ == SOCK_STREAM; }
+
+    // host:port, for error messages
+    inline const std::string& name() const noexcept { return name_; }
+
+  private:
+    sockaddr_storage address_{};
+    socklen_t address_length_ = 0;
+    int socket_type_;
+    std::string name_;
+  };
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <fmt/format.h>
+#include <fmt/std.h>
+#include <fmt/chrono.h>
+
+namespace MR::IO {
+
+/**
+ * Caches the expensive parts of the log line prefix for the worker thread.
+ *
+ * Timestamps: the full fmt rendering of a time_point is only produced once per
+ * second. Within the same second only the sub-second digits are patched in
+ * place. The number of fractional digits is taken from fmt's own output, so
+ * the text stays byte-identical to formatting the time_point with "{}"
+ * (fmt 11 prints the clock's full precision, older fmt versions none).
+ *
+ * Thread ids: rendered through fmt/std once per thread and looked up by id.
+ * The map is cleared when it grows past MAX_THREADS to bound memory with
+ * thread churn.
+ *
+ * Not thread safe - owned by the WritePreparer on the worker thread.
+ */
+class PrefixCache {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    static constexpr size_t MAX_THREADS = 1024;
+
+    std::string_view timestamp(time_point tp) {
+        auto second = std::chrono::floor<std::chrono::seconds>(tp);
+
+        if (!has_second_ || second != cached_second_) {
+            renderSecond(tp, second);
+        }
+
+        if (fraction_digits_ > 0) {
+            patchFraction(static_cast<uint64_t>((tp - second).count()));
+        }
+
+        return timestamp_;
+    }
+
+    std::string_view thread(std::thread::id id) {
+        if (last_thread_ != nullptr && last_thread_id_ == id) {
+            return *last_thread_;
+        }
+
+        auto it = threads_.find(id);
+        if (it == threads_.end()) {
+            if (threads_.size() >= MAX_THREADS) {
+                threads_.clear();
+            }
+            it = threads_.emplace(id, fmt::format("{}", id)).first;
+        }
+
+        last_thread_id_ = id;
+        last_thread_ = &it->second;
+        return it->second;
+    }
+
+private:
+    void renderSecond(time_point tp, std::chrono::sys_seconds second) {
+        timestamp_ = fmt::format("{}", tp);
+        cached_second_ = second;
+        has_second_ = true;
+
+        // Locate the trailing fractional digits fmt emitted (if any)
+        size_t end = timestamp_.size();
+        size_t start = end;
+        while (start > 0 && timestamp_[start - 1] >= '0' && timestamp_[start - 1] <= '9') {
+            --start;
+        }
+
+        fraction_digits_ = 0;
+        fraction_offset_ = 0;
+        if (start > 0 && start < end && timestamp_[start - 1] == '.') {
+            fraction_offset_ = start;
+            fraction_digits_ = end - start;
+        }
+    }
+
+    void patchFraction(uint64_t ticks) {
+        for (size_t i = fraction_digits_; i > 0; --i) {
+            timestamp_[fraction_offset_ + i - 1] = static_cast<char>('0' + ticks % 10);
+            ticks /= 10;
+        }
+    }
+
+    std::string timestamp_;
+    std::chrono::sys_seconds cached_second_{};
+    bool has_second_ = false;
+    size_t fraction_offset_ = 0;
+    size_t fraction_digits_ = 0;
+
+    std::unordered_map<std::thread::id, std::string> threads_;
+    std::thread::id last_thread_id_{};
+    const std::string* last_thread_ = nullptr;
+};
+
+} // namespace MR::IO
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace MR::IO {
+
+  // How IOUring sets up its ring (see Config::ring_mode)
+  enum class RingMode {
+    // Plain ring, every submitted batch costs one io_uring_enter syscall
+    DEFAULT,
+
+    // IORING_SETUP_SQPOLL - a kernel thread polls the submission queue, so no
+    // syscall is needed while it is awake. It sleeps after sqpoll_idle_ms
+    // without work and is woken up by the next submit.
+    SQPOLL,
+
+    // IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN - completions are
+    // only processed when the (single) worker thread asks for them, which
+    // avoids interrupting it with task work while it formats messages.
+    SINGLE_ISSUER
+  };
+
+}
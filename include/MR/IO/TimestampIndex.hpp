@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+namespace MR::IO {
+
+  /**
+   * The sidecar index of a text log file (Config::index_interval_bytes), kept as
+   * indexPath(<log file>) and renamed along with it on rotation.
+   *
+   * INDEX_MAGIC followed by fixed size IndexEntry records in host byte order, about
+   * one per interval of the log file. The offsets only grow; so do the timestamps, as
+   * far as messages reach the file in the order they were logged (threads racing for
+   * the queue may swap neighbours by microseconds, a line filter evens that out).
+   */
+  inline constexpr std::string_view INDEX_MAGIC{"MRLIDX01", 8};
+
+  struct IndexEntry {
+    uint64_t offset;       // Of a buffer in the log file, always the start of a line
+    int64_t timestamp_ns;  // When the first message of the buffer was logged, since the epoch
+    uint64_t message;      // Messages written to the file before it since the logger opened it
+  };
+  static_assert(sizeof(IndexEntry) == 24);
+
+  inline std::string indexPath(std::string_view log_path) {
+    return std::string(log_path) + ".idx";
+  }
+
+  // An entry's timestamp the way log lines show it (fmt's "{}" of the time_point)
+  inline std::string renderTimestamp(int64_t timestamp_ns) {
+    std::chrono::system_clock::time_point tp{
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp_ns))};
+    return fmt::format("{}", tp);
+  }
+
+  // Time bounds compare as text against rendered timestamps: from is an inclusive lower
+  // bound, until an inclusive prefix ("2026-10-14 10:05" covers that whole minute).
+  // An empty bound is open
+  inline bool beforeFrom(std::string_view timestamp, std::string_view from) noexcept {
+    return !from.empty() && timestamp < from;
+  }
+
+  inline bool afterUntil(std::string_view timestamp, std::string_view until) noexcept {
+    return !until.empty() && timestamp.substr(0, until.size()) > until;
+  }
+
+  /**
+   * Worker side: picks the buffers that get an entry while they are queued for their
+   * file. The caller appends pending() to the index file and clears it, at the latest
+   * before start() switches to the next file.
+   */
+  class IndexBuilder {
+  public:
+    inline explicit IndexBuilder(uint64_t interval) noexcept : interval_{interval} {}
+
+    // The file the following buffers go to, its next byte lands at offset. An index
+    // file that is still empty gets INDEX_MAGIC first
+    inline void start(uint64_t offset, bool empty_index) {
+      offset_ = offset;
+      next_entry_ = offset;
+      messages_ = 0;
+      if (empty_index) pending_.append(INDEX_MAGIC);
+    }
+
+    // A buffer appended to the file, first = when its first message was logged (epoch = unknown).
+    // A buffer without messages continues a line and gets no entry
+    inline void append(size_t bytes, uint32_t messages, std::chrono::system_clock::time_point first) {
+      if (messages > 0 && offset_ >= next_entry_ && first != std::chrono::system_clock::time_point{}) {
+        IndexEntry entry{
+          .offset = offset_,
+          .timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(first.time_since_epoch()).count(),
+          .message = messages_
+        };
+        pending_.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        next_entry_ = offset_ + interval_;
+      }
+      offset_ += bytes;
+      messages_ += messages;
+    }
+
+    inline std::string_view pending() const noexcept { return pending_; }
+    inline void clearPending() noexcept { pending_.clear(); }
+
+  private:
+    uint64_t interval_;
+    uint64_t offset_ = 0;
+    uint64_t next_entry_ = 0;
+    uint64_t messages_ = 0;
+    std::string pending_;
+  };
+
+  // The entries of the bytes of an index file, nullopt if they are no index. A partly
+  // written last entry (the process died) is ignored
+  inline std::optional<std::vector<IndexEntry>> readIndex(std::string_view bytes) {
+    if (bytes.substr(0, INDEX_MAGIC.size()) != INDEX_MAGIC) return std::nullopt;
+    bytes.remove_prefix(INDEX_MAGIC.size());
+
+    std::vector<IndexEntry> entries(bytes.size() / sizeof(IndexEntry));
+    std::memcpy(entries.data(), bytes.data(), entries.size() * sizeof(IndexEntry));
+    return entries;
+  }
+
+  struct ByteRange {
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  /**
+   * The part [begin, end) of a log file of file_size bytes holding every message logged
+   * within from and until, found with a binary search over the entries. It starts at the
+   * last entry before from (its buffer may reach past from) and ends at the first entry
+   * after until, the lines in it still need filtering. Bytes before the first entry were
+   * written before the file was indexed and are always included.
+   */
+  inline ByteRange indexRange(const std::vector<IndexEntry>& entries, uint64_t file_size,
+                              std::string_view from, std::string_view until) {
+    ByteRange range{0, file_size};
+
+    if (!from.empty()) {
+      auto first = std::partition_point(entries.begin(), entries.end(), [from](const IndexEntry& entry) {
+        return beforeFrom(renderTimestamp(entry.timestamp_ns), from);
+      });
+      if (first != entries.begin()) range.begin = std::prev(first)->offset;
+    }
+
+    if (!until.empty()) {
+      auto last = std::partition_point(entries.begin(), entries.end(), [until](const IndexEntry& entry) {
+        return !afterUntil(renderTimestamp(entry.timestamp_ns), until);
+      });
+      if (last != entries.end()) range.end = last->offset;
+    }
+
+    // Entries written ahead of data that never made it to the file
+    range.end = std::min(range.end, file_size);
+    range.begin = std::min(range.begin, range.end);
+    return range;
+  }
+}
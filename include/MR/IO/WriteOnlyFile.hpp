@@ -4,31 +4,56 @@
 #include <string>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 
 namespace MR::IO {
+
+// Offset, length and buffer address alignment used for O_DIRECT writes
+inline constexpr size_t DIRECT_IO_BLOCK_SIZE = 4096;
+
+enum class FileMode {
+  APPEND,  // O_APPEND writes at the current end
+  DIRECT,  // O_DIRECT writes at explicit block aligned offsets
+  MAPPED   // Read/write so it can be mapped by MappedFile (a shared mapping needs both)
+};
+
 class WriteOnlyFile {
 
 private:
   std::string path_;
   int fd_;
+  FileMode mode_ = FileMode::APPEND;
 
   inline void close() noexcept {
-    if (!fd_) return;
+    if (fd_ < 0) return;
     ::close(fd_);
     fd_ = -1;
   }
 
 public:
 
-  inline explicit WriteOnlyFile(std::string_view file_path) : path_{file_path}, fd_{-1} {
-    fd_ = open(file_path.data(), O_WRONLY | O_CREAT | O_APPEND, 0644); // O_TRUNCATE possibly too?
+  // O_DIRECT and mapped files are written at explicit offsets, so they are not opened with O_APPEND
+  static inline int openFlags(FileMode mode) {
+    switch (mode) {
+      case FileMode::DIRECT: return O_WRONLY | O_CREAT | O_DIRECT;
+      case FileMode::MAPPED: return O_RDWR | O_CREAT;
+      case FileMode::APPEND: break;
+    }
+    return O_WRONLY | O_CREAT | O_APPEND;
+  }
+
+  inline explicit WriteOnlyFile(std::string_view file_path, FileMode mode = FileMode::APPEND) : path_{file_path}, fd_{-1}, mode_{mode} {
+    fd_ = open(path_.c_str(), openFlags(mode_), 0644); // O_TRUNCATE possibly too?
     if (fd_ < 0) {
       throw std::runtime_error("Fail to open log file");
     }
   }
 
-  inline WriteOnlyFile(WriteOnlyFile &&other) noexcept : fd_{other.fd_} {
+  // Takes ownership of fd, opened elsewhere (e.g. IORING_OP_OPENAT) with openFlags(mode)
+  inline WriteOnlyFile(std::string file_path, int fd, FileMode mode) : path_{std::move(file_path)}, fd_{fd}, mode_{mode} {}
+
+  inline WriteOnlyFile(WriteOnlyFile &&other) noexcept : path_{std::move(other.path_)}, fd_{other.fd_}, mode_{other.mode_} {
     other.fd_ = -1;
   }
 
@@ -36,7 +61,9 @@ public:
     if (this == &other) return *this;
 
     close();
+    path_ = std::move(other.path_);
     fd_ = other.fd_;
+    mode_ = other.mode_;
     other.fd_ = -1;
     return *this;
   }
@@ -45,17 +72,57 @@ public:
   inline WriteOnlyFile& operator=(const WriteOnlyFile&) = delete;
 
   inline ~WriteOnlyFile() noexcept {
-    if (!fd_) return; 
+    if (fd_ < 0) return;
     ::close(fd_);
   }
 
   inline int fd() const { return fd_; }
   inline const std::string& path() const { return path_; }
+  inline FileMode mode() const { return mode_; }
+  inline bool direct() const { return mode_ == FileMode::DIRECT; }
+
+  // Records that the file was renamed on disk, the descriptor is unaffected
+  inline void setPath(std::string new_path) { path_ = std::move(new_path); }
+
+  inline size_t size() const {
+    struct stat st{};
+    if (::fstat(fd_, &st) < 0) {
+      throw std::runtime_error("Failed to stat log file");
+    }
+    return static_cast<size_t>(st.st_size);
+  }
+
+  // Bytes of the last, partially written block_size block. A direct I/O writer
+  // restarts at the block boundary and has to rewrite them. Read through a
+  // separate buffered descriptor since this one is write only (and O_DIRECT).
+  inline std::string readPartialBlock(size_t block_size) const {
+    size_t file_size = size();
+    std::string tail(file_size % block_size, '\0');
+    if (tail.empty()) return tail;
+
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open log file for reading");
+    }
+    ssize_t n = ::pread(fd, tail.data(), tail.size(), static_cast<off_t>(file_size - tail.size()));
+    ::close(fd);
+    if (n != static_cast<ssize_t>(tail.size())) {
+      throw std::runtime_error("Failed to read the partial block of the log file");
+    }
+    return tail;
+  }
+
+  // Cut the zero padding of the last direct I/O block
+  inline void truncate(size_t length) const {
+    if (::ftruncate(fd_, static_cast<off_t>(length)) < 0) {
+      throw std::runtime_error("Failed to truncate log file");
+    }
+  }
   
   inline void reopen(const std::string& new_path) {
     close();
     path_ = new_path;
-    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    fd_ = open(path_.c_str(), openFlags(mode_), 0644);
     if (fd_ < 0) {
       throw std::runtime_error("Failed to reopen log file");
     }
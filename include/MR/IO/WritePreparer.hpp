@@ -3,11 +3,16 @@
 #include <MR/Logger/WriteRequest.hpp>
 #include <MR/Memory/BufferPool.hpp>
 #include <MR/Logger/SeverityLevel.hpp>
+#include <MR/IO/PrefixCache.hpp>
+#include <MR/IO/Layout.hpp>
+#include <MR/IO/BinaryEncoder.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <functional>
 #include <cstring>
 #include <optional>
+#include <string_view>
 
 #include <fmt/format.h>
 #include <fmt/std.h>
@@ -19,9 +24,13 @@ namespace MR::IO {
  * WritePreparer is responsible for preparing write requests for submission.
  *
  * This includes:
- * - Formatting log messages into buffers
+ * - Formatting log messages into buffers (or encoding them, see BinaryEncoder)
  * - Optionally coalescing multiple messages into a single buffer
- * - Managing the staging buffer for coalescing
+ * - Managing the staging buffer for coalescing. It is a pool buffer, messages
+ *   are formatted straight into it and flushStaged() hands that same buffer
+ *   out, so coalesced bytes are never copied
+ * - Splitting messages larger than the largest pooled buffer over a chain of
+ *   them (Buffer::next), see prepareLargeWrite
  *
  * This class does NOT interact with io_uring - it only prepares data.
  * The caller (event loop) is responsible for submitting prepared buffers to io_uring.
@@ -32,7 +41,11 @@ public:
 
     struct Config {
         uint16_t coalesce_size;  // Number of messages to coalesce (0 = disabled)
-        size_t staging_buffer_size = 16384;  // 16KB staging buffer
+        size_t staging_buffer_size = 16384;  // 16KB staging buffer (a multiple of block_size in block mode)
+        bool sync_errors = false;  // Mark buffers holding ERROR messages for a linked fdatasync
+        size_t block_size = 0;  // Direct I/O: only hand out whole blocks (0 = disabled), see prepareBlockWrite
+        bool binary = false;  // Write BinaryFormat records instead of text lines
+        Layout layout = {};  // Line layout of text records
     };
 
     /**
@@ -40,7 +53,7 @@ public:
      * Contains an optional buffer ready for writing.
      */
     struct PreparedWrite {
-        std::unique_ptr<Memory::Buffer> buffer;  // Buffer ready for io_uring write (null if staged)
+        std::unique_ptr<Memory::Buffer> buffer;  // Buffer ready for io_uring write (null if staged), more may be chained to it
         bool should_flush_batch;                
     };
 
@@ -52,9 +65,18 @@ public:
         : config_(config)
         , buffer_pool_(buffer_pool)
         , error_reporter_(std::move(error_reporter))
-        , staging_buffer_(std::make_unique<char[]>(config.staging_buffer_size))
+        , coalesce_size_(config.coalesce_size)
     {}
 
+    WritePreparer(WritePreparer&&) = default;
+
+    // The staging buffer goes back to the pool, which must outlive the preparer
+    ~WritePreparer() {
+        if (staging_) {
+            buffer_pool_.release(std::move(staging_));
+        }
+    }
+
     /**
      * Prepare a write request for submission.
      *
@@ -66,7 +88,9 @@ public:
      * submit pending writes to io_uring.
      */
     PreparedWrite prepareWrite(Logger::WriteRequest&& request) {
-        if (config_.coalesce_size > 1) {
+        if (config_.block_size > 0) {
+            return prepareBlockWrite(std::move(request));
+        } else if (config_.coalesce_size > 1) {
             return prepareCoalescedWrite(std::move(request));
         } else {
             // Coalescing disabled - prepare individual write
@@ -77,81 +101,300 @@ public:
     /**
      * Flush any staged messages and return a buffer ready for writing.
      * Returns nullopt if there's nothing staged.
+     *
+     * In block mode only whole blocks are handed out and the partial tail
+     * block stays staged, unless include_tail is set: then the tail is
+     * written too, zero padded to a full block (Buffer::padding), and kept
+     * staged so the next write rewrites that block with more data appended.
      */
-    std::optional<std::unique_ptr<Memory::Buffer>> flushStaged() {
+    std::optional<std::unique_ptr<Memory::Buffer>> flushStaged(bool include_tail = false) {
+        if (config_.block_size > 0) {
+            return flushBlocks(include_tail);
+        }
+
         if (staging_offset_ == 0) {
             return std::nullopt;
         }
 
-        try {
-            // Copy staging buffer to persistent buffer from pool
-            auto persistent_buffer = buffer_pool_.acquire(staging_offset_);
-            std::memcpy(persistent_buffer->data, staging_buffer_.get(), staging_offset_);
-            persistent_buffer->size = staging_offset_;
+        // The messages were formatted into this buffer, it is written as is.
+        // The next staged message acquires a new one
+        auto buffer = std::move(staging_);
+        buffer->size = staging_offset_;
+        buffer->sync = staging_needs_sync_;
+        buffer->enqueued_at = staging_since_;
+        buffer->messages = static_cast<uint32_t>(messages_in_staging_);
 
-            // Reset staging state
-            staging_offset_ = 0;
-            messages_in_staging_ = 0;
+        staging_offset_ = 0;
+        messages_in_staging_ = 0;
+        staging_needs_sync_ = false;
 
-            return persistent_buffer;
-        } catch (const std::exception& e) {
-            error_reporter_("WritePreparer::flushStaged", e.what());
-            return std::nullopt;
-        }
+        return buffer;
     }
 
     bool hasStaged() const {
         return staging_offset_ > 0;
     }
 
+    size_t stagedMessages() const {
+        return messages_in_staging_;
+    }
+
+    // Enqueue time of the oldest staged message
+    std::chrono::system_clock::time_point stagedSince() const {
+        return staging_since_;
+    }
+
+    // Messages a staging buffer collects before it is handed out, changed at runtime by
+    // Config::autotune. Coalescing itself stays on or off as configured
+    void setCoalesceSize(uint16_t coalesce_size) noexcept {
+        coalesce_size_ = std::max<uint16_t>(coalesce_size, 1);
+    }
+    uint16_t coalesceSize() const noexcept { return coalesce_size_; }
+
+    // Block mode: staged bytes that were not written to the file in any form yet
+    bool hasUnwritten() const {
+        return staging_dirty_;
+    }
+
+    /**
+     * Block mode: seed the staging buffer with the partial last block of an
+     * existing file, so appending continues at the block boundary.
+     */
+    void preloadStaged(std::string_view bytes) {
+        size_t length = std::min(bytes.size(), config_.staging_buffer_size);
+        std::memcpy(stagingArea(), bytes.data(), length);
+        staging_offset_ = length;
+        messages_in_staging_ = 0;
+        staging_dirty_ = false;
+        staging_needs_sync_ = false;
+    }
+
+    /**
+     * Format a single message straight into caller owned memory (e.g. a mapped
+     * file), bypassing staging. Returns the untruncated size like formatTo, the
+     * request is left intact so it can be formatted again into a larger area.
+     */
+    size_t formatInto(Logger::WriteRequest& request, char* buffer, size_t capacity) {
+        return formatTo(std::move(request), buffer, capacity);
+    }
+
+    // Binary encoding: the next record starts a new header, call when switching to another file
+    void resetEncoding() noexcept {
+        encoder_.reset();
+    }
+
+    // Drop everything staged, e.g. once the tail was written to a file being rotated
+    void discardStaged() {
+        staging_offset_ = 0;
+        messages_in_staging_ = 0;
+        staging_dirty_ = false;
+        staging_needs_sync_ = false;
+    }
+
 private:
     /**
      * Prepare a write with coalescing enabled.
      */
     PreparedWrite prepareCoalescedWrite(Logger::WriteRequest&& request) {
-        // Format message directly into staging buffer
+        bool sync = needsSync(request);
+        auto enqueued_at = request.timestamp;
+
+        // Format message directly into the staging buffer
+        size_t formatted_size = formatTo(
+            std::move(request),
+            stagingArea() + staging_offset_,
+            config_.staging_buffer_size - staging_offset_
+        );
+
+        // Didn't fit the rest of the staging buffer (the last byte is the null terminator)
+        if (staging_offset_ + formatted_size >= config_.staging_buffer_size) {
+            return prepareOverflowingWrite(std::move(request), formatted_size, sync);
+        }
+
+        if (messages_in_staging_ == 0) staging_since_ = enqueued_at;
+        staging_offset_ += formatted_size;
+        messages_in_staging_++;
+        staging_needs_sync_ = staging_needs_sync_ || sync;
+
+        // Flush staging buffer when:
+        // 1. Reached coalesce threshold, OR
+        // 2. Buffer is nearly full (>90%), OR
+        // 3. It holds a message that must be made durable
+        bool should_flush = (messages_in_staging_ >= coalesce_size_) ||
+                           (staging_offset_ > config_.staging_buffer_size * 9 / 10) ||
+                           sync;
+
+        if (should_flush) {
+            auto buffer = flushStaged();
+            if (buffer.has_value()) {
+                return PreparedWrite{std::move(buffer.value()), true};
+            }
+        }
+
+        // Message staged, nothing to write yet
+        return PreparedWrite{nullptr, false};
+    }
+
+    /**
+     * A message that does not fit next to the staged ones. The staged messages
+     * are handed out and the message starts the next staging buffer. If it
+     * does not fit an empty staging buffer either, or has to be made durable
+     * right away, both go out together in one buffer of their own.
+     */
+    PreparedWrite prepareOverflowingWrite(Logger::WriteRequest&& request, size_t formatted_size, bool sync) {
+        if (staging_offset_ > 0 && formatted_size < config_.staging_buffer_size && !sync) {
+            auto flushed = flushStaged();
+            staging_since_ = request.timestamp;
+            staging_offset_ = formatTo(std::move(request), stagingArea(), config_.staging_buffer_size);
+            messages_in_staging_ = 1;
+            return PreparedWrite{std::move(flushed.value()), true};
+        }
+
+        try {
+            size_t total = staging_offset_ + formatted_size;
+            if (total >= buffer_pool_.largeBufferSize()) {
+                // Too large for one pooled buffer: the staged messages go first, in their own
+                auto buffer = prepareLargeWrite(request, formatted_size, staging_needs_sync_ || sync);
+                if (auto staged = flushStaged()) {
+                    staged.value()->sync = false;
+                    staged.value()->next = std::move(buffer);
+                    buffer = std::move(staged.value());
+                }
+                discardStaged();
+                return PreparedWrite{std::move(buffer), true};
+            }
+
+            auto buffer = buffer_pool_.acquire(total + 1);
+            buffer->enqueued_at = messages_in_staging_ > 0 ? staging_since_ : request.timestamp;
+            buffer->messages = static_cast<uint32_t>(messages_in_staging_ + 1);
+
+            std::memcpy(buffer->data, stagingArea(), staging_offset_);
+            formatTo(std::move(request), buffer->as_char() + staging_offset_, buffer->capacity - staging_offset_);
+            buffer->size = total;
+            buffer->sync = staging_needs_sync_ || sync;
+
+            discardStaged();
+            return PreparedWrite{std::move(buffer), true};
+        } catch (const std::exception& e) {
+            error_reporter_("WritePreparer::prepareOverflowingWrite", e.what());
+            return PreparedWrite{nullptr, false};
+        }
+    }
+
+    /**
+     * Prepare a write for a direct I/O (O_DIRECT) file.
+     *
+     * Every message is staged, and buffers only ever hold whole blocks so
+     * the writes stay aligned. The bytes of a partial last block are moved
+     * back to the start of the staging buffer and go out with the next one.
+     */
+    PreparedWrite prepareBlockWrite(Logger::WriteRequest&& request) {
+        bool sync = needsSync(request);
+        auto enqueued_at = request.timestamp;
+
         size_t formatted_size = formatTo(
             std::move(request),
-            staging_buffer_.get() + staging_offset_,
+            stagingArea() + staging_offset_,
             config_.staging_buffer_size - staging_offset_
         );
 
-        // Check if formatting succeeded (didn't overflow)
-        if (formatted_size > 0 && staging_offset_ + formatted_size <= config_.staging_buffer_size) {
+        if (staging_offset_ + formatted_size < config_.staging_buffer_size) {
+            if (messages_in_staging_ == 0) staging_since_ = enqueued_at;
             staging_offset_ += formatted_size;
             messages_in_staging_++;
+            staging_dirty_ = true;
+            staging_needs_sync_ = staging_needs_sync_ || sync;
 
-            // Flush staging buffer when:
-            // 1. Reached coalesce threshold, OR
-            // 2. Buffer is nearly full (>90%)
-            bool should_flush = (messages_in_staging_ >= config_.coalesce_size) ||
-                               (staging_offset_ > config_.staging_buffer_size * 9 / 10);
+            bool should_flush = (messages_in_staging_ >= coalesce_size_) ||
+                               (staging_offset_ > config_.staging_buffer_size * 9 / 10) ||
+                               sync;
 
-            if (should_flush && staging_offset_ > 0) {
-                auto buffer = flushStaged();
+            if (should_flush) {
+                // A message that must be durable takes the partial tail block along
+                auto buffer = flushBlocks(sync);
                 if (buffer.has_value()) {
                     return PreparedWrite{std::move(buffer.value()), true};
                 }
             }
 
-            // Message staged, nothing to write yet
             return PreparedWrite{nullptr, false};
-        } else {
-            // Buffer overflow or format error
-            // Flush current staging buffer first
-            auto flushed = flushStaged();
+        }
+
+        // Does not fit next to the staged bytes: hand both out in one oversized buffer
+        try {
+            size_t total = staging_offset_ + formatted_size;
+            auto buffer = buffer_pool_.acquire(alignUp(total + 1, config_.block_size));
+            buffer->enqueued_at = messages_in_staging_ > 0 ? staging_since_ : enqueued_at;
+
+            std::memcpy(buffer->data, stagingArea(), staging_offset_);
+            formatTo(std::move(request), buffer->as_char() + staging_offset_, buffer->capacity - staging_offset_);
+
+            size_t full = total / config_.block_size * config_.block_size;
+            buffer->size = full;
+            buffer->sync = staging_needs_sync_ || sync;
 
-            // Then prepare this message individually as fallback
-            auto individual = prepareIndividualWrite(std::move(request));
+            keepTail(buffer->as_char() + full, total - full);
+            return PreparedWrite{std::move(buffer), true};
+        } catch (const std::exception& e) {
+            error_reporter_("WritePreparer::prepareBlockWrite", e.what());
+            return PreparedWrite{nullptr, false};
+        }
+    }
+
+    std::optional<std::unique_ptr<Memory::Buffer>> flushBlocks(bool include_tail) {
+        size_t full = staging_offset_ / config_.block_size * config_.block_size;
+        size_t tail = staging_offset_ - full;
+        bool write_tail = include_tail && tail > 0 && staging_dirty_;
+
+        if (full == 0 && !write_tail) {
+            return std::nullopt;
+        }
 
-            // If we flushed something, return that first
-            // The current message will be lost in this case, which matches original behavior
-            if (flushed.has_value()) {
-                return PreparedWrite{std::move(flushed.value()), true};
+        try {
+            // The staging buffer itself is written, only the partial tail block
+            // is copied to the start of the next one
+            size_t size = write_tail ? full + config_.block_size : full;
+            auto buffer = std::move(staging_);
+
+            if (write_tail) {
+                std::memset(buffer->as_char() + staging_offset_, 0, size - staging_offset_);
+                buffer->padding = size - staging_offset_;
+            }
+            buffer->size = size;
+            buffer->sync = staging_needs_sync_;
+            buffer->enqueued_at = staging_since_;
+
+            keepTail(buffer->as_char() + full, tail);
+            if (write_tail) {
+                // On disk already, the next staged message makes it dirty again
+                staging_dirty_ = false;
             }
+            return buffer;
+        } catch (const std::exception& e) {
+            error_reporter_("WritePreparer::flushBlocks", e.what());
+            return std::nullopt;
+        }
+    }
+
+    // Restart the staging buffer with the bytes of a partial block
+    void keepTail(const char* tail, size_t length) {
+        std::memmove(stagingArea(), tail, length);
+        staging_offset_ = length;
+        messages_in_staging_ = 0;
+        staging_dirty_ = length > 0;
+        staging_needs_sync_ = false;
+    }
 
-            return individual;
+    // The buffer messages are staged in, acquired from the pool when the last one was handed out
+    char* stagingArea() {
+        if (!staging_) {
+            staging_ = buffer_pool_.acquire(config_.staging_buffer_size);
         }
+        return staging_->as_char();
+    }
+
+    static constexpr size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
     }
 
     /**
@@ -159,14 +402,24 @@ private:
      */
     PreparedWrite prepareIndividualWrite(Logger::WriteRequest&& request) {
         try {
-            // Estimate required buffer size (with some padding for safety)
-            size_t estimated_size = request.data.size() + 256;
+            // Estimate required buffer size (with some padding for safety), at most a pooled one
+            size_t estimated_size = std::min(request.data.size() + 256 +
+                (request.deferred ? request.deferred.sizeHint() : 0), buffer_pool_.largeBufferSize());
 
             // Acquire buffer from pool
             auto buffer = buffer_pool_.acquire(estimated_size);
+            buffer->sync = needsSync(request);
+            buffer->enqueued_at = request.timestamp;
+            buffer->messages = 1;
 
             // Format directly into buffer
             size_t actual_size = formatTo(std::move(request), buffer->as_char(), buffer->capacity);
+            if (actual_size >= buffer->capacity) {
+                // Truncated, the request is intact and formatted again into enough buffers
+                bool sync = buffer->sync;
+                buffer_pool_.release(std::move(buffer));
+                return PreparedWrite{prepareLargeWrite(request, actual_size, sync), false};
+            }
             buffer->size = actual_size;
 
             return PreparedWrite{std::move(buffer), false};
@@ -177,46 +430,152 @@ private:
     }
 
     /**
-     * Format a write request into a buffer.
+     * A message of formatted_size bytes that did not fit where it was formatted first.
+     * Up to the largest pooled buffer it gets a buffer of its own, beyond that a chain
+     * of largest pooled buffers linked through Buffer::next, written in order by the
+     * caller. No single oversized allocation and no truncation however long it is.
+     * Every buffer carries the message's timestamp for the latency statistics, only
+     * the first one counts the message (so no index entry points into its middle) and
+     * only the last one asks for the sync.
+     *
+     * The classic layout copies the text straight from the request behind the rendered
+     * prefix. Other layouts, deferred arguments and binary records are formatted into
+     * large_scratch_ once and copied from there.
+     */
+    std::unique_ptr<Memory::Buffer> prepareLargeWrite(Logger::WriteRequest& request, size_t formatted_size, bool sync) {
+        size_t piece = buffer_pool_.largeBufferSize();
+        if (formatted_size < piece) {
+            auto buffer = buffer_pool_.acquire(formatted_size + 1);
+            buffer->size = formatTo(std::move(request), buffer->as_char(), buffer->capacity);
+            buffer->sync = sync;
+            buffer->enqueued_at = request.timestamp;
+            buffer->messages = 1;
+            return buffer;
+        }
+
+        std::unique_ptr<Memory::Buffer> head;
+        Memory::Buffer* tail = nullptr;
+        auto append = [&](std::string_view bytes) {
+            while (!bytes.empty()) {
+                if (!tail || tail->size == tail->capacity) {
+                    auto buffer = buffer_pool_.acquire(piece);
+                    buffer->enqueued_at = request.timestamp;
+                    Memory::Buffer* next = buffer.get();
+                    (tail ? tail->next : head) = std::move(buffer);
+                    tail = next;
+                }
+                size_t length = std::min(bytes.size(), tail->capacity - tail->size);
+                std::memcpy(tail->as_char() + tail->size, bytes.data(), length);
+                tail->size += length;
+                bytes.remove_prefix(length);
+            }
+        };
+
+        if (!config_.binary && config_.layout.isClassic() && !request.deferred) {
+            // The prefix is what formatTo wrote besides the text and its newline
+            large_scratch_.resize(formatted_size - request.data.size() - 1);
+            LineWriter prefix{large_scratch_.data(), large_scratch_.size()};
+            formatPrefix(request, prefix);
+            append(large_scratch_);
+            append(request.data);
+            append("\n");
+        } else {
+            large_scratch_.resize(formatted_size + 1);
+            formatTo(std::move(request), large_scratch_.data(), large_scratch_.size());
+            append(std::string_view{large_scratch_.data(), formatted_size});
+        }
+
+        // A rare huge message doesn't keep its scratch space
+        if (large_scratch_.capacity() > MAX_KEPT_SCRATCH) {
+            large_scratch_ = std::string{};
+        }
+
+        head->messages = 1;
+        tail->sync = sync;
+        return head;
+    }
+
+    bool needsSync(const Logger::WriteRequest& request) const {
+        return config_.sync_errors && request.level >= Logger::SEVERITY_LEVEL::ERROR;
+    }
+
+    /**
+     * Format a write request into a buffer, with Config::layout or by default as
+     *   "[<timestamp>] [<level>] [Thread: <id>]: <message>\n"
+     * (plus " [Seq: N]" before the colon with LOGGER_TEST_SEQUENCE_TRACKING).
+     *
+     * The timestamp and thread id come pre-rendered from the PrefixCache, so
+     * the prefix is assembled with plain copies. At most capacity - 1 chars
+     * are written followed by a null terminator. Like fmt::format_to_n, the
+     * untruncated size is returned so callers can detect overflow.
      */
     size_t formatTo(Logger::WriteRequest&& request, char* buffer, size_t capacity) {
-#ifdef LOGGER_TEST_SEQUENCE_TRACKING
-        auto result = fmt::format_to_n(
-            buffer, capacity - 1,
-            "[{}] [{}] [Thread: {}] [Seq: {}]: {}\n",
-            request.timestamp,
-            Logger::sevLvlToStr(request.level),
-            request.threadId,
-            request.sequence_number,
-            std::move(request.data)
-        );
-#else
-        auto result = fmt::format_to_n(
-            buffer, capacity - 1,
-            "[{}] [{}] [Thread: {}]: {}\n",
-            request.timestamp,
-            Logger::sevLvlToStr(request.level),
-            request.threadId,
-            std::move(request.data)
-        );
-#endif
+        if (config_.binary) {
+            return encoder_.encode(request, buffer, capacity);
+        }
+
+        LineWriter out{buffer, capacity > 0 ? capacity - 1 : 0};
+
+        if (!config_.layout.isClassic()) {
+            LayoutContext context{request, prefix_cache_, layout_scratch_};
+            config_.layout.render(context, out);
+            if (out.total < capacity) {
+                buffer[out.total] = '\0';
+            }
+            return out.total;
+        }
+
+        formatPrefix(request, out);
+
+        if (request.deferred) {
+            out.total += request.deferred.format(out.cursor(), out.remaining(), request.data);
+        } else {
+            out.append(request.data);
+        }
+        out.put('\n');
 
         // Null terminate
-        if (result.size < capacity) {
-            buffer[result.size] = '\0';
+        if (out.total < capacity) {
+            buffer[out.total] = '\0';
         }
 
-        return result.size;
+        return out.total;
     }
 
+    // Everything of a classic line in front of the message text
+    void formatPrefix(const Logger::WriteRequest& request, LineWriter& out) {
+        out.put('[');
+        out.append(prefix_cache_.timestamp(request.timestamp));
+        out.append("] [");
+        out.append(Logger::sevLvlName(request.level));
+        out.append("] [Thread: ");
+        out.append(prefix_cache_.thread(request.threadId));
+#ifdef LOGGER_TEST_SEQUENCE_TRACKING
+        out.append("] [Seq: ");
+        fmt::format_int sequence(request.sequence_number);
+        out.append(std::string_view{sequence.data(), sequence.size()});
+#endif
+        out.append("]: ");
+    }
+
+    static constexpr size_t MAX_KEPT_SCRATCH = 1024 * 1024;
+
     Config config_;
     Memory::BufferPool& buffer_pool_;
     ErrorReporter error_reporter_;
-
-    // Staging buffer for coalescing
-    std::unique_ptr<char[]> staging_buffer_;
+    PrefixCache prefix_cache_;
+    std::string layout_scratch_;
+    std::string large_scratch_;  // See prepareLargeWrite
+    BinaryEncoder encoder_;
+
+    // Staging buffer for coalescing, written out as is (see flushStaged)
+    std::unique_ptr<Memory::Buffer> staging_;
+    uint16_t coalesce_size_;
     size_t staging_offset_ = 0;
     size_t messages_in_staging_ = 0;
+    std::chrono::system_clock::time_point staging_since_{};  // Enqueue time of the first staged message
+    bool staging_needs_sync_ = false;
+    bool staging_dirty_ = false;  // Block mode: staged bytes not written to the file yet
 };
 
 } // namespace MR::IO
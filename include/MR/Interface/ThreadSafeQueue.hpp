@@ -1,5 +1,7 @@
 #pragma once
 #include <optional>
+#include <span>
+#include <utility>
 
 
 namespace MR::Interface {
@@ -16,6 +18,19 @@ namespace MR::Interface {
       virtual size_t size() const = 0;
       virtual void shutdown() = 0;
 
+      // Moves up to out.size() elements into out without blocking and
+      // returns how many were written. Implementations should override this
+      // to drain the whole batch under a single lock / acquire.
+      virtual size_t tryPopBatch(std::span<T> out) {
+        size_t count = 0;
+        while (count < out.size()) {
+          auto element = tryPop();
+          if (!element) break;
+          out[count++] = std::move(*element);
+        }
+        return count;
+      }
+
       ThreadSafeQueue() = default;
 
       ThreadSafeQueue(const ThreadSafeQueue&) = delete;
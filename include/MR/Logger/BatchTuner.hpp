@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace MR::Logger {
+
+  /**
+   * The controller behind Config::autotune, fed by the worker thread only.
+   *
+   * Every WINDOW it turns what the event loop saw into the thresholds of the next one:
+   * - the arrival rate (messages popped per second, smoothed),
+   * - the SQ occupancy (most operations in flight relative to queue_depth),
+   * - the completion latency of writes (submission to CQE, smoothed).
+   *
+   * Staged messages may wait for more until the oldest reaches holdBudget(): max_delay
+   * minus what the device needs to complete the write, so a message is written about
+   * max_delay after it was logged at the latest. coalesceSize() is the number of messages
+   * expected within that budget, batchSize() the writes expected in it. Light traffic
+   * expects less than one further message: nothing is held and every write is submitted
+   * right away, as without autotuning. A busy ring always gets the largest batches.
+   */
+  class BatchTuner {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds WINDOW{1};
+
+    struct Bounds {
+      uint16_t min_batch_size;
+      uint16_t max_batch_size;
+      uint16_t min_coalesce_size;
+      uint16_t max_coalesce_size;
+      std::chrono::microseconds max_delay;
+    };
+
+    inline explicit BatchTuner(Bounds bounds, Clock::time_point now = Clock::now())
+      : bounds_{bounds},
+        window_start_{now},
+        batch_size_{bounds.min_batch_size},
+        coalesce_size_{bounds.min_coalesce_size},
+        hold_budget_{bounds.max_delay} {}
+
+    // Once per event loop iteration
+    inline void record(size_t popped, size_t in_flight, size_t queue_depth, Clock::time_point now) noexcept {
+      window_messages_ += popped;
+      if (queue_depth > 0) {
+        window_occupancy_ = std::max(window_occupancy_, static_cast<double>(in_flight) / static_cast<double>(queue_depth));
+      }
+
+      auto elapsed = now - window_start_;
+      if (elapsed < WINDOW) return;
+
+      double seconds = std::chrono::duration<double>(elapsed).count();
+      double rate = static_cast<double>(window_messages_) / seconds;
+      // A jump in traffic is followed within one window, a drop over RATE_DECAY (a long
+      // idle window, e.g. one the worker slept through, counts in full)
+      double weight = std::min(1.0, seconds / std::chrono::duration<double>(RATE_DECAY).count());
+      rate_ = rate > rate_ ? rate : rate_ + weight * (rate - rate_);
+
+      window_start_ = now;
+      window_messages_ = 0;
+      retune(window_occupancy_);
+      window_occupancy_ = 0.0;
+    }
+
+    // Submission to CQE of a write
+    inline void recordCompletion(std::chrono::nanoseconds latency) noexcept {
+      double sample = static_cast<double>(latency.count());
+      completion_ns_ = completion_ns_ == 0.0 ? sample : completion_ns_ + SMOOTHING * (sample - completion_ns_);
+    }
+
+    inline uint16_t batchSize() const noexcept { return batch_size_; }
+    inline uint16_t coalesceSize() const noexcept { return coalesce_size_; }
+    inline std::chrono::nanoseconds holdBudget() const noexcept { return hold_budget_; }
+
+    // Whether staged messages wait for more, oldest_age = since the first of them was logged
+    inline bool hold(size_t staged_messages, std::chrono::nanoseconds oldest_age) const noexcept {
+      return coalesce_size_ > 1 && staged_messages < coalesce_size_ && oldest_age < hold_budget_;
+    }
+
+    // Messages per second
+    inline double rate() const noexcept { return rate_; }
+
+  private:
+    static constexpr double SMOOTHING = 0.25;  // Of the completion latency, per write
+    static constexpr std::chrono::milliseconds RATE_DECAY{4};
+    static constexpr double BUSY_RING = 0.5;  // Occupancy from which every batch is as large as allowed
+
+    inline void retune(double occupancy) noexcept {
+      auto budget = std::chrono::duration_cast<std::chrono::nanoseconds>(bounds_.max_delay) -
+        std::chrono::nanoseconds(static_cast<int64_t>(completion_ns_));
+      hold_budget_ = std::max(budget, std::chrono::nanoseconds(0));
+
+      // Messages arriving while the oldest staged one may wait
+      double expected = rate_ * std::chrono::duration<double>(hold_budget_).count();
+      coalesce_size_ = clampTo(expected, bounds_.min_coalesce_size, bounds_.max_coalesce_size);
+
+      batch_size_ = occupancy >= BUSY_RING
+        ? bounds_.max_batch_size
+        : clampTo(expected / coalesce_size_, bounds_.min_batch_size, bounds_.max_batch_size);
+    }
+
+    static inline uint16_t clampTo(double value, uint16_t low, uint16_t high) noexcept {
+      return static_cast<uint16_t>(std::clamp(std::round(value), static_cast<double>(low), static_cast<double>(high)));
+    }
+
+    Bounds bounds_;
+    Clock::time_point window_start_;
+    size_t window_messages_ = 0;
+    double window_occupancy_ = 0.0;
+    double rate_ = 0.0;
+    double completion_ns_ = 0.0;
+
+    uint16_t batch_size_;
+    uint16_t coalesce_size_;
+    std::chrono::nanoseconds hold_budget_;
+  };
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <MR/Logger/WriteRequest.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace MR::Logger {
+
+  // Where the timestamps of messages come from (see Config::clock)
+  enum class ClockSource {
+    SYSTEM,           // std::chrono::system_clock::now(), full resolution
+    REALTIME_COARSE,  // CLOCK_REALTIME_COARSE: the time of the last scheduler tick, 1-4 ms resolution
+    TSC               // The raw time stamp counter, turned into wall time by the worker
+  };
+
+  /**
+   * The clock a logger stamps its messages with. stamp() is called on the caller
+   * threads, everything else by the worker only.
+   *
+   * With TSC the callers store a raw counter value in WriteRequest::timestamp and the
+   * worker converts every popped batch with toWallTime() before anything reads the
+   * timestamps. The conversion is anchored to the system clock with a rate measured
+   * against the steady clock. It is measured for a millisecond when the clock is
+   * created and again once per CALIBRATION_INTERVAL over the whole time since then, so
+   * it gets more precise and follows adjustments of the system clock.
+   * TSC needs an invariant counter (x86 CPUID 0x80000007), otherwise SYSTEM is used.
+   */
+  class Clock {
+  public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    static constexpr std::chrono::seconds CALIBRATION_INTERVAL{1};
+
+    inline explicit Clock(ClockSource requested) noexcept
+      : source_{requested == ClockSource::TSC && !invariantTsc() ? ClockSource::SYSTEM : requested} {
+      if (source_ != ClockSource::TSC) return;
+
+      first_ = sample();
+      auto until = first_.steady + std::chrono::milliseconds(1);
+      while (std::chrono::steady_clock::now() < until) {}
+      calibrate();
+    }
+
+    // The source actually used, SYSTEM if TSC was requested without an invariant counter
+    inline ClockSource source() const noexcept { return source_; }
+
+    // The stamp of a message logged now: a wall time, or raw ticks with TSC
+    inline time_point stamp() const noexcept {
+      switch (source_) {
+        case ClockSource::REALTIME_COARSE: {
+          timespec now;
+          ::clock_gettime(CLOCK_REALTIME_COARSE, &now);
+          return time_point{std::chrono::duration_cast<time_point::duration>(
+            std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec))};
+        }
+        case ClockSource::TSC:
+          return time_point{time_point::duration{static_cast<time_point::rep>(readTsc())}};
+        default:
+          return std::chrono::system_clock::now();
+      }
+    }
+
+    // Worker: the wall time now, read like the converted stamps so differences to them
+    // are unbiased (a coarse stamp trails the system clock by up to a tick)
+    inline time_point now() const noexcept {
+      return source_ == ClockSource::REALTIME_COARSE ? stamp() : std::chrono::system_clock::now();
+    }
+
+    // Worker: the stamps of popped requests become wall time (nothing to do unless TSC)
+    inline void toWallTime(std::span<WriteRequest> requests) noexcept {
+      if (source_ != ClockSource::TSC || requests.empty()) return;
+
+      if (std::chrono::steady_clock::now() - anchor_.steady >= CALIBRATION_INTERVAL) {
+        calibrate();
+      }
+      for (auto& request : requests) {
+        request.timestamp = wallTime(static_cast<uint64_t>(request.timestamp.time_since_epoch().count()));
+      }
+    }
+
+    // Worker: the wall time of raw ticks
+    inline time_point wallTime(uint64_t ticks) const noexcept {
+      double offset = static_cast<double>(static_cast<int64_t>(ticks - anchor_.ticks)) * ns_per_tick_;
+      return anchor_.wall + std::chrono::duration_cast<time_point::duration>(
+        std::chrono::nanoseconds(static_cast<int64_t>(offset)));
+    }
+
+    // Worker: measure the rate again and move the anchor to now
+    inline void calibrate() noexcept {
+      anchor_ = sample();
+      auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(anchor_.steady - first_.steady);
+      if (anchor_.ticks > first_.ticks && elapsed.count() > 0) {
+        ns_per_tick_ = static_cast<double>(elapsed.count()) / static_cast<double>(anchor_.ticks - first_.ticks);
+      }
+    }
+
+  private:
+    struct Sample {
+      uint64_t ticks = 0;
+      std::chrono::steady_clock::time_point steady{};
+      time_point wall{};
+    };
+
+    static inline uint64_t readTsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return 0;
+#endif
+    }
+
+    static inline bool invariantTsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+      return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) != 0;
+#else
+      return false;
+#endif
+    }
+
+    // The counter is read around the clocks, a sample preempted in between is taken again
+    static inline Sample sample() noexcept {
+      Sample best;
+      uint64_t best_span = UINT64_MAX;
+      for (int attempt = 0; attempt < 3; ++attempt) {
+        uint64_t before = readTsc();
+        auto steady = std::chrono::steady_clock::now();
+        auto wall = std::chrono::system_clock::now();
+        uint64_t after = readTsc();
+        if (after - before < best_span) {
+          best_span = after - before;
+          best = Sample{before + (after - before) / 2, steady, wall};
+        }
+      }
+      return best;
+    }
+
+    ClockSource source_;
+    Sample first_;
+    Sample anchor_;
+    double ns_per_tick_ = 1.0;
+  };
+}
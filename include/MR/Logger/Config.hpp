@@ -2,9 +2,18 @@
 
 #include <MR/Interface/ThreadSafeQueue.hpp>
 #include <MR/Logger/WriteRequest.hpp>
+#include <MR/Logger/Clock.hpp>
+#include <MR/Logger/SeverityLevel.hpp>
+#include <MR/IO/RingMode.hpp>
+#include <MR/IO/Backend.hpp>
+#include <MR/IO/Layout.hpp>
+#include <MR/Thread/Placement.hpp>
 #include <cstdint>
 #include <memory>
 #include <functional>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace MR::Logger {
 
@@ -16,12 +25,113 @@ namespace MR::Logger {
     write(STDERR_FILENO, "\n", 1);
   }
 
+  // When written data is forced to stable storage (see Config::durability)
+  enum class DurabilityMode {
+    // Never sync, data reaches the disk whenever the page cache writes it back
+    NONE,
+    // fdatasync every fsync_interval_ms or every fsync_interval_bytes written
+    PERIODIC,
+    // Every write holding an ERROR message is followed by a linked fdatasync
+    ERRORS
+  };
+
+  // Optional zstd compression (see Config::compression)
+  enum class CompressionMode {
+    NONE,
+    // Rotated files are streamed into <name>N.log.zst by a low priority background
+    // thread, the uncompressed file is removed once the copy is complete
+    ROTATED,
+    // Every buffer is compressed into its own zstd frame on the worker thread before
+    // it is written, the log file itself is a zstd stream
+    INLINE
+  };
+
+  // Representation of the log file (see Config::encoding)
+  enum class LogEncoding {
+    // One formatted line per message
+    TEXT,
+    // Records of MR/IO/BinaryFormat.hpp, rendered back to text by mrlogger-decode
+    BINARY
+  };
+
+  // What a producer does while Config::max_queued_messages messages are queued
+  enum class OverflowPolicy {
+    // Wait until the worker made room
+    BLOCK,
+    // Wait at most overflow_timeout_ms, then drop the message
+    BLOCK_TIMEOUT,
+    // Drop the message being logged
+    DROP_NEWEST,
+    // Queue the message anyway, the worker drops as many of the oldest queued messages
+    // as the limit is exceeded by. Twice the limit the new message is dropped instead
+    DROP_OLDEST,
+    // Drop messages below ERROR, ERROR messages wait for room
+    DROP_BELOW_ERROR
+  };
+
+  // Files the shards of a multi-worker logger write (see Config::worker_count)
+  enum class ShardOutput {
+    // Every shard writes its own files, <stem>.<shard><extension> next to the configured
+    // names. Shard 0 keeps the configured names
+    PER_SHARD_FILES,
+    // All shards append to the configured files. Every write lands whole at the current
+    // end of the file (O_APPEND), so lines never interleave, but they are only ordered
+    // within a shard. The files are never rotated
+    SHARED_FILE
+  };
+
+  // An additional log file (see Config::sinks)
+  struct SinkConfig {
+    std::string file_name;
+
+    // Severities written to this file (see severityMask() / severitiesFrom()), 0 = all
+    SeverityMask severities = 0;
+
+    // Rotation threshold of this file, 0 = Config::max_log_size_bytes
+    size_t max_log_size_bytes = 0;
+  };
+
+  // Wire format of a network sink (see Config::network_sinks)
+  enum class NetworkProtocol {
+    // A TCP stream of frames, every write buffer of the file is one frame: its length
+    // as 4 byte big endian number, then its lines. Lost connections are reopened
+    TCP,
+    // Every line as its own UDP datagram, prefixed with the syslog <PRI> header (RFC 5424).
+    // Datagrams that cannot be sent right away are dropped
+    UDP_SYSLOG
+  };
+
+  // A remote collector receiving what one log file receives (see Config::network_sinks)
+  struct NetworkSinkConfig {
+    // Name or address of the collector, resolved once when the logger is created
+    std::string host;
+    uint16_t port = 0;
+    NetworkProtocol protocol = NetworkProtocol::TCP;
+
+    // Log file whose lines are sent, empty = Config::log_file_name. The buffers formatted
+    // for the file are sent as they are, the messages are formatted once for both
+    std::string source_file = "";
+
+    // UDP_SYSLOG: facility and severity of the <PRI> header, the same for every line
+    // (1 = user-level, 6 = informational). The level of a message is part of its line
+    uint8_t syslog_facility = 1;
+    uint8_t syslog_severity = 6;
+
+    // Bytes waiting for the connection before further buffers are dropped (counted in
+    // Stats::network_lines_dropped, the file still gets them), 0 = 4 MiB
+    size_t max_pending_bytes = 0;
+
+    // Milliseconds a connect or send may take before the connection is dropped and
+    // reopened, 0 = 2000. A stopping logger waits at most a second for further sends
+    uint32_t timeout_ms = 0;
+  };
+
   struct Config {
 
     // The handler for all MrLogger internal errors (hopefully none :))
     error_handler_t internal_error_handler = nullptr;
 
-    // All severities always end up here
+    // Main log file, receives the severities in log_file_severities (all by default)
     std::string log_file_name;
 
     // Log files are rotated automatically. New log file will be used
@@ -46,7 +156,10 @@ namespace MR::Logger {
     // Must be >= batch_size
     uint16_t queue_depth;
 
-    // Buffer pool configuration
+    // Buffer pool configuration: most cached buffers per size class and the class
+    // sizes (small < medium < large). Messages larger than large_buffer_size, or
+    // arriving while a class is exhausted, use a plain allocation. A class starts
+    // with buffer_pool_initial_size buffers and keeps the allocated ones up to its size
     uint16_t small_buffer_pool_size;
     uint16_t medium_buffer_pool_size;
     uint16_t large_buffer_pool_size;
@@ -62,7 +175,8 @@ namespace MR::Logger {
     // For experimentation, different implementations of a ThreadSafeQueue can be used, e.g.
     // 1) StdQueue - my mutex/lock based std::queue wrapper
     // 2) moodycamel::ConcurrentQueue - lock free multi producer - multi consumer queue
-    // 3) ???
+    // 3) MPSCRingQueue - bounded lock free multi producer - single consumer ring
+    // 4) SPSCLaneQueue - one wait free SPSC lane per producer thread, merged by timestamp
     std::shared_ptr<Interface::ThreadSafeQueue<WriteRequest>> _queue;
 
     // Target maximum number of log messages to coalesce into a single buffer/write operation
@@ -77,5 +191,232 @@ namespace MR::Logger {
     // 0 = disable coalescing (format and write each message individually)
     uint16_t coalesce_size;
 
+    // Move formatting off the calling thread. When enabled, info/warn/error calls whose
+    // arguments are all deferrable (arithmetic, enums or types opted in via
+    // MR::Logger::is_deferrable, see DeferredFormat.hpp) only copy the format string
+    // pointer and the raw argument bytes into the WriteRequest; fmt runs on the worker
+    // thread straight into the staging buffer. Other calls are still formatted eagerly.
+    bool deferred_formatting = false;
+
+    // Runtime minimum severity. Messages below it are dropped before any formatting
+    // or queue push. Can be changed later with Logger::setMinSeverity().
+    // Defaults to INFO when not set. Levels below MRLOGGER_MIN_SEVERITY (meson option
+    // `min_severity`) are compiled out entirely regardless of this value.
+    std::optional<SEVERITY_LEVEL> min_severity = std::nullopt;
+
+    // Register the pooled buffers with io_uring at startup (io_uring_register_buffers)
+    // and submit them with write_fixed, so the kernel does not pin/map the user pages
+    // on every write. Buffers allocated outside the pool (pool exhausted or oversized
+    // messages) fall back to regular writes. If registration fails (e.g. RLIMIT_MEMLOCK)
+    // a warning is reported and all writes use the regular path.
+    bool register_buffers = false;
+
+    // io_uring setup mode of the worker's ring:
+    //   DEFAULT       - one io_uring_submit syscall per batch
+    //   SQPOLL        - a kernel thread polls the submission queue, submits are syscall
+    //                   free while it is awake. Costs a (mostly busy) kernel thread, so
+    //                   best used with sqpoll_cpu pinned to a dedicated core.
+    //   SINGLE_ISSUER - SINGLE_ISSUER | DEFER_TASKRUN, completions are processed only
+    //                   when the worker enters the kernel instead of interrupting it
+    // If the kernel rejects the mode a warning is reported and DEFAULT is used.
+    IO::RingMode ring_mode = IO::RingMode::DEFAULT;
+
+    // SQPOLL only: idle time in milliseconds before the SQ thread goes to sleep
+    // (0 = kernel default of one second) and the CPU it is pinned to (-1 = not pinned).
+    // sqpoll_cpu is rejected with worker_count > 1, see worker_cpus instead
+    uint32_t sqpoll_idle_ms = 0;
+    int sqpoll_cpu = -1;
+
+    // Durability policy. Syncs are submitted to io_uring as IORING_OP_FSYNC (datasync)
+    // and complete asynchronously like writes, so the worker never blocks on them.
+    // For ERRORS the sync is linked (IOSQE_IO_LINK) right after the write, which also
+    // makes staged ERROR messages flush immediately instead of waiting for coalescing.
+    DurabilityMode durability = DurabilityMode::NONE;
+
+    // PERIODIC only: sync when this many milliseconds passed since the last sync
+    // (0 = default of 1000) or this many bytes were written since (0 = no byte limit)
+    uint32_t fsync_interval_ms = 0;
+    size_t fsync_interval_bytes = 0;
+
+    // Write the log file with O_DIRECT, bypassing the page cache so logging does not
+    // evict the application's hot data. Writes go to explicit, block aligned offsets
+    // (4 KiB) from block aligned pool buffers, so several can be in flight at once.
+    // The partial last block stays in memory and is only written (zero padded, then
+    // truncated back to the real length) on flush(), rotation, shutdown and, with
+    // DurabilityMode::ERRORS, together with every ERROR message.
+    bool direct_io = false;
+
+    // zstd compression of the log files. Requires MR::Logger to be built with zstd
+    // (meson option `compression`), otherwise a warning is reported and nothing is
+    // compressed. INLINE is not supported together with direct_io. With INLINE,
+    // max_log_size_bytes counts compressed bytes.
+    // Logger::compressionBacklog() reports how far ROTATED compression is behind.
+    CompressionMode compression = CompressionMode::NONE;
+
+    // zstd level, negative levels trade ratio for speed (0 = zstd default of 3)
+    int compression_level = 0;
+
+    // Engine writing the log file:
+    //   AUTO     - io_uring, or MMAP if the ring cannot be set up (e.g. io_uring blocked
+    //              by seccomp in a container). The fallback is reported as a warning.
+    //   IO_URING - io_uring only, the constructor throws if the ring cannot be set up
+    //   MMAP     - the worker formats messages straight into a shared mapping of the log
+    //              file, no syscall per write. direct_io, ring_mode, register_buffers and
+    //              INLINE compression do not apply. The file is preallocated
+    //              mmap_chunk_size bytes ahead and only trimmed back by flush(), rotation
+    //              and shutdown. Until then, and after a crash, it may end in zero bytes.
+    IO::Backend backend = IO::Backend::AUTO;
+
+    // MMAP only: size of the mapped (and preallocated) window, 0 = default of 4 MiB
+    size_t mmap_chunk_size = 0;
+
+    // BINARY writes every format string once to a dictionary and after that only its id,
+    // a timestamp delta, the thread, the severity and the raw argument bytes per message.
+    // Calls whose arguments are all arithmetic are captured like deferred_formatting,
+    // so neither the caller nor the worker runs fmt for them. Others (strings, enums,
+    // user types) are formatted on the caller thread and stored as text records.
+    // Render the file with `mrlogger-decode <file>`.
+    LogEncoding encoding = LogEncoding::TEXT;
+
+    // Further log files next to log_file_name, each with its own severity mask, rotation
+    // and staging buffer. All files are written by the one worker thread and their
+    // writes go through the same io_uring in the same batches. A message is written to
+    // every file whose mask contains its severity, e.g. errors into a small file an
+    // alerting system tails:
+    //   .sinks = {{.file_name = "alerts.log", .severities = severitiesFrom(SEVERITY_LEVEL::ERROR)}}
+    std::vector<SinkConfig> sinks = {};
+
+    // Severities written to log_file_name, 0 = all
+    SeverityMask log_file_severities = 0;
+
+    // Allocate all pooled buffers out of one mmap region instead of one malloc each:
+    // fewer TLB entries, and with register_buffers a single registered buffer.
+    // Backed by hugepages when some are reserved (vm.nr_hugepages), otherwise
+    // advised for transparent hugepages
+    bool buffer_arena = false;
+
+    // mlock the buffer arena so it is never paged out (needs RLIMIT_MEMLOCK or CAP_IPC_LOCK)
+    bool lock_buffer_arena = false;
+
+    // Bytes coalesced into one write, 0 = default of 16 KiB. Messages are formatted
+    // straight into a pool buffer of this size which is then written as is, keep it
+    // at most large_buffer_size so that buffer comes from the large pool.
+    // Rounded up to whole 4 KiB blocks for direct_io
+    size_t staging_buffer_size = 0;
+
+    // Microseconds the idle worker keeps polling the queue before it goes to sleep.
+    // A sleeping worker is woken through an eventfd by the next message (one write
+    // syscall on the logging thread), spinning first avoids that within bursts at the
+    // cost of a busy core. 0 = sleep right away
+    uint32_t idle_spin_us = 0;
+
+    // Bound of the queued messages, 0 = none (the queue decides: StdQueue grows without
+    // limit, the bounded queues block or overwrite). While the limit is reached new
+    // messages are handled by overflow_policy. Dropped messages are counted per severity
+    // (Logger::droppedMessages()), and once the queue drained again the worker writes
+    // one WARN line saying how many were lost. The queue itself must not drop entries
+    // (CircularQueue), those would keep counting against the limit
+    size_t max_queued_messages = 0;
+    OverflowPolicy overflow_policy = OverflowPolicy::BLOCK;
+
+    // BLOCK_TIMEOUT only: milliseconds a producer waits for room, 0 = default of 10
+    uint32_t overflow_timeout_ms = 0;
+
+    // Worker threads, 0 = default of 1. Every worker is a shard with its own queue, ring,
+    // buffer pool, staging buffers and files (see shard_output). A logging thread is bound
+    // to one shard on its first message, threads are spread round robin over the shards,
+    // so the messages of one thread stay in order. flush(), stats() and droppedMessages()
+    // cover all shards, the limits and pool sizes of this config apply to each shard.
+    // SHARED_FILE does not support direct_io, BINARY encoding or the mmap backend
+    uint16_t worker_count = 0;
+    ShardOutput shard_output = ShardOutput::PER_SHARD_FILES;
+
+    // Creates the queue of every shard but the first, which uses _queue.
+    // nullptr = a StdQueue per shard
+    std::function<std::shared_ptr<Interface::ThreadSafeQueue<WriteRequest>>()> shard_queue_factory = nullptr;
+
+    // CPUs the worker threads may run on, empty = not pinned, e.g. the housekeeping cores
+    // so logging stays off the latency critical ones. With worker_count > 1 each shard
+    // gets its own contiguous slice ({0, 1, 2, 3} and 2 workers = {0, 1} and {2, 3}), so
+    // the set needs at least worker_count CPUs. The worker pins itself before it
+    // allocates anything, so its staging buffers and coroutine frames are first touched
+    // on its own node. With SQPOLL and sqpoll_cpu = -1 the SQ thread is pinned to the
+    // last CPU of its shard's slice
+    std::vector<int> worker_cpus = {};
+
+    // NUMA node the buffer pool is bound to, -1 = the node of the first CPU of the
+    // shard's slice of worker_cpus on machines with more than one node, else none. Binding needs one mapping, a bound
+    // pool is always carved out of the buffer arena (see buffer_arena)
+    int numa_node = -1;
+
+    // Scheduling policy of the worker thread, BATCH or IDLE keep it from preempting the
+    // application's threads on shared cores
+    Thread::Scheduling worker_scheduling = Thread::Scheduling::NORMAL;
+
+    // Layout of TEXT lines, compiled from a pattern at compile time. Fields the pattern
+    // leaves out are never rendered. Default = "[<timestamp>] [<level>] [Thread: <id>]: <message>"
+    //   .layout = IO::makeLayout<"%T %L %m">()
+    //   .layout = IO::JSON_LAYOUT
+    // See MR/IO/Layout.hpp for the fields. BINARY files are rendered by mrlogger-decode
+    IO::Layout layout = {};
+
+    // How often a worker writes the "suppressed N similar messages" lines of the rate
+    // limited statements (MRLOG_EVERY_N, MRLOG_FIRST_N, MRLOG_EVERY_MS) that suppressed
+    // calls since their last line, 0 = default of 10000. Each line has the level of its
+    // statement. An idle worker wakes up for them
+    uint32_t suppression_report_ms = 0;
+
+    // File keeping a copy of every buffer handed to io_uring until its write completed
+    // (see MR/IO/CrashRing.hpp), empty = none. It is mapped MAP_SHARED, so the copy is in
+    // the page cache the moment it is made and survives however the process dies. When
+    // a logger opens the file again it first appends what the previous process left
+    // unwritten to the log files. Messages still in the queue are not covered. Every shard
+    // gets its own file (<stem>.<i><ext>). Not supported with direct_io, BINARY encoding
+    // or INLINE compression, the mmap backend writes through a shared mapping anyway
+    std::string crash_ring_file = "";
+    size_t crash_ring_size = 0;  // Bytes of pending data the ring holds, 0 = 4 MiB
+
+    // Lets the worker pick batch_size and coalesce_size itself, from the arrival rate,
+    // the SQ occupancy and the completion latency it measures (see MR/Logger/BatchTuner.hpp).
+    // batch_size and coalesce_size become the upper bounds. Light traffic is written
+    // right away; under load staged messages wait for more, at most until the oldest
+    // is written autotune_max_delay_us after it was logged. flush() never waits for it.
+    // io_uring backend only
+    bool autotune = false;
+    uint32_t autotune_max_delay_us = 0;       // 0 = default of 500
+    uint16_t autotune_min_batch_size = 0;     // 0 = default of 1
+    uint16_t autotune_min_coalesce_size = 0;  // 0 = default of 1
+
+    // Collectors the lines of a log file are sent to over io_uring, next to writing them.
+    // TCP sends use IORING_OP_SENDMSG_ZC where the kernel has it. Connecting, reconnecting
+    // and slow collectors are handled by the worker without blocking it. flush() covers
+    // the files only. io_uring backend with TEXT encoding only, not with direct_io or
+    // INLINE compression
+    std::vector<NetworkSinkConfig> network_sinks = {};
+
+    // Bytes of log file per entry of its timestamp index, written next to every log
+    // file as <file>.idx (see MR/IO/TimestampIndex.hpp and mrlogger-query). An entry
+    // holds the offset, first timestamp and message number of a buffer. 0 = no index.
+    // io_uring backend with TEXT encoding only, not with direct_io, compression or
+    // shards sharing one file
+    size_t index_interval_bytes = 0;
+
+    // Buffers of each size class allocated when the logger starts, the classes grow to
+    // their *_buffer_pool_size as messages need more (Logger::warmUp() fills them right
+    // away). 0 = default of 16. With buffer_arena or register_buffers every class is
+    // complete from the start
+    uint16_t buffer_pool_initial_size = 0;
+
+    // While idle, the worker frees cached buffers the peak use of the last interval did
+    // not need, every buffer_pool_trim_ms. The kept count halves per interval after a
+    // burst, never below buffer_pool_initial_size. 0 = default of 1000
+    uint32_t buffer_pool_trim_ms = 0;
+
+    // What messages are timestamped with on the logging thread (see MR/Logger/Clock.hpp).
+    // REALTIME_COARSE and TSC are cheaper than SYSTEM: the coarse clock has the resolution
+    // of a scheduler tick, TSC stores the raw counter and the worker converts it. TSC
+    // falls back to SYSTEM with a warning without an invariant TSC
+    ClockSource clock = ClockSource::SYSTEM;
+
   };
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include <MR/IO/BinaryFormat.hpp>
+#include <MR/IO/LineWriter.hpp>
+#include <MR/Logger/Payload.hpp>
+#include <MR/Logger/Structured.hpp>
+
+namespace MR::Logger {
+
+/**
+ * Marks argument types that may be captured by value on the caller thread
+ * and formatted later on the worker thread.
+ *
+ * A deferrable type must own all of its data (it is memcpy'd into the
+ * WriteRequest), so pointers, string_views and spans are deliberately NOT
+ * deferrable: the pointee may be gone by the time the worker formats it.
+ * Arithmetic types and enums with a fmt::formatter are deferrable by default,
+ * user types can opt in by specializing this trait if they are trivially
+ * copyable and formattable:
+ *
+ *   template<> struct MR::Logger::is_deferrable<Point> : std::true_type {};
+ */
+template <typename T>
+struct is_deferrable : std::bool_constant<std::is_arithmetic_v<T> || std::is_enum_v<T>> {};
+
+template <typename T>
+inline constexpr bool is_deferrable_v = is_deferrable<T>::value;
+
+/**
+ * Format string + type-erased copy of the arguments of a single log call.
+ *
+ * The arguments are packed with their natural alignment into an inline byte
+ * area, so capturing them never allocates. format() is a per-signature thunk
+ * that unpacks the bytes and runs fmt directly into the destination buffer.
+ *
+ * The format string must have static storage duration, which is guaranteed
+ * for fmt::format_string (it is checked and built at compile time).
+ *
+ * When every argument has an IO::Binary::ArgType the signature can also copy
+ * the arguments out unformatted, which is all Config::encoding = BINARY writes.
+ *
+ * captureFields() holds the KeyValues of a structured call instead: the key
+ * pointer and value per field. The message and the string values are copied into
+ * WriteRequest::data and passed back to format() and fields() as strings.
+ */
+class DeferredFormat {
+public:
+    static constexpr size_t ARGS_CAPACITY = 64;
+
+    // Every packed field takes 16 bytes, a key pointer and an 8 byte aligned value
+    static constexpr size_t MAX_FIELDS = ARGS_CAPACITY / 16;
+
+    // Everything known about the argument types of one call signature
+    struct Signature {
+        size_t (*format)(fmt::string_view, const std::byte*, std::string_view, char*, size_t);
+
+        // Binary encoding, encode is nullptr unless every argument has an ArgType
+        void (*encode)(const std::byte*, char*);
+        const IO::Binary::ArgType* types;
+        uint8_t count;
+        uint8_t encoded_size;  // Sum of the argument sizes, without alignment padding
+
+        // Structured calls only, unpacks the fields and returns their number
+        size_t (*fields)(const std::byte*, std::string_view, Field*) = nullptr;
+    };
+
+private:
+    fmt::string_view format_{};
+    const Signature* signature_ = nullptr;
+    alignas(std::max_align_t) std::byte args_[ARGS_CAPACITY];
+
+    static constexpr size_t alignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    template <typename... Args>
+    static constexpr std::array<size_t, sizeof...(Args)> packedOffsets() {
+        std::array<size_t, sizeof...(Args)> offsets{};
+        size_t offset = 0;
+        size_t i = 0;
+        ((offset = alignUp(offset, alignof(Args)), offsets[i++] = offset, offset += sizeof(Args)), ...);
+        return offsets;
+    }
+
+    template <typename... Args>
+    static constexpr size_t packedSize() {
+        size_t offset = 0;
+        ((offset = alignUp(offset, alignof(Args)) + sizeof(Args)), ...);
+        return offset;
+    }
+
+    template <typename T>
+    static const T& load(const std::byte* storage) {
+        return *std::launder(reinterpret_cast<const T*>(storage));
+    }
+
+    template <typename... Args>
+    static size_t formatPacked(fmt::string_view format_str, const std::byte* storage, std::string_view,
+                               char* out, size_t capacity) {
+        constexpr auto offsets = packedOffsets<Args...>();
+
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return fmt::format_to_n(out, capacity, fmt::runtime(format_str), load<Args>(storage + offsets[I])...).size;
+        }(std::index_sequence_for<Args...>{});
+    }
+
+    // Copies the arguments back to back, the layout of EVENT args
+    template <typename... Args>
+    static void encodePacked(const std::byte* storage, char* out) {
+        constexpr auto offsets = packedOffsets<Args...>();
+
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((std::memcpy(out, storage + offsets[I], sizeof(Args)), out += sizeof(Args)), ...);
+        }(std::index_sequence_for<Args...>{});
+    }
+
+    template <typename... Args>
+    static constexpr std::array<IO::Binary::ArgType, sizeof...(Args)> arg_types{IO::Binary::argTypeOf<Args>()...};
+
+    template <typename... Args>
+    static constexpr Signature makeSignature() {
+        if constexpr ((... && IO::Binary::is_encodable_v<Args>)) {
+            return Signature{&formatPacked<Args...>, &encodePacked<Args...>, arg_types<Args...>.data(),
+                             static_cast<uint8_t>(sizeof...(Args)), static_cast<uint8_t>((0 + ... + sizeof(Args))), nullptr};
+        } else {
+            return Signature{&formatPacked<Args...>, nullptr, nullptr, 0, 0, nullptr};
+        }
+    }
+
+    template <typename... Args>
+    static constexpr Signature signature_of = makeSignature<Args...>();
+
+    template <typename... Vs>
+    static size_t unpackFields(const std::byte* storage, std::string_view strings, Field* out) {
+        constexpr auto offsets = packedOffsets<StructuredDetail::PackedField<Vs>...>();
+
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((out[I] = unpackField<Vs>(storage + offsets[I], strings)), ...);
+        }(std::index_sequence_for<Vs...>{});
+        return sizeof...(Vs);
+    }
+
+    template <typename V>
+    static Field unpackField(const std::byte* storage, std::string_view strings) {
+        const auto& packed = load<StructuredDetail::PackedField<V>>(storage);
+        return StructuredDetail::toField<V>(packed.key, packed.value, strings);
+    }
+
+    // The message followed by the fields in logfmt
+    template <typename... Vs>
+    static size_t formatFields(fmt::string_view message, const std::byte* storage, std::string_view strings,
+                               char* out, size_t capacity) {
+        Field fields[sizeof...(Vs)];
+        unpackFields<Vs...>(storage, strings, fields);
+
+        IO::LineWriter writer{out, capacity};
+        writer.append(strings.substr(0, message.size()));
+        appendLogfmtFields(fields, writer);
+        return writer.total;
+    }
+
+    template <typename... Vs>
+    static constexpr Signature fields_signature_of =
+        Signature{&formatFields<Vs...>, nullptr, nullptr, 0, 0, &unpackFields<Vs...>};
+
+public:
+    template <typename... Args>
+    static constexpr bool fits =
+        (... && (is_deferrable_v<Args> && std::is_trivially_copyable_v<Args> && fmt::is_formattable<Args>::value)) &&
+        packedSize<Args...>() <= ARGS_CAPACITY;
+
+    template <typename... Vs>
+    static constexpr bool fields_fit =
+        sizeof...(Vs) > 0 && packedSize<StructuredDetail::PackedField<Vs>...>() <= ARGS_CAPACITY;
+
+    // Captures of these arguments can be written by Config::encoding = BINARY without formatting
+    template <typename... Args>
+    static constexpr bool encodable = fits<Args...> && (... && IO::Binary::is_encodable_v<Args>);
+
+    // Args left uninitialized on purpose, only the captured bytes are ever read
+    DeferredFormat() noexcept {}
+
+    template <typename... Args>
+        requires fits<Args...>
+    static DeferredFormat capture(fmt::string_view format_str, const Args&... args) noexcept {
+        constexpr auto offsets = packedOffsets<Args...>();
+
+        DeferredFormat deferred;
+        deferred.format_ = format_str;
+        deferred.signature_ = &signature_of<Args...>;
+
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (std::memcpy(deferred.args_ + offsets[I], std::addressof(args), sizeof(Args)), ...);
+        }(std::index_sequence_for<Args...>{});
+
+        return deferred;
+    }
+
+    // Captures a structured call. The message and the string values are written to strings,
+    // which has to travel in the same WriteRequest (as its data). Only the size of the
+    // message is kept here, so the caller's message may go away right after the call
+    template <typename... Vs>
+        requires fields_fit<Vs...>
+    static DeferredFormat captureFields(std::string_view message, Payload& strings, const KeyValue<Vs>&... kvs) {
+        constexpr auto offsets = packedOffsets<StructuredDetail::PackedField<Vs>...>();
+
+        size_t size = message.size();
+        auto measure = [&]<typename V>(const KeyValue<V>& kv) {
+            if constexpr (StructuredDetail::is_string_v<V>) size += kv.value.size();
+        };
+        (measure(kvs), ...);
+
+        char* text = strings.prepare(size);
+        if (!message.empty()) std::memcpy(text, message.data(), message.size());
+        size_t written = message.size();
+
+        DeferredFormat deferred;
+        deferred.format_ = fmt::string_view(nullptr, message.size());
+        deferred.signature_ = &fields_signature_of<Vs...>;
+
+        auto pack = [&]<typename V>(size_t offset, const KeyValue<V>& kv) {
+            StructuredDetail::PackedField<V> packed{kv.key, {}};
+            if constexpr (StructuredDetail::is_string_v<V>) {
+                packed.value = {static_cast<uint32_t>(written), static_cast<uint32_t>(kv.value.size())};
+                if (!kv.value.empty()) std::memcpy(text + written, kv.value.data(), kv.value.size());
+                written += kv.value.size();
+            } else {
+                packed.value = kv.value;
+            }
+            std::memcpy(deferred.args_ + offset, &packed, sizeof(packed));
+        };
+
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (pack(offsets[I], kvs), ...);
+        }(std::index_sequence_for<Vs...>{});
+
+        return deferred;
+    }
+
+    explicit operator bool() const noexcept {
+        return signature_ != nullptr;
+    }
+
+    // Formats at most capacity chars into out, returns the untruncated size (like fmt::format_to_n).
+    // strings is the data of the WriteRequest, only read by structured captures
+    size_t format(char* out, size_t capacity, std::string_view strings = {}) const {
+        return signature_->format(format_, args_, strings, out, capacity);
+    }
+
+    bool isStructured() const noexcept { return signature_ && signature_->fields; }
+
+    // The message of a structured capture, it leads strings
+    std::string_view message(std::string_view strings) const noexcept {
+        return strings.substr(0, format_.size());
+    }
+
+    // Unpacks the fields of a structured capture into out (MAX_FIELDS entries), returns their number
+    size_t fields(std::string_view strings, Field* out) const {
+        return signature_->fields(args_, strings, out);
+    }
+
+    // Not set for structured captures, see message()
+    fmt::string_view formatString() const noexcept { return format_; }
+    const Signature& signature() const noexcept { return *signature_; }
+    bool isEncodable() const noexcept { return signature_ && signature_->encode; }
+
+    // Writes signature().encoded_size bytes of packed arguments, requires isEncodable()
+    void encode(char* out) const {
+        signature_->encode(args_, out);
+    }
+
+    // Rough upper bound of the formatted size, used to pick a pooled buffer
+    size_t sizeHint() const noexcept {
+        return format_.size() + ARGS_CAPACITY * 4;
+    }
+};
+
+} // namespace MR::Logger
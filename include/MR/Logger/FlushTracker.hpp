@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace MR::Logger {
+
+  /**
+   * Worker side bookkeeping behind Logger::flush(): the highest ticket up to which
+   * every message is written (flushed()).
+   *
+   * Every queued message carries a ticket (WriteRequest::ticket), handed out in push
+   * order by its logger. Queues like SPSCLaneQueue pop them out of that order, so the
+   * popped tickets are collected in a bitmap window until they are contiguous.
+   *
+   * Whatever a message becomes (a staged line, a write, a rotation) is started by the
+   * worker iteration that popped it. The tasks started in one iteration form an epoch,
+   * and once an iteration sealed its epoch, every message popped so far is covered by
+   * the tasks of that epoch and the ones before it. Tasks complete in any order, an
+   * epoch counts as written once its tasks and those of all earlier epochs completed.
+   */
+  class FlushTracker {
+  public:
+    // Ticket 0 is never handed out, it marks the lines the worker logs itself
+    inline void popped(uint64_t ticket) {
+      if (ticket <= popped_) return;
+
+      uint64_t index = ticket - window_base_;
+      size_t word = static_cast<size_t>(index / 64);
+      if (word >= window_.size()) window_.resize(word + 1, 0);
+      window_[word] |= uint64_t{1} << (index % 64);
+
+      // Advance over the run of popped tickets following popped_
+      while (!window_.empty()) {
+        unsigned bit = static_cast<unsigned>(popped_ + 1 - window_base_);
+        unsigned run = static_cast<unsigned>(std::countr_one(window_.front() >> bit));
+        popped_ += std::min(run, 64 - bit);
+        if (popped_ + 1 - window_base_ < 64) break;
+        window_.pop_front();
+        window_base_ += 64;
+      }
+    }
+
+    // Tickets up to this one were all popped
+    inline uint64_t poppedUpTo() const noexcept { return popped_; }
+
+    // Called when a task starts, its result is passed to taskDone()
+    inline uint64_t taskStarted() noexcept {
+      ++open_tasks_;
+      return first_epoch_ + epochs_.size();
+    }
+
+    inline void taskDone(uint64_t epoch) noexcept {
+      if (epoch == first_epoch_ + epochs_.size()) {
+        --open_tasks_;
+        return;
+      }
+      --epochs_[static_cast<size_t>(epoch - first_epoch_)].tasks;
+      drain();
+    }
+
+    // Ends the epoch of the current iteration. Unless held_back: a sink keeps popped
+    // messages staged across iterations (a direct I/O tail block), the epoch then
+    // stays open until they were handed to a write too
+    inline void seal(bool held_back) {
+      if (held_back) return;
+
+      if (open_tasks_ > 0) {
+        epochs_.push_back(Epoch{popped_, open_tasks_});
+        open_tasks_ = 0;
+      } else if (!epochs_.empty()) {
+        // Messages popped since need no task, they are written with the last epoch
+        epochs_.back().popped = popped_;
+      } else {
+        flushed_ = popped_;
+      }
+      drain();
+    }
+
+    // Every message with a ticket up to this one is written
+    inline uint64_t flushed() const noexcept { return flushed_; }
+
+  private:
+    struct Epoch {
+      uint64_t popped;  // poppedUpTo() when the epoch was sealed
+      size_t tasks;     // Still running
+    };
+
+    inline void drain() {
+      while (!epochs_.empty() && epochs_.front().tasks == 0) {
+        flushed_ = epochs_.front().popped;
+        epochs_.pop_front();
+        ++first_epoch_;
+      }
+    }
+
+    // Bit i of window_[w] marks ticket window_base_ + 64 * w + i as popped
+    std::deque<uint64_t> window_;
+    uint64_t window_base_ = 0;
+    uint64_t popped_ = 0;
+
+    std::deque<Epoch> epochs_;  // Sealed, still running tasks
+    uint64_t first_epoch_ = 0;
+    size_t open_tasks_ = 0;     // Started since the last seal
+    uint64_t flushed_ = 0;
+  };
+}
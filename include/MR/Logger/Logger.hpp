@@ -5,23 +5,46 @@
 
 #include <MR/Logger/SeverityLevel.hpp>
 #include <MR/Logger/Config.hpp>
+#include <MR/Logger/Stats.hpp>
 #include <MR/Memory/BufferPool.hpp>
 #include <MR/Coroutine/WriteTask.hpp>
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include <MR/Logger/WriteRequest.hpp>
+#include <MR/Logger/DeferredFormat.hpp>
+#include <MR/Logger/RateLimit.hpp>
+#include <MR/Logger/FlushTracker.hpp>
+#include <MR/Logger/BatchTuner.hpp>
 #include <MR/Queue/StdQueue.hpp>
 
 #include <MR/IO/WriteOnlyFile.hpp>
 #include <MR/IO/IOUring.hpp>
 #include <MR/IO/FileRotater.hpp>
 #include <MR/IO/WritePreparer.hpp>
+#include <MR/IO/Compressor.hpp>
+#include <MR/IO/MappedFile.hpp>
+#include <MR/IO/EventFd.hpp>
+#include <MR/IO/CrashRing.hpp>
+#include <MR/IO/NetworkTarget.hpp>
+#include <MR/IO/TimestampIndex.hpp>
 
 #include <MR/Interface/ThreadSafeQueue.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
+#include <span>
 #include <thread>
 #include <mutex>
+#include <vector>
 
 // The dispatcher: selects which macro to call based on arg count.
 #define GET_MACRO(_1, _2, NAME, ...) NAME
@@ -54,6 +77,45 @@
 
 #define MRLOGGER_TO_STRING(...) GET_MACRO(__VA_ARGS__, MRLOGGER_TO_STRING_2, MRLOGGER_TO_STRING_1)(__VA_ARGS__)
 
+// Level checked logging macros. Unlike logger->debug(...), the arguments are
+// only evaluated when the level is compiled in AND enabled at runtime:
+//   MRLOG_DEBUG(logger, "state = {}", expensiveDump());
+#define MRLOG_AT(logger, level, method, ...) \
+  do { \
+    if constexpr (::MR::Logger::isCompiledIn(level)) { \
+      if ((logger)->shouldLog(level)) (logger)->method(__VA_ARGS__); \
+    } \
+  } while (0)
+
+#define MRLOG_TRACE(logger, ...) MRLOG_AT(logger, ::MR::Logger::SEVERITY_LEVEL::TRACE, trace, __VA_ARGS__)
+#define MRLOG_DEBUG(logger, ...) MRLOG_AT(logger, ::MR::Logger::SEVERITY_LEVEL::DEBUG, debug, __VA_ARGS__)
+#define MRLOG_INFO(logger, ...) MRLOG_AT(logger, ::MR::Logger::SEVERITY_LEVEL::INFO, info, __VA_ARGS__)
+#define MRLOG_WARN(logger, ...) MRLOG_AT(logger, ::MR::Logger::SEVERITY_LEVEL::WARN, warn, __VA_ARGS__)
+#define MRLOG_ERROR(logger, ...) MRLOG_AT(logger, ::MR::Logger::SEVERITY_LEVEL::ERROR, error, __VA_ARGS__)
+
+// Rate limited logging macros. A static per statement decides before the arguments
+// are evaluated, calls filtered by severity are not counted:
+//   MRLOG_EVERY_N(logger, 1000, WARN, "retrying {}", id);       // the 1st, 1001st, ... call
+//   MRLOG_FIRST_N(logger, 10, ERROR, "bad frame {}", frame);
+//   MRLOG_EVERY_MS(logger, 500, ERROR, "socket error {}", errno); // at most one per 500 ms
+// Suppressed calls are counted per statement and reported by the worker as
+// "suppressed N similar messages" lines (Config::suppression_report_ms) of the logger
+// the statement logged to
+#define MRLOG_LIMITED(logger, LEVEL, Site, limit, ...) \
+  do { \
+    if constexpr (::MR::Logger::isCompiledIn(::MR::Logger::SEVERITY_LEVEL::LEVEL)) { \
+      static ::MR::Logger::Site mrlog_site_{__FILE__, __LINE__, ::MR::Logger::SEVERITY_LEVEL::LEVEL, limit}; \
+      if ((logger)->shouldLog(::MR::Logger::SEVERITY_LEVEL::LEVEL) && mrlog_site_.admit(::std::to_address(logger))) { \
+        MRLOG_##LEVEL(logger, __VA_ARGS__); \
+      } \
+    } \
+  } while (0)
+
+#define MRLOG_EVERY_N(logger, n, LEVEL, ...) MRLOG_LIMITED(logger, LEVEL, EveryN, (n), __VA_ARGS__)
+#define MRLOG_FIRST_N(logger, n, LEVEL, ...) MRLOG_LIMITED(logger, LEVEL, FirstN, (n), __VA_ARGS__)
+#define MRLOG_EVERY_MS(logger, ms, LEVEL, ...) \
+  MRLOG_LIMITED(logger, LEVEL, EveryInterval, ::std::chrono::milliseconds(ms), __VA_ARGS__)
+
 
 
 
@@ -81,84 +143,537 @@ namespace MR::Logger {
         .shutdown_timeout_seconds = 3u,
         ._queue = std::make_shared<Queue::StdQueue<WriteRequest>>(),
         .coalesce_size = 32u,
+        .deferred_formatting = false,
+        .min_severity = SEVERITY_LEVEL::INFO,
+        .register_buffers = false,
+        .ring_mode = IO::RingMode::DEFAULT,
+        .sqpoll_idle_ms = 0,
+        .sqpoll_cpu = -1,
+        .durability = DurabilityMode::NONE,
+        .fsync_interval_ms = 1000,
+        .fsync_interval_bytes = 0,
+        .direct_io = false,
+        .compression = CompressionMode::NONE,
+        .compression_level = 0,
+        .backend = IO::Backend::AUTO,
+        .mmap_chunk_size = IO::DEFAULT_MMAP_CHUNK_SIZE,
+        .encoding = LogEncoding::TEXT,
+        .sinks = {},
+        .log_file_severities = ALL_SEVERITIES,
+        .buffer_arena = false,
+        .lock_buffer_arena = false,
+        .staging_buffer_size = 16384u,
+        .idle_spin_us = 0,
+        .max_queued_messages = 0,
+        .overflow_policy = OverflowPolicy::BLOCK,
+        .overflow_timeout_ms = 10,
+        .worker_count = 1,
+        .shard_output = ShardOutput::PER_SHARD_FILES,
+        .shard_queue_factory = nullptr,
+        .worker_cpus = {},
+        .numa_node = -1,
+        .worker_scheduling = Thread::Scheduling::NORMAL,
+        .layout = {},
+        .suppression_report_ms = 10000,
+        .crash_ring_file = "",
+        .crash_ring_size = IO::DEFAULT_CRASH_RING_SIZE,
+        .autotune = false,
+        .autotune_max_delay_us = 500,
+        .autotune_min_batch_size = 1,
+        .autotune_min_coalesce_size = 1,
+        .network_sinks = {},
+        .index_interval_bytes = 0,
+        .buffer_pool_initial_size = 16,
+        .buffer_pool_trim_ms = 1000,
+        .clock = ClockSource::SYSTEM,
+      };
+
+      // A log file and the worker state of writing it. sinks_[0] is Config::log_file_name,
+      // followed by Config::sinks. Never added or removed once the worker runs, the
+      // coroutines keep references to it
+      struct Sink {
+        Sink(const SinkConfig& sink_config, IO::FileMode mode, unsigned slot_index)
+          : severities{sink_config.severities},
+            slot{slot_index},
+            file{sink_config.file_name, mode},
+            rotater{sink_config.file_name, sink_config.max_log_size_bytes} {}
+
+        inline bool accepts(SEVERITY_LEVEL level) const noexcept { return severities & severityBit(level); }
+
+        SeverityMask severities;
+        unsigned slot;  // Fixed-file slot of file
+        IO::WriteOnlyFile file;
+        IO::FileRotater rotater;
+        std::optional<IO::WriteOnlyFile> standby;  // Pre-opened file the next rotation switches to
+        std::optional<IO::WritePreparer> preparer;  // Own staging buffer, created by the worker
+        std::vector<std::unique_ptr<Memory::Buffer>> gathered;  // Prepared buffers going out as one writev
+        std::unique_ptr<IO::MappedFile> mapped;     // mmap backend only
+
+        // PERIODIC durability bookkeeping
+        size_t unsynced_bytes = 0;
+        bool sync_in_flight = false;
+        std::chrono::steady_clock::time_point last_sync{};
+
+        // Direct I/O (O_DIRECT) file position
+        uint64_t direct_offset = 0;     // Block aligned file offset of the first staged byte
+        uint64_t direct_end = 0;        // Logical end of all data submitted so far
+        bool drain_next_write = false;  // The next write overlaps a padded tail block that may be in flight
+
+        // Rotation state
+        bool standby_opening = false;       // IORING_OP_OPENAT of the standby file in flight
+        bool rotation_in_progress = false;  // Renames of the last rotation still in flight
+        uint32_t generation = 0;            // Bumped whenever file switches to another file
+
+        // Timestamp index (Config::index_interval_bytes), renamed along with file and standby
+        std::optional<IO::WriteOnlyFile> index;
+        std::optional<IO::WriteOnlyFile> standby_index;
+        std::optional<IO::IndexBuilder> indexer;  // Entries of the buffers queued for file
+      };
+
+      // A collector of Config::network_sinks, sent the buffers written to sinks_[source].
+      // Worker state, the coroutines keep references to it
+      struct NetworkSink {
+        static constexpr std::chrono::milliseconds FIRST_RETRY_DELAY{100};
+        static constexpr std::chrono::milliseconds MAX_RETRY_DELAY{5000};
+        static constexpr std::chrono::milliseconds STOPPING_TIMEOUT{1000};
+
+        NetworkSink(const NetworkSinkConfig& network_config, size_t source_index)
+          : target{network_config.host, network_config.port,
+                   network_config.protocol == NetworkProtocol::TCP ? SOCK_STREAM : SOCK_DGRAM},
+            source{source_index},
+            priority{IO::syslogPriority(network_config.syslog_facility, network_config.syslog_severity)},
+            max_pending_bytes{network_config.max_pending_bytes},
+            timeout{network_config.timeout_ms} {}
+
+        IO::NetworkTarget target;
+        size_t source;            // Index of the file in sinks_
+        std::string priority;     // UDP_SYSLOG header of every datagram
+        size_t max_pending_bytes;
+        std::chrono::milliseconds timeout;
+
+        int fd = -1;                   // -1 while not connected
+        bool connecting = false;       // IORING_OP_CONNECT in flight
+        bool sending = false;          // A send task runs until pending is empty, TCP frames stay in order
+        bool was_connected = false;    // The next connection is a reconnect
+        bool outage_reported = false;  // Failures are reported once until connected again
+        std::deque<Memory::Buffer*> pending;  // Shared with their file writes (Buffer::holds)
+        size_t pending_bytes = 0;
+        std::chrono::steady_clock::time_point next_connect{};  // Epoch = never tried
+        std::chrono::milliseconds retry_delay{FIRST_RETRY_DELAY};
       };
 
 
       Config config_;
       uint16_t max_logs_per_iteration_;
-      IO::WriteOnlyFile file_;
-      IO::IOUring ring_;
+      std::atomic<SEVERITY_LEVEL> min_severity_;
+      Clock clock_;  // stamp() on the caller threads, toWallTime() on the worker
+      std::unique_ptr<IO::IOUring> ring_;  // nullptr when running on the mmap backend
+      BufferPool buffer_pool_;  // Outlives the sinks, their preparers hand staging buffers back
+      std::vector<Sink> sinks_;
       std::shared_ptr<Interface::ThreadSafeQueue<WriteRequest>> queue_ = nullptr;
-      BufferPool buffer_pool_;
-      IO::FileRotater file_rotater_;
-
-      std::jthread worker_;
 
-      // Flush synchronization
+      // Effective compression, NONE if unavailable (see resolveCompression())
+      CompressionMode compression_;
+      std::unique_ptr<IO::BackgroundCompressor> compressor_;   // ROTATED
+      std::unique_ptr<IO::FrameCompressor> frame_compressor_;  // INLINE, used by the worker only
+
+      std::vector<NetworkSink> network_sinks_;  // Never resized once the worker runs
+
+      // Must be initialized before worker_ starts acquiring buffers
+      bool fixed_buffers_registered_ = false;
+      bool fixed_file_registered_ = false;
+
+      // Config::crash_ring_file, written by the worker only. Replayed into the files before it starts
+      std::unique_ptr<IO::CrashRing> crash_ring_;
+
+      // Config::autotune, used by the worker only. staging_held_ is set while a staging
+      // buffer waits for more messages, until hold_deadline_ at the latest
+      std::optional<BatchTuner> tuner_;
+      bool staging_held_ = false;
+      std::chrono::steady_clock::time_point hold_deadline_{};
+
+      // Worker only: when the idle worker trims buffer_pool_ next (Config::buffer_pool_trim_ms)
+      std::chrono::steady_clock::time_point next_pool_trim_{};
+
+      // Worker thread state, declared before worker_ so it is initialized before the thread runs
+      FlushTracker flush_tracker_;                // Worker only
+      IO::EventFd wakeup_;                      // Signalled to wake the sleeping worker
+      std::atomic<bool> worker_sleeping_{false};  // Set by the worker right before it sleeps
+      bool ring_signals_wakeup_ = false;          // Worker only: wakeup_ is registered with ring_
+
+      // Flush synchronization. Producers number their messages with next_ticket_, flush()
+      // waits until the worker published them in flushed_ (see FlushTracker). flush_target_
+      // is the highest ticket a flush waits for, flush_waiters_ counts the waiting threads
+      // and flush_callbacks_ (flush_mutex_) the flushAsync() calls
+      struct FlushCallback {
+        uint64_t ticket;
+        std::function<void()> on_flushed;
+      };
+      std::atomic<uint64_t> next_ticket_{1};
+      std::atomic<uint64_t> flushed_{0};
+      std::atomic<uint64_t> flush_target_{0};
+      std::atomic<size_t> flush_waiters_{0};
       std::mutex flush_mutex_;
       std::condition_variable flush_cv_;
+      std::vector<FlushCallback> flush_callbacks_;
       std::atomic<size_t> active_task_count_{0};
 
+      // Tickets of messages that never reached the queue, popped by the worker instead
+      std::mutex abandoned_mutex_;
+      std::vector<uint64_t> abandoned_tickets_;
+      std::atomic<bool> tickets_abandoned_{false};
+
+      std::jthread worker_;
+
+      // Overflow accounting (Config::max_queued_messages). queued_ counts the admitted
+      // messages the worker has not popped yet, producers waiting for room sleep on room_cv_
+      std::atomic<size_t> queued_{0};
+      std::atomic<uint32_t> blocked_producers_{0};
+      std::mutex overflow_mutex_;
+      std::condition_variable room_cv_;
+      bool overflow_closed_ = false;  // The worker exited, nobody makes room anymore (overflow_mutex_)
+      std::array<std::atomic<uint64_t>, SEVERITY_NAMES.size()> dropped_{};
+      std::array<uint64_t, SEVERITY_NAMES.size()> reported_drops_{};  // Worker only: in the last drop report
+      std::chrono::steady_clock::time_point last_suppression_report_{std::chrono::steady_clock::now()};  // Worker only
+
+      // Counted by the worker thread, read by stats()
+      struct PipelineCounters {
+        StatCounter messages_dequeued;
+        StatCounter messages_written;
+        StatCounter bytes_written;
+        StatCounter writes;
+        StatCounter buffers_written;
+        StatCounter rotations;
+        StatCounter network_bytes_sent;
+        StatCounter network_lines_dropped;
+        StatCounter network_reconnects;
+        StatCounter buffer_pool_trimmed;
+        LatencyRecorder write_latency;
+      };
+      PipelineCounters counters_;
+
+      // Config::worker_count - 1 further loggers, each with its own worker. Empty for
+      // the shards themselves. Created last in the constructor, never changed afterwards
+      std::vector<std::unique_ptr<Logger>> shards_;
+      inline static std::atomic<size_t> next_shard_slot_{0};
+
       // Private constructor only for the Factory class
       Logger(const Config& = default_config_);
       friend class Factory;
       
       Config mergeWithDefault(const Config& user_config);
+      bool registerFixedBuffers();
+      bool registerFixedFiles();
+      std::unique_ptr<IO::IOUring> createRing() const;
+      std::vector<int> workerCpus(size_t shard = 0) const;
+      int sqpollCpu() const;
+      int numaNode() const;
+      void placeWorker() const noexcept;
+      IO::FileMode fileMode() const;
+      std::vector<Sink> createSinks() const;
+      std::vector<NetworkSink> createNetworkSinks();
+      IO::WritePreparer createPreparer(const Sink& sink);
+      CompressionMode resolveCompression() const;
+      std::unique_ptr<IO::CrashRing> createCrashRing();
+      std::optional<BatchTuner> createTuner() const;
+      std::unique_ptr<Memory::Buffer> compressBuffer(std::unique_ptr<Memory::Buffer> buffer);
       void eventLoop(std::stop_token);
-      Coroutine::WriteTask createWriteTask(std::unique_ptr<Memory::Buffer> buffer);
+      void mappedEventLoop(std::stop_token);
+      size_t writeMapped(Sink& sink, WriteRequest& request);
+      void rotateMappedFile(Sink& sink);
+      void prepareForSink(Sink& sink, WriteRequest&& request,
+                          Coroutine::TaskList& active_tasks, size_t& pending_writes);
+      void queueWrite(Sink& sink, std::unique_ptr<Memory::Buffer> buffer, Coroutine::TaskList& active_tasks);
+      void queueBuffer(Sink& sink, std::unique_ptr<Memory::Buffer> buffer, Coroutine::TaskList& active_tasks, bool chained);
+      void submitGathered(Sink& sink, Coroutine::TaskList& active_tasks);
+      void releaseBuffer(std::unique_ptr<Memory::Buffer> buffer);
+      void pumpNetwork(Coroutine::TaskList& active_tasks, bool stopping);
+      Coroutine::WriteTask createConnectTask(NetworkSink& network);
+      Coroutine::WriteTask createStreamSendTask(NetworkSink& network);
+      Coroutine::WriteTask createDatagramSendTask(NetworkSink& network);
+      void disconnect(NetworkSink& network, int status);
+      void closeNetworkSinks();
+      Coroutine::WriteTask createWriteTask(Sink& sink, std::unique_ptr<Memory::Buffer> buffer);
+      Coroutine::WriteTask createVectoredWriteTask(Sink& sink, std::vector<std::unique_ptr<Memory::Buffer>> buffers);
+      Coroutine::WriteTask createSyncTask(Sink& sink);
+      void startIndex(Sink& sink);
+      void submitIndex(Sink& sink, Coroutine::TaskList& active_tasks);
+      Coroutine::WriteTask createIndexWriteTask(Sink& sink, std::unique_ptr<Memory::Buffer> buffer);
+      void recordWrite(int bytes, size_t buffers, std::chrono::system_clock::time_point enqueued_at) noexcept;
+      bool periodicSyncDue(const Sink& sink, bool stopping) const;
+      void reapCompletedTasks(Coroutine::TaskList& active_tasks);
+      void rotateFile(Sink& sink, Coroutine::TaskList& active_tasks);
+      Coroutine::WriteTask createRotateTask(Sink& sink, IO::WriteOnlyFile retired, std::optional<IO::WriteOnlyFile> retired_index,
+                                            std::string rotated_name);
+      Coroutine::WriteTask createStandbyTask(Sink& sink);
+      void removeStandbyFile(Sink& sink);
+      void startDirectFile(Sink& sink);
       void reportError(const char* location, const std::string& what) const noexcept;
+      std::chrono::microseconds idleTimeout() const;
+      void trimBufferPool();
+      void idleWait(const std::stop_token& st, std::chrono::microseconds timeout);
+      bool admitOverflowing(SEVERITY_LEVEL severity) noexcept;
+      size_t releaseQueued(std::span<WriteRequest> popped) noexcept;
+      std::optional<WriteRequest> takeDropReport();
+      std::vector<WriteRequest> takeSuppressionReports(bool final);
+      std::chrono::steady_clock::time_point suppressionReportDue() const;
+      void closeAdmission() noexcept;
+      void abandonTicket(uint64_t ticket) noexcept;
+      void popAbandonedTickets();
+      void publishFlushed(uint64_t flushed);
+      std::chrono::steady_clock::time_point flushDeadline(std::chrono::milliseconds timeout) const noexcept;
+      bool flushUntil(std::chrono::steady_clock::time_point deadline);
+      void whenFlushed(std::function<void()> on_flushed);
+      std::vector<std::unique_ptr<Logger>> createShards();
+
+      // The logger (this or a shard) the calling thread writes to. Threads are bound to
+      // a slot on their first message
+      inline Logger& shard() noexcept {
+        if (shards_.empty()) return *this;
+        static thread_local const size_t slot = next_shard_slot_.fetch_add(1, std::memory_order_relaxed);
+        size_t index = slot % (shards_.size() + 1);
+        return index == 0 ? *this : *shards_[index - 1];
+      }
+
+      // Counts the message against Config::max_queued_messages, false = dropped.
+      // One relaxed increment while below the limit
+      inline bool admit(SEVERITY_LEVEL severity) noexcept {
+        if (config_.max_queued_messages == 0) return true;
+        if (queued_.fetch_add(1, std::memory_order_relaxed) < config_.max_queued_messages) return true;
+        return admitOverflowing(severity);
+      }
+
+      // Gives the slot of an admitted message back that never reached the queue
+      inline void unadmit() noexcept {
+        if (config_.max_queued_messages != 0) queued_.fetch_sub(1, std::memory_order_relaxed);
+      }
+
+      // The flush() position of the next message pushed to this logger
+      inline uint64_t takeTicket() noexcept {
+        return next_ticket_.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      // Called after every push. Costs a fence and a load unless the worker announced
+      // that it sleeps, then the first producer to see it signals the eventfd
+      inline void wakeWorker() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker_sleeping_.load(std::memory_order_relaxed) &&
+            worker_sleeping_.exchange(false, std::memory_order_relaxed)) {
+          wakeup_.signal();
+        }
+      }
 
       template<typename T>
       inline void write(SEVERITY_LEVEL severity, T&& data) noexcept {
+        if (!shouldLog(severity)) return;
+        Logger& target = shard();
+        if (!target.admit(severity)) return;
+        uint64_t ticket = target.takeTicket();
         try {
           WriteRequest req{
             .level = severity,
             .data = std::forward<T>(data),
             .threadId = std::this_thread::get_id(),
-            .timestamp = std::chrono::system_clock::now(),
-            .sequence_number = 0  // Will be set by StdQueue::push if LOGGER_TEST_SEQUENCE_TRACKING is defined
+            .timestamp = target.clock_.stamp(),
+            .sequence_number = 0,  // Will be set by StdQueue::push if LOGGER_TEST_SEQUENCE_TRACKING is defined
+            .deferred = {},
+            .ticket = ticket
           };
-          queue_->push(std::move(req));
+          target.queue_->push(std::move(req));
+          target.wakeWorker();
         } catch (const std::exception& e) {
+          target.unadmit();
+          target.abandonTicket(ticket);
           reportError("write to queue", e.what());
         } catch (...) {
+          target.unadmit();
+          target.abandonTicket(ticket);
           reportError("write to queue", "Unknown exception");
         }
       }
 
+      // data carries the string values of a structured capture
+      inline void write(SEVERITY_LEVEL severity, DeferredFormat&& deferred, Payload&& data = {}) noexcept {
+        Logger& target = shard();
+        if (!target.admit(severity)) return;
+        uint64_t ticket = target.takeTicket();
+        try {
+          WriteRequest req{
+            .level = severity,
+            .data = std::move(data),
+            .threadId = std::this_thread::get_id(),
+            .timestamp = target.clock_.stamp(),
+            .sequence_number = 0,
+            .deferred = std::move(deferred),
+            .ticket = ticket
+          };
+          target.queue_->push(std::move(req));
+          target.wakeWorker();
+        } catch (const std::exception& e) {
+          target.unadmit();
+          target.abandonTicket(ticket);
+          reportError("write to queue", e.what());
+        } catch (...) {
+          target.unadmit();
+          target.abandonTicket(ticket);
+          reportError("write to queue", "Unknown exception");
+        }
+      }
+
+      template<typename... Args>
+      inline void log(SEVERITY_LEVEL severity, fmt::format_string<Args...> fmt_str, Args&&... args) noexcept {
+        // Checked before formatting so a filtered call costs one relaxed load
+        if (!shouldLog(severity)) return;
+
+        if constexpr (DeferredFormat::fits<std::remove_cvref_t<Args>...>) {
+          // Binary encoding stores arithmetic arguments as they are, formatting them is left to mrlogger-decode
+          bool capture = config_.deferred_formatting;
+          if constexpr (DeferredFormat::encodable<std::remove_cvref_t<Args>...>) {
+            capture = capture || config_.encoding == LogEncoding::BINARY;
+          }
+          if (capture) {
+            write(severity, DeferredFormat::capture(fmt::string_view(fmt_str), args...));
+            return;
+          }
+        }
+        write(severity, Payload::format(fmt_str, std::forward<Args>(args)...));
+      }
+
+      // Structured calls are always captured, the fields are rendered by the worker
+      template<typename... Vs>
+      inline void logFields(SEVERITY_LEVEL severity, std::string_view message, const KeyValue<Vs>&... fields) noexcept {
+        if (!shouldLog(severity)) return;
+        try {
+          if constexpr (DeferredFormat::fields_fit<Vs...>) {
+            Payload strings;
+            DeferredFormat deferred = DeferredFormat::captureFields(message, strings, fields...);
+            write(severity, std::move(deferred), std::move(strings));
+          } else {
+            // More fields than a capture holds, a JSON layout sees them as part of the message
+            write(severity, formatLogfmt(message, fields...));
+          }
+        } catch (const std::exception& e) {
+          reportError("write to queue", e.what());
+        }
+      }
+
     public:
 
+      template<typename... Args>
+      inline void trace(fmt::format_string<Args...> fmt_str, Args&&... args) noexcept {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::TRACE)) {
+          log(SEVERITY_LEVEL::TRACE, fmt_str, std::forward<Args>(args)...);
+        }
+      }
+
+      template<typename T>
+      inline void trace(T&& str) noexcept
+        requires std::is_convertible_v<std::remove_cvref_t<T>, std::string> {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::TRACE)) {
+          write(SEVERITY_LEVEL::TRACE, std::forward<T>(str));
+        }
+      }
+
+      // Structured: trace("request done", kv("latency_us", latency), kv("route", route)), the message is
+      // copied like the string values. Likewise for the other levels
+      template<size_t N, typename... Vs>
+      inline void trace(const char (&message)[N], KeyValue<Vs>... fields) noexcept
+        requires (sizeof...(Vs) > 0) {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::TRACE)) {
+          logFields(SEVERITY_LEVEL::TRACE, message, fields...);
+        }
+      }
+
+      template<typename... Args>
+      inline void debug(fmt::format_string<Args...> fmt_str, Args&&... args) noexcept {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::DEBUG)) {
+          log(SEVERITY_LEVEL::DEBUG, fmt_str, std::forward<Args>(args)...);
+        }
+      }
+
+      template<typename T>
+      inline void debug(T&& str) noexcept
+        requires std::is_convertible_v<std::remove_cvref_t<T>, std::string> {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::DEBUG)) {
+          write(SEVERITY_LEVEL::DEBUG, std::forward<T>(str));
+        }
+      }
+
+      template<size_t N, typename... Vs>
+      inline void debug(const char (&message)[N], KeyValue<Vs>... fields) noexcept
+        requires (sizeof...(Vs) > 0) {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::DEBUG)) {
+          logFields(SEVERITY_LEVEL::DEBUG, message, fields...);
+        }
+      }
+
       template<typename... Args>
       inline void info(fmt::format_string<Args...> fmt_str, Args&&... args) noexcept {
-        write(SEVERITY_LEVEL::INFO, fmt::format(fmt_str, std::forward<Args>(args)...));
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::INFO)) {
+          log(SEVERITY_LEVEL::INFO, fmt_str, std::forward<Args>(args)...);
+        }
       }
 
       template<typename T>
       inline void info(T&& str) noexcept
         requires std::is_convertible_v<std::remove_cvref_t<T>, std::string> {
-        write(SEVERITY_LEVEL::INFO, std::forward<T>(str));
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::INFO)) {
+          write(SEVERITY_LEVEL::INFO, std::forward<T>(str));
+        }
+      }
+
+      template<size_t N, typename... Vs>
+      inline void info(const char (&message)[N], KeyValue<Vs>... fields) noexcept
+        requires (sizeof...(Vs) > 0) {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::INFO)) {
+          logFields(SEVERITY_LEVEL::INFO, message, fields...);
+        }
       }
 
       template<typename... Args>
       inline void warn(fmt::format_string<Args...> fmt_str, Args&&... args) noexcept {
-        write(SEVERITY_LEVEL::WARN, fmt::format(fmt_str, std::forward<Args>(args)...));
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::WARN)) {
+          log(SEVERITY_LEVEL::WARN, fmt_str, std::forward<Args>(args)...);
+        }
       }
 
       template<typename T>
       inline void warn(T&& str) noexcept
         requires std::is_convertible_v<std::remove_cvref_t<T>, std::string> {
-        write(SEVERITY_LEVEL::WARN, std::forward<T>(str));
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::WARN)) {
+          write(SEVERITY_LEVEL::WARN, std::forward<T>(str));
+        }
+      }
+
+      template<size_t N, typename... Vs>
+      inline void warn(const char (&message)[N], KeyValue<Vs>... fields) noexcept
+        requires (sizeof...(Vs) > 0) {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::WARN)) {
+          logFields(SEVERITY_LEVEL::WARN, message, fields...);
+        }
       }
 
       template<typename... Args>
       inline void error(fmt::format_string<Args...> fmt_str, Args&&... args) noexcept {
-        write(SEVERITY_LEVEL::ERROR, fmt::format(fmt_str, std::forward<Args>(args)...));
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::ERROR)) {
+          log(SEVERITY_LEVEL::ERROR, fmt_str, std::forward<Args>(args)...);
+        }
       }
 
       template<typename T>
       inline void error(T&& str) noexcept
         requires std::is_convertible_v<std::remove_cvref_t<T>, std::string> {
-        write(SEVERITY_LEVEL::ERROR, std::forward<T>(str));
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::ERROR)) {
+          write(SEVERITY_LEVEL::ERROR, std::forward<T>(str));
+        }
+      }
+
+      template<size_t N, typename... Vs>
+      inline void error(const char (&message)[N], KeyValue<Vs>... fields) noexcept
+        requires (sizeof...(Vs) > 0) {
+        if constexpr (isCompiledIn(SEVERITY_LEVEL::ERROR)) {
+          logFields(SEVERITY_LEVEL::ERROR, message, fields...);
+        }
       }
 
 
@@ -177,19 +692,71 @@ namespace MR::Logger {
       inline static const Config& defaultConfig() { return default_config_; }
       inline uint16_t getMaxLogsPerIteration() const { return max_logs_per_iteration_; }
 
-      // Flush all currently queued log messages to disk
+      // Runtime severity filter, safe to change from any thread while logging
+      inline void setMinSeverity(SEVERITY_LEVEL level) noexcept { min_severity_.store(level, std::memory_order_relaxed); }
+      inline SEVERITY_LEVEL getMinSeverity() const noexcept { return min_severity_.load(std::memory_order_relaxed); }
+      inline bool shouldLog(SEVERITY_LEVEL level) const noexcept {
+        return isCompiledIn(level) && level >= min_severity_.load(std::memory_order_relaxed);
+      }
+
+      // Blocks until every message the calling thread logged so far is written. Messages
+      // other threads log meanwhile are not waited for
       void flush();
 
+      // flush() giving up after timeout, false if the messages were not all written by then
+      bool flush(std::chrono::milliseconds timeout);
+
+      // Returns right away, on_flushed runs once the messages logged so far are written.
+      // On the worker thread, or right here if they are written already
+      void flushAsync(std::function<void()> on_flushed);
+      std::future<void> flushAsync();
+
+      // Allocates every buffer pool class up to its Config size and touches the buffers
+      // (see Config::buffer_pool_initial_size), so the first burst neither allocates nor
+      // page faults. Safe to call while logging; the idle worker trims them again later
+      void warmUp();
+
+      // Engine actually writing the log file (AUTO resolved)
+      inline IO::Backend backend() const noexcept { return ring_ ? IO::Backend::IO_URING : IO::Backend::MMAP; }
+
+      // Rotated files still waiting for CompressionMode::ROTATED compression
+      IO::CompressionBacklog compressionBacklog() const noexcept;
+
+      // Snapshot of the pipeline counters, cheap enough to scrape periodically from any thread
+      Stats stats() const;
+
+      // Messages dropped by Config::overflow_policy so far, in total or of one severity
+      uint64_t droppedMessages() const noexcept;
+      inline uint64_t droppedMessages(SEVERITY_LEVEL level) const noexcept {
+        uint64_t dropped = dropped_[static_cast<size_t>(level)].load(std::memory_order_relaxed);
+        for (const auto& shard : shards_) dropped += shard->droppedMessages(level);
+        return dropped;
+      }
+
+      // Where the worker of shard `shard` (0 = this logger) runs, resolved from worker_cpus,
+      // sqpoll_cpu and numa_node. Throws std::out_of_range past the last shard. Used only for
+      // internal testing
+      struct WorkerPlacement {
+        std::vector<int> cpus;
+        int sqpoll_cpu;
+        int numa_node;
+      };
+      WorkerPlacement _workerPlacement(size_t shard) const;
+
     private:
       // Factory class for singleton access
       class Factory {
         friend class Logger;
 
         static std::shared_ptr<Logger> instance_;
+        static std::atomic<bool> published_;  // instance_ is set, get() reads it without the mutex
+        static std::unordered_map<std::string, std::shared_ptr<Logger>> named_;
         static std::mutex mutex_;
 
-        static std::shared_ptr<Logger> _get();
+        static const std::shared_ptr<Logger>& _get();
+        static std::shared_ptr<Logger> _get(std::string_view name);
         static void init(Config&& config);
+        static std::shared_ptr<Logger> create(std::string name, Config&& config);
         static void _reset();
         static const Config& getConfig();
       };
@@ -197,12 +764,31 @@ namespace MR::Logger {
     public:
       static void init(Config&& config = {});
       static void init(const Config& config);
-      static std::shared_ptr<Logger> get() { return Factory::_get(); }
+
+      // Lock free once init() created the instance: an acquire load and a reference to the
+      // shared_ptr owning it, which is not replaced before _reset(). No refcount is touched
+      // unless the caller copies it
+      static const std::shared_ptr<Logger>& get() {
+        if (Factory::published_.load(std::memory_order_acquire)) [[likely]] {
+          return Factory::instance_;
+        }
+        return Factory::_get();
+      }
       static const Config& getConfig() { return Factory::getConfig(); }
 
+      // Independently configured logger with its own queue and worker thread, so a flood of
+      // messages in one subsystem doesn't delay the others. Its files must differ from those
+      // of every other logger. Like init(), a second call with the same name returns the
+      // existing logger and ignores config. Loggers live until _reset() or process exit
+      static std::shared_ptr<Logger> create(std::string name, Config config = {});
+
+      // Takes a mutex, keep the returned pointer instead of looking the logger up per call.
+      // Throws std::runtime_error if no logger of that name was created
+      static std::shared_ptr<Logger> get(std::string_view name) { return Factory::_get(name); }
+
       /*
-        Should never be called. Destroys the shared_ptr instance but does not guarantee logger shutdown due to ref counting.
-        Used only for internal testing.
+        Should never be called. Destroys the shared_ptr instance (and those of the named loggers) but does not guarantee
+        logger shutdown due to ref counting. Must not race with get(). Used only for internal testing.
        */
       static void _reset();
   };
@@ -210,6 +796,8 @@ namespace MR::Logger {
   // Namespace-level convenience functions
   void init(Config&& config = {});
   void init(const Config& config);
-  std::shared_ptr<Logger> get();
+  const std::shared_ptr<Logger>& get();
   const Config& getConfig();
+  std::shared_ptr<Logger> create(std::string name, Config config = {});
+  std::shared_ptr<Logger> get(std::string_view name);
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+namespace MR::Logger {
+
+/**
+ * The text of a WriteRequest. Up to INLINE_CAPACITY bytes live inside the request
+ * itself, so formatting a typical message neither allocates on the logging thread
+ * nor frees on the worker, and queues keeping their requests in a preallocated ring
+ * never touch the allocator. Longer text spills to the heap.
+ *
+ * Moving copies only the bytes in use.
+ */
+class Payload {
+public:
+    static constexpr size_t SIZE = 256;  // sizeof(Payload)
+    static constexpr size_t INLINE_CAPACITY = SIZE - sizeof(char*) - sizeof(uint32_t) * 2;
+
+    Payload() noexcept = default;
+
+    Payload(std::string_view text) { assign(text.data(), text.size()); }
+    Payload(const std::string& text) : Payload(std::string_view(text)) {}
+    Payload(const char* text) : Payload(std::string_view(text)) {}
+
+    Payload(const Payload& other) { assign(other.data(), other.size()); }
+
+    Payload(Payload&& other) noexcept { take(other); }
+
+    Payload& operator=(const Payload& other) {
+        if (this != &other) {
+            release();
+            assign(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    Payload& operator=(Payload&& other) noexcept {
+        if (this != &other) {
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~Payload() { release(); }
+
+    // Formats straight into the inline area, a second pass into a heap block if it is too small
+    template<typename... Args>
+    static Payload format(fmt::format_string<Args...> fmt_str, Args&&... args) {
+        Payload payload;
+        auto format_args = fmt::make_format_args(args...);
+        auto result = fmt::vformat_to_n(payload.inline_, INLINE_CAPACITY, fmt::string_view(fmt_str), format_args);
+        if (result.size <= INLINE_CAPACITY) {
+            payload.size_ = static_cast<uint32_t>(result.size);
+            return payload;
+        }
+
+        char* heap = payload.spill(result.size);
+        fmt::vformat_to_n(heap, result.size, fmt::string_view(fmt_str), format_args);
+        return payload;
+    }
+
+    // Drops the text and returns room for size bytes, which the caller fills in
+    inline char* prepare(size_t size) {
+        release();
+        char* destination = size <= INLINE_CAPACITY ? inline_ : spill(size);
+        size_ = static_cast<uint32_t>(size);
+        return destination;
+    }
+
+    inline const char* data() const noexcept { return heap_ ? heap_ : inline_; }
+    inline size_t size() const noexcept { return size_; }
+    inline bool empty() const noexcept { return size_ == 0; }
+    inline bool spilled() const noexcept { return heap_ != nullptr; }
+
+    inline operator std::string_view() const noexcept { return std::string_view(data(), size_); }
+
+    friend inline bool operator==(const Payload& payload, std::string_view text) noexcept {
+        return std::string_view(payload) == text;
+    }
+
+private:
+    inline void assign(const char* text, size_t size) {
+        char* destination = size <= INLINE_CAPACITY ? inline_ : spill(size);
+        if (size > 0) std::memcpy(destination, text, size);
+        size_ = static_cast<uint32_t>(size);
+    }
+
+    inline char* spill(size_t size) {
+        heap_ = new char[size];
+        size_ = static_cast<uint32_t>(size);
+        return heap_;
+    }
+
+    inline void take(Payload& other) noexcept {
+        size_ = other.size_;
+        heap_ = std::exchange(other.heap_, nullptr);
+        if (!heap_ && size_ > 0) std::memcpy(inline_, other.inline_, size_);
+        other.size_ = 0;
+    }
+
+    inline void release() noexcept {
+        delete[] heap_;
+        heap_ = nullptr;
+        size_ = 0;
+    }
+
+    char* heap_ = nullptr;  // Holds the text when it did not fit inline
+    uint32_t size_ = 0;
+    char inline_[INLINE_CAPACITY];
+};
+
+static_assert(sizeof(Payload) == Payload::SIZE);
+
+}
+
+template<>
+struct fmt::formatter<MR::Logger::Payload> : fmt::formatter<fmt::string_view> {
+    template<typename FormatContext>
+    auto format(const MR::Logger::Payload& payload, FormatContext& ctx) const {
+        return fmt::formatter<fmt::string_view>::format(fmt::string_view(payload.data(), payload.size()), ctx);
+    }
+};
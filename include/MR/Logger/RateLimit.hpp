@@ -0,0 +1,162 @@
+#pragma once
+
+#include <MR/Logger/SeverityLevel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+namespace MR::Logger {
+
+  /**
+   * State of one rate limited log statement (the static of an MRLOG_EVERY_N,
+   * MRLOG_FIRST_N or MRLOG_EVERY_MS expansion). Admitting a call costs one
+   * relaxed atomic operation on the site's own counter.
+   *
+   * A site enrolls in a process wide list the first time it suppresses a call,
+   * the workers walk that list to write "suppressed N similar messages" lines
+   * (Config::suppression_report_ms). Each call passes the logger it logs to, the
+   * site is reported by the logger whose call it suppressed last, so a statement
+   * logging to a named logger is not reported in another logger's file. Sites are
+   * never removed: they are statics, their destructors are trivial so a worker
+   * still running at exit may read them.
+   */
+  class CallSite {
+  public:
+    CallSite(const char* file, int line, SEVERITY_LEVEL level) noexcept
+      : file_{file}, line_{line}, level_{level} {}
+
+    CallSite(const CallSite&) = delete;
+    CallSite& operator=(const CallSite&) = delete;
+
+    // Enrolled sites, the most recent first
+    static CallSite* first() noexcept { return head_.load(std::memory_order_acquire); }
+    CallSite* next() const noexcept { return next_; }
+
+    // File name without its directories
+    std::string_view file() const noexcept {
+      std::string_view path{file_};
+      size_t slash = path.find_last_of('/');
+      return slash == std::string_view::npos ? path : path.substr(slash + 1);
+    }
+    int line() const noexcept { return line_; }
+    SEVERITY_LEVEL level() const noexcept { return level_; }
+
+    // The logger of the last suppressed call, only compared against
+    const void* owner() const noexcept { return owner_.load(std::memory_order_relaxed); }
+
+    uint64_t suppressed() const noexcept {
+      uint64_t count = count_.load(std::memory_order_relaxed);
+      // EveryN counts calls, the first of every period was logged
+      return period_ == 0 ? count : count - (count + period_ - 1) / period_;
+    }
+
+    bool hasUnreported() const noexcept {
+      return suppressed() > reported_.load(std::memory_order_relaxed);
+    }
+
+    // Suppressions since the last call, each one is taken by exactly one worker
+    uint64_t takeUnreported() noexcept {
+      uint64_t total = suppressed();
+      uint64_t reported = reported_.load(std::memory_order_relaxed);
+      while (reported < total) {
+        if (reported_.compare_exchange_weak(reported, total, std::memory_order_relaxed)) {
+          return total - reported;
+        }
+      }
+      return 0;
+    }
+
+  protected:
+    std::atomic<uint64_t> count_{0};  // Suppressed calls, all calls for EveryN
+    uint64_t period_ = 0;
+
+    void suppress(const void* owner) noexcept {
+      if (owner_.load(std::memory_order_relaxed) != owner) owner_.store(owner, std::memory_order_relaxed);
+      if (!enrolled_.load(std::memory_order_relaxed)) enroll();
+    }
+
+  private:
+    inline static std::atomic<CallSite*> head_{nullptr};
+
+    const char* file_;
+    int line_;
+    SEVERITY_LEVEL level_;
+    std::atomic<const void*> owner_{nullptr};
+    std::atomic<bool> enrolled_{false};
+    std::atomic<uint64_t> reported_{0};
+    CallSite* next_ = nullptr;
+
+    void enroll() noexcept {
+      if (enrolled_.exchange(true, std::memory_order_relaxed)) return;
+      CallSite* head = head_.load(std::memory_order_relaxed);
+      do {
+        next_ = head;
+      } while (!head_.compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+    }
+  };
+
+  // The 1st, (n+1)th, (2n+1)th... call
+  class EveryN : public CallSite {
+  public:
+    EveryN(const char* file, int line, SEVERITY_LEVEL level, uint64_t n) noexcept
+      : CallSite(file, line, level) {
+      period_ = std::max<uint64_t>(n, 1);
+    }
+
+    bool admit(const void* owner) noexcept {
+      if (count_.fetch_add(1, std::memory_order_relaxed) % period_ == 0) return true;
+      suppress(owner);
+      return false;
+    }
+  };
+
+  // The first n calls
+  class FirstN : public CallSite {
+  public:
+    FirstN(const char* file, int line, SEVERITY_LEVEL level, uint64_t n) noexcept
+      : CallSite(file, line, level), limit_{n} {}
+
+    bool admit(const void* owner) noexcept {
+      // A load first, so the site stops writing to the shared counter once the limit is reached
+      if (admitted_.load(std::memory_order_relaxed) < limit_ &&
+          admitted_.fetch_add(1, std::memory_order_relaxed) < limit_) {
+        return true;
+      }
+      count_.fetch_add(1, std::memory_order_relaxed);
+      suppress(owner);
+      return false;
+    }
+
+  private:
+    uint64_t limit_;
+    std::atomic<uint64_t> admitted_{0};
+  };
+
+  // At most one call per interval
+  class EveryInterval : public CallSite {
+  public:
+    EveryInterval(const char* file, int line, SEVERITY_LEVEL level, std::chrono::nanoseconds interval) noexcept
+      : CallSite(file, line, level), interval_{interval.count()} {}
+
+    bool admit(const void* owner) noexcept {
+      int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+      int64_t next = next_.load(std::memory_order_relaxed);
+      if (now >= next && next_.compare_exchange_strong(next, now + interval_, std::memory_order_relaxed)) {
+        return true;
+      }
+      count_.fetch_add(1, std::memory_order_relaxed);
+      suppress(owner);
+      return false;
+    }
+
+  private:
+    int64_t interval_;
+    std::atomic<int64_t> next_{std::numeric_limits<int64_t>::min()};
+  };
+
+}
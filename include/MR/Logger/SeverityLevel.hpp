@@ -1,14 +1,55 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+
+// Compile-time severity floor, set through the meson option `min_severity`.
+// Log calls below it are discarded with `if constexpr`; through the MRLOG_*
+// macros in Logger.hpp their arguments are not even evaluated.
+// 0 = TRACE, 1 = DEBUG, 2 = INFO, 3 = WARN, 4 = ERROR
+#ifndef MRLOGGER_MIN_SEVERITY
+#define MRLOGGER_MIN_SEVERITY 0
+#endif
 
 namespace MR::Logger {
-  enum class SEVERITY_LEVEL { INFO, WARN, ERROR };
+  enum class SEVERITY_LEVEL { TRACE, DEBUG, INFO, WARN, ERROR };
+
+  inline constexpr SEVERITY_LEVEL COMPILE_TIME_MIN_SEVERITY = static_cast<SEVERITY_LEVEL>(MRLOGGER_MIN_SEVERITY);
+
+  inline constexpr bool isCompiledIn(SEVERITY_LEVEL lvl) {
+    return lvl >= COMPILE_TIME_MIN_SEVERITY;
+  }
+
+  inline constexpr std::array<std::string_view, 5> SEVERITY_NAMES{"TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+
+  inline constexpr std::string_view sevLvlName(SEVERITY_LEVEL lvl) {
+    auto index = static_cast<size_t>(lvl);
+    return index < SEVERITY_NAMES.size() ? SEVERITY_NAMES[index] : std::string_view{"UNKNOWN LEVEL"};
+  }
+
   inline std::string sevLvlToStr(SEVERITY_LEVEL lvl) {
-    switch (lvl) {
-      case SEVERITY_LEVEL::INFO: return "INFO";
-      case SEVERITY_LEVEL::WARN: return "WARN";
-      case SEVERITY_LEVEL::ERROR: return "ERROR";
-      default: return "UNKNOWN LEVEL";
-    }
-  }
-}
\ No newline at end of file
+    return std::string{sevLvlName(lvl)};
+  }
+
+  // Set of severities, one bit per SEVERITY_LEVEL (see Config::sinks)
+  using SeverityMask = uint8_t;
+
+  inline constexpr SeverityMask ALL_SEVERITIES = (1u << SEVERITY_NAMES.size()) - 1;
+
+  inline constexpr SeverityMask severityBit(SEVERITY_LEVEL lvl) {
+    return static_cast<SeverityMask>(1u << static_cast<unsigned>(lvl));
+  }
+
+  // severityMask(SEVERITY_LEVEL::WARN, SEVERITY_LEVEL::ERROR)
+  template <typename... Levels>
+  inline constexpr SeverityMask severityMask(Levels... levels) {
+    return static_cast<SeverityMask>((SeverityMask{0} | ... | severityBit(levels)));
+  }
+
+  // lvl and everything more severe
+  inline constexpr SeverityMask severitiesFrom(SEVERITY_LEVEL lvl) {
+    return static_cast<SeverityMask>(ALL_SEVERITIES & ~(severityBit(lvl) - 1u));
+  }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace MR::Logger {
+
+  // Latencies in power of two microsecond buckets: bucket 0 counts latencies below
+  // 1us, bucket i those in [2^(i-1), 2^i) us, the last bucket everything longer
+  struct LatencyHistogram {
+    static constexpr size_t BUCKETS = 24;  // The last bucket starts at ~4.2 s
+
+    std::array<uint64_t, BUCKETS> counts{};
+
+    static constexpr size_t bucketOf(std::chrono::nanoseconds latency) noexcept {
+      auto us = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0) / 1000);
+      return std::min<size_t>(std::bit_width(us), BUCKETS - 1);
+    }
+
+    // Latencies in the bucket are below this
+    static constexpr std::chrono::microseconds upperBound(size_t bucket) noexcept {
+      return std::chrono::microseconds(int64_t{1} << bucket);
+    }
+
+    inline uint64_t count() const noexcept {
+      uint64_t total = 0;
+      for (uint64_t c : counts) total += c;
+      return total;
+    }
+
+    // Upper bound of the bucket the quantile (0..1) falls into, 0 if nothing was recorded
+    inline std::chrono::microseconds percentile(double quantile) const noexcept {
+      uint64_t total = count();
+      if (total == 0) return std::chrono::microseconds(0);
+
+      auto rank = static_cast<uint64_t>(quantile * static_cast<double>(total - 1)) + 1;
+      uint64_t seen = 0;
+      for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return upperBound(i);
+      }
+      return upperBound(BUCKETS - 1);
+    }
+
+    inline LatencyHistogram& operator+=(const LatencyHistogram& other) noexcept {
+      for (size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+      return *this;
+    }
+  };
+
+  // Snapshot of the logging pipeline (Logger::stats()). Counters are totals since the
+  // logger was created, queue_depth and in_flight are the current values
+  struct Stats {
+    uint64_t messages_enqueued = 0;   // Popped by the worker plus queue_depth
+    uint64_t messages_written = 0;    // Formatted into the log file(s), once per message
+    uint64_t messages_dropped = 0;    // By Config::overflow_policy
+    uint64_t bytes_written = 0;       // Written to the log files (compressed bytes with INLINE compression)
+
+    // io_uring backend only
+    uint64_t writes = 0;              // Completed write operations, a writev counts once
+    uint64_t buffers_written = 0;     // Buffers those writes carried
+    uint64_t sq_full = 0;             // Operations that found the submission queue full (-EAGAIN)
+    size_t in_flight = 0;             // Write, sync, open and rename tasks waiting for their CQE
+
+    size_t queue_depth = 0;           // Messages queued right now
+    uint64_t rotations = 0;
+    uint64_t buffer_pool_hits = 0;
+    uint64_t buffer_pool_misses = 0;  // Plain allocations: size class exhausted or larger than all classes
+    uint64_t buffer_pool_trimmed = 0; // Cached buffers freed again by the idle worker
+
+    // Config::network_sinks, summed over all of them
+    uint64_t network_bytes_sent = 0;     // Including the TCP frame and syslog headers
+    uint64_t network_lines_dropped = 0;  // Never sent: too much pending, a failed datagram, lost at shutdown
+    uint64_t network_reconnects = 0;     // Connections reopened after they were lost
+
+    // From the enqueue of the oldest message in a write to its CQE (io_uring backend only),
+    // both read from Config::clock
+    LatencyHistogram write_latency;
+
+    // Sums the counters of another shard (Config::worker_count)
+    inline Stats& operator+=(const Stats& other) noexcept {
+      messages_enqueued += other.messages_enqueued;
+      messages_written += other.messages_written;
+      messages_dropped += other.messages_dropped;
+      bytes_written += other.bytes_written;
+      writes += other.writes;
+      buffers_written += other.buffers_written;
+      sq_full += other.sq_full;
+      in_flight += other.in_flight;
+      queue_depth += other.queue_depth;
+      rotations += other.rotations;
+      buffer_pool_hits += other.buffer_pool_hits;
+      buffer_pool_misses += other.buffer_pool_misses;
+      buffer_pool_trimmed += other.buffer_pool_trimmed;
+      network_bytes_sent += other.network_bytes_sent;
+      network_lines_dropped += other.network_lines_dropped;
+      network_reconnects += other.network_reconnects;
+      write_latency += other.write_latency;
+      return *this;
+    }
+
+    // Messages per write buffer
+    inline double coalescingRatio() const noexcept {
+      return buffers_written == 0 ? 0.0 : static_cast<double>(messages_written) / static_cast<double>(buffers_written);
+    }
+  };
+
+  // A counter with only one writing thread. A relaxed load and store instead of a
+  // locked read-modify-write, other threads may read it at any time
+  class StatCounter {
+  public:
+    inline void add(uint64_t n = 1) noexcept {
+      value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    inline uint64_t load() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<uint64_t> value_{0};
+  };
+
+  // LatencyHistogram filled by one thread, snapshot() may be called from any
+  class LatencyRecorder {
+  public:
+    inline void record(std::chrono::nanoseconds latency) noexcept {
+      buckets_[LatencyHistogram::bucketOf(latency)].add();
+    }
+
+    inline LatencyHistogram snapshot() const noexcept {
+      LatencyHistogram histogram;
+      for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        histogram.counts[i] = buckets_[i].load();
+      }
+      return histogram;
+    }
+
+  private:
+    std::array<StatCounter, LatencyHistogram::BUCKETS> buckets_{};
+  };
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <MR/IO/Escape.hpp>
+#include <MR/IO/LineWriter.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+namespace MR::Logger {
+
+/**
+ * A named field of a structured log call, made by kv():
+ *
+ *   log->info("request done", kv("latency_us", latency), kv("route", route));
+ *
+ * Arithmetic values and enums are kept as they are, strings are viewed and copied
+ * into the WriteRequest by the log call, anything else fmt can format is rendered
+ * to a string by kv() itself. The key must be a string literal.
+ */
+template <typename V>
+struct KeyValue {
+    const char* key;
+    V value;
+};
+
+template <typename T>
+struct is_key_value : std::false_type {};
+
+template <typename V>
+struct is_key_value<KeyValue<V>> : std::true_type {};
+
+template <size_t N, typename T>
+inline auto kv(const char (&key)[N], const T& value) {
+    using D = std::remove_cvref_t<T>;
+    if constexpr (std::is_arithmetic_v<D> || std::is_enum_v<D>) {
+        return KeyValue<D>{key, value};
+    } else if constexpr (std::is_pointer_v<std::decay_t<D>> && std::is_convertible_v<const T&, const char*>) {
+        const char* text = value;
+        return KeyValue<std::string_view>{key, text ? std::string_view(text) : std::string_view{}};
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        return KeyValue<std::string_view>{key, std::string_view(value)};
+    } else {
+        return KeyValue<std::string>{key, fmt::format("{}", value)};
+    }
+}
+
+enum class FieldType : uint8_t { INT, UINT, FLOAT, BOOL, STRING };
+
+// A field as the worker renders it, see DeferredFormat::fields()
+struct Field {
+    std::string_view key;
+    FieldType type;
+    union {
+        int64_t integer;
+        uint64_t unsigned_integer;
+        double floating;
+        bool boolean;
+    };
+    std::string_view text;  // STRING
+};
+
+namespace StructuredDetail {
+
+    template <typename V>
+    inline constexpr bool is_string_v = std::is_same_v<V, std::string_view> || std::is_same_v<V, std::string>;
+
+    // Where a string value sits in WriteRequest::data
+    struct StringSlice {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    template <typename V>
+    using Stored = std::conditional_t<is_string_v<V>, StringSlice, V>;
+
+    // What a DeferredFormat holds per field
+    template <typename V>
+    struct PackedField {
+        const char* key;
+        Stored<V> value;
+    };
+
+    // Field of a value, text points into strings for a StringSlice
+    template <typename V>
+    inline Field toField(const char* key, const Stored<V>& value, std::string_view strings) {
+        Field field;
+        field.key = key;
+        if constexpr (is_string_v<V>) {
+            field.type = FieldType::STRING;
+            field.text = strings.substr(value.offset, value.size);
+        } else if constexpr (std::is_same_v<V, bool>) {
+            field.type = FieldType::BOOL;
+            field.boolean = value;
+        } else if constexpr (std::is_same_v<V, char>) {
+            field.type = FieldType::STRING;
+            field.text = std::string_view(&value, 1);
+        } else if constexpr (std::is_enum_v<V>) {
+            using U = std::underlying_type_t<V>;
+            if constexpr (std::is_signed_v<U>) {
+                field.type = FieldType::INT;
+                field.integer = static_cast<int64_t>(value);
+            } else {
+                field.type = FieldType::UINT;
+                field.unsigned_integer = static_cast<uint64_t>(value);
+            }
+        } else if constexpr (std::is_floating_point_v<V>) {
+            field.type = FieldType::FLOAT;
+            field.floating = static_cast<double>(value);
+        } else if constexpr (std::is_signed_v<V>) {
+            field.type = FieldType::INT;
+            field.integer = static_cast<int64_t>(value);
+        } else {
+            field.type = FieldType::UINT;
+            field.unsigned_integer = static_cast<uint64_t>(value);
+        }
+        return field;
+    }
+
+    // Field of a KeyValue still on the caller thread, strings are viewed in place
+    template <typename V>
+    inline Field toField(const KeyValue<V>& kv) {
+        if constexpr (is_string_v<V>) {
+            Field field;
+            field.key = kv.key;
+            field.type = FieldType::STRING;
+            field.text = kv.value;
+            return field;
+        } else {
+            return toField<V>(kv.key, kv.value, {});
+        }
+    }
+
+    inline void appendValue(const Field& field, IO::LineWriter& out, bool json) {
+        switch (field.type) {
+            case FieldType::INT: {
+                fmt::format_int text(field.integer);
+                out.append(std::string_view{text.data(), text.size()});
+                break;
+            }
+            case FieldType::UINT: {
+                fmt::format_int text(field.unsigned_integer);
+                out.append(std::string_view{text.data(), text.size()});
+                break;
+            }
+            case FieldType::FLOAT:
+                if (json && !std::isfinite(field.floating)) {
+                    out.append("null");
+                } else {
+                    out.total += fmt::format_to_n(out.cursor(), out.remaining(), "{}", field.floating).size;
+                }
+                break;
+            case FieldType::BOOL:
+                out.append(field.boolean ? "true" : "false");
+                break;
+            case FieldType::STRING:
+                if (json) {
+                    out.put('"');
+                    IO::appendJsonEscaped(field.text, out);
+                    out.put('"');
+                } else {
+                    IO::appendLogfmtValue(field.text, out);
+                }
+                break;
+        }
+    }
+
+}
+
+// " key=value" per field, after the message of the classic layout and %m
+inline void appendLogfmtFields(std::span<const Field> fields, IO::LineWriter& out) {
+    for (const Field& field : fields) {
+        out.put(' ');
+        out.append(field.key);
+        out.put('=');
+        StructuredDetail::appendValue(field, out, false);
+    }
+}
+
+// ,"key":value per field, the %F layout field
+inline void appendJsonFields(std::span<const Field> fields, IO::LineWriter& out) {
+    for (const Field& field : fields) {
+        out.append(",\"");
+        IO::appendJsonEscaped(field.key, out);
+        out.append("\":");
+        StructuredDetail::appendValue(field, out, true);
+    }
+}
+
+// Message and logfmt fields as one string, for calls whose fields don't fit a DeferredFormat
+template <typename... Vs>
+inline std::string formatLogfmt(std::string_view message, const KeyValue<Vs>&... kvs) {
+    const Field fields[] = {StructuredDetail::toField(kvs)...};
+
+    IO::LineWriter measure{nullptr, 0};
+    measure.append(message);
+    appendLogfmtFields(fields, measure);
+
+    std::string text(measure.total, '\0');
+    IO::LineWriter out{text.data(), text.size()};
+    out.append(message);
+    appendLogfmtFields(fields, out);
+    return text;
+}
+
+} // namespace MR::Logger
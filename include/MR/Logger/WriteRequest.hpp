@@ -1,5 +1,7 @@
 #pragma once
 #include <MR/Logger/SeverityLevel.hpp>
+#include <MR/Logger/DeferredFormat.hpp>
+#include <MR/Logger/Payload.hpp>
 #include <string>
 #include <thread>
 #include <chrono>
@@ -7,9 +9,16 @@
 namespace MR::Logger {
   struct WriteRequest {
     SEVERITY_LEVEL level;
-    std::string data;
+    Payload data;  // Inline up to Payload::INLINE_CAPACITY bytes
     std::thread::id threadId;
     std::chrono::system_clock::time_point timestamp;
     uint64_t sequence_number = 0;
+
+    // Set instead of data when Config::deferred_formatting is on and all
+    // arguments of the call are deferrable. Formatted by the worker thread.
+    DeferredFormat deferred;
+
+    // Position in the push order of its logger, what flush() waits for. 0 = not counted
+    uint64_t ticket = 0;
   };
 }
\ No newline at end of file
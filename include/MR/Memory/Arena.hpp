@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+namespace MR::Memory {
+
+// One anonymous mapping holding every pooled buffer of a BufferPool, so the
+// buffers share a few (huge) pages and can be registered with io_uring as a
+// single fixed buffer.
+//
+// The mapping is tried with MAP_HUGETLB first (needs reserved hugepages,
+// vm.nr_hugepages), otherwise it is a regular mapping advised for transparent
+// hugepages. The size is always rounded up to a whole hugepage.
+class Arena {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    // lock = mlock the region so it is never paged out. Failing to lock is not
+    // an error (usually RLIMIT_MEMLOCK), see lockError().
+    // numa_node >= 0 binds the region to that node (MPOL_PREFERRED) before any page
+    // is touched, failing to bind is not an error either, see numaError().
+    // Throws std::runtime_error if the region cannot be mapped at all
+    Arena(size_t size, bool lock, int numa_node = -1);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    inline char* data() const noexcept { return data_; }
+    inline size_t size() const noexcept { return size_; }
+
+    // Backed by explicitly reserved hugepages (MAP_HUGETLB)
+    inline bool hugePages() const noexcept { return huge_pages_; }
+
+    // Negative errno of a failed mlock, 0 if locked or locking was not requested
+    inline int lockError() const noexcept { return lock_error_; }
+
+    // Negative errno of a failed mbind, 0 if bound or no node was requested
+    inline int numaError() const noexcept { return numa_error_; }
+
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    bool huge_pages_ = false;
+    bool locked_ = false;
+    int lock_error_ = 0;
+    int numa_error_ = 0;
+};
+
+} // namespace MR::Memory
@@ -1,20 +1,62 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <memory>
 
 namespace MR::Memory {
 struct Buffer {
     void* data;
     size_t size;
     size_t capacity;
+
+    // Index of this buffer in the io_uring fixed buffer table, -1 if not registered
+    int buf_index = -1;
+
+    // Request an fdatasync linked right after the write of this buffer
+    bool sync = false;
+
+    // Zero bytes appended to pad the last block of a direct I/O write,
+    // not part of the log data (size includes them)
+    size_t padding = 0;
+
+    // false for a buffer pointing into an Arena, data is then never freed
+    bool owned = true;
+
+    // When the oldest message in it was logged (Logger::Stats::write_latency), epoch = unknown
+    std::chrono::system_clock::time_point enqueued_at{};
+
+    // Messages formatted into it (Config::index_interval_bytes), 0 in direct I/O block mode
+    // and in the continuation buffers of a chained message
+    uint32_t messages = 0;
+
+    // Position of the copy of the data in the logger's CrashRing, UINT64_MAX = none
+    uint64_t crash_record = UINT64_MAX;
+
+    // Network sinks still sending the buffer besides its file write, the last of them
+    // hands it back to the pool (worker only)
+    uint32_t holds = 0;
+
+    // The rest of a message too large for one pooled buffer, written right after this
+    // one (see WritePreparer). The worker unlinks the chain before queueing it
+    std::unique_ptr<Buffer> next;
     
-    inline Buffer(size_t cap) : size(0), capacity(cap) {
-        data = malloc(cap);
+    // alignment > 0 allocates the data aligned, e.g. to the block size for O_DIRECT
+    inline Buffer(size_t cap, size_t alignment = 0) : size(0), capacity(cap) {
+        if (alignment > 0) {
+            if (posix_memalign(&data, alignment, cap) != 0) data = nullptr;
+        } else {
+            data = malloc(cap);
+        }
     }
+
+    // Non-owning view of cap bytes of memory that outlives the buffer (an Arena slot)
+    inline Buffer(void* memory, size_t cap) : data(memory), size(0), capacity(cap), owned(false) {}
     
     inline ~Buffer() {
-        if (data) {
+        if (data && owned) {
             free(data);
         }
     }
@@ -22,27 +64,46 @@ struct Buffer {
     Buffer(const Buffer&) = delete;
     Buffer& operator=(const Buffer&) = delete;
     
-    inline Buffer(Buffer&& other) noexcept : data(other.data), size(other.size), capacity(other.capacity) {
+    inline Buffer(Buffer&& other) noexcept : data(other.data), size(other.size), capacity(other.capacity), buf_index(other.buf_index), sync(other.sync), padding(other.padding), owned(other.owned), enqueued_at(other.enqueued_at), messages(other.messages), crash_record(other.crash_record), next(std::move(other.next)) {
         other.data = nullptr;
         other.size = 0;
         other.capacity = 0;
+        other.buf_index = -1;
+        other.sync = false;
+        other.padding = 0;
     }
     
     inline Buffer& operator=(Buffer&& other) noexcept {
         if (this != &other) {
-            if (data) free(data);
+            if (data && owned) free(data);
             data = other.data;
             size = other.size;
             capacity = other.capacity;
+            buf_index = other.buf_index;
+            sync = other.sync;
+            padding = other.padding;
+            owned = other.owned;
+            enqueued_at = other.enqueued_at;
+            messages = other.messages;
+            crash_record = other.crash_record;
+            next = std::move(other.next);
             other.data = nullptr;
             other.size = 0;
             other.capacity = 0;
+            other.buf_index = -1;
+            other.sync = false;
+            other.padding = 0;
         }
         return *this;
     }
     
     inline void clear() {
         size = 0;
+        sync = false;
+        padding = 0;
+        enqueued_at = {};
+        messages = 0;
+        crash_record = UINT64_MAX;
     }
     
     inline char* as_char() const {
@@ -1,15 +1,26 @@
 #pragma once
 
+#include <MR/Memory/Arena.hpp>
 #include <MR/Memory/Buffer.hpp>
 #include <MR/Memory/Pool.hpp>
 
+#include <atomic>
 #include <memory>
 #include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
 
 namespace MR::Memory {
 
+// Three size classes of cached buffers, larger requests (and requests while a
+// class is exhausted) fall back to plain allocations, which refill the class up
+// to its pool size when released. acquire() and release() are lock free and O(1),
+// see Pool.
 class BufferPool {
 public:
+    // Defaults of a BufferPool(), the Logger builds its pool from Config
     static constexpr size_t SMALL_BUFFER_SIZE = 1024;
     static constexpr size_t MEDIUM_BUFFER_SIZE = 4096;
     static constexpr size_t LARGE_BUFFER_SIZE = 16384;
@@ -17,20 +28,90 @@ public:
     static constexpr size_t SMALL_POOL_SIZE = 128;
     static constexpr size_t MEDIUM_POOL_SIZE = 64;
     static constexpr size_t LARGE_POOL_SIZE = 32;
-    
+
+    struct Config {
+        // Buffer sizes must be strictly increasing
+        size_t small_buffer_size = SMALL_BUFFER_SIZE;
+        size_t medium_buffer_size = MEDIUM_BUFFER_SIZE;
+        size_t large_buffer_size = LARGE_BUFFER_SIZE;
+
+        // Most buffers of each size kept cached (0 = always allocate)
+        size_t small_pool_size = SMALL_POOL_SIZE;
+        size_t medium_pool_size = MEDIUM_POOL_SIZE;
+        size_t large_pool_size = LARGE_POOL_SIZE;
+
+        // Buffers of each size allocated up front (capped at the pool size), the rest
+        // are cached as they come back. trim() never goes below it. An arena is always
+        // carved up completely
+        size_t initial_buffers = SIZE_MAX;
+
+        // > 0 allocates every buffer (pooled and fallback) aligned to it,
+        // as required by O_DIRECT writes
+        size_t alignment = 0;
+
+        // Carve all pooled buffers out of one Arena instead of one allocation each,
+        // lock_arena additionally mlocks it. Falls back to allocations if it can't be mapped
+        bool arena = false;
+        bool lock_arena = false;
+
+        // >= 0 binds the arena to this NUMA node (see Arena)
+        int numa_node = -1;
+    };
+
     BufferPool();
+    explicit BufferPool(size_t alignment);
+    explicit BufferPool(const Config& config);  // Throws std::invalid_argument for unordered sizes
     ~BufferPool();
     
     std::unique_ptr<Buffer> acquire(size_t required_size);
-    void release(std::unique_ptr<Buffer> buffer);
+    void release(std::unique_ptr<Buffer> buffer);  // Including the buffers chained to it (Buffer::next)
     
+    // Capacity of the largest pooled buffers, the pieces of a chained message
+    inline size_t largeBufferSize() const noexcept { return large_pool_.buffer_size; }
+
     size_t getTotalBuffers() const;
     size_t getAvailableBuffers() const;
+
+    // acquire() calls so far, and how many of them had to allocate (class exhausted or
+    // larger than all classes). Relaxed counts, safe to read from any thread
+    inline uint64_t acquireCount() const noexcept { return acquired_.load(std::memory_order_relaxed); }
+    inline uint64_t missCount() const noexcept { return misses_.load(std::memory_order_relaxed); }
+
+    // Frees cached buffers the recent peak use did not need (see Pool::trim) and
+    // returns how many. Called from one thread, the worker
+    size_t trim();
+    bool trimmable() const noexcept;
+
+    // Fills every class up to its pool size and touches the pages of the cached
+    // buffers, so a burst right after startup neither allocates nor faults
+    void warmUp();
+
+    // Allocates every class up to its pool size, assigns a fixed buffer index to every
+    // pooled buffer and returns the iovecs to pass to io_uring_register_buffers, in
+    // index order. With an arena that is a single iovec covering it, every pooled
+    // buffer has index 0. Must be called while no buffer is in use (before the first acquire).
+    std::vector<iovec> prepareFixedBuffers();
+
+    // Undo prepareFixedBuffers() if registration with the ring failed
+    void clearFixedBuffers();
+
+    // nullptr unless Config::arena was requested and the arena could be mapped
+    inline const Arena* arena() const noexcept { return arena_.get(); }
+    inline const std::string& arenaError() const noexcept { return arena_error_; }
     
 private:
+    static const Config& validate(const Config& config);
+    std::unique_ptr<Arena> createArena(const Config& config);
+    char* arenaSlice(const Config& config, size_t pool);
+
+    size_t alignment_;
+    std::string arena_error_;
+    std::unique_ptr<Arena> arena_;  // Outlives the pools, their buffers point into it
     Pool small_pool_;
     Pool medium_pool_;
     Pool large_pool_;
+    std::atomic<uint64_t> acquired_{0};
+    std::atomic<uint64_t> misses_{0};
     
     std::unique_ptr<Buffer> createBuffer(size_t size);
 };
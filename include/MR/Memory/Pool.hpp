@@ -1,21 +1,111 @@
 #pragma once
 
 #include <MR/Memory/Buffer.hpp>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
-#include <mutex>
 
 namespace MR::Memory {
+
+// Up to pool_size cached buffers of one size, shared by all threads without a lock.
+// Every buffer sits in a slot, two stacks of slot indices track which slots hold a
+// buffer (full_) and which ones gave theirs out or never had one (empty_). Acquire
+// and release pop one stack and push the other, both O(1).
+//
+// A heap backed pool starts with initial buffers and grows as buffers allocated on a
+// miss are released into its empty slots. trim() gives back what the recent peak use
+// did not need, so a burst does not keep its memory forever.
 struct Pool {
-    std::vector<std::unique_ptr<Buffer>> buffers;
-    size_t next_index;
     size_t pool_size;
     size_t buffer_size;
-    mutable std::mutex mutex_;
 
-    Pool(size_t pool_sz, size_t buf_sz);
+    // Set once the buffers are registered with io_uring. From then on only
+    // registered buffers are taken back, so a registered buffer always finds
+    // its slot again and is never freed while the ring still references it.
+    bool fixed = false;
+
+    // storage != nullptr carves the buffers out of pool_sz * slotSize() bytes there
+    // (an Arena) instead of allocating each one, all of them right away (the mapping
+    // is faulted in lazily anyway). Otherwise initial (at most pool_sz) are allocated
+    Pool(size_t pool_sz, size_t buf_sz, size_t alignment = 0, char* storage = nullptr, size_t initial = SIZE_MAX);
+
+    // Distance between two buffers in storage: cache line (or alignment) aligned
+    static constexpr size_t slotSize(size_t buf_sz, size_t alignment) {
+        size_t granularity = alignment > 64 ? alignment : 64;
+        return (buf_sz + granularity - 1) / granularity * granularity;
+    }
 
     std::unique_ptr<Buffer> tryAcquire();
     bool tryRelease(std::unique_ptr<Buffer> buffer);
+
+    // Buffers currently in the pool
+    inline size_t available() const noexcept { return available_.load(std::memory_order_relaxed); }
+
+    // Buffers of this size out of the pool, counted by the BufferPool on acquire and release
+    inline size_t inUse() const noexcept { return in_use_.load(std::memory_order_relaxed); }
+
+    void noteAcquired() noexcept;
+    inline void noteReleased() noexcept { in_use_.fetch_sub(1, std::memory_order_relaxed); }
+
+    // Allocates the buffers missing in empty slots, only while none is in use
+    void fill();
+
+    // Brings the pool up to pool_size minus the buffers in use, and writes to every page
+    // of every cached buffer so the first messages don't fault. Safe while the pool is
+    // used. Counts as peak use for trim()
+    void warmUp();
+
+    // Frees the cached buffers above max(high water mark, initial) minus the buffers in
+    // use. The high water mark is the peak use since the last trim, or half the last
+    // one if that was higher. Returns the number of buffers freed. Arena and registered
+    // buffers are never freed. One thread at a time (the worker)
+    size_t trim();
+
+    // trim() may free something
+    bool trimmable() const noexcept;
+
+    // Visits the buffers currently in the pool in slot order. Only safe while no
+    // other thread uses the pool (before handing it to the worker)
+    template <typename F>
+    void forEachBuffer(F&& visit) {
+        for (auto& buffer : slots_) {
+            if (buffer) visit(*buffer);
+        }
+    }
+
+private:
+    // Treiber stack of slot indices. The head carries a tag bumped by every
+    // update, so a pop racing with a pop + push of the same index (ABA) fails its CAS
+    class IndexStack {
+    public:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        explicit IndexStack(size_t capacity) : next_(capacity) {}
+
+        void push(uint32_t index) noexcept;
+        uint32_t pop() noexcept;  // NONE if empty
+
+    private:
+        std::atomic<uint64_t> head_{NONE};  // tag << 32 | index
+        std::vector<std::atomic<uint32_t>> next_;
+    };
+
+    std::unique_ptr<Buffer> allocate() const;
+    size_t keepCached() const noexcept;
+    void raisePeak(size_t use) noexcept;
+
+    // A slot is only touched by the thread that popped its index
+    std::vector<std::unique_ptr<Buffer>> slots_;
+    IndexStack full_;
+    IndexStack empty_;
+    std::atomic<size_t> available_{0};
+
+    size_t alignment_;
+    size_t initial_;
+    bool heap_;  // Buffers are allocated one by one, not carved out of storage
+    std::atomic<size_t> in_use_{0};
+    std::atomic<size_t> peak_{0};  // Highest in_use_ since the last trim()
+    size_t high_water_ = 0;        // trim() only
 };
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
 #include <vector>
@@ -92,6 +93,19 @@ public:
         return item;
     }
 
+    size_t tryPopBatch(std::span<T> out) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t count = std::min(out.size(), count_);
+
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = std::move(buffer_[head_]);
+            head_ = (head_ + 1) % capacity_;
+        }
+        count_ -= count;
+
+        return count;
+    }
+
     std::optional<T> pop() override {
         std::unique_lock<std::mutex> lock(mutex_);
         not_empty_.wait(lock, [this] { return count_ > 0 || stopped_; });
@@ -0,0 +1,200 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <MR/Interface/ThreadSafeQueue.hpp>
+
+namespace MR::Queue {
+
+/**
+ * Bounded lock-free multi-producer / single-consumer ring queue.
+ *
+ * Every slot carries its own sequence number (Vyukov style), so producers only
+ * contend on a single CAS of the tail counter and the consumer never touches
+ * shared state besides the slot it pops and its own head counter.
+ * Head and tail live on separate cache lines to avoid false sharing between
+ * the worker thread and the producer threads.
+ *
+ * Capacity is rounded up to the next power of two. When the ring is full,
+ * push() spins and then yields until the consumer frees a slot (backpressure,
+ * same semantics as FixedSizeBlockingQueue) or until shutdown() is called.
+ *
+ * Only ONE thread may call tryPop()/pop() at a time (the logger worker).
+ */
+template <typename T>
+class MPSCRingQueue : public Interface::ThreadSafeQueue<T> {
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};  // Next position to claim (producers)
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};  // Next position to pop (consumer)
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> stopped_{false};
+
+    static size_t roundCapacity(size_t requested) {
+        if (requested == 0) {
+            throw std::invalid_argument("Queue capacity must be > 0");
+        }
+        return std::bit_ceil(requested);
+    }
+
+    static void backoff(uint32_t& spins) {
+        if (++spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename U>
+    void emplace(U&& item) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        uint32_t spins = 0;
+
+        for (;;) {
+            if (stopped_.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            Slot& slot = slots_[pos & mask_];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Ring is full - wait for the consumer to free the slot
+                backoff(spins);
+                pos = tail_.load(std::memory_order_relaxed);
+            } else {
+                // Another producer claimed this position
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        Slot& slot = slots_[pos & mask_];
+        slot.value = std::forward<U>(item);
+        slot.sequence.store(pos + 1, std::memory_order_release);
+    }
+
+public:
+    explicit MPSCRingQueue(size_t requested_capacity)
+        : capacity_(roundCapacity(requested_capacity)),
+          mask_(capacity_ - 1),
+          slots_(std::make_unique<Slot[]>(capacity_)) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPSCRingQueue() override {
+        shutdown();
+    }
+
+    MPSCRingQueue(const MPSCRingQueue&) = delete;
+    MPSCRingQueue& operator=(const MPSCRingQueue&) = delete;
+    MPSCRingQueue(MPSCRingQueue&&) = delete;
+    MPSCRingQueue& operator=(MPSCRingQueue&&) = delete;
+
+    void push(const T& item) override {
+        emplace(item);
+    }
+
+    void push(T&& item) override {
+        emplace(std::move(item));
+    }
+
+    std::optional<T> tryPop() override {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask_];
+
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return std::nullopt;
+        }
+
+        T item = std::move(slot.value);
+        slot.sequence.store(pos + capacity_, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_release);
+
+        return item;
+    }
+
+    // Stops at the first slot that is claimed but not yet published
+    size_t tryPopBatch(std::span<T> out) override {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        size_t count = 0;
+
+        while (count < out.size()) {
+            Slot& slot = slots_[pos & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+
+            out[count++] = std::move(slot.value);
+            slot.sequence.store(pos + capacity_, std::memory_order_release);
+            ++pos;
+        }
+
+        head_.store(pos, std::memory_order_release);
+        return count;
+    }
+
+    std::optional<T> pop() override {
+        uint32_t spins = 0;
+
+        for (;;) {
+            if (auto item = tryPop()) {
+                return item;
+            }
+
+            if (stopped_.load(std::memory_order_acquire) && empty()) {
+                return std::nullopt;
+            }
+
+            if (spins < 128) {
+                backoff(spins);
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    bool empty() const override {
+        return size() == 0;
+    }
+
+    // Includes slots that were claimed by a producer but not yet published
+    size_t size() const override {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    void shutdown() override {
+        stopped_.store(true, std::memory_order_release);
+    }
+};
+
+} // namespace MR::Queue
@@ -0,0 +1,405 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <MR/Interface/ThreadSafeQueue.hpp>
+
+namespace MR::Queue {
+
+/**
+ * Queue made of per-thread single-producer / single-consumer lanes.
+ *
+ * The first push() from a thread lazily registers a dedicated SPSC ring (lane)
+ * for that thread, after which the hot path touches no shared atomic at all:
+ * the producer only writes its own lane's tail, the worker only its head.
+ *
+ * The consumer side drains the lanes with a k-way merge on the lane heads.
+ * If T has a `timestamp` member the oldest head is popped first, so
+ * cross-thread order in the log file stays sensible without a global
+ * sequence counter. Otherwise lanes are drained round-robin. Either way
+ * tryPopBatch() reads every lane's tail once and publishes every head once
+ * per batch, the timestamp merge runs on a heap over that snapshot.
+ *
+ * Threads beyond max_lanes share one mutex protected overflow lane, for as
+ * long as they live so their own messages keep their order. A thread's lanes
+ * are looked up in a thread_local map keyed by queue and given back to their
+ * queues when the thread exits, the next thread registering reuses them (with
+ * whatever the worker did not pop yet, still in order). Lanes are freed with
+ * the queue, worst case memory is max_lanes * lane_capacity * sizeof(T).
+ *
+ * Only ONE thread may call tryPop()/pop() at a time (the logger worker).
+ */
+template <typename T>
+class SPSCLaneQueue : public Interface::ThreadSafeQueue<T> {
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct Lane {
+        explicit Lane(size_t capacity)
+            : mask(capacity - 1), slots(std::make_unique<T[]>(capacity)) {}
+
+        const size_t mask;
+        std::unique_ptr<T[]> slots;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};  // Written by the owning producer
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};  // Written by the consumer
+
+        size_t size() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+    };
+
+    // Lanes of exited threads. Shared with the LaneRegistry of every thread holding a
+    // lane, so a thread exiting after the queue is gone finds it closed
+    struct FreeLanes {
+        std::mutex mutex;
+        std::vector<Lane*> lanes;
+        std::atomic<bool> open{true};  // Written under mutex
+    };
+
+    // The lanes of one thread, in every queue it pushed to
+    struct LaneRegistry {
+        struct Entry {
+            Lane* lane;  // nullptr: the thread uses the overflow lane
+            std::shared_ptr<FreeLanes> free;
+        };
+
+        // The queue pushed to last, most threads only ever use one
+        uint64_t last_id = 0;
+        Lane* last_lane = nullptr;
+        std::unordered_map<uint64_t, Entry> entries;
+
+        // Forgets the queues that are gone
+        void prune() {
+            std::erase_if(entries, [](const auto& entry) {
+                return !entry.second.free->open.load(std::memory_order_relaxed);
+            });
+        }
+
+        ~LaneRegistry() {
+            for (auto& [id, entry] : entries) {
+                if (!entry.lane) continue;
+                std::lock_guard<std::mutex> lock(entry.free->mutex);
+                if (entry.free->open.load(std::memory_order_relaxed)) entry.free->lanes.push_back(entry.lane);
+            }
+        }
+    };
+
+    const uint64_t id_;
+    const size_t lane_capacity_;
+    const size_t max_lanes_;
+
+    // Published lane table: slots [0, lane_count_) are valid and never change
+    std::unique_ptr<std::atomic<Lane*>[]> lane_table_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> lane_count_{0};
+
+    std::mutex registration_mutex_;
+    std::vector<std::unique_ptr<Lane>> owned_lanes_;
+    std::shared_ptr<FreeLanes> free_lanes_ = std::make_shared<FreeLanes>();
+
+    // Shared by producers once max_lanes_ is exhausted
+    std::mutex overflow_mutex_;
+    Lane* overflow_lane_ = nullptr;
+
+    // Round-robin cursor for T without a timestamp (consumer only)
+    size_t next_lane_ = 0;
+
+    // What tryPopBatch() merges: the items a lane had when the batch started (consumer only)
+    struct Run {
+        Lane* lane;
+        size_t start;  // lane->head when the batch started
+        size_t head;
+        size_t tail;
+    };
+    std::vector<Run> runs_;
+    std::vector<uint32_t> merge_heap_;  // Indices into runs_ of the runs not taken yet, oldest front first
+
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> stopped_{false};
+
+    static uint64_t nextQueueId() {
+        static std::atomic<uint64_t> counter{1};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void backoff(uint32_t& spins) {
+        if (++spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    // A lane an exited thread gave back, a new one, or nullptr once max_lanes_ are taken
+    Lane* registerLane() {
+        {
+            std::lock_guard<std::mutex> lock(free_lanes_->mutex);
+            if (!free_lanes_->lanes.empty()) {
+                Lane* lane = free_lanes_->lanes.back();
+                free_lanes_->lanes.pop_back();
+                return lane;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(registration_mutex_);
+
+        size_t count = lane_count_.load(std::memory_order_relaxed);
+        if (count >= max_lanes_) {
+            return nullptr;
+        }
+
+        owned_lanes_.push_back(std::make_unique<Lane>(lane_capacity_));
+        Lane* lane = owned_lanes_.back().get();
+        lane_table_[count].store(lane, std::memory_order_relaxed);
+        lane_count_.store(count + 1, std::memory_order_release);
+        return lane;
+    }
+
+    // Returns the calling thread's lane, or nullptr if it has to use the overflow lane
+    Lane* localLane() {
+        static thread_local LaneRegistry registry;
+
+        if (registry.last_id == id_) return registry.last_lane;
+
+        auto entry = registry.entries.find(id_);
+        if (entry == registry.entries.end()) {
+            registry.prune();
+            entry = registry.entries.emplace(id_, typename LaneRegistry::Entry{nullptr, free_lanes_}).first;
+            entry->second.lane = registerLane();
+        }
+        registry.last_id = id_;
+        registry.last_lane = entry->second.lane;
+        return entry->second.lane;
+    }
+
+    template <typename U>
+    void pushToLane(Lane& lane, U&& item) {
+        size_t tail = lane.tail.load(std::memory_order_relaxed);
+        uint32_t spins = 0;
+
+        // Lane full - wait for the worker to drain it
+        while (tail - lane.head.load(std::memory_order_acquire) > lane.mask) {
+            if (stopped_.load(std::memory_order_relaxed)) return;
+            backoff(spins);
+        }
+
+        lane.slots[tail & lane.mask] = std::forward<U>(item);
+        lane.tail.store(tail + 1, std::memory_order_release);
+    }
+
+    template <typename U>
+    void emplace(U&& item) {
+        if (stopped_.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        if (Lane* lane = localLane()) {
+            pushToLane(*lane, std::forward<U>(item));
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        pushToLane(*overflow_lane_, std::forward<U>(item));
+    }
+
+    static bool hasItem(const Lane& lane) {
+        return lane.tail.load(std::memory_order_acquire) != lane.head.load(std::memory_order_relaxed);
+    }
+
+    static T take(Lane& lane) {
+        size_t head = lane.head.load(std::memory_order_relaxed);
+        T item = std::move(lane.slots[head & lane.mask]);
+        lane.head.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    const T& front(const Lane& lane) const {
+        return lane.slots[lane.head.load(std::memory_order_relaxed) & lane.mask];
+    }
+
+    // Lane to pop from next, nullptr if every lane is empty
+    Lane* selectLane() {
+        size_t count = lane_count_.load(std::memory_order_acquire);
+
+        if constexpr (requires(const T& t) { t.timestamp < t.timestamp; }) {
+            Lane* oldest = hasItem(*overflow_lane_) ? overflow_lane_ : nullptr;
+            for (size_t i = 0; i < count; ++i) {
+                Lane* lane = lane_table_[i].load(std::memory_order_relaxed);
+                if (!hasItem(*lane)) continue;
+                if (!oldest || front(*lane).timestamp < front(*oldest).timestamp) {
+                    oldest = lane;
+                }
+            }
+            return oldest;
+        } else {
+            for (size_t i = 0; i <= count; ++i) {
+                size_t idx = (next_lane_ + i) % (count + 1);
+                Lane* lane = idx == count ? overflow_lane_ : lane_table_[idx].load(std::memory_order_relaxed);
+                if (hasItem(*lane)) {
+                    next_lane_ = idx + 1;
+                    return lane;
+                }
+            }
+            return nullptr;
+        }
+    }
+
+public:
+    explicit SPSCLaneQueue(size_t lane_capacity = 1024, size_t max_lanes = 128)
+        : id_(nextQueueId()),
+          lane_capacity_(lane_capacity == 0 ? 0 : std::bit_ceil(lane_capacity)),
+          max_lanes_(max_lanes),
+          lane_table_(std::make_unique<std::atomic<Lane*>[]>(max_lanes)) {
+        if (lane_capacity == 0) {
+            throw std::invalid_argument("Lane capacity must be > 0");
+        }
+        owned_lanes_.reserve(max_lanes + 1);
+        runs_.reserve(max_lanes + 1);
+        merge_heap_.reserve(max_lanes + 1);
+        owned_lanes_.push_back(std::make_unique<Lane>(lane_capacity_));
+        overflow_lane_ = owned_lanes_.back().get();
+    }
+
+    ~SPSCLaneQueue() override {
+        shutdown();
+        std::lock_guard<std::mutex> lock(free_lanes_->mutex);
+        free_lanes_->open.store(false, std::memory_order_relaxed);
+    }
+
+    SPSCLaneQueue(const SPSCLaneQueue&) = delete;
+    SPSCLaneQueue& operator=(const SPSCLaneQueue&) = delete;
+    SPSCLaneQueue(SPSCLaneQueue&&) = delete;
+    SPSCLaneQueue& operator=(SPSCLaneQueue&&) = delete;
+
+    void push(const T& item) override {
+        emplace(item);
+    }
+
+    void push(T&& item) override {
+        emplace(std::move(item));
+    }
+
+    std::optional<T> tryPop() override {
+        Lane* lane = selectLane();
+        if (!lane) {
+            return std::nullopt;
+        }
+        return take(*lane);
+    }
+
+    size_t tryPopBatch(std::span<T> out) override {
+        size_t count = 0;
+
+        if constexpr (requires(const T& t) { t.timestamp < t.timestamp; }) {
+            // Items pushed from here on wait for the next batch
+            size_t lanes = lane_count_.load(std::memory_order_acquire);
+            runs_.clear();
+            merge_heap_.clear();
+            for (size_t i = 0; i <= lanes; ++i) {
+                Lane* lane = i == lanes ? overflow_lane_ : lane_table_[i].load(std::memory_order_relaxed);
+                size_t head = lane->head.load(std::memory_order_relaxed);
+                size_t tail = lane->tail.load(std::memory_order_acquire);
+                if (head == tail) continue;
+                merge_heap_.push_back(static_cast<uint32_t>(runs_.size()));
+                runs_.push_back(Run{lane, head, head, tail});
+            }
+
+            auto front_of = [this](uint32_t run) -> const T& {
+                return runs_[run].lane->slots[runs_[run].head & runs_[run].lane->mask];
+            };
+            auto later = [&](uint32_t a, uint32_t b) { return front_of(b).timestamp < front_of(a).timestamp; };
+            std::make_heap(merge_heap_.begin(), merge_heap_.end(), later);
+
+            while (count < out.size() && !merge_heap_.empty()) {
+                std::pop_heap(merge_heap_.begin(), merge_heap_.end(), later);
+                Run& run = runs_[merge_heap_.back()];
+                out[count++] = std::move(run.lane->slots[run.head & run.lane->mask]);
+                if (++run.head == run.tail) {
+                    merge_heap_.pop_back();
+                } else {
+                    std::push_heap(merge_heap_.begin(), merge_heap_.end(), later);
+                }
+            }
+
+            // The producers see the freed slots only now, they never touch a slot still being moved from
+            for (const Run& run : runs_) {
+                if (run.head != run.start) run.lane->head.store(run.head, std::memory_order_release);
+            }
+        } else {
+            // No ordering to restore - drain each lane in turn with one head update,
+            // starting where the previous call stopped so no lane is starved
+            size_t lanes = lane_count_.load(std::memory_order_acquire);
+            size_t start = next_lane_;
+            for (size_t i = 0; i <= lanes && count < out.size(); ++i) {
+                size_t idx = (start + i) % (lanes + 1);
+                Lane& lane = idx == lanes ? *overflow_lane_ : *lane_table_[idx].load(std::memory_order_relaxed);
+                size_t head = lane.head.load(std::memory_order_relaxed);
+                size_t available = lane.tail.load(std::memory_order_acquire) - head;
+                size_t n = std::min(available, out.size() - count);
+
+                for (size_t j = 0; j < n; ++j) {
+                    out[count++] = std::move(lane.slots[(head + j) & lane.mask]);
+                }
+                lane.head.store(head + n, std::memory_order_release);
+                next_lane_ = idx + 1;
+            }
+        }
+
+        return count;
+    }
+
+    std::optional<T> pop() override {
+        uint32_t spins = 0;
+
+        for (;;) {
+            if (auto item = tryPop()) {
+                return item;
+            }
+
+            if (stopped_.load(std::memory_order_acquire) && empty()) {
+                return std::nullopt;
+            }
+
+            if (spins < 128) {
+                backoff(spins);
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    bool empty() const override {
+        return size() == 0;
+    }
+
+    size_t size() const override {
+        size_t total = overflow_lane_->size();
+        size_t count = lane_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            total += lane_table_[i].load(std::memory_order_relaxed)->size();
+        }
+        return total;
+    }
+
+    // Lanes registered so far, including those waiting for a thread to reuse them
+    size_t laneCount() const {
+        return lane_count_.load(std::memory_order_acquire);
+    }
+
+    void shutdown() override {
+        stopped_.store(true, std::memory_order_release);
+    }
+};
+
+} // namespace MR::Queue
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -98,6 +99,18 @@ namespace MR::Queue {
         return element;
       }
 
+      inline size_t tryPopBatch(std::span<T> out) override {
+        LOCK();
+        size_t count = std::min(out.size(), queue_.size());
+
+        for (size_t i = 0; i < count; ++i) {
+          out[i] = std::move(queue_.front());
+          queue_.pop();
+        }
+
+        return count;
+      }
+
       inline std::optional<T> pop() override {
         
         LOCK();
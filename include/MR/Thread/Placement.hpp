@@ -0,0 +1,30 @@
+#pragma once
+
+#include <span>
+
+namespace MR::Thread {
+
+  // Linux scheduling policy of the worker thread (see Config::worker_scheduling)
+  enum class Scheduling {
+    // SCHED_OTHER, whatever the creating thread had
+    NORMAL,
+    // SCHED_BATCH - treated as CPU bound, preempts interactive threads less often
+    BATCH,
+    // SCHED_IDLE - only runs on cores with nothing else to do
+    IDLE
+  };
+
+  // Restricts the calling thread to the CPUs, 0 or the negative errno.
+  // An empty set leaves the affinity alone
+  int pinCurrentThread(std::span<const int> cpus) noexcept;
+
+  // Switches the calling thread (not the process) to the policy, 0 or the negative errno
+  int setCurrentScheduling(Scheduling scheduling) noexcept;
+
+  // NUMA node of the CPU from /sys/devices/system/cpu, -1 if unknown (no NUMA support)
+  int numaNodeOf(int cpu) noexcept;
+
+  // Online NUMA nodes, 0 without NUMA support
+  int numaNodeCount() noexcept;
+
+}
@@ -0,0 +1,266 @@
+#include <MR/IO/BinaryDecoder.hpp>
+#include <MR/Logger/SeverityLevel.hpp>
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+namespace MR::IO {
+
+namespace {
+
+constexpr uint8_t NATIVE_FLAGS = std::endian::native == std::endian::big ? Binary::FLAG_BIG_ENDIAN : 0;
+
+// Cursor over the input, every read fails once the input runs out
+struct Reader {
+    std::string_view input;
+    size_t pos;
+
+    bool byte(uint8_t& value) {
+        if (pos >= input.size()) return false;
+        value = static_cast<uint8_t>(input[pos++]);
+        return true;
+    }
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t b;
+            if (!byte(b)) return false;
+            value |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool bytes(size_t length, std::string_view& value) {
+        if (input.size() - pos < length) return false;
+        value = input.substr(pos, length);
+        pos += length;
+        return true;
+    }
+
+    template <typename T>
+    bool fixed(T& value) {
+        std::string_view raw;
+        if (!bytes(sizeof(T), raw)) return false;
+        std::memcpy(&value, raw.data(), sizeof(T));
+        return true;
+    }
+
+    bool string(std::string_view& value) {
+        uint64_t length;
+        return varint(length) && bytes(length, value);
+    }
+};
+
+template <typename T>
+T load(const char*& args) {
+    T value;
+    std::memcpy(&value, args, sizeof(T));
+    args += sizeof(T);
+    return value;
+}
+
+}
+
+size_t BinaryDecoder::decode(std::string_view input, std::string& out) {
+    size_t consumed = 0;
+
+    while (consumed < input.size() && error_.empty()) {
+        size_t pos = consumed;
+        Status status = decodeRecord(input, pos, out);
+        if (status == Status::INCOMPLETE) break;
+        if (status == Status::INVALID) {
+            if (error_.empty()) error_ = "malformed record";
+            error_ += " at offset " + std::to_string(consumed) + " of the input";
+            break;
+        }
+        consumed = pos;
+    }
+
+    return consumed;
+}
+
+BinaryDecoder::Status BinaryDecoder::decodeRecord(std::string_view input, size_t& pos, std::string& out) {
+    Reader in{input, pos};
+
+    // A header wherever a record may start (the file was appended to by another logger)
+    if (input[pos] == Binary::MAGIC[0]) {
+        std::string_view magic;
+        uint8_t version, flags;
+        int64_t base;
+        if (!in.bytes(sizeof(Binary::MAGIC), magic) || !in.byte(version) || !in.byte(flags) || !in.fixed(base)) {
+            // Only a prefix of the header is available, it may still turn out to be one
+            auto available = input.substr(pos, sizeof(Binary::MAGIC));
+            return std::string_view(Binary::MAGIC, sizeof(Binary::MAGIC)).starts_with(available) ?
+                Status::INCOMPLETE : Status::INVALID;
+        }
+        if (magic != std::string_view(Binary::MAGIC, sizeof(Binary::MAGIC))) {
+            error_ = "not a MR::Logger binary log";
+            return Status::INVALID;
+        }
+        if (version != Binary::VERSION) {
+            error_ = "unsupported binary log version " + std::to_string(version);
+            return Status::INVALID;
+        }
+        if ((flags & Binary::FLAG_BIG_ENDIAN) != NATIVE_FLAGS) {
+            error_ = "binary log written on a host with a different byte order";
+            return Status::INVALID;
+        }
+
+        started_ = true;
+        flags_ = flags;
+        last_timestamp_ = base;
+        formats_.clear();
+        threads_.clear();
+        pos = in.pos;
+        return Status::OK;
+    }
+
+    if (!started_) {
+        error_ = "not a MR::Logger binary log";
+        return Status::INVALID;
+    }
+
+    uint8_t tag_byte = 0;
+    in.byte(tag_byte);
+    auto tag = static_cast<Binary::Tag>(tag_byte);
+
+    switch (tag) {
+        case Binary::Tag::PADDING:
+            break;
+
+        case Binary::Tag::FORMAT: {
+            uint64_t id;
+            uint8_t count;
+            std::string_view types, text;
+            if (!in.varint(id) || !in.byte(count) || !in.bytes(count, types) || !in.string(text)) {
+                return Status::INCOMPLETE;
+            }
+
+            Format format{std::string(text), {}, 0};
+            for (char type : types) {
+                auto arg = static_cast<Binary::ArgType>(type);
+                size_t size = Binary::argSize(arg);
+                if (size == 0) {
+                    error_ = "unknown argument type " + std::to_string(static_cast<uint8_t>(type));
+                    return Status::INVALID;
+                }
+                format.types.push_back(arg);
+                format.args_size += size;
+            }
+            formats_[static_cast<uint32_t>(id)] = std::move(format);
+            break;
+        }
+
+        case Binary::Tag::THREAD: {
+            uint64_t index;
+            std::string_view name;
+            if (!in.varint(index) || !in.string(name)) return Status::INCOMPLETE;
+            threads_[static_cast<uint32_t>(index)] = std::string(name);
+            break;
+        }
+
+        case Binary::Tag::EVENT:
+        case Binary::Tag::TEXT: {
+            uint64_t format_id = 0, delta, thread_index, sequence = 0;
+            uint8_t level;
+            if ((tag == Binary::Tag::EVENT && !in.varint(format_id)) ||
+                !in.varint(delta) || !in.varint(thread_index) || !in.byte(level) ||
+                ((flags_ & Binary::FLAG_SEQUENCE) && !in.varint(sequence))) {
+                return Status::INCOMPLETE;
+            }
+
+            const Format* format = nullptr;
+            std::string_view payload;
+            if (tag == Binary::Tag::EVENT) {
+                auto it = formats_.find(static_cast<uint32_t>(format_id));
+                if (it == formats_.end()) {
+                    error_ = "event refers to unknown format " + std::to_string(format_id);
+                    return Status::INVALID;
+                }
+                format = &it->second;
+                if (!in.bytes(format->args_size, payload)) return Status::INCOMPLETE;
+            } else {
+                uint32_t length;
+                if (!in.fixed(length) || !in.bytes(length, payload)) return Status::INCOMPLETE;
+            }
+
+            auto thread = threads_.find(static_cast<uint32_t>(thread_index));
+            if (thread == threads_.end()) {
+                error_ = "record refers to unknown thread " + std::to_string(thread_index);
+                return Status::INVALID;
+            }
+
+            // Same layout as WritePreparer::formatTo
+            last_timestamp_ += Binary::unzigzag(delta);
+            std::chrono::system_clock::time_point timestamp{
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(last_timestamp_))};
+
+            out += '[';
+            out += prefix_cache_.timestamp(timestamp);
+            out += "] [";
+            out += Logger::sevLvlName(static_cast<Logger::SEVERITY_LEVEL>(level));
+            out += "] [Thread: ";
+            out += thread->second;
+            if (flags_ & Binary::FLAG_SEQUENCE) {
+                out += "] [Seq: ";
+                out += std::to_string(sequence);
+            }
+            out += "]: ";
+            if (format) {
+                render(*format, payload.data(), out);
+            } else {
+                out += payload;
+            }
+            out += '\n';
+            ++messages_;
+            break;
+        }
+
+        default:
+            error_ = "unknown record type " + std::to_string(tag_byte);
+            return Status::INVALID;
+    }
+
+    pos = in.pos;
+    return Status::OK;
+}
+
+void BinaryDecoder::render(const Format& format, const char* args, std::string& out) const {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    store.reserve(format.types.size(), 0);
+
+    for (auto type : format.types) {
+        switch (type) {
+            case Binary::ArgType::BOOL: store.push_back(load<bool>(args)); break;
+            case Binary::ArgType::CHAR: store.push_back(load<char>(args)); break;
+            case Binary::ArgType::I8: store.push_back(load<int8_t>(args)); break;
+            case Binary::ArgType::U8: store.push_back(load<uint8_t>(args)); break;
+            case Binary::ArgType::I16: store.push_back(load<int16_t>(args)); break;
+            case Binary::ArgType::U16: store.push_back(load<uint16_t>(args)); break;
+            case Binary::ArgType::I32: store.push_back(load<int32_t>(args)); break;
+            case Binary::ArgType::U32: store.push_back(load<uint32_t>(args)); break;
+            case Binary::ArgType::I64: store.push_back(load<int64_t>(args)); break;
+            case Binary::ArgType::U64: store.push_back(load<uint64_t>(args)); break;
+            case Binary::ArgType::F32: store.push_back(load<float>(args)); break;
+            case Binary::ArgType::F64: store.push_back(load<double>(args)); break;
+            case Binary::ArgType::NONE: break;
+        }
+    }
+
+    try {
+        fmt::vformat_to(std::back_inserter(out), fmt::string_view(format.text), store);
+    } catch (const fmt::format_error& e) {
+        out += "<format error: ";
+        out += e.what();
+        out += " in \"" + format.text + "\">";
+    }
+}
+
+}
@@ -0,0 +1,228 @@
+#include <MR/IO/Compressor.hpp>
+
+#include <cerrno>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#ifdef MRLOGGER_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace MR::IO {
+
+namespace {
+
+// ioprio_set(2) has no glibc wrapper
+constexpr int IOPRIO_WHO_PROCESS = 1;
+constexpr int IOPRIO_CLASS_IDLE = 3;
+constexpr int IOPRIO_CLASS_SHIFT = 13;
+
+struct FdGuard {
+    int fd;
+    ~FdGuard() { if (fd >= 0) ::close(fd); }
+};
+
+#ifdef MRLOGGER_HAS_ZSTD
+struct CCtxDeleter {
+    void operator()(ZSTD_CCtx* ctx) const noexcept { ZSTD_freeCCtx(ctx); }
+};
+
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string streamCompress(int in, int out, int level, const std::stop_token& st) {
+    std::unique_ptr<ZSTD_CCtx, CCtxDeleter> ctx{ZSTD_createCCtx()};
+    if (!ctx) return "Failed to create zstd context";
+
+    ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_compressionLevel, level);
+    ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_checksumFlag, 1);
+
+    std::vector<char> in_buf(ZSTD_CStreamInSize());
+    std::vector<char> out_buf(ZSTD_CStreamOutSize());
+
+    bool last = false;
+    while (!last) {
+        if (st.stop_requested()) return "Interrupted";
+
+        ssize_t n = ::read(in, in_buf.data(), in_buf.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return "Failed to read";
+        }
+        last = n == 0;
+
+        ZSTD_EndDirective mode = last ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer input{in_buf.data(), static_cast<size_t>(n), 0};
+
+        bool finished = false;
+        while (!finished) {
+            ZSTD_outBuffer output{out_buf.data(), out_buf.size(), 0};
+            size_t remaining = ZSTD_compressStream2(ctx.get(), &output, &input, mode);
+            if (ZSTD_isError(remaining)) {
+                return std::string("zstd error: ") + ZSTD_getErrorName(remaining);
+            }
+            if (!writeAll(out, out_buf.data(), output.pos)) return "Failed to write";
+
+            finished = last ? remaining == 0 : input.pos == input.size;
+        }
+    }
+
+    return {};
+}
+#endif
+
+}
+
+bool compressionAvailable() noexcept {
+#ifdef MRLOGGER_HAS_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+FrameCompressor::FrameCompressor(int level) {
+#ifdef MRLOGGER_HAS_ZSTD
+    auto* ctx = ZSTD_createCCtx();
+    if (ctx) {
+        ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, level);
+    }
+    ctx_ = ctx;
+#else
+    (void)level;
+#endif
+}
+
+FrameCompressor::~FrameCompressor() {
+#ifdef MRLOGGER_HAS_ZSTD
+    ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(ctx_));
+#endif
+}
+
+size_t FrameCompressor::bound(size_t length) noexcept {
+#ifdef MRLOGGER_HAS_ZSTD
+    return ZSTD_compressBound(length);
+#else
+    return length;
+#endif
+}
+
+size_t FrameCompressor::compress(const void* src, size_t length, void* dst, size_t capacity) noexcept {
+#ifdef MRLOGGER_HAS_ZSTD
+    if (!ctx_ || !dst) return 0;
+
+    size_t size = ZSTD_compress2(static_cast<ZSTD_CCtx*>(ctx_), dst, capacity, src, length);
+    return ZSTD_isError(size) ? 0 : size;
+#else
+    (void)src; (void)length; (void)dst; (void)capacity;
+    return 0;
+#endif
+}
+
+BackgroundCompressor::BackgroundCompressor(int level, error_handler_t on_error)
+    : level_(level), on_error_(std::move(on_error)),
+      worker_([this](std::stop_token st) { run(st); }) {}
+
+void BackgroundCompressor::enqueue(std::string path) {
+    std::error_code ec;
+    size_t size = std::filesystem::file_size(path, ec);
+    if (ec) size = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.emplace_back(std::move(path), size);
+        backlog_files_.fetch_add(1, std::memory_order_relaxed);
+        backlog_bytes_.fetch_add(size, std::memory_order_relaxed);
+    }
+    cv_.notify_one();
+}
+
+CompressionBacklog BackgroundCompressor::backlog() const noexcept {
+    return CompressionBacklog{
+        .files = backlog_files_.load(std::memory_order_relaxed),
+        .bytes = backlog_bytes_.load(std::memory_order_relaxed)
+    };
+}
+
+std::string BackgroundCompressor::compressFile(const std::string& path, int level, std::stop_token st) {
+#ifdef MRLOGGER_HAS_ZSTD
+    std::string out_path = path + ".zst";
+
+    FdGuard in{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (in.fd < 0) return "Failed to open " + path;
+    ::posix_fadvise(in.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    std::string error;
+    {
+        // An existing archive is never replaced, the original is kept instead
+        FdGuard out{::open(out_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644)};
+        if (out.fd < 0) {
+            return errno == EEXIST ? out_path + " already exists, keeping " + path + " uncompressed"
+                                   : "Failed to create " + out_path;
+        }
+
+        error = streamCompress(in.fd, out.fd, level, st);
+
+        // The original is only unlinked once the compressed copy is on disk
+        if (error.empty() && ::fdatasync(out.fd) < 0) error = "Failed to sync";
+    }
+
+    if (!error.empty()) {
+        ::unlink(out_path.c_str());
+        return error + " while compressing " + path;
+    }
+
+    // Rotated logs are not read again, keep them from crowding out the page cache
+    ::posix_fadvise(in.fd, 0, 0, POSIX_FADV_DONTNEED);
+
+    if (::unlink(path.c_str()) < 0) return "Failed to remove " + path + " after compressing it";
+    return {};
+#else
+    (void)level; (void)st;
+    return "Cannot compress " + path + ", MR::Logger was built without zstd";
+#endif
+}
+
+void BackgroundCompressor::run(std::stop_token st) {
+    // Background work only: lowest CPU priority and the idle I/O class, for this thread alone
+    auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    ::setpriority(PRIO_PROCESS, tid, 19);
+    ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+
+    while (true) {
+        std::pair<std::string, size_t> next;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!cv_.wait(lock, st, [this] { return !pending_.empty(); })) return;
+            next = std::move(pending_.front());
+            pending_.pop_front();
+        }
+
+        auto error = compressFile(next.first, level_, st);
+
+        backlog_files_.fetch_sub(1, std::memory_order_relaxed);
+        backlog_bytes_.fetch_sub(next.second, std::memory_order_relaxed);
+
+        if (!error.empty() && !st.stop_requested() && on_error_) {
+            on_error_("BackgroundCompressor", error);
+        }
+    }
+}
+
+}
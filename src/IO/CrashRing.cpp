@@ -0,0 +1,194 @@
+#include <MR/IO/CrashRing.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace MR::IO {
+
+namespace {
+
+constexpr uint64_t MAGIC = 0x474e495248534352ull;  // "RCSHRING"
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 64;
+constexpr size_t RECORD_ALIGNMENT = 8;
+
+constexpr size_t RECORD_HEADER_SIZE = 8;
+
+enum RecordState : uint16_t { PENDING = 1, WRITTEN = 2, SKIP = 3 };
+
+constexpr size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr size_t recordSize(size_t size) {
+    return RECORD_HEADER_SIZE + alignUp(size, RECORD_ALIGNMENT);
+}
+
+}
+
+// Positions are byte counts since the ring was created, a record sits at position % capacity
+struct CrashRing::Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t capacity;
+    uint64_t head;  // End of the last appended record
+    uint64_t tail;  // Start of the oldest record that may still be pending
+};
+
+// Followed by size bytes of data, padded to RECORD_ALIGNMENT. A SKIP record fills
+// the end of the area a record didn't fit into
+struct CrashRing::RecordHeader {
+    uint32_t size;
+    uint16_t sink;
+    uint16_t state;
+};
+
+CrashRing::CrashRing(const std::string& path, size_t capacity)
+    : capacity_{std::max<size_t>(capacity, 4096) / RECORD_ALIGNMENT * RECORD_ALIGNMENT} {
+    static_assert(sizeof(Header) <= HEADER_SIZE && sizeof(RecordHeader) == RECORD_HEADER_SIZE);
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open crash ring file " + path);
+    }
+
+    struct stat st{};
+    if (::fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) >= HEADER_SIZE && map(static_cast<size_t>(st.st_size))) {
+        recover();
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+
+    if (::ftruncate(fd_, static_cast<off_t>(HEADER_SIZE + capacity_)) < 0 || !map(HEADER_SIZE + capacity_)) {
+        ::close(fd_);
+        throw std::runtime_error("Failed to map crash ring file " + path);
+    }
+
+    Header& h = header();
+    h.capacity = capacity_;
+    h.head = 0;
+    h.tail = 0;
+    h.version = VERSION;
+    h.reserved = 0;
+    std::atomic_ref<uint64_t>(h.magic).store(MAGIC, std::memory_order_release);
+}
+
+CrashRing::~CrashRing() {
+    // Nothing is cleared, a clean shutdown completed every record anyway
+    if (map_) ::munmap(map_, map_size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool CrashRing::map(size_t size) noexcept {
+    void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (memory == MAP_FAILED) return false;
+    map_ = static_cast<char*>(memory);
+    map_size_ = size;
+    return true;
+}
+
+CrashRing::Header& CrashRing::header() const noexcept {
+    return *reinterpret_cast<Header*>(map_);
+}
+
+char* CrashRing::records() const noexcept {
+    return map_ + HEADER_SIZE;
+}
+
+CrashRing::RecordHeader& CrashRing::recordAt(uint64_t position) const noexcept {
+    return *reinterpret_cast<RecordHeader*>(records() + position % capacity_);
+}
+
+// Reads the pending records of the previous run from the current mapping, which may
+// have another capacity. Anything inconsistent ends the walk, the file is never trusted
+void CrashRing::recover() noexcept {
+    const Header& h = header();
+    if (h.magic != MAGIC || h.version != VERSION) return;
+
+    uint64_t capacity = h.capacity;
+    uint64_t head = h.head;
+    uint64_t tail = h.tail;
+    if (capacity == 0 || capacity % RECORD_ALIGNMENT != 0 || HEADER_SIZE + capacity > map_size_) return;
+    if (head < tail || head - tail > capacity) return;
+
+    try {
+        for (uint64_t position = tail; position < head;) {
+            size_t offset = position % capacity;
+            const auto& record = *reinterpret_cast<const RecordHeader*>(records() + offset);
+            if (record.state == SKIP) {
+                position += capacity - offset;
+                continue;
+            }
+
+            size_t size = recordSize(record.size);
+            if (offset + size > capacity || position + size > head) return;
+            if (record.state == PENDING) {
+                const char* data = records() + offset + RECORD_HEADER_SIZE;
+                recovered_.push_back(Record{record.sink, std::string(data, record.size)});
+            } else if (record.state != WRITTEN) {
+                return;
+            }
+            position += size;
+        }
+    } catch (...) {
+        // Out of memory, what was read so far is still replayed
+    }
+}
+
+uint64_t CrashRing::append(uint16_t sink, const void* data, size_t size) noexcept {
+    if (size > UINT32_MAX || recordSize(size) > capacity_) return NO_RECORD;
+
+    Header& h = header();
+    uint64_t head = h.head;
+    size_t offset = head % capacity_;
+    size_t total = recordSize(size);
+    size_t skip = offset + total > capacity_ ? capacity_ - offset : 0;
+    if (head + skip + total - h.tail > capacity_) return NO_RECORD;
+
+    if (skip > 0) {
+        recordAt(head) = RecordHeader{0, 0, SKIP};
+        head += skip;
+    }
+
+    // Data and header before the head moves past them, a record is only seen complete
+    RecordHeader& record = recordAt(head);
+    std::memcpy(records() + head % capacity_ + RECORD_HEADER_SIZE, data, size);
+    record = RecordHeader{static_cast<uint32_t>(size), sink, PENDING};
+    std::atomic_ref<uint64_t>(h.head).store(head + total, std::memory_order_release);
+    return head;
+}
+
+void CrashRing::complete(uint64_t position) noexcept {
+    if (position == NO_RECORD) return;
+    std::atomic_ref<uint16_t>(recordAt(position).state).store(WRITTEN, std::memory_order_release);
+
+    // Reclaim the space of the oldest records, as far as they are all written
+    Header& h = header();
+    uint64_t tail = h.tail;
+    while (tail < h.head) {
+        const RecordHeader& record = recordAt(tail);
+        if (record.state == SKIP) {
+            tail += capacity_ - tail % capacity_;
+        } else if (record.state == WRITTEN) {
+            tail += recordSize(record.size);
+        } else {
+            break;
+        }
+    }
+    std::atomic_ref<uint64_t>(h.tail).store(tail, std::memory_order_release);
+}
+
+size_t CrashRing::pendingBytes() const noexcept {
+    const Header& h = header();
+    return static_cast<size_t>(h.head - h.tail);
+}
+
+}
@@ -21,15 +21,23 @@ void FileRotater::extractBaseAndExtension(const std::string& filename) {
     }
 }
 
+bool FileRotater::isTaken(const std::string& rotated_name) {
+    // CompressionMode::ROTATED leaves only the archive, the index keeps its plain name
+    return std::filesystem::exists(rotated_name) ||
+           std::filesystem::exists(rotated_name + ".zst") ||
+           std::filesystem::exists(rotated_name + ".idx");
+}
+
 std::string FileRotater::getNextRotatedName() {
-    int counter = 1;
+    // Indices below next_index_ are known to be taken, so only the first rotation
+    // scans past the files left by earlier runs. Afterwards this is a single check
     std::string rotated_name;
-    
+
     do {
-        rotated_name = base_name_ + std::to_string(counter) + extension_;
-        counter++;
-    } while (std::filesystem::exists(rotated_name));
-    
+        rotated_name = base_name_ + std::to_string(next_index_) + extension_;
+        next_index_++;
+    } while (isTaken(rotated_name));
+
     return rotated_name;
 }
 
@@ -37,15 +45,30 @@ bool FileRotater::shouldRotate() const {
     return current_size_ >= max_size_bytes_;
 }
 
-void FileRotater::rotate() {
+std::string FileRotater::rotate() {
     std::string current_filename = getCurrentFilename();
+    std::string rotated_name;
     
     if (std::filesystem::exists(current_filename)) {
-        std::string rotated_name = getNextRotatedName();
+        rotated_name = getNextRotatedName();
         std::filesystem::rename(current_filename, rotated_name);
     }
     
     current_size_ = 0;
+    return rotated_name;
+}
+
+std::string FileRotater::beginRotation() {
+    current_size_ = 0;
+    return getNextRotatedName();
+}
+
+std::string FileRotater::getStandbyFilename() const {
+    return getCurrentFilename() + ".next";
+}
+
+bool FileRotater::shouldPrepareStandby() const {
+    return current_size_ >= max_size_bytes_ / 2;
 }
 
 void FileRotater::updateCurrentSize(size_t bytes_written) {
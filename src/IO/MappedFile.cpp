@@ -0,0 +1,124 @@
+#include <MR/IO/MappedFile.hpp>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace MR::IO {
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+MappedFile::MappedFile(size_t chunk_size)
+    : page_size_(static_cast<size_t>(::sysconf(_SC_PAGESIZE))) {
+    chunk_size_ = alignUp(std::max(chunk_size, page_size_), page_size_);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::open(const WriteOnlyFile& file) {
+    close();
+
+    size_t size = file.size();
+    fd_ = file.fd();
+    cursor_ = size;
+    file_size_ = size;
+    synced_ = size;
+}
+
+void MappedFile::close() noexcept {
+    if (fd_ < 0) return;
+
+    trim();
+    unmap();
+    fd_ = -1;
+}
+
+char* MappedFile::reserve(size_t length) noexcept {
+    if (fd_ < 0) return nullptr;
+
+    if (!window_ || cursor_ + length > window_offset_ + window_size_) {
+        if (!remap(length)) return nullptr;
+    }
+
+    // Grow the file up to the end of the window, a write past EOF would raise SIGBUS
+    size_t window_end = window_offset_ + window_size_;
+    if (cursor_ + length > file_size_) {
+        if (::fallocate(fd_, 0, static_cast<off_t>(file_size_), static_cast<off_t>(window_end - file_size_)) < 0) {
+            // Not every filesystem supports fallocate, ftruncate still grows the file (sparse)
+            if (errno != EOPNOTSUPP || ::ftruncate(fd_, static_cast<off_t>(window_end)) < 0) {
+                return nullptr;
+            }
+        }
+        file_size_ = window_end;
+    }
+
+    return window_ + (cursor_ - window_offset_);
+}
+
+bool MappedFile::remap(size_t length) noexcept {
+    unmap();
+
+    window_offset_ = cursor_ / page_size_ * page_size_;
+    window_size_ = alignUp(std::max(chunk_size_, cursor_ - window_offset_ + length), page_size_);
+
+    void* window = ::mmap(nullptr, window_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+                          static_cast<off_t>(window_offset_));
+    if (window == MAP_FAILED) {
+        window_size_ = 0;
+        return false;
+    }
+
+    window_ = static_cast<char*>(window);
+    ::madvise(window_, window_size_, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::unmap() noexcept {
+    if (!window_) return;
+
+    // Start writeback of the finished window without waiting for it
+    ::msync(window_, window_size_, MS_ASYNC);
+    ::munmap(window_, window_size_);
+    window_ = nullptr;
+    window_size_ = 0;
+}
+
+int MappedFile::sync() noexcept {
+    if (fd_ < 0 || synced_ == cursor_) return 0;
+
+    int status;
+    if (window_ && synced_ >= window_offset_) {
+        // Everything unsynced is still mapped, only msync that range
+        size_t start = synced_ / page_size_ * page_size_;
+        status = ::msync(window_ + (start - window_offset_), cursor_ - start, MS_SYNC);
+    } else {
+        // Part of it was unmapped already, its dirty pages are only reachable through the file
+        status = ::fdatasync(fd_);
+    }
+
+    if (status < 0) return -errno;
+    synced_ = cursor_;
+    return 0;
+}
+
+int MappedFile::trim() noexcept {
+    if (fd_ < 0 || file_size_ == cursor_) return 0;
+
+    // The window stays mapped, reserve() grows the file again before anything is written past EOF
+    if (::ftruncate(fd_, static_cast<off_t>(cursor_)) < 0) return -errno;
+    file_size_ = cursor_;
+    return 0;
+}
+
+}
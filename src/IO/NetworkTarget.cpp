@@ -0,0 +1,44 @@
+#include <MR/IO/NetworkTarget.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace MR::IO {
+
+NetworkTarget::NetworkTarget(const std::string& host, uint16_t port, int socket_type)
+    : socket_type_{socket_type},
+      name_{host + ":" + std::to_string(port)} {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = socket_type;
+
+    addrinfo* result = nullptr;
+    int status = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result);
+    if (status != 0 || !result) {
+        throw std::runtime_error("Failed to resolve " + name_ + ": " + ::gai_strerror(status));
+    }
+
+    // The first address is what a plain connect() would try first too
+    std::memcpy(&address_, result->ai_addr, result->ai_addrlen);
+    address_length_ = static_cast<socklen_t>(result->ai_addrlen);
+    ::freeaddrinfo(result);
+}
+
+int NetworkTarget::openSocket() const noexcept {
+    int fd = ::socket(address_.ss_family, socket_type_ | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -errno;
+
+    // Frames are whole buffers already, holding them back for more only adds latency
+    if (stream()) {
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+}
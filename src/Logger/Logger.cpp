@@ -7,14 +7,22 @@
 #include <MR/Coroutine/WriteTask.hpp>
 
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
 #include <stop_token>
 #include <string>
 #include <thread>
 #include <future>
 #include <cmath>
-#include <list>
+#include <span>
+#include <vector>
 
 #include <fmt/core.h>
 #include <fmt/std.h>
@@ -79,9 +87,139 @@ Config Logger::mergeWithDefault(const Config& user_config) {
 
   .coalesce_size = user_config.coalesce_size == 0
     ? default_config_.coalesce_size
-    : user_config.coalesce_size
+    : user_config.coalesce_size,
+
+  .deferred_formatting = user_config.deferred_formatting,
+
+  .min_severity = user_config.min_severity.has_value()
+    ? user_config.min_severity
+    : default_config_.min_severity,
+
+  .register_buffers = user_config.register_buffers,
+
+  .ring_mode = user_config.ring_mode,
+
+  .sqpoll_idle_ms = user_config.sqpoll_idle_ms,
+
+  .sqpoll_cpu = user_config.sqpoll_cpu,
+
+  .durability = user_config.durability,
+
+  .fsync_interval_ms = user_config.fsync_interval_ms == 0
+    ? default_config_.fsync_interval_ms
+    : user_config.fsync_interval_ms,
+
+  .fsync_interval_bytes = user_config.fsync_interval_bytes,
+
+  .direct_io = user_config.direct_io,
+
+  .compression = user_config.compression,
+
+  .compression_level = user_config.compression_level,
+
+  .backend = user_config.backend,
+
+  .mmap_chunk_size = user_config.mmap_chunk_size == 0
+    ? default_config_.mmap_chunk_size
+    : user_config.mmap_chunk_size,
+
+  .encoding = user_config.encoding,
+
+  .sinks = user_config.sinks,
+
+  .log_file_severities = user_config.log_file_severities == 0
+    ? default_config_.log_file_severities
+    : user_config.log_file_severities,
+
+  .buffer_arena = user_config.buffer_arena,
+
+  .lock_buffer_arena = user_config.lock_buffer_arena,
+
+  .staging_buffer_size = user_config.staging_buffer_size == 0
+    ? default_config_.staging_buffer_size
+    : user_config.staging_buffer_size,
+
+  .idle_spin_us = user_config.idle_spin_us,
+
+  .max_queued_messages = user_config.max_queued_messages,
+
+  .overflow_policy = user_config.overflow_policy,
+
+  .overflow_timeout_ms = user_config.overflow_timeout_ms == 0
+    ? default_config_.overflow_timeout_ms
+    : user_config.overflow_timeout_ms,
+
+  .worker_count = user_config.worker_count == 0
+    ? default_config_.worker_count
+    : user_config.worker_count,
+
+  .shard_output = user_config.shard_output,
+
+  .shard_queue_factory = user_config.shard_queue_factory,
+
+  .worker_cpus = user_config.worker_cpus,
+
+  .numa_node = user_config.numa_node,
+
+  .worker_scheduling = user_config.worker_scheduling,
+
+  .layout = user_config.layout,
+
+  .suppression_report_ms = user_config.suppression_report_ms == 0
+    ? default_config_.suppression_report_ms
+    : user_config.suppression_report_ms,
+
+  .crash_ring_file = user_config.crash_ring_file,
+
+  .crash_ring_size = user_config.crash_ring_size == 0
+    ? default_config_.crash_ring_size
+    : user_config.crash_ring_size,
+
+  .autotune = user_config.autotune,
+
+  .autotune_max_delay_us = user_config.autotune_max_delay_us == 0
+    ? default_config_.autotune_max_delay_us
+    : user_config.autotune_max_delay_us,
+
+  .autotune_min_batch_size = user_config.autotune_min_batch_size == 0
+    ? default_config_.autotune_min_batch_size
+    : user_config.autotune_min_batch_size,
+
+  .autotune_min_coalesce_size = user_config.autotune_min_coalesce_size == 0
+    ? default_config_.autotune_min_coalesce_size
+    : user_config.autotune_min_coalesce_size,
+
+  .network_sinks = user_config.network_sinks,
+
+  .index_interval_bytes = user_config.index_interval_bytes,
+
+  .buffer_pool_initial_size = user_config.buffer_pool_initial_size == 0
+    ? default_config_.buffer_pool_initial_size
+    : user_config.buffer_pool_initial_size,
+
+  .buffer_pool_trim_ms = user_config.buffer_pool_trim_ms == 0
+    ? default_config_.buffer_pool_trim_ms
+    : user_config.buffer_pool_trim_ms,
+
+  .clock = user_config.clock
   };
 
+  // Shards sharing a file would rename it under each other
+  if (merged.worker_count > 1 && merged.shard_output == ShardOutput::SHARED_FILE) {
+    merged.max_log_size_bytes = SIZE_MAX;
+    for (auto& sink : merged.sinks) sink.max_log_size_bytes = SIZE_MAX;
+  }
+
+  for (auto& sink : merged.sinks) {
+    if (sink.severities == 0) sink.severities = ALL_SEVERITIES;
+    if (sink.max_log_size_bytes == 0) sink.max_log_size_bytes = merged.max_log_size_bytes;
+  }
+
+  for (auto& network : merged.network_sinks) {
+    if (network.max_pending_bytes == 0) network.max_pending_bytes = 4 * 1024 * 1024;
+    if (network.timeout_ms == 0) network.timeout_ms = 2000;
+  }
+
   bool user_specified_batch_size = user_config.batch_size != 0;
   bool user_specified_queue_depth = user_config.queue_depth != 0;
   bool user_specified_coalesce_size = user_config.coalesce_size != 0;
@@ -103,14 +241,46 @@ Logger::Logger(const Config& config) :
       static_cast<uint16_t>(config_.batch_size * std::sqrt(static_cast<double>(config_.queue_depth) / config_.batch_size))
     )
   )),
-  file_{config_.log_file_name},
-  ring_{config_.queue_depth},
+  min_severity_{config_.min_severity.value_or(SEVERITY_LEVEL::INFO)},
+  clock_{config_.clock},
+  ring_{createRing()},
+  buffer_pool_{BufferPool::Config{
+    .small_buffer_size = config_.small_buffer_size,
+    .medium_buffer_size = config_.medium_buffer_size,
+    .large_buffer_size = config_.large_buffer_size,
+    .small_pool_size = config_.small_buffer_pool_size,
+    .medium_pool_size = config_.medium_buffer_pool_size,
+    .large_pool_size = config_.large_buffer_pool_size,
+    .initial_buffers = config_.buffer_pool_initial_size,
+    .alignment = config_.direct_io ? IO::DIRECT_IO_BLOCK_SIZE : 0,
+    .arena = config_.buffer_arena || numaNode() >= 0,
+    .lock_arena = config_.lock_buffer_arena,
+    .numa_node = numaNode()
+  }},
+  sinks_{createSinks()},
   queue_{config_._queue},
-  file_rotater_{config_.log_file_name, config_.max_log_size_bytes},
+  compression_{resolveCompression()},
+  compressor_{compression_ == CompressionMode::ROTATED
+    ? std::make_unique<IO::BackgroundCompressor>(config_.compression_level,
+        [this](const char* loc, const std::string& msg) { reportError(loc, msg); })
+    : nullptr},
+  frame_compressor_{compression_ == CompressionMode::INLINE
+    ? std::make_unique<IO::FrameCompressor>(config_.compression_level)
+    : nullptr},
+  network_sinks_{createNetworkSinks()},
+  fixed_buffers_registered_{ring_ && config_.register_buffers && registerFixedBuffers()},
+  fixed_file_registered_{ring_ && registerFixedFiles()},
+  crash_ring_{createCrashRing()},
+  tuner_{createTuner()},
   worker_{
   [this](std::stop_token st){
+      placeWorker();
       try {
-        eventLoop(st);
+        if (ring_) {
+          eventLoop(st);
+        } else {
+          mappedEventLoop(st);
+        }
       } catch (const std::exception& e) {
         std::cerr << "[MrLogger] Exception caught from main eventLoop. Shutting down logger. Exception = " << e.what() << "\n";
       } catch (...) {
@@ -118,214 +288,1927 @@ Logger::Logger(const Config& config) :
       }
 
       queue_->shutdown();
+      closeAdmission();
+
+      // Nothing is written anymore, no flush may keep waiting for it
+      publishFlushed(UINT64_MAX);
+    }
+  } {
+
+    if (std::any_of(config_.worker_cpus.begin(), config_.worker_cpus.end(), [](int cpu) { return cpu < 0; })) {
+      throw std::invalid_argument{"worker_cpus cannot contain negative CPU numbers"};
+    }
+    if (!config_.worker_cpus.empty() && config_.worker_cpus.size() < config_.worker_count) {
+      throw std::invalid_argument{"worker_cpus needs at least one CPU per worker (worker_count)"};
+    }
+    // Every shard's SQ thread would poll on the same core
+    if (config_.sqpoll_cpu >= 0 && config_.worker_count > 1 && config_.ring_mode == IO::RingMode::SQPOLL) {
+      throw std::invalid_argument{"sqpoll_cpu cannot be combined with worker_count > 1, the SQ threads follow worker_cpus"};
+    }
+
+    // Validation: batch_size must not exceed queue_depth
+    if (config_.batch_size > config_.queue_depth) {
+      throw std::invalid_argument{"batch_size cannot exceed queue_depth"};
+    }
+
+    // Warn about suboptimal configurationsq
+    if (config_.batch_size > config_.queue_depth / 2) {
+      reportError("constructor",
+        "Warning: batch_size (" + std::to_string(config_.batch_size) +
+        ") is more than half of queue_depth (" + std::to_string(config_.queue_depth) +
+        "). This may result in inefficient CQE processing. Consider reducing batch_size or increasing queue_depth.");
+    }
+
+    // Validate queue_depth relative to batch_size
+    if (config_.queue_depth < config_.batch_size * 8) {
+      reportError("constructor",
+        "Warning: queue_depth (" + std::to_string(config_.queue_depth) +
+        ") is less than 8x batch_size (" + std::to_string(config_.batch_size * 8) +
+        "). This may limit I/O pipeline depth. Consider increasing queue_depth to at least " +
+        std::to_string(config_.batch_size * 16) + " for optimal performance.");
+    }
+
+    // Validate coalesce_size relative to batch_size
+    double coalesce_ratio = static_cast<double>(config_.coalesce_size) / config_.batch_size;
+    if (config_.coalesce_size > 0 && (coalesce_ratio < 0.5 || coalesce_ratio > 2.0)) {
+      reportError("constructor",
+        "Warning: coalesce_size (" + std::to_string(config_.coalesce_size) +
+        ") differs significantly from batch_size (" + std::to_string(config_.batch_size) +
+        "). Optimal ratio is close to 1:1. Current ratio: " + std::to_string(coalesce_ratio));
+    }
+
+    if (!ring_ && config_.direct_io) {
+      reportError("constructor",
+        "Warning: direct_io is not supported by the mmap backend. Writing through the page cache.");
+    }
+
+    if (!ring_ && !config_.crash_ring_file.empty()) {
+      reportError("constructor",
+        "Warning: crash_ring_file is not used by the mmap backend, its log files are shared mappings already.");
+    }
+
+    if (!ring_ && config_.index_interval_bytes > 0) {
+      reportError("constructor",
+        "Warning: index_interval_bytes is not supported by the mmap backend, no timestamp index is written.");
+    }
+
+    if (!ring_ && config_.autotune) {
+      reportError("constructor",
+        "Warning: autotune is not supported by the mmap backend, every message is copied into the mapping right away.");
+    }
+
+    if (config_.clock == ClockSource::TSC && clock_.source() != ClockSource::TSC) {
+      reportError("constructor",
+        "Warning: clock TSC needs an invariant time stamp counter. Falling back to the system clock.");
+    }
+
+    if (config_.buffer_arena && !buffer_pool_.arena()) {
+      reportError("constructor",
+        "Warning: " + buffer_pool_.arenaError() + ". Falling back to individually allocated buffers.");
+    }
+
+    if (const auto* arena = buffer_pool_.arena(); arena && arena->numaError() < 0) {
+      reportError("constructor",
+        "Warning: failed to bind the buffer arena to NUMA node " + std::to_string(numaNode()) +
+        " (error code: " + std::to_string(arena->numaError()) + "). Its pages are placed by first touch.");
+    }
+
+    if (const auto* arena = buffer_pool_.arena(); arena && arena->lockError() < 0) {
+      reportError("constructor",
+        "Warning: failed to mlock the " + std::to_string(arena->size()) + " byte buffer arena (error code: " +
+        std::to_string(arena->lockError()) + "). It may be paged out under memory pressure.");
+    }
+
+    if (ring_ && (config_.coalesce_size > 1 || config_.direct_io) && config_.staging_buffer_size > config_.large_buffer_size) {
+      reportError("constructor",
+        "Warning: staging_buffer_size (" + std::to_string(config_.staging_buffer_size) +
+        ") exceeds large_buffer_size (" + std::to_string(config_.large_buffer_size) +
+        "). Every coalesced write allocates its buffer instead of taking one from the pool.");
+    }
+
+    if (ring_ && ring_->mode() != config_.ring_mode) {
+      reportError("constructor",
+        "Warning: requested io_uring setup mode was rejected by the kernel (error code: " +
+        std::to_string(ring_->setupError()) + "). Falling back to the default ring setup.");
+    }
+
+    // Ensure calculated max_logs_per_iteration allows at least 2 batches
+    if (max_logs_per_iteration_ < config_.batch_size * 2) {
+      reportError("constructor",
+        "Warning: Calculated max_logs_per_iteration (" + std::to_string(max_logs_per_iteration_) +
+        ") is less than 2x batch_size (" + std::to_string(config_.batch_size * 2) +
+        "). This may cause excessive syscall overhead. Consider adjusting queue_depth.");
+    }
+
+    shards_ = createShards();
+  }
+
+  std::vector<std::unique_ptr<Logger>> Logger::createShards() {
+    std::vector<std::unique_ptr<Logger>> shards;
+    if (config_.worker_count <= 1) return shards;
+
+    bool shared = config_.shard_output == ShardOutput::SHARED_FILE;
+    if (shared) {
+      // Offsets of O_DIRECT writes, the per file dictionary and the mapping are all owned by one worker
+      if (config_.direct_io) {
+        throw std::invalid_argument{"shard_output SHARED_FILE cannot be combined with direct_io"};
+      }
+      if (config_.encoding == LogEncoding::BINARY) {
+        throw std::invalid_argument{"shard_output SHARED_FILE cannot be combined with BINARY encoding"};
+      }
+      if (!ring_) {
+        throw std::invalid_argument{"shard_output SHARED_FILE is not supported by the mmap backend"};
+      }
+      if (config_.index_interval_bytes > 0) {
+        throw std::invalid_argument{"shard_output SHARED_FILE cannot be combined with index_interval_bytes"};
+      }
+    }
+
+    auto indexedName = [](const std::string& file_name, size_t index) {
+      std::filesystem::path path(file_name);
+      return (path.parent_path() / (path.stem().string() + "." + std::to_string(index) + path.extension().string())).string();
+    };
+    auto shardName = [&](const std::string& file_name, size_t index) {
+      return shared ? file_name : indexedName(file_name, index);
+    };
+
+    shards.reserve(config_.worker_count - 1);
+    for (size_t index = 1; index < config_.worker_count; ++index) {
+      Config shard_config = config_;
+      shard_config.worker_count = 1;
+      shard_config.worker_cpus = workerCpus(index);
+      shard_config._queue = config_.shard_queue_factory
+        ? config_.shard_queue_factory()
+        : std::make_shared<Queue::StdQueue<WriteRequest>>();
+      shard_config.log_file_name = shardName(config_.log_file_name, index);
+      for (auto& sink : shard_config.sinks) {
+        sink.file_name = shardName(sink.file_name, index);
+      }
+      for (auto& network : shard_config.network_sinks) {
+        if (!network.source_file.empty()) network.source_file = shardName(network.source_file, index);
+      }
+      if (!shard_config.crash_ring_file.empty()) {
+        shard_config.crash_ring_file = indexedName(config_.crash_ring_file, index);
+      }
+
+      shards.push_back(std::unique_ptr<Logger>(new Logger(shard_config)));
+    }
+    return shards;
+  }
+
+  std::unique_ptr<IO::IOUring> Logger::createRing() const {
+    if (config_.backend == IO::Backend::MMAP) return nullptr;
+
+    try {
+      return std::make_unique<IO::IOUring>(config_.queue_depth, config_.ring_mode, config_.sqpoll_idle_ms, sqpollCpu());
+    } catch (const std::exception& e) {
+      if (config_.backend == IO::Backend::IO_URING) throw;
+
+      reportError("constructor", std::string("Warning: ") + e.what() + ". Falling back to the mmap backend.");
+      return nullptr;
+    }
+  }
+
+  // Shard `shard` runs on the shard-th of worker_count contiguous, near equal slices of
+  // worker_cpus. A shard's own config holds just its slice and worker_count = 1
+  std::vector<int> Logger::workerCpus(size_t shard) const {
+    const auto& cpus = config_.worker_cpus;
+    size_t count = std::max<size_t>(config_.worker_count, 1);
+    return {cpus.begin() + static_cast<ptrdiff_t>(shard * cpus.size() / count),
+            cpus.begin() + static_cast<ptrdiff_t>((shard + 1) * cpus.size() / count)};
+  }
+
+  // An unpinned SQ thread follows the worker's CPU set
+  int Logger::sqpollCpu() const {
+    if (config_.sqpoll_cpu >= 0) return config_.sqpoll_cpu;
+    auto cpus = workerCpus();
+    return cpus.empty() ? -1 : cpus.back();
+  }
+
+  int Logger::numaNode() const {
+    if (config_.numa_node >= 0) return config_.numa_node;
+    auto cpus = workerCpus();
+    if (cpus.empty() || Thread::numaNodeCount() < 2) return -1;
+    return Thread::numaNodeOf(cpus.front());
+  }
+
+  Logger::WorkerPlacement Logger::_workerPlacement(size_t shard) const {
+    if (shard > 0) return shards_.at(shard - 1)->_workerPlacement(0);
+    return {.cpus = workerCpus(), .sqpoll_cpu = sqpollCpu(), .numa_node = numaNode()};
+  }
+
+  // Runs first on the worker thread, before it allocates its per sink state
+  void Logger::placeWorker() const noexcept {
+    if (int status = Thread::pinCurrentThread(workerCpus()); status < 0) {
+      reportError("worker",
+        "Warning: failed to pin the worker thread to worker_cpus (error code: " + std::to_string(status) + ").");
+    }
+    if (int status = Thread::setCurrentScheduling(config_.worker_scheduling); status < 0) {
+      reportError("worker",
+        "Warning: failed to set the scheduling policy of the worker thread (error code: " + std::to_string(status) + ").");
+    }
+  }
+
+  IO::FileMode Logger::fileMode() const {
+    if (!ring_) return IO::FileMode::MAPPED;
+    return config_.direct_io ? IO::FileMode::DIRECT : IO::FileMode::APPEND;
+  }
+
+  bool Logger::registerFixedBuffers() {
+    auto iovecs = buffer_pool_.prepareFixedBuffers();
+
+    int status = ring_->registerBuffers(iovecs);
+    if (status < 0) {
+      buffer_pool_.clearFixedBuffers();
+      reportError("constructor",
+        "Warning: failed to register " + std::to_string(iovecs.size()) +
+        " fixed buffers with io_uring (error code: " + std::to_string(status) +
+        "). Falling back to regular writes.");
+      return false;
+    }
+
+    return true;
+  }
+
+  std::vector<Logger::Sink> Logger::createSinks() const {
+    std::vector<SinkConfig> configs;
+    configs.push_back(SinkConfig{
+      .file_name = config_.log_file_name,
+      .severities = config_.log_file_severities,
+      .max_log_size_bytes = config_.max_log_size_bytes
+    });
+    configs.insert(configs.end(), config_.sinks.begin(), config_.sinks.end());
+
+    // Two sinks on one path would interleave partial writes and rotate each other's files
+    std::vector<std::filesystem::path> paths;
+    SeverityMask routed = 0;
+    for (const auto& sink : configs) {
+      if (sink.file_name.empty()) {
+        throw std::invalid_argument{"sink file_name cannot be empty"};
+      }
+      auto path = std::filesystem::absolute(sink.file_name).lexically_normal();
+      if (std::find(paths.begin(), paths.end(), path) != paths.end()) {
+        throw std::invalid_argument{"log file " + sink.file_name + " is used by more than one sink"};
+      }
+      paths.push_back(std::move(path));
+      routed |= sink.severities;
+    }
+
+    for (size_t i = 0; i < SEVERITY_NAMES.size(); ++i) {
+      auto level = static_cast<SEVERITY_LEVEL>(i);
+      if (!(routed & severityBit(level))) {
+        reportError("constructor",
+          "Warning: no log file receives " + sevLvlToStr(level) + " messages, they are discarded.");
+      }
+    }
+
+    // Index offsets are where the worker queued plain text buffers
+    bool indexed = config_.index_interval_bytes > 0 && ring_;
+    if (indexed) {
+      if (config_.direct_io) {
+        throw std::invalid_argument{"index_interval_bytes cannot be combined with direct_io"};
+      }
+      if (config_.encoding == LogEncoding::BINARY) {
+        throw std::invalid_argument{"index_interval_bytes cannot be combined with BINARY encoding"};
+      }
+      if (config_.compression != CompressionMode::NONE) {
+        throw std::invalid_argument{"index_interval_bytes cannot be combined with compression"};
+      }
+    }
+
+    IO::FileMode mode = fileMode();
+    std::vector<Sink> sinks;
+    sinks.reserve(configs.size());
+    for (const auto& sink : configs) {
+      sinks.emplace_back(sink, mode, static_cast<unsigned>(sinks.size()));
+      if (indexed) {
+        sinks.back().index.emplace(IO::indexPath(sink.file_name));
+        sinks.back().indexer.emplace(config_.index_interval_bytes);
+      }
+    }
+    return sinks;
+  }
+
+  // Config::network_sinks, each attached to the log file it mirrors. Resolves the hosts,
+  // so a name that does not resolve fails the constructor instead of every reconnect
+  std::vector<Logger::NetworkSink> Logger::createNetworkSinks() {
+    std::vector<NetworkSink> network_sinks;
+    if (config_.network_sinks.empty()) return network_sinks;
+
+    if (!ring_) {
+      reportError("constructor",
+        "Warning: network_sinks are not supported by the mmap backend, nothing is sent.");
+      return network_sinks;
+    }
+    // The buffers are sent as the file gets them: plain lines, each written once
+    if (config_.encoding == LogEncoding::BINARY) {
+      throw std::invalid_argument{"network_sinks cannot be combined with BINARY encoding"};
+    }
+    if (config_.direct_io) {
+      throw std::invalid_argument{"network_sinks cannot be combined with direct_io"};
+    }
+    if (compression_ == CompressionMode::INLINE) {
+      throw std::invalid_argument{"network_sinks cannot be combined with INLINE compression"};
+    }
+
+    network_sinks.reserve(config_.network_sinks.size());
+    for (const auto& network : config_.network_sinks) {
+      const std::string& source = network.source_file.empty() ? config_.log_file_name : network.source_file;
+      auto sink = std::find_if(sinks_.begin(), sinks_.end(), [&](const Sink& s) { return s.file.path() == source; });
+      if (sink == sinks_.end()) {
+        throw std::invalid_argument{"network sink source_file " + source + " is not one of the log files"};
+      }
+      if (network.port == 0) {
+        throw std::invalid_argument{"network sink " + network.host + " needs a port"};
+      }
+      if (network.syslog_facility > 23 || network.syslog_severity > 7) {
+        throw std::invalid_argument{"network sink " + network.host + " has an invalid syslog facility or severity"};
+      }
+      network_sinks.emplace_back(network, static_cast<size_t>(sink - sinks_.begin()));
+    }
+    return network_sinks;
+  }
+
+  IO::WritePreparer Logger::createPreparer(const Sink& sink) {
+    if (!ring_) {
+      // Only formats, messages are written one by one straight into the mapping
+      return IO::WritePreparer(
+          IO::WritePreparer::Config{.coalesce_size = 1, .binary = config_.encoding == LogEncoding::BINARY, .layout = config_.layout},
+          buffer_pool_,
+          [this](const char* loc, const std::string& msg) { reportError(loc, msg); }
+      );
+    }
+
+    return IO::WritePreparer(
+        IO::WritePreparer::Config{
+            .coalesce_size = config_.coalesce_size,
+            .staging_buffer_size = sink.file.direct()
+              ? (config_.staging_buffer_size + IO::DIRECT_IO_BLOCK_SIZE - 1) / IO::DIRECT_IO_BLOCK_SIZE * IO::DIRECT_IO_BLOCK_SIZE
+              : config_.staging_buffer_size,
+            .sync_errors = config_.durability == DurabilityMode::ERRORS,
+            .block_size = sink.file.direct() ? IO::DIRECT_IO_BLOCK_SIZE : 0,
+            .binary = config_.encoding == LogEncoding::BINARY,
+            .layout = config_.layout
+        },
+        buffer_pool_,
+        [this](const char* loc, const std::string& msg) { reportError(loc, msg); }
+    );
+  }
+
+  bool Logger::registerFixedFiles() {
+    std::vector<int> fds;
+    for (const auto& sink : sinks_) {
+      fds.push_back(sink.file.fd());
+    }
+
+    int status = ring_->registerFiles(fds);
+    if (status < 0) {
+      reportError("constructor",
+        "Warning: failed to register the log files with io_uring (error code: " +
+        std::to_string(status) + "). Falling back to regular file descriptors.");
+      return false;
+    }
+
+    return true;
+  }
+
+  CompressionMode Logger::resolveCompression() const {
+    if (config_.compression == CompressionMode::NONE) return CompressionMode::NONE;
+
+    if (!IO::compressionAvailable()) {
+      reportError("constructor",
+        "Warning: compression requested but MR::Logger was built without zstd. Log files are not compressed.");
+      return CompressionMode::NONE;
+    }
+
+    if (config_.compression == CompressionMode::INLINE && (config_.direct_io || !ring_)) {
+      reportError("constructor",
+        "Warning: inline compression is not supported with direct_io or the mmap backend. Log files are not compressed.");
+      return CompressionMode::NONE;
+    }
+
+    return config_.compression;
+  }
+
+  // Config::autotune bounds: the configured batch_size and coalesce_size are the largest
+  std::optional<BatchTuner> Logger::createTuner() const {
+    if (!config_.autotune || !ring_) return std::nullopt;
+
+    if (config_.autotune_min_batch_size > config_.batch_size) {
+      throw std::invalid_argument{"autotune_min_batch_size cannot exceed batch_size"};
+    }
+    if (config_.autotune_min_coalesce_size > std::max<uint16_t>(config_.coalesce_size, 1)) {
+      throw std::invalid_argument{"autotune_min_coalesce_size cannot exceed coalesce_size"};
+    }
+
+    return BatchTuner(BatchTuner::Bounds{
+      .min_batch_size = config_.autotune_min_batch_size,
+      .max_batch_size = config_.batch_size,
+      .min_coalesce_size = config_.autotune_min_coalesce_size,
+      .max_coalesce_size = std::max<uint16_t>(config_.coalesce_size, 1),
+      .max_delay = std::chrono::microseconds(config_.autotune_max_delay_us)
+    });
+  }
+
+  // Opens Config::crash_ring_file and appends the records the previous process left
+  // unwritten to their files, before the worker writes anything
+  std::unique_ptr<IO::CrashRing> Logger::createCrashRing() {
+    if (config_.crash_ring_file.empty() || !ring_) return nullptr;
+
+    if (config_.direct_io) {
+      throw std::invalid_argument{"crash_ring_file cannot be combined with direct_io"};
+    }
+    if (config_.encoding == LogEncoding::BINARY) {
+      throw std::invalid_argument{"crash_ring_file cannot be combined with BINARY encoding"};
+    }
+    if (compression_ == CompressionMode::INLINE) {
+      throw std::invalid_argument{"crash_ring_file cannot be combined with INLINE compression"};
+    }
+
+    auto crash_ring = std::make_unique<IO::CrashRing>(config_.crash_ring_file, config_.crash_ring_size);
+
+    size_t replayed = 0;
+    for (const auto& record : crash_ring->recovered()) {
+      if (record.sink >= sinks_.size()) continue;  // The previous run had more sinks
+
+      Sink& sink = sinks_[record.sink];
+      size_t done = 0;
+      while (done < record.data.size()) {
+        ssize_t n = ::write(sink.file.fd(), record.data.data() + done, record.data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+          reportError("constructor", "Failed to replay the crash ring into " + sink.file.path() + ": " + std::strerror(errno));
+          break;
+        }
+        done += static_cast<size_t>(n);
+      }
+      sink.rotater.updateCurrentSize(done);
+      replayed += done;
+    }
+
+    if (replayed > 0) {
+      reportError("constructor",
+        "Warning: appended " + std::to_string(replayed) + " bytes from " + config_.crash_ring_file +
+        " the previous process handed to io_uring but never saw written.");
+    }
+    crash_ring->recovered().clear();
+    crash_ring->recovered().shrink_to_fit();
+    return crash_ring;
+  }
+
+  IO::CompressionBacklog Logger::compressionBacklog() const noexcept {
+    IO::CompressionBacklog backlog = compressor_ ? compressor_->backlog() : IO::CompressionBacklog{};
+    for (const auto& shard : shards_) {
+      auto shard_backlog = shard->compressionBacklog();
+      backlog.files += shard_backlog.files;
+      backlog.bytes += shard_backlog.bytes;
+    }
+    return backlog;
+  }
+
+  std::unique_ptr<Memory::Buffer> Logger::compressBuffer(std::unique_ptr<Memory::Buffer> buffer) {
+    auto frame = buffer_pool_.acquire(IO::FrameCompressor::bound(buffer->size));
+
+    size_t size = frame_compressor_->compress(buffer->data, buffer->size, frame->data, frame->capacity);
+    if (size == 0) {
+      buffer_pool_.release(std::move(frame));
+      reportError("compressBuffer", "zstd compression failed, writing the buffer uncompressed");
+      return buffer;
+    }
+
+    frame->size = size;
+    frame->sync = buffer->sync;
+    buffer_pool_.release(std::move(buffer));
+    return frame;
+  }
+
+  void Logger::eventLoop(std::stop_token st) {
+
+    // Required to hold the state of the coroutines while they
+    // are suspended and not finished. Their frames come from a pool
+    // of queue_depth frames, finished tasks unlink themselves
+    Coroutine::TaskList active_tasks(config_.queue_depth);
+
+    size_t pending_writes = 0;
+
+    // Every sink formats and coalesces into its own WritePreparer, their writes share the ring
+    for (auto& sink : sinks_) {
+      sink.preparer.emplace(createPreparer(sink));
+      sink.last_sync = std::chrono::steady_clock::now();
+
+      if (sink.file.direct()) {
+        startDirectFile(sink);
+      }
+      startIndex(sink);
+    }
+
+    auto has_unwritten = [this]() {
+      return std::any_of(sinks_.begin(), sinks_.end(), [](const Sink& sink) { return sink.preparer->hasUnwritten(); });
+    };
+
+    // Reused every iteration as the target of tryPopBatch
+    std::vector<WriteRequest> batch(max_logs_per_iteration_);
+
+    // Every sink accepting the severity gets the request, the last one takes the request itself
+    auto route = [&](WriteRequest&& request) {
+      try {
+        Sink* target = nullptr;
+        for (auto& sink : sinks_) {
+          if (!sink.accepts(request.level)) continue;
+          if (target) {
+            prepareForSink(*target, WriteRequest{request}, active_tasks, pending_writes);
+          }
+          target = &sink;
+        }
+        if (target) {
+          prepareForSink(*target, std::move(request), active_tasks, pending_writes);
+        }
+
+      } catch (const std::exception& e) {
+        reportError("eventLoop:processing", e.what());
+      } catch (...) {
+        reportError("eventLoop:processing", "Unknown exception");
+      }
+    };
+
+    // A SINGLE_ISSUER ring is created disabled and bound to the thread enabling it
+    if (int status = ring_->enable(); status < 0) {
+      reportError("eventLoop", "Failed to enable io_uring (error code: " + std::to_string(status) + ")");
+      ring_->markFailed();
+    }
+
+    // Completions then wake the idle worker through the same eventfd as producers
+    if (ring_->isOperational()) {
+      if (int status = ring_->registerEventFd(wakeup_.fd()); status < 0) {
+        reportError("eventLoop", "Failed to register the wakeup eventfd, the idle worker polls instead (error code: " +
+                    std::to_string(status) + ")");
+      } else {
+        ring_signals_wakeup_ = true;
+      }
+    }
+
+    // Connected network sinks still send what is pending while stopping
+    auto network_unsent = [this]() {
+      return std::any_of(network_sinks_.begin(), network_sinks_.end(),
+                         [](const NetworkSink& network) { return network.fd >= 0 && !network.pending.empty(); });
+    };
+
+    while(!st.stop_requested() || !queue_->empty() || !active_tasks.empty() || has_unwritten() || staging_held_ ||
+          network_unsent()) {
+
+      if (!ring_->isOperational()) {
+        reportError("eventLoop", "io_uring marked as failed. Draining queue and shutting down.");
+
+        // Drain remaining queue items without processing
+        size_t dropped = 0;
+        while (size_t n = queue_->tryPopBatch(std::span<WriteRequest>(batch))) {
+          dropped += n;
+        }
+
+        if (dropped > 0) {
+          reportError("eventLoop", "Dropped " + std::to_string(dropped) + " log messages due to io_uring failure.");
+        }
+
+        break;
+      }
+
+      // Drain up to max_logs_per_iteration_ requests in a single call so the
+      // queue lock (or acquire) is paid once per iteration instead of per message.
+      // The bound prevents too many requests from stalling processCompletions below
+      size_t popped = queue_->tryPopBatch(std::span<WriteRequest>(batch));
+      size_t first = releaseQueued(std::span<WriteRequest>(batch.data(), popped));
+      clock_.toWallTime(std::span<WriteRequest>(batch.data() + first, popped - first));
+      counters_.messages_dequeued.add(popped);
+      counters_.messages_written.add(popped - first);
+      for (size_t i = 0; i < popped; ++i) flush_tracker_.popped(batch[i].ticket);
+      popAbandonedTickets();
+
+      if (tuner_) {
+        tuner_->record(popped, active_task_count_.load(std::memory_order_relaxed), config_.queue_depth,
+                       std::chrono::steady_clock::now());
+        for (auto& sink : sinks_) sink.preparer->setCoalesceSize(tuner_->coalesceSize());
+      }
+
+      for (size_t i = first; i < popped; ++i) {
+        // Don't process new requests if ring has failed
+        if (!ring_->isOperational()) {
+          reportError("eventLoop", "Skipping " + std::to_string(popped - i) +
+                      " requests because io_uring is not operational");
+          break;
+        }
+
+        route(std::move(batch[i]));
+      }
+
+      // Once the queue recovered from an overflow the loss is logged, after the
+      // messages that were queued before it
+      if (auto report = takeDropReport()) {
+        route(std::move(*report));
+      }
+      for (auto& report : takeSuppressionReports(st.stop_requested())) {
+        route(std::move(report));
+      }
+
+      // A flush waiting for messages that are staged still gets the partial tail block
+      // of direct I/O written too, it is written when the worker stops as well
+      bool flush_requested = flush_target_.load(std::memory_order_acquire) > flush_tracker_.flushed();
+      bool write_tail = flush_requested || (st.stop_requested() && queue_->empty());
+
+      // Autotuning lets a staging buffer wait for more messages while the oldest is within
+      // the hold budget, flushing and stopping write it right away
+      bool may_hold = tuner_ && !flush_requested && !st.stop_requested();
+      staging_held_ = false;
+      hold_deadline_ = std::chrono::steady_clock::time_point::max();
+
+      for (auto& sink : sinks_) {
+        // Flush any remaining data in the sink's staging buffer
+        // (direct I/O keeps its partial tail block unless flushing or shutting down)
+        try {
+          auto age = clock_.now() - sink.preparer->stagedSince();
+          if (may_hold && !sink.file.direct() && sink.preparer->hasStaged() &&
+              tuner_->hold(sink.preparer->stagedMessages(), age)) {
+            staging_held_ = true;
+            hold_deadline_ = std::min(hold_deadline_, std::chrono::steady_clock::now() +
+              std::chrono::duration_cast<std::chrono::steady_clock::duration>(tuner_->holdBudget() - age));
+          } else if (auto flushed = sink.preparer->flushStaged(write_tail && sink.file.direct()); flushed.has_value()) {
+            queueWrite(sink, std::move(flushed.value()), active_tasks);
+            pending_writes++;
+          }
+          submitGathered(sink, active_tasks);
+        } catch (const std::exception& e) {
+          reportError("eventLoop:flush_staging", e.what());
+        }
+
+        // Pre-open the file the next rotation switches to well before it is needed
+        // (not before the last rotation renamed the previous standby away)
+        if (!sink.standby && !sink.standby_opening && !sink.rotation_in_progress && sink.rotater.shouldPrepareStandby()) {
+          active_tasks.adopt(createStandbyTask(sink));
+          active_task_count_.fetch_add(1, std::memory_order_release);
+          pending_writes++;
+        }
+
+        // Periodic durability: sync whatever was written so far (forced while shutting down)
+        if (config_.durability == DurabilityMode::PERIODIC && periodicSyncDue(sink, st.stop_requested())) {
+          active_tasks.adopt(createSyncTask(sink));
+          active_task_count_.fetch_add(1, std::memory_order_release);
+          pending_writes++;
+        }
+      }
+
+      if (!network_sinks_.empty()) {
+        pumpNetwork(active_tasks, st.stop_requested());
+      }
+
+      // Submit any remaining requests (including the follow-up operations of resumed rotations)
+      if (pending_writes > 0 || ring_->hasUnsubmittedSQEs()) {
+        if (!ring_->submitPendingSQEs()) {
+          reportError("eventLoop:submit", "Failed to submit remaining writes.");
+        }
+        pending_writes = 0;
+      }
+
+      // Process CQEs
+      ring_->processCompletions();
+
+      // Clean up completed tasks and check for exceptions
+      reapCompletedTasks(active_tasks);
+
+      // Everything popped so far is staged or in tasks started by now
+      flush_tracker_.seal(has_unwritten() || staging_held_);
+      publishFlushed(flush_tracker_.flushed());
+
+      // Nothing queued: sleep until a write completes or the worker is woken
+      if (!st.stop_requested() && queue_->empty()) {
+        trimBufferPool();
+        idleWait(st, idleTimeout());
+      }
+    }
+
+    for (auto& sink : sinks_) {
+      removeStandbyFile(sink);
+    }
+    closeNetworkSinks();
+  }
+
+  void Logger::prepareForSink(Sink& sink, WriteRequest&& request,
+                              Coroutine::TaskList& active_tasks, size_t& pending_writes) {
+    // Rotate between messages, so a prepared buffer (and for direct I/O its
+    // offset) never straddles two files
+    if (sink.rotater.shouldRotate() && !sink.rotation_in_progress) {
+      rotateFile(sink, active_tasks);
+      pending_writes = 0;
+    }
+
+    // Prepare the write request (format and optionally coalesce)
+    auto prepared = sink.preparer->prepareWrite(std::move(request));
+
+    // If we got a buffer back, queue it for writing
+    if (prepared.buffer) {
+      queueWrite(sink, std::move(prepared.buffer), active_tasks);
+      pending_writes++;
+    }
+
+    // Submit batch if we've accumulated enough writes or preparer says so
+    uint16_t batch_size = tuner_ ? tuner_->batchSize() : config_.batch_size;
+    if (prepared.should_flush_batch || pending_writes >= batch_size) {
+      for (auto& other : sinks_) {
+        submitGathered(other, active_tasks);
+      }
+      if (!ring_->submitPendingSQEs()) {
+        reportError("eventLoop:submit", "Failed to submit batch. io_uring may be degraded.");
+      }
+      pending_writes = 0;
+    }
+  }
+
+  void Logger::mappedEventLoop(std::stop_token st) {
+    std::vector<WriteRequest> batch(max_logs_per_iteration_);
+
+    for (auto& sink : sinks_) {
+      sink.preparer.emplace(createPreparer(sink));
+      sink.mapped = std::make_unique<IO::MappedFile>(config_.mmap_chunk_size);
+      sink.mapped->open(sink.file);
+      sink.last_sync = std::chrono::steady_clock::now();
+    }
+
+    // writeMapped only reads the request, every sink formats the same one
+    auto write_to_sinks = [this](WriteRequest& request) {
+      for (auto& sink : sinks_) {
+        if (!sink.accepts(request.level)) continue;
+
+        try {
+          if (sink.rotater.shouldRotate()) {
+            rotateMappedFile(sink);
+          }
+
+          size_t written = writeMapped(sink, request);
+          sink.rotater.updateCurrentSize(written);
+          sink.unsynced_bytes += written;
+          counters_.bytes_written.add(written);
+        } catch (const std::exception& e) {
+          reportError("mappedEventLoop:processing", e.what());
+        } catch (...) {
+          reportError("mappedEventLoop:processing", "Unknown exception");
+        }
+      }
+    };
+
+    while (!st.stop_requested() || !queue_->empty()) {
+      size_t popped = queue_->tryPopBatch(std::span<WriteRequest>(batch));
+      size_t first = releaseQueued(std::span<WriteRequest>(batch.data(), popped));
+      clock_.toWallTime(std::span<WriteRequest>(batch.data() + first, popped - first));
+      bool error_written = false;
+      counters_.messages_dequeued.add(popped);
+      counters_.messages_written.add(popped - first);
+      for (size_t i = 0; i < popped; ++i) flush_tracker_.popped(batch[i].ticket);
+      popAbandonedTickets();
+
+      for (size_t i = first; i < popped; ++i) {
+        error_written = error_written || batch[i].level >= SEVERITY_LEVEL::ERROR;
+        write_to_sinks(batch[i]);
+      }
+
+      if (auto report = takeDropReport()) {
+        write_to_sinks(*report);
+      }
+      for (auto& report : takeSuppressionReports(st.stop_requested())) {
+        write_to_sinks(report);
+      }
+
+      // ERRORS durability syncs the files the errors were written to
+      bool sync_errors = config_.durability == DurabilityMode::ERRORS && error_written;
+      for (auto& sink : sinks_) {
+        bool sync = sync_errors && sink.accepts(SEVERITY_LEVEL::ERROR);
+        if (sync || (config_.durability == DurabilityMode::PERIODIC && periodicSyncDue(sink, st.stop_requested()))) {
+          if (int status = sink.mapped->sync(); status < 0) {
+            reportError("mappedEventLoop:sync", "msync failed with error code: " + std::to_string(status));
+          }
+          sink.unsynced_bytes = 0;
+          sink.last_sync = std::chrono::steady_clock::now();
+        }
+      }
+
+      // Written straight into the mappings, there is nothing in flight
+      flush_tracker_.seal(false);
+      bool flushing = flush_waiters_.load(std::memory_order_relaxed) > 0 &&
+        flush_tracker_.flushed() > flushed_.load(std::memory_order_relaxed);
+
+      // A flush() waits: give the preallocated space back so the caller reads the real file size.
+      // Not whenever the queue drains, the next message would fallocate the same window again.
+      // Progress is only published along with the trim, so no flush() returns before it
+      if (flushing) {
+        for (auto& sink : sinks_) {
+          if (int status = sink.mapped->trim(); status < 0) {
+            reportError("mappedEventLoop:trim", "Failed to trim " + sink.file.path() + " (error code: " + std::to_string(status) + ")");
+          }
+        }
+        publishFlushed(flush_tracker_.flushed());
+      }
+
+      if (queue_->empty()) {
+
+        if (popped == 0 && !st.stop_requested()) {
+          trimBufferPool();
+          idleWait(st, idleTimeout());
+        }
+      }
+    }
+
+    for (auto& sink : sinks_) {
+      sink.mapped->close();
+    }
+  }
+
+  size_t Logger::writeMapped(Sink& sink, WriteRequest& request) {
+    size_t capacity = request.data.size() + 256 + (request.deferred ? request.deferred.sizeHint() : 0);
+
+    // A second attempt with the exact size if the estimate was too small
+    for (int attempt = 0; attempt < 2; ++attempt) {
+      char* destination = sink.mapped->reserve(capacity);
+      if (!destination) {
+        throw std::runtime_error("Failed to grow the mapped log file " + sink.file.path() + ", message dropped");
+      }
+
+      size_t size = sink.preparer->formatInto(request, destination, capacity);
+      if (size < capacity) {
+        sink.mapped->commit(size);
+        return size;
+      }
+      capacity = size + 1;  // Room for the null terminator
+    }
+
+    return 0;
+  }
+
+  void Logger::rotateMappedFile(Sink& sink) {
+    sink.mapped->close();
+    std::string rotated_name = sink.rotater.rotate();
+    sink.file.reopen(sink.rotater.getCurrentFilename());
+    sink.mapped->open(sink.file);
+    sink.preparer->resetEncoding();
+    counters_.rotations.add();
+
+    if (compressor_ && !rotated_name.empty()) {
+      compressor_->enqueue(std::move(rotated_name));
+    }
+  }
+
+  void Logger::reapCompletedTasks(Coroutine::TaskList& active_tasks) {
+    // Only visits the tasks that finished since the last call
+    active_tasks.reap([this](const std::exception_ptr& exception) {
+      // Check if task completed with exception
+      if (exception) {
+        try {
+          std::rethrow_exception(exception);
+        } catch (const std::exception& e) {
+          reportError("coroutine", e.what());
+        } catch (...) {
+          reportError("coroutine", "Unknown exception in completed task");
+        }
+      }
+
+      active_task_count_.fetch_sub(1, std::memory_order_relaxed);
+    });
+  }
+
+  void Logger::rotateFile(Sink& sink, Coroutine::TaskList& active_tasks) {
+    if (!sink.standby) {
+      // Opened in the background, keep writing to the current file until it is ready
+      if (sink.standby_opening) return;
+
+      // The file grew past the limit before the standby was prepared (or preparing it failed)
+      try {
+        sink.standby.emplace(sink.rotater.getStandbyFilename(), sink.file.mode());
+      } catch (const std::exception& e) {
+        sink.rotater.reset();
+        reportError("rotateFile", std::string(e.what()) + ". Rotation postponed.");
+        return;
+      }
+    }
+
+    if (sink.indexer && !sink.standby_index) {
+      std::string index_path = IO::indexPath(sink.rotater.getStandbyFilename());
+      try {
+        sink.standby_index.emplace(index_path);
+      } catch (const std::exception& e) {
+        reportError("rotateFile", std::string(e.what()) + ". " + index_path + " is not written.");
+      }
+    }
+
+    // Gathered and staged messages (for direct I/O including the partial tail block) still
+    // belong to the current file, like their index entries. A binary file must not end up
+    // with records of the next one
+    auto tail = sink.preparer->flushStaged(true);
+    if (tail.has_value()) {
+      queueWrite(sink, std::move(tail.value()), active_tasks);
+    }
+    submitGathered(sink, active_tasks);
+
+    // Prepared SQEs target the current file (through the fixed-file slot, and for
+    // direct I/O at its offsets), hand them to the kernel before the slot switches
+    if (!ring_->submitPendingSQEs()) {
+      reportError("rotateFile", "Failed to submit writes before rotation.");
+    }
+
+    IO::WriteOnlyFile retired = std::move(sink.file);
+    sink.file = std::move(*sink.standby);
+    sink.standby.reset();
+    std::optional<IO::WriteOnlyFile> retired_index = std::move(sink.index);
+    sink.index = std::move(sink.standby_index);
+    sink.standby_index.reset();
+    sink.generation++;
+    counters_.rotations.add();
+
+    if (fixed_file_registered_) {
+      int status = ring_->updateRegisteredFile(sink.slot, sink.file.fd());
+      if (status < 0) {
+        reportError("rotateFile",
+          "Failed to update the registered log file " + sink.file.path() + " after rotation (error code: " +
+          std::to_string(status) + "). Falling back to its regular file descriptor.");
+      }
+    }
+
+    sink.preparer->resetEncoding();
+    if (sink.file.direct()) {
+      sink.preparer->discardStaged();
+      sink.direct_end = 0;
+      startDirectFile(sink);
+    }
+
+    startIndex(sink);
+
+    active_tasks.adopt(createRotateTask(sink, std::move(retired), std::move(retired_index), sink.rotater.beginRotation()));
+    active_task_count_.fetch_add(1, std::memory_order_release);
+  }
+
+  // retired is never read, it only keeps the old fd open until the coroutine ends
+  Coroutine::WriteTask Logger::createRotateTask(Sink& sink, [[maybe_unused]] IO::WriteOnlyFile retired,
+                                                std::optional<IO::WriteOnlyFile> retired_index,
+                                                std::string rotated_name) {
+    sink.rotation_in_progress = true;
+    uint64_t epoch = flush_tracker_.taskStarted();
+
+    try {
+      std::string current_name = sink.rotater.getCurrentFilename();
+      std::string standby_name = sink.rotater.getStandbyFilename();
+
+      // Drained: starts only once every write submitted so far (those of the other
+      // sinks included), so all writes to the retired file, completed. It is closed
+      // after this task finished
+      int status = co_await ring_->createRenameAwaiter(current_name, rotated_name, true);
+      if (status == -EAGAIN) {
+        // No room in the SQ, rename synchronously
+        std::error_code ec;
+        std::filesystem::rename(current_name, rotated_name, ec);
+        status = -ec.value();
+      }
+      if (status < 0 && status != -ENOENT) {
+        reportError("rotateFile", "Failed to rename " + current_name + " to " + rotated_name +
+          " (error code: " + std::to_string(status) + ")");
+      } else if (status == 0 && compressor_) {
+        // Complete: every write to it was drained before the rename
+        compressor_->enqueue(rotated_name);
+      }
+
+      // The index follows its file, its writes were drained by the same rename
+      if (status == 0 && retired_index) {
+        std::string rotated_index = IO::indexPath(rotated_name);
+        int index_status = co_await ring_->createRenameAwaiter(retired_index->path(), rotated_index);
+        if (index_status == -EAGAIN) {
+          std::error_code ec;
+          std::filesystem::rename(retired_index->path(), rotated_index, ec);
+          index_status = -ec.value();
+        }
+        if (index_status < 0) {
+          reportError("rotateFile", "Failed to rename " + retired_index->path() + " to " + rotated_index +
+            " (error code: " + std::to_string(index_status) + ")");
+        }
+      }
+
+      status = co_await ring_->createRenameAwaiter(standby_name, current_name);
+      if (status == -EAGAIN) {
+        std::error_code ec;
+        std::filesystem::rename(standby_name, current_name, ec);
+        status = -ec.value();
+      }
+      if (status < 0) {
+        reportError("rotateFile", "Failed to rename " + standby_name + " to " + current_name +
+          " (error code: " + std::to_string(status) + ")");
+      } else {
+        sink.file.setPath(current_name);
+      }
+
+      if (status == 0 && sink.index) {
+        std::string standby_index = sink.index->path();
+        std::string current_index = IO::indexPath(current_name);
+        int index_status = co_await ring_->createRenameAwaiter(standby_index, current_index);
+        if (index_status == -EAGAIN) {
+          std::error_code ec;
+          std::filesystem::rename(standby_index, current_index, ec);
+          index_status = -ec.value();
+        }
+        if (index_status < 0) {
+          reportError("rotateFile", "Failed to rename " + standby_index + " to " + current_index +
+            " (error code: " + std::to_string(index_status) + ")");
+        } else {
+          sink.index->setPath(current_index);
+        }
+      }
+    } catch (const std::exception& e) {
+      reportError("rotateFile", e.what());
+    } catch (...) {
+      reportError("rotateFile", "Unknown exception");
+    }
+
+    sink.rotation_in_progress = false;
+    flush_tracker_.taskDone(epoch);
+  }
+
+  Coroutine::WriteTask Logger::createStandbyTask(Sink& sink) {
+    sink.standby_opening = true;
+    uint64_t epoch = flush_tracker_.taskStarted();
+
+    try {
+      std::string path = sink.rotater.getStandbyFilename();
+      IO::FileMode mode = sink.file.mode();
+
+      // Not truncated: a standby left behind by a crash mid rotation may already hold log lines
+      int fd = co_await ring_->createOpenAwaiter(path, IO::WriteOnlyFile::openFlags(mode));
+      if (fd >= 0) {
+        sink.standby.emplace(std::move(path), fd, mode);
+      } else {
+        reportError("createStandbyTask", "Failed to pre-open " + path + " (error code: " +
+          std::to_string(fd) + "). The next rotation opens it synchronously.");
+      }
+
+      // Its index, opened synchronously by the next rotation if this fails
+      if (sink.standby && sink.indexer) {
+        std::string index_path = IO::indexPath(sink.standby->path());
+        int index_fd = co_await ring_->createOpenAwaiter(index_path, IO::WriteOnlyFile::openFlags(IO::FileMode::APPEND));
+        if (index_fd >= 0) {
+          sink.standby_index.emplace(std::move(index_path), index_fd, IO::FileMode::APPEND);
+        }
+      }
+    } catch (const std::exception& e) {
+      reportError("createStandbyTask", e.what());
+    } catch (...) {
+      reportError("createStandbyTask", "Unknown exception");
+    }
+
+    sink.standby_opening = false;
+    flush_tracker_.taskDone(epoch);
+  }
+
+  void Logger::removeStandbyFile(Sink& sink) {
+    if (sink.standby_index) {
+      try {
+        bool empty = sink.standby_index->size() == 0;
+        std::string path = sink.standby_index->path();
+        sink.standby_index.reset();
+
+        std::error_code ec;
+        if (empty) std::filesystem::remove(path, ec);
+      } catch (const std::exception& e) {
+        reportError("removeStandbyFile", e.what());
+      }
+    }
+
+    if (!sink.standby) return;
+
+    try {
+      // Don't leave an unused standby behind, unless it holds lines of an earlier run
+      bool empty = sink.standby->size() == 0;
+      std::string path = sink.standby->path();
+      sink.standby.reset();
+
+      std::error_code ec;
+      if (empty) std::filesystem::remove(path, ec);
+    } catch (const std::exception& e) {
+      reportError("removeStandbyFile", e.what());
+    }
+  }
+
+  void Logger::startDirectFile(Sink& sink) {
+    sink.drain_next_write = false;
+
+    try {
+      // Continue an existing file at its last block boundary, rewriting the partial block
+      auto partial = sink.file.readPartialBlock(IO::DIRECT_IO_BLOCK_SIZE);
+      sink.direct_end = sink.file.size();
+      sink.direct_offset = sink.direct_end - partial.size();
+      sink.preparer->preloadStaged(partial);
+    } catch (const std::exception& e) {
+      // Skip to the next block boundary, the gap reads back as zeros
+      sink.direct_offset = (sink.direct_end + IO::DIRECT_IO_BLOCK_SIZE - 1) / IO::DIRECT_IO_BLOCK_SIZE * IO::DIRECT_IO_BLOCK_SIZE;
+      sink.direct_end = sink.direct_offset;
+      reportError("startDirectFile", e.what());
+    }
+  }
+
+  Coroutine::WriteTask Logger::createWriteTask(Sink& sink, std::unique_ptr<Memory::Buffer> buffer) {
+    uint64_t epoch = flush_tracker_.taskStarted();
+    try {
+      if (frame_compressor_) {
+        buffer = compressBuffer(std::move(buffer));
+      }
+
+      // Submit write (and its linked fdatasync if requested) to io_uring and wait for completion
+      auto awaiter = ring_->createWriteAwaiter(sink.file, buffer->data, buffer->size, buffer->buf_index, buffer->sync);
+
+      size_t padding = buffer->padding;
+      auto enqueued_at = buffer->enqueued_at;
+      uint32_t generation = sink.generation;
+      int fd = sink.file.fd();
+      uint64_t end = 0;
+      if (sink.file.direct()) {
+        // Whole blocks advance the offset, a padded tail block is rewritten by the next write.
+        // Draining keeps that next write from racing with the tail write it overlaps
+        size_t data = buffer->size - padding;
+        awaiter.offset = sink.direct_offset;
+        awaiter.drain = sink.drain_next_write;
+        sink.drain_next_write = padding > 0;
+        sink.direct_end = sink.direct_offset + data;
+        end = sink.direct_end;
+        sink.direct_offset += data / IO::DIRECT_IO_BLOCK_SIZE * IO::DIRECT_IO_BLOCK_SIZE;
+      }
+
+      auto submitted = std::chrono::steady_clock::now();
+      int bytes_written = co_await awaiter;
+      if (tuner_) tuner_->recordCompletion(std::chrono::steady_clock::now() - submitted);
+
+      // Release buffer back to pool after write completes
+      if (crash_ring_) crash_ring_->complete(buffer->crash_record);
+      releaseBuffer(std::move(buffer));
+
+      // Handle write result
+      if (bytes_written < 0) {
+        reportError("createWriteTask", "io_uring write to " + sink.file.path() + " failed with error code: " + std::to_string(bytes_written));
+      } else {
+        if (padding > 0) {
+          // Cut the zero padding again. Later writes only ever extend up to direct_end.
+          // If the file was rotated meanwhile this was its last write, and the retired
+          // file stays open until the rename drained behind this write completed
+          if (generation == sink.generation) {
+            sink.file.truncate(sink.direct_end);
+          } else if (::ftruncate(fd, static_cast<off_t>(end)) < 0) {
+            throw std::runtime_error("Failed to truncate rotated log file");
+          }
+          bytes_written -= std::min<int>(bytes_written, static_cast<int>(padding));
+        }
+        recordWrite(bytes_written, 1, enqueued_at);
+
+        // Update file rotater with bytes written
+        sink.rotater.updateCurrentSize(bytes_written);
+        sink.unsynced_bytes += bytes_written;
+
+        if (awaiter.sync && awaiter.sync_result < 0) {
+          reportError("createWriteTask", "io_uring fdatasync failed with error code: " + std::to_string(awaiter.sync_result));
+        }
+      }
+    } catch (const std::exception& e) {
+      reportError("createWriteTask", e.what());
+    } catch (...) {
+      reportError("createWriteTask", "Unknown exception");
+    }
+    if (buffer) releaseBuffer(std::move(buffer));
+    flush_tracker_.taskDone(epoch);
+  }
+
+  Coroutine::WriteTask Logger::createVectoredWriteTask(Sink& sink, std::vector<std::unique_ptr<Memory::Buffer>> buffers) {
+    uint64_t epoch = flush_tracker_.taskStarted();
+    try {
+      // Lives in the coroutine frame, so it stays valid until the write completed
+      std::vector<iovec> iovecs;
+      iovecs.reserve(buffers.size());
+      bool sync = false;
+      auto enqueued_at = std::chrono::system_clock::time_point::max();
+      for (auto& buffer : buffers) {
+        // Before compression replaces the buffer
+        enqueued_at = std::min(enqueued_at, buffer->enqueued_at);
+        if (frame_compressor_) {
+          buffer = compressBuffer(std::move(buffer));
+        }
+        iovecs.push_back(iovec{buffer->data, buffer->size});
+        sync = sync || buffer->sync;
+      }
+
+      auto awaiter = ring_->createVectoredWriteAwaiter(sink.file, iovecs.data(), static_cast<unsigned>(iovecs.size()), sync);
+      auto submitted = std::chrono::steady_clock::now();
+      int bytes_written = co_await awaiter;
+      if (tuner_) tuner_->recordCompletion(std::chrono::steady_clock::now() - submitted);
+
+      for (auto& buffer : buffers) {
+        if (crash_ring_) crash_ring_->complete(buffer->crash_record);
+        releaseBuffer(std::move(buffer));
+      }
+
+      if (bytes_written < 0) {
+        reportError("createVectoredWriteTask", "io_uring writev to " + sink.file.path() + " failed with error code: " + std::to_string(bytes_written));
+      } else {
+        sink.rotater.updateCurrentSize(bytes_written);
+        sink.unsynced_bytes += bytes_written;
+        recordWrite(bytes_written, iovecs.size(), enqueued_at);
+
+        if (awaiter.sync && awaiter.sync_result < 0) {
+          reportError("createVectoredWriteTask", "io_uring fdatasync failed with error code: " + std::to_string(awaiter.sync_result));
+        }
+      }
+    } catch (const std::exception& e) {
+      reportError("createVectoredWriteTask", e.what());
+    } catch (...) {
+      reportError("createVectoredWriteTask", "Unknown exception");
+    }
+    for (auto& buffer : buffers) {
+      if (buffer) releaseBuffer(std::move(buffer));
+    }
+    flush_tracker_.taskDone(epoch);
+  }
+
+  void Logger::recordWrite(int bytes, size_t buffers, std::chrono::system_clock::time_point enqueued_at) noexcept {
+    counters_.bytes_written.add(static_cast<uint64_t>(bytes));
+    counters_.writes.add();
+    counters_.buffers_written.add(buffers);
+    if (enqueued_at != std::chrono::system_clock::time_point{}) {
+      counters_.write_latency.record(clock_.now() - enqueued_at);
+    }
+  }
+
+  void Logger::queueWrite(Sink& sink, std::unique_ptr<Memory::Buffer> buffer, Coroutine::TaskList& active_tasks) {
+    if (!buffer->next) {
+      queueBuffer(sink, std::move(buffer), active_tasks, false);
+      return;
+    }
+
+    // A message chained over several buffers (Buffer::next) goes out as one writev, with
+    // registered buffers too, so nothing lands between its parts. Only one longer than
+    // IOV_MAX buffers is split over consecutive writes
+    size_t parts = 0;
+    for (const auto* part = buffer.get(); part; part = part->next.get()) ++parts;
+    if (sink.gathered.size() + parts > IOV_MAX) {
+      submitGathered(sink, active_tasks);
     }
-  } {
 
-    // Validation: batch_size must not exceed queue_depth
-    if (config_.batch_size > config_.queue_depth) {
-      throw std::invalid_argument{"batch_size cannot exceed queue_depth"};
+    while (buffer) {
+      auto next = std::move(buffer->next);
+      queueBuffer(sink, std::move(buffer), active_tasks, true);
+      buffer = std::move(next);
     }
+    // Unchained registered buffers are written right away, the chain must not fall behind them
+    if (fixed_buffers_registered_) {
+      submitGathered(sink, active_tasks);
+    }
+  }
 
-    // Warn about suboptimal configurationsq
-    if (config_.batch_size > config_.queue_depth / 2) {
-      reportError("constructor",
-        "Warning: batch_size (" + std::to_string(config_.batch_size) +
-        ") is more than half of queue_depth (" + std::to_string(config_.queue_depth) +
-        "). This may result in inefficient CQE processing. Consider reducing batch_size or increasing queue_depth.");
+  void Logger::queueBuffer(Sink& sink, std::unique_ptr<Memory::Buffer> buffer, Coroutine::TaskList& active_tasks, bool chained) {
+    if (crash_ring_) {
+      buffer->crash_record = crash_ring_->append(static_cast<uint16_t>(&sink - sinks_.data()), buffer->data, buffer->size);
     }
 
-    // Validate queue_depth relative to batch_size
-    if (config_.queue_depth < config_.batch_size * 8) {
-      reportError("constructor",
-        "Warning: queue_depth (" + std::to_string(config_.queue_depth) +
-        ") is less than 8x batch_size (" + std::to_string(config_.batch_size * 8) +
-        "). This may limit I/O pipeline depth. Consider increasing queue_depth to at least " +
-        std::to_string(config_.batch_size * 16) + " for optimal performance.");
+    if (sink.indexer) {
+      sink.indexer->append(buffer->size, buffer->messages, buffer->enqueued_at);
     }
 
-    // Validate coalesce_size relative to batch_size
-    double coalesce_ratio = static_cast<double>(config_.coalesce_size) / config_.batch_size;
-    if (config_.coalesce_size > 0 && (coalesce_ratio < 0.5 || coalesce_ratio > 2.0)) {
-      reportError("constructor",
-        "Warning: coalesce_size (" + std::to_string(config_.coalesce_size) +
-        ") differs significantly from batch_size (" + std::to_string(config_.batch_size) +
-        "). Optimal ratio is close to 1:1. Current ratio: " + std::to_string(coalesce_ratio));
+    // The network sinks of this file send the same buffer, the last of its users releases it
+    buffer->holds = 0;
+    for (auto& network : network_sinks_) {
+      if (network.source != static_cast<size_t>(&sink - sinks_.data())) continue;
+      if (network.pending_bytes + buffer->size > network.max_pending_bytes) {
+        counters_.network_lines_dropped.add(IO::countLines({static_cast<const char*>(buffer->data), buffer->size}));
+        continue;
+      }
+      buffer->holds++;
+      network.pending.push_back(buffer.get());
+      network.pending_bytes += buffer->size;
     }
 
-    // Ensure calculated max_logs_per_iteration allows at least 2 batches
-    if (max_logs_per_iteration_ < config_.batch_size * 2) {
-      reportError("constructor",
-        "Warning: Calculated max_logs_per_iteration (" + std::to_string(max_logs_per_iteration_) +
-        ") is less than 2x batch_size (" + std::to_string(config_.batch_size * 2) +
-        "). This may cause excessive syscall overhead. Consider adjusting queue_depth.");
+    // Registered buffers need write_fixed, and direct I/O places every buffer at its
+    // own offset (a padded tail block is rewritten), both keep one write per buffer
+    if ((fixed_buffers_registered_ && !chained) || sink.file.direct()) {
+      active_tasks.adopt(createWriteTask(sink, std::move(buffer)));
+      active_task_count_.fetch_add(1, std::memory_order_release);
+      return;
     }
 
+    sink.gathered.push_back(std::move(buffer));
+    if (sink.gathered.size() >= IOV_MAX) {
+      submitGathered(sink, active_tasks);
+    }
   }
 
-  void Logger::eventLoop(std::stop_token st) {
+  // Buffers queued since the last call become a single write (writev if more than one)
+  void Logger::submitGathered(Sink& sink, Coroutine::TaskList& active_tasks) {
+    submitIndex(sink, active_tasks);
+    if (sink.gathered.empty()) return;
 
-    // Required to hold the state of the coroutines while they
-    // are suspended and not finished
-    // Using std::list for O(1) removal of completed tasks
-    std::list<Coroutine::WriteTask> active_tasks;
+    if (sink.gathered.size() == 1) {
+      active_tasks.adopt(createWriteTask(sink, std::move(sink.gathered.front())));
+    } else {
+      active_tasks.adopt(createVectoredWriteTask(sink, std::move(sink.gathered)));
+    }
+    active_task_count_.fetch_add(1, std::memory_order_release);
+    sink.gathered.clear();
+  }
 
-    size_t pending_writes = 0;
+  // A buffer still sent by a network sink is handed back to the pool by the last of its users
+  void Logger::releaseBuffer(std::unique_ptr<Memory::Buffer> buffer) {
+    if (buffer->holds > 0) {
+      buffer->holds--;
+      (void)buffer.release();
+      return;
+    }
+    buffer_pool_.release(std::move(buffer));
+  }
 
-    // Create WritePreparer to handle message formatting and coalescing
-    IO::WritePreparer preparer(
-        IO::WritePreparer::Config{
-            .coalesce_size = config_.coalesce_size,
-            .staging_buffer_size = 16384  // 16KB
-        },
-        buffer_pool_,
-        [this](const char* loc, const std::string& msg) { reportError(loc, msg); }
-    );
+  // Connects what is due, and starts sending what a connected sink has pending. A send
+  // task keeps going until nothing is pending, so it is started once per burst
+  void Logger::pumpNetwork(Coroutine::TaskList& active_tasks, bool stopping) {
+    auto now = std::chrono::steady_clock::now();
+    for (auto& network : network_sinks_) {
+      // A collector that stopped reading must not hold up the shutdown for long
+      if (stopping) network.timeout = std::min(network.timeout, NetworkSink::STOPPING_TIMEOUT);
+
+      if (network.fd < 0) {
+        // A stopping logger still tries its first connection, not the retries
+        bool never_tried = network.next_connect == std::chrono::steady_clock::time_point{};
+        if (!network.connecting && (never_tried || !stopping) && now >= network.next_connect) {
+          active_tasks.adopt(createConnectTask(network));
+          active_task_count_.fetch_add(1, std::memory_order_release);
+        }
+        continue;
+      }
 
-    while(!st.stop_requested() || !queue_->empty() || !active_tasks.empty()) {
+      if (!network.sending && !network.pending.empty()) {
+        active_tasks.adopt(network.target.stream() ? createStreamSendTask(network) : createDatagramSendTask(network));
+        active_task_count_.fetch_add(1, std::memory_order_release);
+      }
+    }
+  }
 
-      if (!ring_.isOperational()) {
-        reportError("eventLoop", "io_uring marked as failed. Draining queue and shutting down.");
+  Coroutine::WriteTask Logger::createConnectTask(NetworkSink& network) {
+    network.connecting = true;
+    network.next_connect = std::chrono::steady_clock::now() + network.retry_delay;
 
-        // Drain remaining queue items without processing
-        size_t dropped = 0;
-        while (queue_->tryPop()) {
-          dropped++;
-        }
+    try {
+      int fd = network.target.openSocket();
+      int status = fd;
+      if (fd >= 0) {
+        status = co_await ring_->createConnectAwaiter(fd, network.target.address(), network.target.addressLength(),
+                                                      network.timeout);
+      }
 
-        if (dropped > 0) {
-          reportError("eventLoop", "Dropped " + std::to_string(dropped) + " log messages due to io_uring failure.");
+      if (status < 0) {
+        if (fd >= 0) ::close(fd);
+        // Retried with a growing delay, reported once per outage
+        network.retry_delay = std::min(network.retry_delay * 2, NetworkSink::MAX_RETRY_DELAY);
+        if (!network.outage_reported) {
+          reportError("createConnectTask", "Failed to connect to " + network.target.name() + " (error code: " +
+                      std::to_string(status) + "), retrying in the background");
+          network.outage_reported = true;
         }
-
-        break; 
+      } else {
+        network.fd = fd;
+        network.retry_delay = NetworkSink::FIRST_RETRY_DELAY;
+        network.outage_reported = false;
+        if (network.was_connected) counters_.network_reconnects.add();
+        network.was_connected = true;
       }
+    } catch (const std::exception& e) {
+      reportError("createConnectTask", e.what());
+    } catch (...) {
+      reportError("createConnectTask", "Unknown exception");
+    }
+    network.connecting = false;
+  }
 
-      size_t processed_this_iteration = 0;
+  // TCP: the pending buffers go out as frames, up to IOV_MAX / 2 of them in one sendmsg.
+  // A short send continues with the rest of the same frames, so the stream stays in order
+  Coroutine::WriteTask Logger::createStreamSendTask(NetworkSink& network) {
+    network.sending = true;
 
-      // NON BLOCKING REMOVAL AS LONG AS THERE ARE ELEMENTS
-      while (auto request = queue_->tryPop()) {
-        // Don't process new requests if ring has failed
-        if (!ring_.isOperational()) {
-          reportError("eventLoop", "Skipping request because io_uring is not operational");
-          break;
+    // Live in the coroutine frame, a zero copy send reads them until its notification
+    std::vector<Memory::Buffer*> buffers;
+    std::vector<std::array<unsigned char, IO::TCP_FRAME_HEADER_SIZE>> headers;
+    std::vector<iovec> iovecs;
+
+    try {
+      while (network.fd >= 0 && !network.pending.empty()) {
+        size_t frames = std::min<size_t>(network.pending.size(), IOV_MAX / 2);
+        buffers.assign(network.pending.begin(), network.pending.begin() + frames);
+        network.pending.erase(network.pending.begin(), network.pending.begin() + frames);
+
+        headers.clear();
+        iovecs.clear();
+        headers.reserve(frames);
+        size_t total = 0;
+        for (auto* buffer : buffers) {
+          network.pending_bytes -= buffer->size;
+          headers.push_back(IO::tcpFrameHeader(static_cast<uint32_t>(buffer->size)));
+          iovecs.push_back(iovec{headers.back().data(), IO::TCP_FRAME_HEADER_SIZE});
+          iovecs.push_back(iovec{buffer->data, buffer->size});
+          total += IO::TCP_FRAME_HEADER_SIZE + buffer->size;
         }
 
-        try {
-          // Prepare the write request (format and optionally coalesce)
-          auto prepared = preparer.prepareWrite(std::move(request.value()));
+        size_t sent = 0;
+        size_t first = 0;
+        int status = 0;
+        while (sent < total) {
+          msghdr message{};
+          message.msg_iov = iovecs.data() + first;
+          message.msg_iovlen = iovecs.size() - first;
+          status = co_await ring_->createSendAwaiter(network.fd, &message, 1, MSG_NOSIGNAL, true, network.timeout);
+          if (status <= 0) break;
+
+          // Skip what went out, a partly sent iovec continues where it stopped
+          sent += static_cast<size_t>(status);
+          for (size_t done = static_cast<size_t>(status); done > 0;) {
+            size_t step = std::min(done, iovecs[first].iov_len);
+            iovecs[first].iov_base = static_cast<char*>(iovecs[first].iov_base) + step;
+            iovecs[first].iov_len -= step;
+            done -= step;
+            if (iovecs[first].iov_len == 0) first++;
+          }
+        }
 
-          // If we got a buffer back, submit it for writing
-          if (prepared.buffer) {
-            active_tasks.push_back(createWriteTask(std::move(prepared.buffer)));
-            active_task_count_.fetch_add(1, std::memory_order_release);
-            pending_writes++;
+        if (sent < total) {
+          // The frames go out again, whole, on the next connection. What the lost one
+          // received of them ends in a partial frame the collector discards
+          for (auto it = buffers.rbegin(); it != buffers.rend(); ++it) {
+            network.pending.push_front(*it);
+            network.pending_bytes += (*it)->size;
           }
+          buffers.clear();
+          disconnect(network, status == 0 ? -EPIPE : status);
+          break;
+        }
 
-          processed_this_iteration++;
+        counters_.network_bytes_sent.add(total);
+        for (auto* buffer : buffers) releaseBuffer(std::unique_ptr<Memory::Buffer>(buffer));
+        buffers.clear();
+      }
+    } catch (const std::exception& e) {
+      reportError("createStreamSendTask", e.what());
+    } catch (...) {
+      reportError("createStreamSendTask", "Unknown exception");
+    }
+    for (auto* buffer : buffers) releaseBuffer(std::unique_ptr<Memory::Buffer>(buffer));
+    network.sending = false;
+  }
 
-          // Submit batch if we've accumulated enough writes or preparer says so
-          if (prepared.should_flush_batch || pending_writes >= config_.batch_size) {
-            if (!ring_.submitPendingSQEs()) {
-              reportError("eventLoop:submit", "Failed to submit batch. io_uring may be degraded.");
-            }
-            pending_writes = 0;
-          }
+  // UDP_SYSLOG: every line its own datagram behind the <PRI> header, up to
+  // DATAGRAMS_IN_FLIGHT of them sent at once. Datagrams are never retried
+  Coroutine::WriteTask Logger::createDatagramSendTask(NetworkSink& network) {
+    static constexpr size_t DATAGRAMS_IN_FLIGHT = 64;
+    network.sending = true;
 
-          // Prevents too many requests from causing this loop to stall
-          // and processCompletions not being called below
-          if (processed_this_iteration >= max_logs_per_iteration_) break;
+    std::vector<Memory::Buffer*> buffers;
+    std::vector<iovec> iovecs;
+    std::vector<msghdr> messages;
+    size_t in_flight = std::max<size_t>(1, std::min(DATAGRAMS_IN_FLIGHT, ring_->capacity() / 4));
 
-        } catch (const std::exception& e) {
-          reportError("eventLoop:processing", e.what());
-        } catch (...) {
-          reportError("eventLoop:processing", "Unknown exception");
+    try {
+      while (network.fd >= 0 && !network.pending.empty()) {
+        // Whole buffers, until their lines fill a round of datagrams
+        buffers.clear();
+        iovecs.clear();
+        while (!network.pending.empty() && iovecs.size() / 2 < in_flight) {
+          auto* buffer = network.pending.front();
+          network.pending.pop_front();
+          network.pending_bytes -= buffer->size;
+          buffers.push_back(buffer);
+          IO::forEachLine({static_cast<const char*>(buffer->data), buffer->size}, [&](std::string_view line) {
+            iovecs.push_back(iovec{network.priority.data(), network.priority.size()});
+            iovecs.push_back(iovec{const_cast<char*>(line.data()), line.size()});
+          });
         }
-      }
 
-      // Flush any remaining data in preparer's staging buffer
-      try {
-        auto flushed = preparer.flushStaged();
-        if (flushed.has_value()) {
-          active_tasks.push_back(createWriteTask(std::move(flushed.value())));
-          active_task_count_.fetch_add(1, std::memory_order_release);
-          pending_writes++;
+        messages.assign(iovecs.size() / 2, msghdr{});
+        for (size_t i = 0; i < messages.size(); ++i) {
+          messages[i].msg_iov = &iovecs[i * 2];
+          messages[i].msg_iovlen = 2;
         }
-      } catch (const std::exception& e) {
-        reportError("eventLoop:flush_staging", e.what());
-      }
 
-      // Submit any remaining requests
-      if (pending_writes > 0) {
-        if (!ring_.submitPendingSQEs()) {
-          reportError("eventLoop:submit", "Failed to submit remaining writes.");
+        for (size_t first = 0; first < messages.size(); first += in_flight) {
+          unsigned count = static_cast<unsigned>(std::min(in_flight, messages.size() - first));
+          auto awaiter = ring_->createSendAwaiter(network.fd, &messages[first], count, MSG_DONTWAIT | MSG_NOSIGNAL);
+          int status = co_await awaiter;
+
+          // Nothing was queued when the submission queue was full
+          bool queued = status != -EAGAIN || awaiter.failures > 0;
+          counters_.network_lines_dropped.add(queued ? awaiter.failures : count);
+          counters_.network_bytes_sent.add(awaiter.transferred);
         }
-        pending_writes = 0;
-      }
 
-      // Process CQEs
-      ring_.processCompletions();
+        for (auto* buffer : buffers) releaseBuffer(std::unique_ptr<Memory::Buffer>(buffer));
+        buffers.clear();
+      }
+    } catch (const std::exception& e) {
+      reportError("createDatagramSendTask", e.what());
+    } catch (...) {
+      reportError("createDatagramSendTask", "Unknown exception");
+    }
+    for (auto* buffer : buffers) releaseBuffer(std::unique_ptr<Memory::Buffer>(buffer));
+    network.sending = false;
+  }
 
-      // Clean up completed tasks and check for exceptions
-      // Using std::list::remove_if for O(1) removal per element
-      active_tasks.remove_if(
-          [this](const Coroutine::WriteTask& task) {
-            if (!task.done()) return false;
-
-            // Check if task completed with exception
-            if (task.has_exception()) {
-              try {
-                task.rethrow_if_exception();
-              } catch (const std::exception& e) {
-                reportError("coroutine", e.what());
-              } catch (...) {
-                reportError("coroutine", "Unknown exception in completed task");
-              }
-            }
-
-            if (active_task_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-              flush_cv_.notify_one();
-            }
-
-            return true;
-          }
-      );
+  // A failed TCP send: the socket is closed, pumpNetwork() reconnects after the retry delay
+  void Logger::disconnect(NetworkSink& network, int status) {
+    ::close(network.fd);
+    network.fd = -1;
+    network.next_connect = std::chrono::steady_clock::now() + network.retry_delay;
+    if (!network.outage_reported) {
+      reportError("createStreamSendTask", "Lost the connection to " + network.target.name() + " (error code: " +
+                  std::to_string(status) + "), reconnecting");
+      network.outage_reported = true;
+    }
+  }
 
-      // Smart waiting strategy
-      if (!st.stop_requested()) {
-        if (queue_->empty() && !active_tasks.empty()) {
-          ring_.waitForCompletion(std::chrono::microseconds(100));
-        } else if (queue_->empty() && active_tasks.empty()) {
-          std::this_thread::sleep_for(std::chrono::microseconds(10));
-        }
+  // The worker stopped: what could not be sent is dropped
+  void Logger::closeNetworkSinks() {
+    for (auto& network : network_sinks_) {
+      for (auto* buffer : network.pending) {
+        counters_.network_lines_dropped.add(IO::countLines({static_cast<const char*>(buffer->data), buffer->size}));
+        releaseBuffer(std::unique_ptr<Memory::Buffer>(buffer));
       }
+      network.pending.clear();
+      network.pending_bytes = 0;
+
+      if (network.fd >= 0) ::close(network.fd);
+      network.fd = -1;
     }
   }
 
-  Coroutine::WriteTask Logger::createWriteTask(std::unique_ptr<Memory::Buffer> buffer) {
+  Coroutine::WriteTask Logger::createSyncTask(Sink& sink) {
+    // Everything completed up to now is covered by this sync
+    sink.sync_in_flight = true;
+    sink.unsynced_bytes = 0;
+    sink.last_sync = std::chrono::steady_clock::now();
+    uint64_t epoch = flush_tracker_.taskStarted();
+
     try {
-      // Check if file rotation is needed
-      if (file_rotater_.shouldRotate()) {
-        file_rotater_.rotate();
-        file_.reopen(file_rotater_.getCurrentFilename());
+      int status = co_await ring_->createSyncAwaiter(sink.file);
+      if (status < 0) {
+        reportError("createSyncTask", "io_uring fdatasync of " + sink.file.path() + " failed with error code: " + std::to_string(status));
       }
+    } catch (const std::exception& e) {
+      reportError("createSyncTask", e.what());
+    } catch (...) {
+      reportError("createSyncTask", "Unknown exception");
+    }
 
-      // Submit write to io_uring and wait for completion
-      int bytes_written = co_await ring_.createWriteAwaiter(file_, buffer->data, buffer->size);
+    sink.sync_in_flight = false;
+    flush_tracker_.taskDone(epoch);
+  }
 
-      // Release buffer back to pool after write completes
-      buffer_pool_.release(std::move(buffer));
+  // The index continues where the file ends, lines it held before are covered by no entry
+  void Logger::startIndex(Sink& sink) {
+    if (!sink.indexer) return;
 
-      // Handle write result
-      if (bytes_written < 0) {
-        reportError("createWriteTask", "io_uring write failed with error code: " + std::to_string(bytes_written));
-      } else {
-        // Update file rotater with bytes written
-        file_rotater_.updateCurrentSize(bytes_written);
+    try {
+      sink.indexer->start(sink.file.size(), sink.index && sink.index->size() == 0);
+    } catch (const std::exception& e) {
+      sink.indexer->start(0, false);
+      reportError("startIndex", e.what());
+    }
+  }
+
+  // Entries collected since the last call are appended to the index file in one write
+  void Logger::submitIndex(Sink& sink, Coroutine::TaskList& active_tasks) {
+    if (!sink.indexer || sink.indexer->pending().empty()) return;
+
+    // Opening the index of this file failed, it goes without one
+    if (!sink.index) {
+      sink.indexer->clearPending();
+      return;
+    }
+
+    auto entries = sink.indexer->pending();
+    auto buffer = buffer_pool_.acquire(entries.size());
+    std::memcpy(buffer->data, entries.data(), entries.size());
+    buffer->size = entries.size();
+    sink.indexer->clearPending();
+
+    active_tasks.adopt(createIndexWriteTask(sink, std::move(buffer)));
+    active_task_count_.fetch_add(1, std::memory_order_release);
+  }
+
+  Coroutine::WriteTask Logger::createIndexWriteTask(Sink& sink, std::unique_ptr<Memory::Buffer> buffer) {
+    uint64_t epoch = flush_tracker_.taskStarted();
+
+    try {
+      // A rotation may switch sink.index while the write is in flight
+      std::string path = sink.index->path();
+      int status = co_await ring_->createWriteAwaiter(*sink.index, buffer->data, buffer->size, buffer->buf_index);
+      if (status < 0) {
+        reportError("createIndexWriteTask", "io_uring write to " + path + " failed with error code: " + std::to_string(status));
+      } else if (static_cast<size_t>(status) < buffer->size) {
+        reportError("createIndexWriteTask", "Short write to " + path + ", its last entry is incomplete.");
       }
     } catch (const std::exception& e) {
-      reportError("createWriteTask", e.what());
+      reportError("createIndexWriteTask", e.what());
     } catch (...) {
-      reportError("createWriteTask", "Unknown exception");
+      reportError("createIndexWriteTask", "Unknown exception");
+    }
+
+    buffer_pool_.release(std::move(buffer));
+    flush_tracker_.taskDone(epoch);
+  }
+
+  // Frees the cached buffers the last Config::buffer_pool_trim_ms did not need (idle worker only)
+  void Logger::trimBufferPool() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_pool_trim_) return;
+
+    next_pool_trim_ = now + std::chrono::milliseconds(config_.buffer_pool_trim_ms);
+    if (size_t freed = buffer_pool_.trim(); freed > 0) {
+      counters_.buffer_pool_trimmed.add(freed);
+    }
+  }
+
+  // How long the idle worker may sleep, negative = until woken. PERIODIC durability
+  // wakes up for the next sync that is due, suppressed rate limited calls for their report,
+  // a staging buffer held by autotuning for its deadline, a lost connection for its retry,
+  // cached buffers for their next trim
+  std::chrono::microseconds Logger::idleTimeout() const {
+    auto timeout = std::chrono::microseconds(-1);
+    auto now = std::chrono::steady_clock::now();
+
+    auto report_due = suppressionReportDue();
+    if (report_due != std::chrono::steady_clock::time_point::max()) {
+      timeout = std::max(std::chrono::duration_cast<std::chrono::microseconds>(report_due - now),
+                         std::chrono::microseconds(0));
+    }
+    if (buffer_pool_.trimmable()) {
+      auto due = std::max(std::chrono::duration_cast<std::chrono::microseconds>(next_pool_trim_ - now),
+                          std::chrono::microseconds(0));
+      if (timeout.count() < 0 || due < timeout) timeout = due;
+    }
+    if (staging_held_) {
+      auto due = std::max(std::chrono::duration_cast<std::chrono::microseconds>(hold_deadline_ - now),
+                          std::chrono::microseconds(0));
+      if (timeout.count() < 0 || due < timeout) timeout = due;
+    }
+    for (const auto& network : network_sinks_) {
+      if (network.fd >= 0 || network.connecting) continue;
+
+      auto due = std::max(std::chrono::duration_cast<std::chrono::microseconds>(network.next_connect - now),
+                          std::chrono::microseconds(0));
+      if (timeout.count() < 0 || due < timeout) timeout = due;
+    }
+    if (config_.durability != DurabilityMode::PERIODIC) return timeout;
+
+    for (const auto& sink : sinks_) {
+      if (sink.sync_in_flight || sink.unsynced_bytes == 0) continue;
+
+      auto due = std::chrono::duration_cast<std::chrono::microseconds>(
+        sink.last_sync + std::chrono::milliseconds(config_.fsync_interval_ms) - now);
+      due = std::max(due, std::chrono::microseconds(0));
+      if (timeout.count() < 0 || due < timeout) timeout = due;
+    }
+    return timeout;
+  }
+
+  void Logger::idleWait(const std::stop_token& st, std::chrono::microseconds timeout) {
+    // Latency sensitive setups poll a while first, a message arriving meanwhile needs no wakeup
+    if (config_.idle_spin_us > 0) {
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config_.idle_spin_us);
+      while (queue_->empty() && !st.stop_requested() && !(ring_ && ring_->hasCompletions()) &&
+             std::chrono::steady_clock::now() < deadline) {
+      }
+    }
+
+    // Follow-ups of coroutines resumed by the last processCompletions() must be in flight
+    // before sleeping, their completion is what wakes the worker
+    if (ring_ && ring_->hasUnsubmittedSQEs() && !ring_->submitPendingSQEs()) {
+      reportError("idleWait", "Failed to submit pending operations.");
+    }
+
+    // Announced before the re-check, a producer pushing after it sees the flag (wakeWorker).
+    // flush() and the destructor signal too. A flush waiting for a staged direct I/O
+    // tail block (or a held staging buffer) needs another iteration writing it
+    worker_sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool flush_waits = flush_target_.load(std::memory_order_relaxed) > flush_tracker_.flushed() &&
+      (staging_held_ || std::any_of(sinks_.begin(), sinks_.end(), [](const Sink& sink) { return sink.preparer->hasUnwritten(); }));
+    if (queue_->empty() && !st.stop_requested() && !flush_waits && !(ring_ && ring_->hasCompletions())) {
+      if (!ring_ || ring_signals_wakeup_) {
+        // Producers and (registered with the ring) completions signal the eventfd.
+        // Rounded up, so a due sync is never missed by a fraction of a millisecond
+        wakeup_.wait(timeout.count() < 0 ? -1 : static_cast<int>((timeout.count() + 999) / 1000));
+      } else {
+        // Registering the eventfd failed, fall back to checking the queue regularly
+        auto poll_interval = std::chrono::microseconds(100);
+        ring_->waitForCompletion(timeout.count() < 0 ? poll_interval : std::min(timeout, poll_interval));
+      }
+    }
+
+    worker_sleeping_.store(false, std::memory_order_relaxed);
+  }
+
+  bool Logger::admitOverflowing(SEVERITY_LEVEL severity) noexcept {
+    const size_t limit = config_.max_queued_messages;
+    auto drop = [this, severity]() {
+      dropped_[static_cast<size_t>(severity)].fetch_add(1, std::memory_order_relaxed);
+      return false;
+    };
+
+    // queued_ already counts this message
+    switch (config_.overflow_policy) {
+      case OverflowPolicy::DROP_OLDEST:
+        // The worker drops the oldest ones for it (releaseQueued), up to twice the limit
+        if (queued_.load(std::memory_order_relaxed) <= 2 * limit) return true;
+        unadmit();
+        return drop();
+      case OverflowPolicy::DROP_NEWEST:
+        unadmit();
+        return drop();
+      case OverflowPolicy::DROP_BELOW_ERROR:
+        if (severity < SEVERITY_LEVEL::ERROR) {
+          unadmit();
+          return drop();
+        }
+        break;
+      case OverflowPolicy::BLOCK:
+      case OverflowPolicy::BLOCK_TIMEOUT:
+        break;
+    }
+
+    // Wait for room. Announced before the check under the lock, a worker popping after
+    // the check sees it and notifies (releaseQueued)
+    unadmit();
+    blocked_producers_.fetch_add(1, std::memory_order_seq_cst);
+    bool admitted;
+    {
+      std::unique_lock<std::mutex> lock(overflow_mutex_);
+      auto ready = [this, limit]() {
+        return overflow_closed_ || queued_.load(std::memory_order_seq_cst) < limit;
+      };
+
+      if (config_.overflow_policy == OverflowPolicy::BLOCK_TIMEOUT) {
+        room_cv_.wait_for(lock, std::chrono::milliseconds(config_.overflow_timeout_ms), ready);
+      } else {
+        room_cv_.wait(lock, ready);
+      }
+
+      // Several producers woken at once may overshoot the limit by one message each
+      admitted = !overflow_closed_ && queued_.load(std::memory_order_relaxed) < limit;
+      if (admitted) queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+    blocked_producers_.fetch_sub(1, std::memory_order_relaxed);
+
+    return admitted || drop();
+  }
+
+  // Called by the worker with every popped batch. Returns how many of its oldest
+  // messages are dropped (DROP_OLDEST)
+  size_t Logger::releaseQueued(std::span<WriteRequest> popped) noexcept {
+    const size_t limit = config_.max_queued_messages;
+    if (limit == 0 || popped.empty()) return 0;
+
+    size_t dropped = 0;
+    if (config_.overflow_policy == OverflowPolicy::DROP_OLDEST) {
+      size_t queued = queued_.load(std::memory_order_relaxed);
+      dropped = queued > limit ? std::min(queued - limit, popped.size()) : 0;
+      for (size_t i = 0; i < dropped; ++i) {
+        dropped_[static_cast<size_t>(popped[i].level)].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    queued_.fetch_sub(popped.size(), std::memory_order_seq_cst);
+    if (blocked_producers_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(overflow_mutex_);
+      room_cv_.notify_all();
+    }
+    return dropped;
+  }
+
+  // The "N messages dropped" line for the drops since the last one, once the queue
+  // drained to half the limit again (a queue stuck at the limit is reported when it recovers)
+  std::optional<WriteRequest> Logger::takeDropReport() {
+    if (config_.max_queued_messages == 0) return std::nullopt;
+    if (queued_.load(std::memory_order_relaxed) > config_.max_queued_messages / 2) return std::nullopt;
+
+    uint64_t total = 0;
+    std::string by_severity;
+    for (size_t i = 0; i < dropped_.size(); ++i) {
+      uint64_t count = dropped_[i].load(std::memory_order_relaxed) - reported_drops_[i];
+      if (count == 0) continue;
+
+      reported_drops_[i] += count;
+      total += count;
+      by_severity += fmt::format("{}{} {}", by_severity.empty() ? "" : ", ", count, SEVERITY_NAMES[i]);
+    }
+    if (total == 0) return std::nullopt;
+
+    return WriteRequest{
+      .level = SEVERITY_LEVEL::WARN,
+      .data = fmt::format("[MrLogger] {} messages dropped because the log queue was full ({})", total, by_severity),
+      .threadId = std::this_thread::get_id(),
+      .timestamp = clock_.now(),
+      .sequence_number = 0,
+      .deferred = {}
+    };
+  }
+
+  // When the next suppression report is due, time_point::max() while no rate limited
+  // statement of this logger has unreported suppressions
+  std::chrono::steady_clock::time_point Logger::suppressionReportDue() const {
+    for (const CallSite* site = CallSite::first(); site; site = site->next()) {
+      if (site->owner() == this && site->hasUnreported()) {
+        return last_suppression_report_ + std::chrono::milliseconds(config_.suppression_report_ms);
+      }
+    }
+    return std::chrono::steady_clock::time_point::max();
+  }
+
+  // One line per rate limited statement of this logger that suppressed calls since its
+  // last one, every suppression_report_ms and when the worker stops. The macros are given
+  // the logger itself, never one of its shards, so with several workers its first one
+  // reports them
+  std::vector<WriteRequest> Logger::takeSuppressionReports(bool final) {
+    std::vector<WriteRequest> reports;
+    auto now = std::chrono::steady_clock::now();
+    if (!final && now - last_suppression_report_ < std::chrono::milliseconds(config_.suppression_report_ms)) {
+      return reports;
+    }
+
+    for (CallSite* site = CallSite::first(); site; site = site->next()) {
+      if (site->owner() != this) continue;
+      uint64_t count = site->takeUnreported();
+      if (count == 0) continue;
+
+      reports.push_back(WriteRequest{
+        .level = site->level(),
+        .data = fmt::format("[MrLogger] suppressed {} similar messages at {}:{}", count, site->file(), site->line()),
+        .threadId = std::this_thread::get_id(),
+        .timestamp = clock_.now(),
+        .sequence_number = 0,
+        .deferred = {}
+      });
+    }
+    last_suppression_report_ = now;
+    return reports;
+  }
+
+  void Logger::closeAdmission() noexcept {
+    {
+      std::lock_guard<std::mutex> lock(overflow_mutex_);
+      overflow_closed_ = true;
     }
+    room_cv_.notify_all();
+  }
+
+  Stats Logger::stats() const {
+    size_t queue_depth = queue_->size();
+    uint64_t dropped = 0;  // Of this shard, droppedMessages() covers all of them
+    for (const auto& count : dropped_) dropped += count.load(std::memory_order_relaxed);
+
+    Stats stats{
+      .messages_enqueued = counters_.messages_dequeued.load() + queue_depth,
+      .messages_written = counters_.messages_written.load(),
+      .messages_dropped = dropped,
+      .bytes_written = counters_.bytes_written.load(),
+      .writes = counters_.writes.load(),
+      .buffers_written = counters_.buffers_written.load(),
+      .sq_full = ring_ ? ring_->sqFullCount() : 0,
+      .in_flight = active_task_count_.load(std::memory_order_relaxed),
+      .queue_depth = queue_depth,
+      .rotations = counters_.rotations.load(),
+      .buffer_pool_hits = buffer_pool_.acquireCount() - buffer_pool_.missCount(),
+      .buffer_pool_misses = buffer_pool_.missCount(),
+      .buffer_pool_trimmed = counters_.buffer_pool_trimmed.load(),
+      .network_bytes_sent = counters_.network_bytes_sent.load(),
+      .network_lines_dropped = counters_.network_lines_dropped.load(),
+      .network_reconnects = counters_.network_reconnects.load(),
+      .write_latency = counters_.write_latency.snapshot()
+    };
+    for (const auto& shard : shards_) stats += shard->stats();
+    return stats;
+  }
+
+  void Logger::warmUp() {
+    buffer_pool_.warmUp();
+    for (auto& shard : shards_) shard->warmUp();
+  }
+
+  uint64_t Logger::droppedMessages() const noexcept {
+    uint64_t total = 0;
+    for (const auto& count : dropped_) {
+      total += count.load(std::memory_order_relaxed);
+    }
+    for (const auto& shard : shards_) total += shard->droppedMessages();
+    return total;
+  }
+
+  bool Logger::periodicSyncDue(const Sink& sink, bool stopping) const {
+    if (sink.sync_in_flight || sink.unsynced_bytes == 0) return false;
+    if (stopping) return true;
+
+    if (config_.fsync_interval_bytes > 0 && sink.unsynced_bytes >= config_.fsync_interval_bytes) {
+      return true;
+    }
+
+    return std::chrono::steady_clock::now() - sink.last_sync >= std::chrono::milliseconds(config_.fsync_interval_ms);
   }
 
   Logger::~Logger() {
@@ -334,6 +2217,7 @@ Logger::Logger(const Config& config) :
 
     if (worker_.joinable()) {
       worker_.request_stop();
+      wakeup_.signal();
 
       auto join_future = std::async(std::launch::async, [this]() {
         worker_.join();
@@ -350,24 +2234,51 @@ Logger::Logger(const Config& config) :
 
   // Factory static member definitions
   std::shared_ptr<Logger> Logger::Factory::instance_ = nullptr;
+  std::atomic<bool> Logger::Factory::published_{false};
+  std::unordered_map<std::string, std::shared_ptr<Logger>> Logger::Factory::named_;
   std::mutex Logger::Factory::mutex_;
 
   void Logger::Factory::init(Config&& config) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (!instance_) {
       instance_ = std::shared_ptr<Logger>(new Logger(config));
+      published_.store(true, std::memory_order_release);
     }
   }
 
-  std::shared_ptr<Logger> Logger::Factory::_get() {
+  const std::shared_ptr<Logger>& Logger::Factory::_get() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (!instance_) throw std::runtime_error{"MR::Logger instance not created. MR::Logger::init() must be called before any call to MR::Logger::get()."};
     return instance_;
   }
 
+  std::shared_ptr<Logger> Logger::Factory::create(std::string name, Config&& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = named_.find(name);
+    if (it != named_.end()) return it->second;
+
+    // Never the default queue, two workers would steal each other's messages
+    if (!config._queue) {
+      config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    }
+
+    auto logger = std::shared_ptr<Logger>(new Logger(config));
+    named_.emplace(std::move(name), logger);
+    return logger;
+  }
+
+  std::shared_ptr<Logger> Logger::Factory::_get(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = named_.find(std::string(name));
+    if (it == named_.end()) throw std::runtime_error{"MR::Logger named logger \"" + std::string(name) + "\" not created. MR::Logger::create() must be called first."};
+    return it->second;
+  }
+
   void Logger::Factory::_reset() {
     std::lock_guard<std::mutex> lock(mutex_);
+    published_.store(false, std::memory_order_release);
     instance_.reset();
+    named_.clear();
   }
 
   const Config& Logger::Factory::getConfig() {
@@ -386,6 +2297,9 @@ Logger::Logger(const Config& config) :
   void Logger::init(const Config& config) {
     Factory::init(Config{config});
   }
+  std::shared_ptr<Logger> Logger::create(std::string name, Config config) {
+    return Factory::create(std::move(name), std::move(config));
+  }
   void Logger::_reset() {
     Factory::_reset();
   }
@@ -401,12 +2315,135 @@ Logger::Logger(const Config& config) :
   }
 
   void Logger::flush() {
+    flushUntil(std::chrono::steady_clock::time_point::max());
+  }
+
+  bool Logger::flush(std::chrono::milliseconds timeout) {
+    return flushUntil(flushDeadline(timeout));
+  }
+
+  std::chrono::steady_clock::time_point Logger::flushDeadline(std::chrono::milliseconds timeout) const noexcept {
+    auto now = std::chrono::steady_clock::now();
+    if (timeout >= std::chrono::steady_clock::time_point::max() - now) return std::chrono::steady_clock::time_point::max();
+    return now + timeout;
+  }
+
+  // Waits for the tickets handed out so far, those of this logger and of its shards
+  bool Logger::flushUntil(std::chrono::steady_clock::time_point deadline) {
+    for (auto& shard : shards_) {
+      if (!shard->flushUntil(deadline)) return false;
+    }
+
+    uint64_t target = next_ticket_.load(std::memory_order_relaxed) - 1;
+    if (flushed_.load(std::memory_order_acquire) >= target) return true;
+
+    auto flushed = [this, target]() { return flushed_.load(std::memory_order_seq_cst) >= target; };
+
     std::unique_lock<std::mutex> lock(flush_mutex_);
+    flush_waiters_.fetch_add(1, std::memory_order_seq_cst);
+    uint64_t requested = flush_target_.load(std::memory_order_relaxed);
+    while (requested < target && !flush_target_.compare_exchange_weak(requested, target, std::memory_order_release)) {}
+    wakeWorker();
+
+    bool done = true;
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+      flush_cv_.wait(lock, flushed);
+    } else {
+      done = flush_cv_.wait_until(lock, deadline, flushed);
+    }
+    flush_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return done;
+  }
 
-    // Wait until queue is empty AND all active tasks are done
-    flush_cv_.wait(lock, [this]() {
-      return queue_->size() == 0 && active_task_count_.load(std::memory_order_acquire) == 0;
-    });
+  void Logger::flushAsync(std::function<void()> on_flushed) {
+    if (shards_.empty()) {
+      whenFlushed(std::move(on_flushed));
+      return;
+    }
+
+    // Called once the last of the shards is flushed
+    auto remaining = std::make_shared<std::atomic<size_t>>(shards_.size() + 1);
+    auto shared = std::make_shared<std::function<void()>>(std::move(on_flushed));
+    auto done = [remaining, shared]() {
+      if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) (*shared)();
+    };
+    for (auto& shard : shards_) shard->whenFlushed(done);
+    whenFlushed(done);
+  }
+
+  std::future<void> Logger::flushAsync() {
+    auto promise = std::make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    flushAsync([promise]() { promise->set_value(); });
+    return future;
+  }
+
+  void Logger::whenFlushed(std::function<void()> on_flushed) {
+    uint64_t target = next_ticket_.load(std::memory_order_relaxed) - 1;
+    {
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      flush_waiters_.fetch_add(1, std::memory_order_seq_cst);
+      if (flushed_.load(std::memory_order_seq_cst) < target) {
+        flush_callbacks_.push_back(FlushCallback{target, std::move(on_flushed)});
+        uint64_t requested = flush_target_.load(std::memory_order_relaxed);
+        while (requested < target && !flush_target_.compare_exchange_weak(requested, target, std::memory_order_release)) {}
+        wakeWorker();
+        return;
+      }
+      flush_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    on_flushed();
+  }
+
+  // Called by the worker whenever FlushTracker::flushed() may have moved. Costs a
+  // load unless a flush waits
+  void Logger::publishFlushed(uint64_t flushed) {
+    if (flushed <= flushed_.load(std::memory_order_relaxed)) return;
+
+    // Ordered before the load of flush_waiters_, a flush that registers later sees it
+    flushed_.store(flushed, std::memory_order_seq_cst);
+    if (flush_waiters_.load(std::memory_order_seq_cst) == 0) return;
+
+    std::vector<FlushCallback> ready;
+    {
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      auto pending = std::partition(flush_callbacks_.begin(), flush_callbacks_.end(),
+        [flushed](const FlushCallback& callback) { return callback.ticket > flushed; });
+      std::move(pending, flush_callbacks_.end(), std::back_inserter(ready));
+      flush_callbacks_.erase(pending, flush_callbacks_.end());
+      flush_waiters_.fetch_sub(ready.size(), std::memory_order_relaxed);
+      flush_cv_.notify_all();
+    }
+
+    for (auto& callback : ready) {
+      try {
+        callback.on_flushed();
+      } catch (const std::exception& e) {
+        reportError("flushAsync", e.what());
+      } catch (...) {
+        reportError("flushAsync", "Unknown exception in the flush callback");
+      }
+    }
+  }
+
+  void Logger::abandonTicket(uint64_t ticket) noexcept {
+    try {
+      std::lock_guard<std::mutex> lock(abandoned_mutex_);
+      abandoned_tickets_.push_back(ticket);
+      tickets_abandoned_.store(true, std::memory_order_release);
+    } catch (...) {
+      reportError("write to queue", "Failed to give back the flush ticket of a lost message, flush() may block");
+    }
+  }
+
+  // Worker only: the tickets of messages that never reached the queue count as popped
+  void Logger::popAbandonedTickets() {
+    if (!tickets_abandoned_.load(std::memory_order_acquire)) return;
+
+    std::lock_guard<std::mutex> lock(abandoned_mutex_);
+    for (uint64_t ticket : abandoned_tickets_) flush_tracker_.popped(ticket);
+    abandoned_tickets_.clear();
+    tickets_abandoned_.store(false, std::memory_order_relaxed);
   }
 
   // Namespace-level convenience functions
@@ -418,10 +2455,18 @@ Logger::Logger(const Config& config) :
     Logger::init(config);
   }
 
-  std::shared_ptr<Logger> get() {
+  const std::shared_ptr<Logger>& get() {
     return Logger::get();
   }
 
+  std::shared_ptr<Logger> create(std::string name, Config config) {
+    return Logger::create(std::move(name), std::move(config));
+  }
+
+  std::shared_ptr<Logger> get(std::string_view name) {
+    return Logger::get(name);
+  }
+
   const Config& getConfig() {
     return Logger::getConfig();
   }
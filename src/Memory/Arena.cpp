@@ -0,0 +1,70 @@
+#include <MR/Memory/Arena.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace MR::Memory {
+
+namespace {
+
+// mbind(2) is only wrapped by libnuma
+constexpr int MPOL_PREFERRED_MODE = 1;
+
+int bindToNode(void* region, size_t size, int node) {
+    constexpr size_t BITS = sizeof(unsigned long) * 8;
+    unsigned long mask[4] = {};
+    if (node < 0 || static_cast<size_t>(node) >= BITS * 4) return -EINVAL;
+    mask[node / BITS] = 1UL << (node % BITS);
+
+    // maxnode counts one past the last bit the kernel reads
+    long status = ::syscall(SYS_mbind, region, size, MPOL_PREFERRED_MODE, mask, BITS * 4 + 1, 0);
+    return status == 0 ? 0 : -errno;
+}
+
+}
+
+Arena::Arena(size_t size, bool lock, int numa_node)
+    : size_((size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE) {
+    if (size_ == 0) size_ = HUGE_PAGE_SIZE;
+
+    void* region = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    region = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge_pages_ = region != MAP_FAILED;
+#endif
+
+    if (region == MAP_FAILED) {
+        region = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) {
+            throw std::runtime_error("Failed to map the buffer arena: " + std::string(std::strerror(errno)));
+        }
+#ifdef MADV_HUGEPAGE
+        // Best effort, THP may be disabled
+        ::madvise(region, size_, MADV_HUGEPAGE);
+#endif
+    }
+
+    data_ = static_cast<char*>(region);
+
+    // Before mlock, which faults every page in
+    if (numa_node >= 0) numa_error_ = bindToNode(data_, size_, numa_node);
+
+    if (lock) {
+        locked_ = ::mlock(data_, size_) == 0;
+        if (!locked_) lock_error_ = -errno;
+    }
+}
+
+Arena::~Arena() {
+    if (!data_) return;
+
+    if (locked_) ::munlock(data_, size_);
+    ::munmap(data_, size_);
+}
+
+} // namespace MR::Memory
@@ -1,81 +1,173 @@
 #include <MR/Memory/BufferPool.hpp>
 
+#include <stdexcept>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 namespace MR::Memory {
 
-BufferPool::BufferPool() 
-    : small_pool_(SMALL_POOL_SIZE, SMALL_BUFFER_SIZE),
-      medium_pool_(MEDIUM_POOL_SIZE, MEDIUM_BUFFER_SIZE),
-      large_pool_(LARGE_POOL_SIZE, LARGE_BUFFER_SIZE) {
+BufferPool::BufferPool() : BufferPool(Config{}) {}
+
+BufferPool::BufferPool(size_t alignment) : BufferPool(Config{.alignment = alignment}) {}
+
+BufferPool::BufferPool(const Config& config)
+    : alignment_(validate(config).alignment),
+      arena_(createArena(config)),
+      small_pool_(config.small_pool_size, config.small_buffer_size, config.alignment,
+                  arenaSlice(config, 0), config.initial_buffers),
+      medium_pool_(config.medium_pool_size, config.medium_buffer_size, config.alignment,
+                  arenaSlice(config, 1), config.initial_buffers),
+      large_pool_(config.large_pool_size, config.large_buffer_size, config.alignment,
+                  arenaSlice(config, 2), config.initial_buffers) {
+}
+
+const BufferPool::Config& BufferPool::validate(const Config& config) {
+    // acquire() picks the first class that fits and release() matches the capacity exactly
+    if (config.small_buffer_size == 0 ||
+        config.small_buffer_size >= config.medium_buffer_size ||
+        config.medium_buffer_size >= config.large_buffer_size) {
+        throw std::invalid_argument{"buffer sizes must be non-zero and small < medium < large"};
+    }
+    return config;
+}
+
+std::unique_ptr<Arena> BufferPool::createArena(const Config& config) {
+    if (!config.arena) return nullptr;
+
+    size_t size = config.small_pool_size * Pool::slotSize(config.small_buffer_size, config.alignment) +
+                  config.medium_pool_size * Pool::slotSize(config.medium_buffer_size, config.alignment) +
+                  config.large_pool_size * Pool::slotSize(config.large_buffer_size, config.alignment);
+    if (size == 0) return nullptr;
+
+    try {
+        return std::make_unique<Arena>(size, config.lock_arena, config.numa_node);
+    } catch (const std::exception& e) {
+        arena_error_ = e.what();
+        return nullptr;
+    }
+}
+
+// Start of the buffers of pool 0 (small), 1 (medium) or 2 (large) in the arena
+char* BufferPool::arenaSlice(const Config& config, size_t pool) {
+    if (!arena_) return nullptr;
+
+    size_t offset = 0;
+    if (pool > 0) offset += config.small_pool_size * Pool::slotSize(config.small_buffer_size, config.alignment);
+    if (pool > 1) offset += config.medium_pool_size * Pool::slotSize(config.medium_buffer_size, config.alignment);
+    return arena_->data() + offset;
 }
 
 BufferPool::~BufferPool() = default;
 
 std::unique_ptr<Buffer> BufferPool::acquire(size_t required_size) {
-    std::unique_ptr<Buffer> buffer = nullptr;
+    acquired_.fetch_add(1, std::memory_order_relaxed);
 
-    if (required_size <= SMALL_BUFFER_SIZE) {
-        buffer = small_pool_.tryAcquire();
-        if (!buffer) {
-            buffer = createBuffer(SMALL_BUFFER_SIZE);
-        }
-    } else if (required_size <= MEDIUM_BUFFER_SIZE) {
-        buffer = medium_pool_.tryAcquire();
-        if (!buffer) {
-            buffer = createBuffer(MEDIUM_BUFFER_SIZE);
-        }
-    } else if (required_size <= LARGE_BUFFER_SIZE) {
-        buffer = large_pool_.tryAcquire();
-        if (!buffer) {
-            buffer = createBuffer(LARGE_BUFFER_SIZE);
-        }
+    Pool* pool = nullptr;
+    if (required_size <= small_pool_.buffer_size) {
+        pool = &small_pool_;
+    } else if (required_size <= medium_pool_.buffer_size) {
+        pool = &medium_pool_;
+    } else if (required_size <= large_pool_.buffer_size) {
+        pool = &large_pool_;
     } else {
         // For very large requests that exceed all pool sizes
-        buffer = createBuffer(required_size);
+        return createBuffer(required_size);
     }
 
+    pool->noteAcquired();
+    std::unique_ptr<Buffer> buffer = pool->tryAcquire();
+    if (!buffer) {
+        buffer = createBuffer(pool->buffer_size);
+    }
     return buffer;
 }
 
 void BufferPool::release(std::unique_ptr<Buffer> buffer) {
-    if (!buffer) return;
-    
-    bool released = false;
-    
-    if (buffer->capacity == SMALL_BUFFER_SIZE) {
-        released = small_pool_.tryRelease(std::move(buffer));
-    } else if (buffer->capacity == MEDIUM_BUFFER_SIZE) {
-        released = medium_pool_.tryRelease(std::move(buffer));
-    } else if (buffer->capacity == LARGE_BUFFER_SIZE) {
-        released = large_pool_.tryRelease(std::move(buffer));
+    while (buffer) {
+        auto next = std::move(buffer->next);
+        for (Pool* pool : {&small_pool_, &medium_pool_, &large_pool_}) {
+            if (buffer->capacity == pool->buffer_size) {
+                pool->noteReleased();
+                // Destroyed here if the pool is full (or it's a fallback while the pool is fixed)
+                pool->tryRelease(std::move(buffer));
+                break;
+            }
+        }
+        buffer = std::move(next);
     }
-    
-    if (!released) {
-        // Buffer will be destroyed when it goes out of scope
+}
+
+size_t BufferPool::trim() {
+    size_t freed = small_pool_.trim() + medium_pool_.trim() + large_pool_.trim();
+#if defined(__GLIBC__)
+    // Freed buffers mostly sit below the mmap threshold, hand the heap's free pages back too
+    if (freed > 0) ::malloc_trim(0);
+#endif
+    return freed;
+}
+
+bool BufferPool::trimmable() const noexcept {
+    return small_pool_.trimmable() || medium_pool_.trimmable() || large_pool_.trimmable();
+}
+
+void BufferPool::warmUp() {
+    for (Pool* pool : {&small_pool_, &medium_pool_, &large_pool_}) {
+        pool->warmUp();
     }
 }
 
 size_t BufferPool::getTotalBuffers() const {
-    return SMALL_POOL_SIZE + MEDIUM_POOL_SIZE + LARGE_POOL_SIZE;
+    return small_pool_.pool_size + medium_pool_.pool_size + large_pool_.pool_size;
 }
 
 size_t BufferPool::getAvailableBuffers() const {
-    size_t available = 0;
-    
-    for (const auto& buffer : small_pool_.buffers) {
-        if (buffer) ++available;
+    return small_pool_.available() + medium_pool_.available() + large_pool_.available();
+}
+
+std::vector<iovec> BufferPool::prepareFixedBuffers() {
+    std::vector<iovec> iovecs;
+    iovecs.reserve(getTotalBuffers());
+
+    for (Pool* pool : {&small_pool_, &medium_pool_, &large_pool_}) {
+        if (pool->inUse() > 0) {
+            throw std::logic_error("prepareFixedBuffers() called while buffers are in use");
+        }
+        // Registered buffers are never freed nor replaced, the pool is complete from the start
+        pool->fill();
     }
-    for (const auto& buffer : medium_pool_.buffers) {
-        if (buffer) ++available;
+
+    if (arena_) {
+        // Registered as a whole, write_fixed accepts any range inside a registered buffer
+        iovecs.push_back(iovec{arena_->data(), arena_->size()});
     }
-    for (const auto& buffer : large_pool_.buffers) {
-        if (buffer) ++available;
+
+    for (Pool* pool : {&small_pool_, &medium_pool_, &large_pool_}) {
+        pool->forEachBuffer([this, &iovecs](Buffer& buffer) {
+            if (arena_) {
+                buffer.buf_index = 0;
+                return;
+            }
+            buffer.buf_index = static_cast<int>(iovecs.size());
+            iovecs.push_back(iovec{buffer.data, buffer.capacity});
+        });
+        pool->fixed = true;
+    }
+
+    return iovecs;
+}
+
+void BufferPool::clearFixedBuffers() {
+    for (Pool* pool : {&small_pool_, &medium_pool_, &large_pool_}) {
+        pool->forEachBuffer([](Buffer& buffer) { buffer.buf_index = -1; });
+        pool->fixed = false;
     }
-    
-    return available;
 }
 
 std::unique_ptr<Buffer> BufferPool::createBuffer(size_t size) {
-    return std::make_unique<Buffer>(size);
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::make_unique<Buffer>(size, alignment_);
 }
 
 } // namespace MR::Memory
\ No newline at end of file
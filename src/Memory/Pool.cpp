@@ -1,43 +1,160 @@
-
 #include <MR/Memory/Pool.hpp>
 #include <MR/Memory/Buffer.hpp>
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace MR::Memory {
-    
-    Pool::Pool(size_t pool_sz, size_t buf_sz) : next_index(0), pool_size(pool_sz), buffer_size(buf_sz) {
-        buffers.reserve(pool_sz);
-        for (size_t i = 0; i < pool_sz; ++i) {
-            buffers.emplace_back(std::make_unique<Buffer>(buf_sz));
+
+    void Pool::IndexStack::push(uint32_t index) noexcept {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t desired;
+        do {
+            next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            desired = (((head >> 32) + 1) << 32) | index;
+        } while (!head_.compare_exchange_weak(head, desired, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    uint32_t Pool::IndexStack::pop() noexcept {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t index = static_cast<uint32_t>(head);
+            if (index == NONE) return NONE;
+
+            // May be stale if index was popped meanwhile, the tag then fails the CAS
+            uint32_t next = next_[index].load(std::memory_order_relaxed);
+            uint64_t desired = (((head >> 32) + 1) << 32) | next;
+            if (head_.compare_exchange_weak(head, desired, std::memory_order_acquire, std::memory_order_acquire)) {
+                return index;
+            }
         }
     }
-    
-    std::unique_ptr<Buffer> Pool::tryAcquire() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (size_t i = 0; i < pool_size; ++i) {
-            size_t idx = (next_index + i) % pool_size;
-            if (buffers[idx]) {
-                next_index = (idx + 1) % pool_size;
-
-                auto buffer = std::move(buffers[idx]);
-                buffer->clear();
-                return buffer;
+
+    Pool::Pool(size_t pool_sz, size_t buf_sz, size_t alignment, char* storage, size_t initial)
+        : pool_size(pool_sz), buffer_size(buf_sz), full_(pool_sz), empty_(pool_sz),
+          alignment_(alignment), initial_(storage ? pool_sz : std::min(initial, pool_sz)), heap_(storage == nullptr) {
+        if (pool_sz >= IndexStack::NONE) {
+            throw std::invalid_argument("Pool size too large");
+        }
+
+        slots_.resize(pool_sz);
+        for (size_t i = 0; i < initial_; ++i) {
+            if (storage) {
+                slots_[i] = std::make_unique<Buffer>(storage + i * slotSize(buf_sz, alignment), buf_sz);
+            } else {
+                slots_[i] = allocate();
+            }
+        }
+        // Pushed in reverse so the first acquires hand out slot 0, 1, ... and the first
+        // releases fill the empty slots in order
+        for (size_t i = pool_sz; i > initial_; --i) {
+            empty_.push(static_cast<uint32_t>(i - 1));
+        }
+        for (size_t i = initial_; i > 0; --i) {
+            full_.push(static_cast<uint32_t>(i - 1));
+        }
+        available_.store(initial_, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Buffer> Pool::allocate() const {
+        return std::make_unique<Buffer>(buffer_size, alignment_);
+    }
+
+    void Pool::raisePeak(size_t use) noexcept {
+        size_t peak = peak_.load(std::memory_order_relaxed);
+        while (use > peak && !peak_.compare_exchange_weak(peak, use, std::memory_order_relaxed)) {}
+    }
+
+    void Pool::noteAcquired() noexcept {
+        raisePeak(in_use_.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+
+    void Pool::fill() {
+        if (inUse() > 0) {
+            throw std::logic_error("Pool::fill() called while buffers are in use");
+        }
+        while (available() < pool_size) {
+            if (!tryRelease(allocate())) break;
+        }
+    }
+
+    void Pool::warmUp() {
+        // Taken out while being touched, the slots of buffers in use stay free for them
+        std::vector<std::unique_ptr<Buffer>> buffers;
+        while (auto buffer = tryAcquire()) {
+            buffers.push_back(std::move(buffer));
+        }
+        size_t in_use = inUse();
+        while (heap_ && buffers.size() + in_use < pool_size) {
+            buffers.push_back(allocate());
+        }
+        // Counts as use, so the next trim() keeps them and later ones let them go gradually
+        raisePeak(buffers.size() + in_use);
+
+        constexpr size_t PAGE_SIZE = 4096;
+        for (auto& buffer : buffers) {
+            auto* bytes = static_cast<volatile char*>(buffer->data);
+            for (size_t offset = 0; offset < buffer->capacity; offset += PAGE_SIZE) {
+                bytes[offset] = 0;
             }
+            tryRelease(std::move(buffer));
+        }
+    }
+
+    size_t Pool::keepCached() const noexcept {
+        size_t needed = std::max(high_water_, initial_);
+        size_t in_use = inUse();
+        return needed > in_use ? needed - in_use : 0;
+    }
+
+    size_t Pool::trim() {
+        // The window restarts at the current use
+        size_t peak = peak_.exchange(inUse(), std::memory_order_relaxed);
+        high_water_ = std::max(peak, high_water_ / 2);
+        if (!heap_ || fixed) return 0;
+
+        size_t freed = 0;
+        size_t keep = keepCached();
+        while (available() > keep) {
+            auto buffer = tryAcquire();
+            if (!buffer) break;
+            ++freed;
         }
-        return nullptr;
+        return freed;
     }
-    
+
+    bool Pool::trimmable() const noexcept {
+        return heap_ && !fixed && (available() > keepCached() || high_water_ > initial_);
+    }
+
+    std::unique_ptr<Buffer> Pool::tryAcquire() {
+        uint32_t index = full_.pop();
+        if (index == IndexStack::NONE) return nullptr;
+        available_.fetch_sub(1, std::memory_order_relaxed);
+
+        auto buffer = std::move(slots_[index]);
+        empty_.push(index);
+
+        buffer->clear();
+        return buffer;
+    }
+
     bool Pool::tryRelease(std::unique_ptr<Buffer> buffer) {
         if (buffer->capacity != buffer_size) {
             return false;
         }
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (size_t i = 0; i < pool_size; ++i) {
-            if (!buffers[i]) {
-                buffers[i] = std::move(buffer);
-                return true;
-            }
+        if (fixed && buffer->buf_index < 0) {
+            return false;
         }
-        return false;
+
+        uint32_t index = empty_.pop();
+        if (index == IndexStack::NONE) return false;
+
+        slots_[index] = std::move(buffer);
+        // Counted before the slot is visible, so a racing acquire never takes the counter below 0
+        available_.fetch_add(1, std::memory_order_relaxed);
+        full_.push(index);
+        return true;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,73 @@
+#include <MR/Thread/Placement.hpp>
+
+#include <cerrno>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace MR::Thread {
+
+namespace {
+
+// nodeN entries of a sysfs directory
+bool isNodeEntry(const std::string& name) {
+    return name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+           name.find_first_not_of("0123456789", 4) == std::string::npos;
+}
+
+}
+
+int pinCurrentThread(std::span<const int> cpus) noexcept {
+    if (cpus.empty()) return 0;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return -EINVAL;
+        CPU_SET(cpu, &set);
+    }
+
+    // Returns the error number instead of setting errno
+    return -::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+}
+
+int setCurrentScheduling(Scheduling scheduling) noexcept {
+    int policy = SCHED_OTHER;
+    switch (scheduling) {
+        case Scheduling::NORMAL: return 0;
+        case Scheduling::BATCH: policy = SCHED_BATCH; break;
+        case Scheduling::IDLE: policy = SCHED_IDLE; break;
+    }
+
+    // Static priority must be 0 for the non realtime policies. pid 0 is the calling thread
+    sched_param param{};
+    return ::sched_setscheduler(0, policy, &param) == 0 ? 0 : -errno;
+}
+
+int numaNodeOf(int cpu) noexcept {
+    if (cpu < 0) return -1;
+
+    // The CPU directory holds a nodeN link to its node
+    std::error_code ec;
+    std::filesystem::directory_iterator it("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec);
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (isNodeEntry(name)) return std::stoi(name.substr(4));
+    }
+    return -1;
+}
+
+int numaNodeCount() noexcept {
+    int nodes = 0;
+    std::error_code ec;
+    std::filesystem::directory_iterator it("/sys/devices/system/node", ec);
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        if (isNodeEntry(it->path().filename().string())) nodes++;
+    }
+    return nodes;
+}
+
+}
@@ -0,0 +1,91 @@
+// mrlogger-decode: renders Config::encoding = BINARY log files as text
+//
+//   mrlogger-decode [FILE...]     (no FILE or "-" reads stdin)
+//
+// Compressed files can be piped through zstd:  zstd -dc app1.log.zst | mrlogger-decode
+
+#include <MR/IO/BinaryDecoder.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr size_t CHUNK_SIZE = 1 << 20;
+
+bool decodeStream(std::FILE* in, const char* name) {
+  MR::IO::BinaryDecoder decoder;
+  std::vector<char> buffer(CHUNK_SIZE);
+  size_t buffered = 0;
+  std::string out;
+
+  while (true) {
+    size_t n = std::fread(buffer.data() + buffered, 1, buffer.size() - buffered, in);
+    buffered += n;
+
+    size_t consumed = decoder.decode(std::string_view(buffer.data(), buffered), out);
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    out.clear();
+
+    if (!decoder.error().empty()) {
+      std::fprintf(stderr, "mrlogger-decode: %s: %s\n", name, decoder.error().c_str());
+      return false;
+    }
+
+    // Keep the incomplete record for the next read, grow if a single record exceeds the buffer
+    std::memmove(buffer.data(), buffer.data() + consumed, buffered - consumed);
+    buffered -= consumed;
+    if (buffered == buffer.size()) {
+      buffer.resize(buffer.size() * 2);
+    }
+
+    if (n == 0) break;
+  }
+
+  if (std::ferror(in)) {
+    std::fprintf(stderr, "mrlogger-decode: %s: read failed: %s\n", name, std::strerror(errno));
+    return false;
+  }
+  if (buffered > 0) {
+    // The logger was killed in the middle of a write
+    std::fprintf(stderr, "mrlogger-decode: %s: ignoring %zu bytes of a truncated last record\n", name, buffered);
+  }
+  return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+  std::vector<const char*> paths(argv + 1, argv + argc);
+  if (paths.empty()) paths.push_back("-");
+
+  bool ok = true;
+  for (const char* path : paths) {
+    if (std::string_view(path) == "-h" || std::string_view(path) == "--help") {
+      std::printf("Usage: mrlogger-decode [FILE...]\n"
+                  "Renders MR::Logger binary log files (Config::encoding = BINARY) as text.\n"
+                  "With no FILE, or when FILE is -, reads standard input.\n");
+      return 0;
+    }
+
+    if (std::string_view(path) == "-") {
+      ok = decodeStream(stdin, "<stdin>") && ok;
+      continue;
+    }
+
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+      std::fprintf(stderr, "mrlogger-decode: %s: %s\n", path, std::strerror(errno));
+      ok = false;
+      continue;
+    }
+    ok = decodeStream(file, path) && ok;
+    std::fclose(file);
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+// mrlogger-query: prints the lines of text log files logged within a time range, using
+// the timestamp index written next to them (Config::index_interval_bytes)
+//
+//   mrlogger-query [--from TIME] [--until TIME] [--level LEVEL] FILE...
+//
+// TIME is written like the timestamps of the lines, "2026-10-14 10:05:00.250" or any
+// prefix of it: --from is inclusive, --until covers everything starting with it
+// ("--until '2026-10-14 10:05'" includes that minute). --level keeps LEVEL and above.
+// Files without a readable index are scanned in full. Lines in another than the
+// classic layout are filtered by their index block only.
+
+#include <MR/IO/TimestampIndex.hpp>
+#include <MR/Logger/SeverityLevel.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct Filter {
+  std::string from;
+  std::string until;
+  MR::Logger::SEVERITY_LEVEL level = MR::Logger::SEVERITY_LEVEL::TRACE;
+};
+
+// A read only mapping of a whole file, empty if it could not be mapped. error is set
+// unless the file was merely empty
+class MappedInput {
+public:
+  explicit MappedInput(const char* path) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      error_ = std::strerror(errno);
+      return;
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) < 0) {
+      error_ = std::strerror(errno);
+    } else if (st.st_size > 0) {
+      void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        error_ = std::strerror(errno);
+      } else {
+        data_ = static_cast<const char*>(data);
+        size_ = static_cast<size_t>(st.st_size);
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+      }
+    }
+    ::close(fd);
+  }
+
+  ~MappedInput() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+  }
+
+  MappedInput(const MappedInput&) = delete;
+  MappedInput& operator=(const MappedInput&) = delete;
+
+  std::string_view bytes() const { return {data_, size_}; }
+  const std::string& error() const { return error_; }
+
+private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  std::string error_;
+};
+
+std::optional<MR::Logger::SEVERITY_LEVEL> parseLevel(std::string_view name) {
+  std::string upper(name);
+  std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+  for (size_t i = 0; i < MR::Logger::SEVERITY_NAMES.size(); ++i) {
+    if (MR::Logger::SEVERITY_NAMES[i] == upper) return static_cast<MR::Logger::SEVERITY_LEVEL>(i);
+  }
+  return std::nullopt;
+}
+
+// "[<timestamp>] [<level>] ..." of the classic layout, false for other layouts
+bool parseClassic(std::string_view line, std::string_view& timestamp, std::string_view& level) {
+  if (line.size() < 2 || line[0] != '[') return false;
+  size_t close = line.find(']');
+  if (close == std::string_view::npos || line.substr(close + 1, 2) != " [") return false;
+  size_t level_close = line.find(']', close + 3);
+  if (level_close == std::string_view::npos) return false;
+
+  timestamp = line.substr(1, close - 1);
+  level = line.substr(close + 3, level_close - close - 3);
+  return true;
+}
+
+bool matches(std::string_view line, const Filter& filter) {
+  std::string_view timestamp;
+  std::string_view level_name;
+  if (!parseClassic(line, timestamp, level_name)) return true;
+
+  if (MR::IO::beforeFrom(timestamp, filter.from) || MR::IO::afterUntil(timestamp, filter.until)) return false;
+  auto level = parseLevel(level_name);
+  return !level || *level >= filter.level;
+}
+
+bool queryFile(const char* path, const Filter& filter) {
+  MappedInput log(path);
+  if (!log.error().empty()) {
+    std::fprintf(stderr, "mrlogger-query: %s: %s\n", path, log.error().c_str());
+    return false;
+  }
+
+  std::string_view text = log.bytes();
+  MR::IO::ByteRange range{0, text.size()};
+
+  // Without an index (or with a damaged one) the whole file is scanned
+  MappedInput index(MR::IO::indexPath(path).c_str());
+  if (index.error().empty() && !index.bytes().empty()) {
+    if (auto entries = MR::IO::readIndex(index.bytes())) {
+      range = MR::IO::indexRange(*entries, text.size(), filter.from, filter.until);
+    } else {
+      std::fprintf(stderr, "mrlogger-query: %s: not a timestamp index, scanning %s\n",
+                   MR::IO::indexPath(path).c_str(), path);
+    }
+  }
+
+  text = text.substr(range.begin, range.end - range.begin);
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    if (!line.empty() && matches(line, filter)) {
+      std::fwrite(line.data(), 1, line.size(), stdout);
+      std::fputc('\n', stdout);
+    }
+    if (end == std::string_view::npos) break;
+    text.remove_prefix(end + 1);
+  }
+  return true;
+}
+
+void usage() {
+  std::printf("Usage: mrlogger-query [--from TIME] [--until TIME] [--level LEVEL] FILE...\n"
+              "Prints the lines of MR::Logger text log files logged within a time range, seeking\n"
+              "through the timestamp index next to each file (Config::index_interval_bytes).\n"
+              "TIME is written like the line timestamps or a prefix of them, e.g. \"2026-10-14 10:05\".\n"
+              "--from is inclusive, --until includes every timestamp starting with it.\n"
+              "--level keeps LEVEL (TRACE, DEBUG, INFO, WARN, ERROR) and above.\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+  Filter filter;
+  std::vector<const char*> paths;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (arg == "-h" || arg == "--help") {
+      usage();
+      return 0;
+    }
+
+    bool has_value = arg == "--from" || arg == "--until" || arg == "--level";
+    if (has_value && i + 1 >= argc) {
+      std::fprintf(stderr, "mrlogger-query: %s needs a value\n", argv[i]);
+      return 2;
+    }
+
+    if (arg == "--from") {
+      filter.from = argv[++i];
+    } else if (arg == "--until") {
+      filter.until = argv[++i];
+    } else if (arg == "--level") {
+      auto level = parseLevel(argv[++i]);
+      if (!level) {
+        std::fprintf(stderr, "mrlogger-query: unknown level %s\n", argv[i]);
+        return 2;
+      }
+      filter.level = *level;
+    } else if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".idx") {
+      continue;  // A shell glob picked up the index files too
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+
+  if (paths.empty()) {
+    usage();
+    return 2;
+  }
+
+  // Output is usually piped, write it in large blocks
+  static char out_buffer[1 << 16];
+  std::setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+  bool ok = true;
+  for (const char* path : paths) {
+    ok = queryFile(path, filter) && ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -2,19 +2,115 @@
 #include <gmock/gmock.h>
 #include <MR/Logger/Logger.hpp>
 #include <MR/Logger/Config.hpp>
+#include <MR/IO/BinaryDecoder.hpp>
 #include <thread>
 #include <chrono>
 #include <fstream>
 #include <filesystem>
 #include <vector>
+#include <map>
+#include <set>
+#include <sstream>
 #include <barrier>
 
+#include <sched.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #ifdef LOGGER_TEST_SEQUENCE_TRACKING
 #include <MR/Queue/StdQueue.hpp>
+
+#ifdef MRLOGGER_HAS_ZSTD
+#include <zstd.h>
+#endif
 #endif
 
 namespace MR::Logger::Test {
 
+// Holds everything back from the worker until resumed, so a test decides when it catches up
+class PausableQueue : public Queue::StdQueue<WriteRequest> {
+public:
+    std::atomic<bool> paused{true};
+
+    std::optional<WriteRequest> tryPop() override {
+        return paused.load() ? std::nullopt : StdQueue::tryPop();
+    }
+
+    size_t tryPopBatch(std::span<WriteRequest> out) override {
+        return paused.load() ? 0 : StdQueue::tryPopBatch(out);
+    }
+};
+
+// A collector on an ephemeral loopback port, bound right away and listening once listen() is called
+class LocalCollector {
+public:
+    explicit LocalCollector(int type) : fd_{::socket(AF_INET, type | SOCK_CLOEXEC, 0)} {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        EXPECT_EQ(::bind(fd_, reinterpret_cast<sockaddr*>(&address), length), 0);
+        EXPECT_EQ(::getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length), 0);
+        port_ = ntohs(address.sin_port);
+    }
+    ~LocalCollector() { ::close(fd_); }
+
+    uint16_t port() const { return port_; }
+    void listen() { EXPECT_EQ(::listen(fd_, 4), 0); }
+
+    // TCP: the next connection, -1 if none arrives within timeout
+    int accept(std::chrono::milliseconds timeout) {
+        pollfd ready{fd_, POLLIN, 0};
+        if (::poll(&ready, 1, static_cast<int>(timeout.count())) <= 0) return -1;
+        return ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    }
+
+    // TCP: the lines of the frames on connection until the logger closes it
+    static std::vector<std::string> readFrames(int connection) {
+        std::string stream;
+        char chunk[65536];
+        pollfd ready{connection, POLLIN, 0};
+        while (::poll(&ready, 1, 10000) > 0) {
+            ssize_t n = ::read(connection, chunk, sizeof(chunk));
+            if (n <= 0) break;
+            stream.append(chunk, static_cast<size_t>(n));
+        }
+
+        std::vector<std::string> lines;
+        size_t position = 0;
+        while (stream.size() - position >= 4) {
+            auto byte = [&](size_t i) { return static_cast<uint32_t>(static_cast<unsigned char>(stream[position + i])); };
+            uint32_t length = byte(0) << 24 | byte(1) << 16 | byte(2) << 8 | byte(3);
+            if (stream.size() - position - 4 < length) break;
+
+            std::istringstream frame(stream.substr(position + 4, length));
+            for (std::string line; std::getline(frame, line);) lines.push_back(line);
+            position += 4 + length;
+        }
+        return lines;
+    }
+
+    // UDP: up to count datagrams, fewer if none arrives for timeout
+    std::vector<std::string> receive(size_t count, std::chrono::milliseconds timeout) {
+        std::vector<std::string> datagrams;
+        char datagram[65536];
+        pollfd ready{fd_, POLLIN, 0};
+        while (datagrams.size() < count && ::poll(&ready, 1, static_cast<int>(timeout.count())) > 0) {
+            ssize_t n = ::recv(fd_, datagram, sizeof(datagram), 0);
+            if (n < 0) break;
+            datagrams.emplace_back(datagram, static_cast<size_t>(n));
+        }
+        return datagrams;
+    }
+
+private:
+    int fd_;
+    uint16_t port_ = 0;
+};
+
 class LoggerIntegrationTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -60,6 +156,25 @@ protected:
         return lines;
     }
 
+    // Renders a Config::encoding = BINARY file like mrlogger-decode
+    static std::vector<std::string> decodeBinaryFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        IO::BinaryDecoder decoder;
+        std::string text;
+        EXPECT_EQ(decoder.decode(data, text), data.size()) << path;
+        EXPECT_EQ(decoder.error(), "") << path;
+
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
     void waitForLogCompletion(int expected_messages) {
         auto start = std::chrono::steady_clock::now();
         const std::chrono::seconds timeout{5};
@@ -359,6 +474,255 @@ TEST_F(LoggerIntegrationTest, FlushMultiThreaded) {
     ASSERT_EQ(lines.size(), num_threads * messages_per_thread);
 }
 
+TEST_F(LoggerIntegrationTest, FlushReturnsUnderContinuousLoad) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    // The queue never drains while this thread logs
+    std::atomic<bool> stop{false};
+    std::thread noise([&logger, &stop]() {
+        while (!stop.load(std::memory_order_relaxed)) logger->info("Noise");
+    });
+
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 100; ++i) logger->info("Mine {} {}", round, i);
+
+        ASSERT_TRUE(logger->flush(std::chrono::seconds(10))) << "round " << round;
+
+        auto lines = readLogFile();
+        size_t mine = std::count_if(lines.begin(), lines.end(), [round](const std::string& line) {
+            return line.find("Mine " + std::to_string(round) + " ") != std::string::npos;
+        });
+        EXPECT_EQ(mine, 100u) << "round " << round;
+    }
+    logger->flush();
+
+    stop.store(true);
+    noise.join();
+    logger.reset();
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, FlushAsync) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.worker_count = 2;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    // Nothing logged yet: the callback runs right away
+    bool called = false;
+    logger->flushAsync([&called]() { called = true; });
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(logger->flush(std::chrono::milliseconds(0)));
+
+    for (int i = 0; i < 1000; ++i) logger->info("Async {}", i);
+    auto flushed = logger->flushAsync();
+    ASSERT_EQ(flushed.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+    // Both shards wrote everything logged before
+    auto shard_file = std::filesystem::temp_directory_path() / "logger_integration_test.1.log";
+    size_t lines = readLogFile().size();
+    std::ifstream shard(shard_file);
+    std::string line;
+    while (std::getline(shard, line)) lines++;
+    EXPECT_EQ(lines, 1000u);
+
+    logger.reset();
+    Logger::_reset();
+    std::filesystem::remove(shard_file);
+}
+
+TEST_F(LoggerIntegrationTest, AutotuneWritesLightTrafficWithoutFlush) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.autotune = true;
+    custom_config.autotune_max_delay_us = 2000;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    // A burst is held for more messages, every line still arrives
+    const size_t burst = 20000;
+    for (size_t i = 0; i < burst; ++i) logger->info("Burst {}", i);
+    logger->flush();
+    EXPECT_EQ(readLogFile().size(), burst);
+    EXPECT_GT(logger->stats().coalescingRatio(), 1.0);
+
+    // Sparse messages are written by themselves, no flush needed
+    for (int i = 0; i < 5; ++i) {
+        logger->info("Sparse {}", i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (readLogFile().size() < burst + 5 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), burst + 5);
+    EXPECT_THAT(lines.back(), testing::HasSubstr("Sparse 4"));
+
+    logger.reset();
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, NetworkSinkStreamsTheFileOverTcp) {
+    Logger::_reset();
+
+    LocalCollector collector(SOCK_STREAM);
+    collector.listen();
+
+    Config custom_config = config_;
+    custom_config.network_sinks = {{.host = "127.0.0.1", .port = collector.port()}};
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    int connection = collector.accept(std::chrono::seconds(5));
+    ASSERT_GE(connection, 0);
+    std::vector<std::string> received;
+    std::thread reader([&]() { received = LocalCollector::readFrames(connection); });
+
+    const size_t total = 5000;
+    for (size_t i = 0; i < total; ++i) logger->info("Network message {}", i);
+    logger->flush();
+    EXPECT_EQ(logger->stats().messages_written, total);  // Formatted once
+
+    // Stopping sends what is pending, then closes the connection
+    logger.reset();
+    Logger::_reset();
+
+    reader.join();
+    ::close(connection);
+    EXPECT_EQ(received, readLogFile());
+    EXPECT_EQ(received.size(), total);
+}
+
+TEST_F(LoggerIntegrationTest, NetworkSinkConnectsLateAndReconnects) {
+    Logger::_reset();
+
+    // Bound but not listening yet: the first connects are refused
+    LocalCollector collector(SOCK_STREAM);
+
+    std::vector<std::string> errors;
+    std::mutex errors_mutex;
+    Config custom_config = config_;
+    custom_config.internal_error_handler = [&](const std::string& message) {
+        std::lock_guard<std::mutex> lock(errors_mutex);
+        errors.push_back(message);
+    };
+    custom_config.network_sinks = {{.host = "127.0.0.1", .port = collector.port()}};
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    for (int i = 0; i < 100; ++i) logger->info("Before listening {}", i);
+    logger->flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    collector.listen();
+
+    // Pending lines are sent once the retry connects
+    int first = collector.accept(std::chrono::seconds(5));
+    ASSERT_GE(first, 0);
+    ::shutdown(first, SHUT_RDWR);
+    ::close(first);
+
+    // Sends on the lost connection fail, the sink reconnects
+    int second = -1;
+    for (int i = 0; i < 500 && second < 0; ++i) {
+        logger->info("While reconnecting {}", i);
+        second = collector.accept(std::chrono::milliseconds(10));
+    }
+    ASSERT_GE(second, 0);
+    std::vector<std::string> received;
+    std::thread reader([&]() { received = LocalCollector::readFrames(second); });
+
+    logger->info("After reconnecting");
+    logger->flush();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (logger->stats().network_reconnects == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(logger->stats().network_reconnects, 1u);
+
+    logger.reset();
+    Logger::_reset();
+
+    reader.join();
+    ::close(second);
+    ASSERT_FALSE(received.empty());
+    EXPECT_THAT(received.back(), testing::HasSubstr("After reconnecting"));
+
+    std::lock_guard<std::mutex> lock(errors_mutex);
+    EXPECT_EQ(std::count_if(errors.begin(), errors.end(), [](const std::string& e) {
+        return e.find("Failed to connect") != std::string::npos;
+    }), 1);
+}
+
+TEST_F(LoggerIntegrationTest, NetworkSinkSendsSyslogDatagrams) {
+    Logger::_reset();
+
+    LocalCollector collector(SOCK_DGRAM);
+
+    Config custom_config = config_;
+    custom_config.log_file_severities = severitiesFrom(SEVERITY_LEVEL::WARN);
+    custom_config.network_sinks = {{
+        .host = "127.0.0.1",
+        .port = collector.port(),
+        .protocol = NetworkProtocol::UDP_SYSLOG,
+        .syslog_facility = 16,
+        .syslog_severity = 4
+    }};
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    // Only what the source file gets is sent
+    const size_t total = 200;
+    for (size_t i = 0; i < total; ++i) {
+        logger->warn("Datagram {}", i);
+        logger->info("Not sent {}", i);
+    }
+
+    auto datagrams = collector.receive(total, std::chrono::seconds(5));
+    ASSERT_EQ(datagrams.size(), total);
+
+    // The datagrams may all be out before the file write completed
+    logger->flush();
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), total);
+    for (size_t i = 0; i < total; ++i) {
+        EXPECT_EQ(datagrams[i], "<132>" + lines[i]);
+    }
+
+    logger.reset();
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, NetworkSinkRejectsUnsupportedModes) {
+    Logger::_reset();
+
+    Config binary = config_;
+    binary.encoding = LogEncoding::BINARY;
+    binary.network_sinks = {{.host = "127.0.0.1", .port = 5140}};
+    EXPECT_THROW(Logger::create("network_binary", binary), std::invalid_argument);
+
+    Config unknown = config_;
+    unknown.network_sinks = {{.host = "127.0.0.1", .port = 5140, .source_file = "/tmp/not_a_log_file.log"}};
+    EXPECT_THROW(Logger::create("network_unknown", unknown), std::invalid_argument);
+
+    Config unresolved = config_;
+    unresolved.network_sinks = {{.host = "nonexistent.invalid", .port = 5140}};
+    EXPECT_THROW(Logger::create("network_unresolved", unresolved), std::runtime_error);
+}
+
 #ifdef LOGGER_TEST_SEQUENCE_TRACKING
 TEST_F(LoggerIntegrationTest, SequenceNumberOrderingWithoutSync) {
     auto logger = Logger::get();
@@ -611,4 +975,1967 @@ TEST_F(LoggerIntegrationTest, IncrementalSmallBatches) {
     EXPECT_THAT(lines[4], testing::HasSubstr("Batch2-Message3"));
 }
 
-}
\ No newline at end of file
+TEST_F(LoggerIntegrationTest, DeferredFormattingMatchesEagerOutput) {
+    Logger::_reset();
+
+    auto deferred_log_file = std::filesystem::temp_directory_path() / "logger_deferred_test.log";
+    if (std::filesystem::exists(deferred_log_file)) {
+        std::filesystem::remove(deferred_log_file);
+    }
+
+    Config custom_config = config_;
+    custom_config.log_file_name = deferred_log_file.string();
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.deferred_formatting = true;
+
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    std::string owned = "owned";
+    logger->info("Deferred {} {:.1f} {}", 7, 2.25, true);
+    logger->warn("Eager {} {}", owned, 3);
+    logger->error("Deferred error code={}", -5);
+    logger->flush();
+
+    std::ifstream file(deferred_log_file);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    file.close();
+
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_THAT(lines[0], testing::HasSubstr("[INFO]"));
+    EXPECT_THAT(lines[0], testing::EndsWith("]: Deferred 7 2.2 true"));
+    EXPECT_THAT(lines[1], testing::HasSubstr("[WARN]"));
+    EXPECT_THAT(lines[1], testing::EndsWith("]: Eager owned 3"));
+    EXPECT_THAT(lines[2], testing::HasSubstr("[ERROR]"));
+    EXPECT_THAT(lines[2], testing::EndsWith("]: Deferred error code=-5"));
+
+    if (std::filesystem::exists(deferred_log_file)) {
+        std::filesystem::remove(deferred_log_file);
+    }
+}
+
+TEST_F(LoggerIntegrationTest, CompiledLayout) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.deferred_formatting = true;
+    custom_config.layout = IO::makeLayout<"%L %m">();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    logger->warn("Layout message {}", 1);
+    logger->error("Layout message {}", std::string("two"));
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "WARN Layout message 1");
+    EXPECT_EQ(lines[1], "ERROR Layout message two");
+}
+
+TEST_F(LoggerIntegrationTest, StructuredFields) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    std::string route = "/api/users";
+    logger->info("request done", kv("latency_us", 125), kv("route", route), kv("ok", true));
+    logger->debug("filtered", kv("n", 1));
+    logger->warn("many fields", kv("a", 1), kv("b", 2), kv("c", 3), kv("d", 4), kv("e", "x y"));
+    logger->flush();
+    Logger::_reset();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_THAT(lines[0], testing::EndsWith("]: request done latency_us=125 route=/api/users ok=true"));
+    EXPECT_THAT(lines[1], testing::EndsWith(R"(]: many fields a=1 b=2 c=3 d=4 e="x y")"));
+
+    // Binary encoding keeps them as text records
+    custom_config.encoding = LogEncoding::BINARY;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    std::filesystem::remove(test_log_file_);
+    Logger::init(custom_config);
+    Logger::get()->error("failed", kv("code", -2), kv("path", "/tmp/a"));
+    Logger::get()->flush();
+    Logger::_reset();
+
+    auto decoded = decodeBinaryFile(test_log_file_);
+    ASSERT_EQ(decoded.size(), 1u);
+    EXPECT_THAT(decoded[0], testing::EndsWith("]: failed code=-2 path=/tmp/a"));
+}
+
+TEST_F(LoggerIntegrationTest, RuntimeSeverityFilter) {
+    auto logger = Logger::get();
+
+    // Default runtime floor is INFO
+    EXPECT_EQ(logger->getMinSeverity(), SEVERITY_LEVEL::INFO);
+    logger->trace("hidden trace");
+    logger->debug("hidden debug {}", 1);
+    logger->info("visible info");
+
+    logger->setMinSeverity(SEVERITY_LEVEL::TRACE);
+    logger->trace("visible trace");
+    logger->debug("visible debug {}", 2);
+
+    logger->setMinSeverity(SEVERITY_LEVEL::ERROR);
+    logger->warn("hidden warn");
+    logger->error("visible error");
+
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_THAT(lines[0], testing::HasSubstr("[INFO]"));
+    EXPECT_THAT(lines[1], testing::HasSubstr("[TRACE]"));
+    EXPECT_THAT(lines[2], testing::HasSubstr("visible debug 2"));
+    EXPECT_THAT(lines[2], testing::HasSubstr("[DEBUG]"));
+    EXPECT_THAT(lines[3], testing::HasSubstr("[ERROR]"));
+    EXPECT_THAT(lines, testing::Not(testing::Contains(testing::HasSubstr("hidden"))));
+}
+
+TEST_F(LoggerIntegrationTest, DisabledMacroSkipsArgumentEvaluation) {
+    auto logger = Logger::get();
+    int evaluations = 0;
+    auto expensive = [&evaluations]() { return ++evaluations; };
+
+    MRLOG_DEBUG(logger, "debug {}", expensive());
+    EXPECT_EQ(evaluations, 0);
+
+    MRLOG_INFO(logger, "info {}", expensive());
+    EXPECT_EQ(evaluations, 1);
+
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_THAT(lines[0], testing::HasSubstr("info 1"));
+}
+
+TEST_F(LoggerIntegrationTest, RateLimitedMacrosReportSuppressions) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.suppression_report_ms = 50;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    int evaluations = 0;
+    auto expensive = [&evaluations]() { return ++evaluations; };
+
+    int every_line = 0;
+    int first_line = 0;
+    for (int i = 0; i < 1000; ++i) {
+        every_line = __LINE__ + 1;
+        MRLOG_EVERY_N(logger, 100, WARN, "every {} {}", i, expensive());
+        first_line = __LINE__ + 1;
+        MRLOG_FIRST_N(logger, 3, ERROR, "first {}", i);
+        MRLOG_EVERY_N(logger, 10, DEBUG, "filtered {}", i);  // Below INFO, neither logged nor counted
+    }
+    EXPECT_EQ(evaluations, 10);
+
+    // The idle worker wakes up for the report
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    logger->flush();
+
+    auto lines = readLogFile();
+    auto count = [&](const std::string& text) {
+        return std::count_if(lines.begin(), lines.end(), [&](const auto& line) { return line.find(text) != std::string::npos; });
+    };
+    EXPECT_EQ(count("]: every "), 10);
+    EXPECT_EQ(count("]: first "), 3);
+    EXPECT_EQ(count("filtered"), 0);
+    EXPECT_EQ(count("[WARN] [Thread: "), 11);
+
+    std::string file = std::filesystem::path(__FILE__).filename().string();
+    EXPECT_EQ(count(fmt::format("[MrLogger] suppressed 990 similar messages at {}:{}", file, every_line)), 1);
+    EXPECT_EQ(count(fmt::format("[MrLogger] suppressed 997 similar messages at {}:{}", file, first_line)), 1);
+    EXPECT_EQ(count("suppressed"), 2);
+}
+
+TEST_F(LoggerIntegrationTest, MinSeverityFromConfig) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.min_severity = SEVERITY_LEVEL::DEBUG;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    EXPECT_EQ(logger->getMinSeverity(), SEVERITY_LEVEL::DEBUG);
+    EXPECT_TRUE(logger->shouldLog(SEVERITY_LEVEL::DEBUG));
+    EXPECT_FALSE(logger->shouldLog(SEVERITY_LEVEL::TRACE));
+}
+
+TEST_F(LoggerIntegrationTest, RegisteredFixedBuffers) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.register_buffers = true;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 300; ++i) {
+        logger->info("Fixed buffer message {}", i);
+    }
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 300);
+    EXPECT_THAT(lines[0], testing::HasSubstr("Fixed buffer message 0"));
+    EXPECT_THAT(lines[299], testing::HasSubstr("Fixed buffer message 299"));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("write failed"))));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("fixed buffers"))));
+
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, UncoalescedWritesAreGathered) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.coalesce_size = 1;  // One buffer per message, sent out as writev batches
+    custom_config.durability = DurabilityMode::ERRORS;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 2000; ++i) {
+        if (i % 500 == 499) {
+            logger->error("Gathered message {}", i);
+        } else {
+            logger->info("Gathered message {}", i);
+        }
+    }
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 2000u);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        ASSERT_THAT(lines[i], testing::EndsWith("Gathered message " + std::to_string(i)));
+    }
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("failed"))));
+
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, SleepingWorkerWakesForMessages) {
+    for (uint32_t spin_us : {0u, 200u}) {
+        Logger::_reset();
+
+        std::vector<std::string> errors;
+        Config custom_config = config_;
+        custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+        custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+        custom_config.idle_spin_us = spin_us;
+        Logger::init(custom_config);
+
+        // Between the bursts the worker runs out of work and sleeps on the eventfd
+        auto logger = Logger::get();
+        for (int burst = 0; burst < 20; ++burst) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            for (int i = 0; i < 10; ++i) {
+                logger->info("Wakeup message {}", burst * 10 + i);
+            }
+            if (burst % 5 == 4) logger->flush();
+        }
+        logger->flush();
+
+        auto lines = readLogFile();
+        ASSERT_EQ(lines.size(), 200u);
+        for (size_t i = 0; i < lines.size(); ++i) {
+            ASSERT_THAT(lines[i], testing::EndsWith("Wakeup message " + std::to_string(i)));
+        }
+        EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("eventfd"))));
+
+        Logger::_reset();
+        std::filesystem::remove(config_.log_file_name);
+    }
+}
+
+TEST_F(LoggerIntegrationTest, RegisteredBufferArena) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.register_buffers = true;
+    custom_config.buffer_arena = true;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 3000; ++i) {
+        logger->info("Arena buffer message {}", i);
+    }
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 3000u);
+    EXPECT_THAT(lines[0], testing::HasSubstr("Arena buffer message 0"));
+    EXPECT_THAT(lines[2999], testing::HasSubstr("Arena buffer message 2999"));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("write failed"))));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("arena"))));
+
+    logger.reset();
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, PinnedWorkerOnNumaNode) {
+    Logger::_reset();
+
+    cpu_set_t allowed;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &allowed)) cpu++;
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.worker_cpus = {cpu};
+    custom_config.numa_node = 0;  // Also carves the pool out of an arena
+    custom_config.worker_scheduling = Thread::Scheduling::BATCH;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 3000; ++i) {
+        logger->info("Pinned worker message {}", i);
+    }
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 3000u);
+    EXPECT_THAT(lines[2999], testing::HasSubstr("Pinned worker message 2999"));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("worker thread"))));
+
+    logger.reset();
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, CrashRingReplaysUnwrittenData) {
+    Logger::_reset();
+
+    auto ring_file = std::filesystem::temp_directory_path() / "logger_crash_ring_test.ring";
+    std::filesystem::remove(ring_file);
+    {
+        // What a process that died with two writes in flight leaves behind
+        IO::CrashRing ring(ring_file.string(), 64 * 1024);
+        std::string written = "written before the crash\n";
+        std::string lost = "lost line 1\nlost line 2\n";
+        ring.complete(ring.append(0, written.data(), written.size()));
+        ring.append(0, lost.data(), lost.size());
+    }
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.crash_ring_file = ring_file.string();
+    custom_config.crash_ring_size = 64 * 1024;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 500; ++i) {
+        logger->info("After restart {}", i);
+    }
+    logger->flush();
+    logger.reset();
+    Logger::_reset();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 502u);
+    EXPECT_EQ(lines[0], "lost line 1");
+    EXPECT_EQ(lines[1], "lost line 2");
+    EXPECT_THAT(lines[501], testing::HasSubstr("After restart 499"));
+    EXPECT_THAT(errors, testing::Contains(testing::HasSubstr("appended 24 bytes")));
+
+    // Every write of this run completed, nothing is left for the next one
+    EXPECT_TRUE(IO::CrashRing(ring_file.string(), 64 * 1024).recovered().empty());
+
+    Config direct = custom_config;
+    direct.direct_io = true;
+    EXPECT_THROW(Logger::create("crash_ring_direct", direct), std::invalid_argument);
+
+    std::filesystem::remove(ring_file);
+}
+
+TEST_F(LoggerIntegrationTest, RotationUpdatesRegisteredFile) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_registered_file_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "rotation.log").string();
+    custom_config.max_log_size_bytes = 4096;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    const int total = 2000;
+    for (int i = 0; i < total; ++i) {
+        logger->info("Rotating message {}", i);
+        if (i % 100 == 99) logger->flush();
+    }
+    logger->flush();
+    Logger::_reset();
+
+    size_t files = 0;
+    size_t lines = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::ifstream file(entry.path());
+        std::string line;
+        while (std::getline(file, line)) {
+            EXPECT_THAT(line, testing::HasSubstr("Rotating message"));
+            lines++;
+        }
+        files++;
+    }
+
+    EXPECT_GT(files, 1u);
+    EXPECT_EQ(lines, static_cast<size_t>(total));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("error code"))));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, RotationUsesPreOpenedStandbyFile) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_standby_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "standby.log").string();
+    custom_config.max_log_size_bytes = 8192;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    const int total = 3000;
+    for (int i = 0; i < total; ++i) {
+        logger->info("Standby message {}", i);
+        if (i % 50 == 49) logger->flush();
+    }
+    logger->flush();
+
+    // Halfway through the current file the next one is already open
+    EXPECT_TRUE(std::filesystem::exists(dir / "standby1.log"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "standby2.log"));
+
+    logger.reset();
+    Logger::_reset();
+
+    // The unused standby is removed on shutdown, every line landed in a numbered file or the base file
+    EXPECT_FALSE(std::filesystem::exists(dir / "standby.log.next"));
+
+    std::set<int> seen;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::ifstream file(entry.path());
+        std::string line;
+        while (std::getline(file, line)) {
+            auto pos = line.rfind(' ');
+            ASSERT_NE(pos, std::string::npos);
+            seen.insert(std::stoi(line.substr(pos + 1)));
+        }
+    }
+
+    EXPECT_EQ(seen.size(), static_cast<size_t>(total));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("rotateFile"))));
+
+    std::filesystem::remove_all(dir);
+}
+
+// Every entry of an index file points at the start of a line logged at its timestamp
+static void expectIndexMatches(const std::filesystem::path& log_path, bool file_started_empty) {
+    std::ifstream log_file(log_path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    std::ifstream index_file(IO::indexPath(log_path.string()), std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(index_file)), std::istreambuf_iterator<char>());
+
+    auto entries = IO::readIndex(bytes);
+    ASSERT_TRUE(entries.has_value()) << log_path;
+    ASSERT_FALSE(entries->empty()) << log_path;
+    EXPECT_EQ(bytes.size(), IO::INDEX_MAGIC.size() + entries->size() * sizeof(IO::IndexEntry));
+
+    for (size_t i = 0; i < entries->size(); ++i) {
+        const auto& entry = (*entries)[i];
+        ASSERT_LT(entry.offset, text.size()) << log_path;
+        if (entry.offset > 0) {
+            EXPECT_EQ(text[entry.offset - 1], '\n') << log_path << " entry " << i;
+        }
+        EXPECT_TRUE(text.substr(entry.offset).starts_with("[" + IO::renderTimestamp(entry.timestamp_ns) + "]"))
+            << log_path << " entry " << i;
+        if (file_started_empty) {
+            EXPECT_EQ(entry.message, static_cast<uint64_t>(std::count(text.begin(), text.begin() + entry.offset, '\n')));
+        }
+        if (i > 0) {
+            EXPECT_GT(entry.offset, (*entries)[i - 1].offset);
+        }
+    }
+}
+
+TEST_F(LoggerIntegrationTest, TimestampIndexPointsAtLineStarts) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.index_interval_bytes = 4096;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    std::filesystem::path index_path = IO::indexPath(test_log_file_.string());
+
+    auto logger = Logger::get();
+    const size_t total = 20000;
+    for (size_t i = 0; i < total; ++i) {
+        logger->info("Indexed message {}", i);
+        if (i % 1000 == 999) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    logger->flush();
+    logger.reset();
+    Logger::_reset();
+
+    expectIndexMatches(test_log_file_, true);
+
+    std::ifstream index_file(index_path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(index_file)), std::istreambuf_iterator<char>());
+    auto entries = *IO::readIndex(bytes);
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), total);
+    EXPECT_GT(entries.size(), 10u);
+    for (size_t i = 1; i < entries.size(); ++i) {
+        EXPECT_GE(entries[i].offset - entries[i - 1].offset, 4096u);
+    }
+
+    // The range around a line in the middle starts before and ends after it
+    const std::string& middle = lines[total / 2];
+    std::string timestamp = middle.substr(1, middle.find(']') - 1);
+    uint64_t file_size = std::filesystem::file_size(test_log_file_);
+    auto range = IO::indexRange(entries, file_size, timestamp, timestamp);
+    std::ifstream log_file(test_log_file_, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    size_t position = text.find(middle);
+    EXPECT_LE(range.begin, position);
+    EXPECT_GE(range.end, position + middle.size());
+
+    std::filesystem::remove(index_path);
+}
+
+TEST_F(LoggerIntegrationTest, TimestampIndexFollowsRotation) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_index_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "indexed.log").string();
+    custom_config.max_log_size_bytes = 8192;
+    custom_config.index_interval_bytes = 1024;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 3000; ++i) {
+        logger->info("Rotated index message {}", i);
+        if (i % 50 == 49) logger->flush();
+    }
+    logger.reset();
+    Logger::_reset();
+
+    // Every log file has its own index, and the one of the unused standby is gone too
+    size_t log_files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() != ".log") continue;
+        ++log_files;
+        expectIndexMatches(entry.path(), true);
+    }
+    EXPECT_GT(log_files, 3u);
+    EXPECT_FALSE(std::filesystem::exists(dir / "indexed.log.next.idx"));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("rotateFile"))));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, TimestampIndexRejectsUnsupportedModes) {
+    Logger::_reset();
+
+    Config binary = config_;
+    binary.encoding = LogEncoding::BINARY;
+    binary.index_interval_bytes = 65536;
+    EXPECT_THROW(Logger::create("index_binary", binary), std::invalid_argument);
+
+    Config direct = config_;
+    direct.direct_io = true;
+    direct.index_interval_bytes = 65536;
+    EXPECT_THROW(Logger::create("index_direct", direct), std::invalid_argument);
+
+    Config compressed = config_;
+    compressed.compression = CompressionMode::ROTATED;
+    compressed.index_interval_bytes = 65536;
+    EXPECT_THROW(Logger::create("index_compressed", compressed), std::invalid_argument);
+}
+
+TEST_F(LoggerIntegrationTest, CompressionWithoutZstdWarns) {
+    if (IO::compressionAvailable()) GTEST_SKIP() << "built with zstd";
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.compression = CompressionMode::ROTATED;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    logger->info("Still written uncompressed");
+    logger->flush();
+    EXPECT_EQ(logger->compressionBacklog().files, 0u);
+    logger.reset();
+    Logger::_reset();
+
+    EXPECT_THAT(errors, testing::Contains(testing::HasSubstr("built without zstd")));
+    EXPECT_THAT(readLogFile(), testing::Contains(testing::HasSubstr("Still written uncompressed")));
+}
+
+#ifdef MRLOGGER_HAS_ZSTD
+namespace {
+std::string zstdDecompress(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ZSTD_DCtx* ctx = ZSTD_createDCtx();
+    std::string result;
+    std::vector<char> out(ZSTD_DStreamOutSize());
+    ZSTD_inBuffer input{data.data(), data.size(), 0};
+    while (input.pos < input.size) {
+        ZSTD_outBuffer output{out.data(), out.size(), 0};
+        if (ZSTD_isError(ZSTD_decompressStream(ctx, &output, &input))) break;
+        result.append(out.data(), output.pos);
+    }
+    ZSTD_freeDCtx(ctx);
+    return result;
+}
+}
+
+TEST_F(LoggerIntegrationTest, RotatedFilesAreCompressed) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_compressed_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "app.log").string();
+    custom_config.max_log_size_bytes = 16384;
+    custom_config.compression = CompressionMode::ROTATED;
+    custom_config.compression_level = 1;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    const int total = 3000;
+    for (int i = 0; i < total; ++i) {
+        logger->info("Compressed message {}", i);
+        if (i % 100 == 99) logger->flush();
+    }
+    logger->flush();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (logger->compressionBacklog().files > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(logger->compressionBacklog().files, 0u);
+
+    logger.reset();
+    Logger::_reset();
+
+    // Rotated files only exist compressed, the current one stays plain
+    std::set<int> seen;
+    size_t compressed_files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::string content;
+        if (entry.path().extension() == ".zst") {
+            content = zstdDecompress(entry.path());
+            compressed_files++;
+        } else {
+            EXPECT_EQ(entry.path().filename(), "app.log");
+            std::ifstream file(entry.path());
+            content.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        }
+
+        std::istringstream lines(content);
+        std::string line;
+        while (std::getline(lines, line)) {
+            seen.insert(std::stoi(line.substr(line.rfind(' ') + 1)));
+        }
+    }
+
+    EXPECT_GT(compressed_files, 0u);
+    EXPECT_EQ(seen.size(), static_cast<size_t>(total));
+    EXPECT_TRUE(errors.empty());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, RotatedArchivesSurviveARestart) {
+    auto dir = std::filesystem::temp_directory_path() / "logger_compressed_restart";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> errors;
+    auto run = [&](int number) {
+        Logger::_reset();
+        Config custom_config = config_;
+        custom_config.log_file_name = (dir / "app.log").string();
+        custom_config.max_log_size_bytes = 16384;
+        custom_config.compression = CompressionMode::ROTATED;
+        custom_config.compression_level = 1;
+        custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+        custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+        Logger::init(custom_config);
+
+        auto logger = Logger::get();
+        for (int i = 0; i < 1000; ++i) {
+            logger->info("Run {} message {}", number, i);
+            if (i % 100 == 99) logger->flush();
+        }
+        logger->flush();
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (logger->compressionBacklog().files > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        logger.reset();
+        Logger::_reset();
+    };
+    auto archives = [&dir]() {
+        std::map<std::string, std::string> contents;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.path().extension() == ".zst") contents[entry.path().filename()] = zstdDecompress(entry.path());
+        }
+        return contents;
+    };
+
+    run(1);
+    auto first = archives();
+    ASSERT_FALSE(first.empty());
+
+    // The second run starts counting rotations at 1 again and has to skip the archives
+    run(2);
+    auto both = archives();
+    EXPECT_GT(both.size(), first.size());
+    for (const auto& [name, content] : first) {
+        ASSERT_TRUE(both.contains(name)) << name;
+        EXPECT_EQ(both[name], content) << name;
+        EXPECT_THAT(content, testing::Not(testing::HasSubstr("Run 2")));
+    }
+    EXPECT_TRUE(errors.empty());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, InlineCompressionWritesZstdFrames) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.compression = CompressionMode::INLINE;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    const int total = 1000;
+    for (int i = 0; i < total; ++i) {
+        logger->info("Inline compressed message {}", i);
+    }
+    logger->flush();
+    logger.reset();
+    Logger::_reset();
+
+    std::istringstream lines(zstdDecompress(test_log_file_));
+    std::string line;
+    int count = 0;
+    while (std::getline(lines, line)) {
+        EXPECT_THAT(line, testing::HasSubstr("Inline compressed message"));
+        count++;
+    }
+    EXPECT_EQ(count, total);
+}
+#endif
+
+TEST_F(LoggerIntegrationTest, MmapBackendWritesAllMessages) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.backend = IO::Backend::MMAP;
+    custom_config.mmap_chunk_size = 64 * 1024;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    EXPECT_EQ(logger->backend(), IO::Backend::MMAP);
+
+    const int total = 5000;
+    for (int i = 0; i < total; ++i) {
+        logger->info("Mapped message {}", i);
+    }
+    logger->error("Mapped error");
+    logger->flush();
+
+    // Readable right after flush(), without the preallocated tail
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), static_cast<size_t>(total + 1));
+    for (int i = 0; i < total; ++i) {
+        EXPECT_THAT(lines[i], testing::EndsWith("Mapped message " + std::to_string(i)));
+    }
+    EXPECT_THAT(lines.back(), testing::HasSubstr("[ERROR]"));
+
+    logger.reset();
+    Logger::_reset();
+    EXPECT_TRUE(errors.empty());
+}
+
+TEST_F(LoggerIntegrationTest, MmapBackendKeepsThePreallocatedWindowUntilFlush) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.backend = IO::Backend::MMAP;
+    custom_config.mmap_chunk_size = 64 * 1024;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    logger->info("Mapped message");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (logger->stats().messages_written < 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // The drained queue does not trim, the next message needs no fallocate
+    EXPECT_EQ(std::filesystem::file_size(test_log_file_), 64u * 1024);
+
+    logger->flush();
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_THAT(lines[0], testing::EndsWith("Mapped message"));
+    EXPECT_EQ(std::filesystem::file_size(test_log_file_), lines[0].size() + 1);
+
+    logger.reset();
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, MmapBackendRotation) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_mmap_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    Config custom_config = config_;
+    custom_config.backend = IO::Backend::MMAP;
+    custom_config.log_file_name = (dir / "mapped.log").string();
+    custom_config.max_log_size_bytes = 16384;
+    custom_config.mmap_chunk_size = 4096;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    const int total = 3000;
+    for (int i = 0; i < total; ++i) {
+        logger->info("Rotating mapped message {}", i);
+    }
+    logger.reset();
+    Logger::_reset();
+
+    size_t files = 0;
+    std::set<int> seen;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::ifstream file(entry.path());
+        std::string line;
+        while (std::getline(file, line)) {
+            ASSERT_THAT(line, testing::MatchesRegex(".*Rotating mapped message [0-9]+"));
+            seen.insert(std::stoi(line.substr(line.rfind(' ') + 1)));
+        }
+        files++;
+    }
+
+    EXPECT_GT(files, 1u);
+    EXPECT_EQ(seen.size(), static_cast<size_t>(total));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, AutoBackendFallsBackToMmap) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    // More entries than io_uring accepts (IORING_MAX_ENTRIES), ring setup fails with EINVAL
+    custom_config.queue_depth = 65535;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    EXPECT_EQ(logger->backend(), IO::Backend::MMAP);
+    logger->info("Written without io_uring");
+    logger->flush();
+    logger.reset();
+    Logger::_reset();
+
+    EXPECT_THAT(errors, testing::Contains(testing::HasSubstr("Falling back to the mmap backend")));
+    EXPECT_THAT(readLogFile(), testing::Contains(testing::HasSubstr("Written without io_uring")));
+}
+
+TEST_F(LoggerIntegrationTest, IoUringBackendDoesNotFallBack) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.backend = IO::Backend::IO_URING;
+    custom_config.queue_depth = 65535;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+
+    EXPECT_THROW(Logger::init(custom_config), std::runtime_error);
+}
+
+TEST_F(LoggerIntegrationTest, SQPollRingMode) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.ring_mode = IO::RingMode::SQPOLL;
+    custom_config.sqpoll_idle_ms = 10;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 500; ++i) {
+        logger->info("SQPOLL message {}", i);
+        // Let the SQ thread go idle now and then so the wakeup path is used too
+        if (i % 100 == 99) {
+            logger->flush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 500);
+    EXPECT_THAT(lines[0], testing::HasSubstr("SQPOLL message 0"));
+    EXPECT_THAT(lines[499], testing::HasSubstr("SQPOLL message 499"));
+
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, SingleIssuerRingMode) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.ring_mode = IO::RingMode::SINGLE_ISSUER;
+    custom_config.register_buffers = true;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 500; ++i) {
+        logger->info("Single issuer message {}", i);
+    }
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 500);
+    EXPECT_THAT(lines[0], testing::HasSubstr("Single issuer message 0"));
+    EXPECT_THAT(lines[499], testing::HasSubstr("Single issuer message 499"));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("Failed to enable"))));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("write failed"))));
+
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, DurabilityErrorsLinksSync) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.durability = DurabilityMode::ERRORS;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 300; ++i) {
+        if (i % 10 == 0) {
+            logger->error("Durable message {}", i);
+        } else {
+            logger->info("Regular message {}", i);
+        }
+    }
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 300);
+    EXPECT_THAT(lines[0], testing::HasSubstr("Durable message 0"));
+    EXPECT_THAT(lines[299], testing::HasSubstr("Regular message 299"));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("failed"))));
+
+    Logger::_reset();
+}
+
+TEST_F(LoggerIntegrationTest, DurabilityPeriodicSync) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.durability = DurabilityMode::PERIODIC;
+    custom_config.fsync_interval_ms = 5;
+    custom_config.fsync_interval_bytes = 4096;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 1000; ++i) {
+        logger->info("Periodic message {}", i);
+        if (i % 250 == 249) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    logger->flush();
+    Logger::_reset();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 1000);
+    EXPECT_THAT(lines[999], testing::HasSubstr("Periodic message 999"));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("failed"))));
+}
+
+TEST_F(LoggerIntegrationTest, DirectIOWritesExactContent) {
+    Logger::_reset();
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    custom_config.direct_io = true;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 500; ++i) {
+        logger->info("Direct message {}", i);
+    }
+    logger->flush();
+
+    // flush() writes the partial last block and cuts its padding again
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 500);
+    EXPECT_THAT(lines[0], testing::HasSubstr("Direct message 0"));
+    EXPECT_THAT(lines[499], testing::EndsWith("Direct message 499"));
+
+    // Shutdown writes the partial last block as well
+    for (int i = 500; i < 600; ++i) {
+        logger->info("Direct message {}", i);
+    }
+    logger.reset();
+    Logger::_reset();
+
+    lines = readLogFile();
+    ASSERT_EQ(lines.size(), 600);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EXPECT_THAT(lines[i], testing::EndsWith("Direct message " + std::to_string(i)));
+    }
+    EXPECT_TRUE(errors.empty());
+}
+
+TEST_F(LoggerIntegrationTest, DirectIOAppendsToExistingFile) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.direct_io = true;
+
+    for (int run = 0; run < 3; ++run) {
+        custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+        Logger::init(custom_config);
+        for (int i = 0; i < 50; ++i) {
+            Logger::get()->info("Run {} message {}", run, i);
+        }
+        Logger::_reset();
+    }
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 150);
+    EXPECT_THAT(lines[0], testing::EndsWith("Run 0 message 0"));
+    EXPECT_THAT(lines[50], testing::EndsWith("Run 1 message 0"));
+    EXPECT_THAT(lines[149], testing::EndsWith("Run 2 message 49"));
+}
+
+TEST_F(LoggerIntegrationTest, DirectIORotation) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_direct_io_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "direct.log").string();
+    custom_config.max_log_size_bytes = 16384;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.direct_io = true;
+    Logger::init(custom_config);
+
+    const int total = 3000;
+    for (int i = 0; i < total; ++i) {
+        Logger::get()->info("Rotating direct message {}", i);
+        if (i % 100 == 99) Logger::get()->flush();
+    }
+    Logger::_reset();
+
+    size_t files = 0;
+    size_t lines = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::ifstream file(entry.path());
+        std::string line;
+        while (std::getline(file, line)) {
+            EXPECT_THAT(line, testing::MatchesRegex(".*Rotating direct message [0-9]+"));
+            lines++;
+        }
+        files++;
+    }
+
+    EXPECT_GT(files, 1u);
+    EXPECT_EQ(lines, static_cast<size_t>(total));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, BinaryEncodingRoundTrip) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.encoding = LogEncoding::BINARY;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    const int per_thread = 2000;
+    auto produce = [](int thread) {
+        auto logger = Logger::get();
+        for (int i = 0; i < per_thread; ++i) {
+            logger->info("Thread {} request {} took {:.2f} ms", thread, i, i * 0.25);
+            if (i % 100 == 0) {
+                logger->warn("Thread {} checkpoint {} {}", thread, i, std::string("with a string"));
+            }
+        }
+    };
+    std::thread t1(produce, 1);
+    std::thread t2(produce, 2);
+    t1.join();
+    t2.join();
+    Logger::get()->flush();
+    Logger::_reset();
+
+    auto lines = decodeBinaryFile(test_log_file_);
+    ASSERT_EQ(lines.size(), static_cast<size_t>(2 * (per_thread + per_thread / 100)));
+
+    std::set<std::string> events;
+    size_t text_bytes = 0;
+    for (const auto& line : lines) {
+        ASSERT_THAT(line, testing::MatchesRegex("\\[.*\\] \\[(INFO|WARN)\\] \\[Thread: [0-9]+\\].*: Thread [12] .*"));
+        events.insert(line.substr(line.find("]: ") + 3));
+        text_bytes += line.size() + 1;
+    }
+    EXPECT_EQ(events.size(), lines.size());
+    EXPECT_TRUE(events.count("Thread 2 request 1999 took 499.75 ms"));
+    EXPECT_TRUE(events.count("Thread 1 checkpoint 1900 with a string"));
+
+    // The point of the exercise
+    EXPECT_LT(std::filesystem::file_size(test_log_file_) * 3, text_bytes);
+}
+
+TEST_F(LoggerIntegrationTest, BinaryEncodingRotation) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_binary_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    Config custom_config = config_;
+    custom_config.encoding = LogEncoding::BINARY;
+    custom_config.log_file_name = (dir / "binary.log").string();
+    custom_config.max_log_size_bytes = 8192;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    const int total = 5000;
+    for (int i = 0; i < total; ++i) {
+        Logger::get()->info("Rotating binary message {}", i);
+        if (i % 100 == 99) Logger::get()->flush();
+    }
+    Logger::_reset();
+
+    // Every file carries its own header and dictionary
+    size_t files = 0;
+    std::set<int> seen;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        for (const auto& line : decodeBinaryFile(entry.path())) {
+            ASSERT_THAT(line, testing::MatchesRegex(".*Rotating binary message [0-9]+"));
+            seen.insert(std::stoi(line.substr(line.rfind(' ') + 1)));
+        }
+        files++;
+    }
+
+    EXPECT_GT(files, 1u);
+    EXPECT_EQ(seen.size(), static_cast<size_t>(total));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, BinaryEncodingMmapBackend) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.encoding = LogEncoding::BINARY;
+    custom_config.backend = IO::Backend::MMAP;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    for (int i = 0; i < 1000; ++i) {
+        Logger::get()->error("Mapped binary {} {}", i, static_cast<uint8_t>(i % 256));
+    }
+    Logger::get()->flush();
+    Logger::_reset();
+
+    auto lines = decodeBinaryFile(test_log_file_);
+    ASSERT_EQ(lines.size(), 1000u);
+    EXPECT_THAT(lines.back(), testing::HasSubstr("[ERROR]"));
+    EXPECT_THAT(lines.back(), testing::EndsWith("]: Mapped binary 999 231"));
+}
+
+TEST_F(LoggerIntegrationTest, SinksRouteBySeverity) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_sinks";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "app.log").string();
+    custom_config.log_file_severities = ALL_SEVERITIES & ~severitiesFrom(SEVERITY_LEVEL::ERROR);
+    custom_config.sinks = {
+        {.file_name = (dir / "alerts.log").string(), .severities = severitiesFrom(SEVERITY_LEVEL::ERROR)},
+        {.file_name = (dir / "all.log").string()}
+    };
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    const int total = 3000;
+    for (int i = 0; i < total; ++i) {
+        if (i % 10 == 0) {
+            logger->error("Routed error {}", i);
+        } else {
+            logger->info("Routed info {}", i);
+        }
+    }
+    logger->flush();
+    logger.reset();
+    Logger::_reset();
+
+    auto read = [](const std::filesystem::path& path) {
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line)) lines.push_back(line);
+        return lines;
+    };
+
+    auto app = read(dir / "app.log");
+    auto alerts = read(dir / "alerts.log");
+    auto all = read(dir / "all.log");
+
+    ASSERT_EQ(app.size(), static_cast<size_t>(total - total / 10));
+    ASSERT_EQ(alerts.size(), static_cast<size_t>(total / 10));
+    ASSERT_EQ(all.size(), static_cast<size_t>(total));
+
+    for (const auto& line : app) {
+        EXPECT_THAT(line, testing::HasSubstr("[INFO]"));
+    }
+    for (int i = 0; i < total / 10; ++i) {
+        EXPECT_THAT(alerts[i], testing::EndsWith("Routed error " + std::to_string(i * 10)));
+    }
+    for (int i = 0; i < total; ++i) {
+        EXPECT_THAT(all[i], testing::EndsWith(" " + std::to_string(i)));
+    }
+    EXPECT_TRUE(errors.empty());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, SinksRotateIndependently) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_sink_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "main.log").string();
+    custom_config.sinks = {{.file_name = (dir / "small.log").string(), .max_log_size_bytes = 4096}};
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    const int total = 2000;
+    for (int i = 0; i < total; ++i) {
+        logger->warn("Rotating sink message {}", i);
+        if (i % 100 == 99) logger->flush();
+    }
+    logger->flush();
+    logger.reset();
+    Logger::_reset();
+
+    size_t main_lines = 0, small_lines = 0, small_files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::ifstream file(entry.path());
+        size_t lines = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            EXPECT_THAT(line, testing::HasSubstr("Rotating sink message"));
+            lines++;
+        }
+
+        if (entry.path().filename() == "main.log") {
+            main_lines = lines;
+        } else {
+            EXPECT_THAT(entry.path().filename().string(), testing::StartsWith("small"));
+            small_lines += lines;
+            small_files++;
+        }
+    }
+
+    EXPECT_EQ(main_lines, static_cast<size_t>(total));
+    EXPECT_GT(small_files, 1u);
+    EXPECT_EQ(small_lines, static_cast<size_t>(total));
+    EXPECT_THAT(errors, testing::Not(testing::Contains(testing::HasSubstr("error code"))));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, SinksMmapBackend) {
+    Logger::_reset();
+
+    auto alerts_file = std::filesystem::temp_directory_path() / "logger_mmap_alerts.log";
+    std::filesystem::remove(alerts_file);
+
+    std::vector<std::string> errors;
+    Config custom_config = config_;
+    custom_config.backend = IO::Backend::MMAP;
+    custom_config.sinks = {{.file_name = alerts_file.string(), .severities = severityMask(SEVERITY_LEVEL::WARN)}};
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    custom_config.internal_error_handler = [&errors](const std::string& msg) { errors.push_back(msg); };
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 4 == 0) {
+            logger->warn("Mapped warning {}", i);
+        } else {
+            logger->info("Mapped info {}", i);
+        }
+    }
+    logger->flush();
+
+    // Both files are trimmed when flush() returns
+    EXPECT_EQ(readLogFile().size(), 1000u);
+
+    std::ifstream file(alerts_file);
+    std::vector<std::string> alerts;
+    std::string line;
+    while (std::getline(file, line)) alerts.push_back(line);
+    ASSERT_EQ(alerts.size(), 250u);
+    EXPECT_THAT(alerts.back(), testing::EndsWith("Mapped warning 996"));
+
+    logger.reset();
+    Logger::_reset();
+    EXPECT_TRUE(errors.empty());
+    std::filesystem::remove(alerts_file);
+}
+
+TEST_F(LoggerIntegrationTest, GetReturnsTheSameInstance) {
+    const auto& first = Logger::get();
+    const auto& second = MR::Logger::get();
+
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(first.use_count(), second.use_count());
+}
+
+TEST_F(LoggerIntegrationTest, NamedLoggersWriteIndependently) {
+    auto dir = std::filesystem::temp_directory_path() / "logger_named";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    Config db_config = config_;
+    db_config.log_file_name = (dir / "db.log").string();
+    db_config._queue = nullptr;  // create() gives every logger its own queue
+    Config net_config = db_config;
+    net_config.log_file_name = (dir / "net.log").string();
+
+    auto db = Logger::create("db", db_config);
+    auto net = MR::Logger::create("net", net_config);
+    ASSERT_NE(db, net);
+    EXPECT_EQ(Logger::get("db"), db);
+    EXPECT_EQ(Logger::create("db", net_config), db);
+    EXPECT_THROW(Logger::get("missing"), std::runtime_error);
+
+    // The default logger keeps running next to them
+    Logger::get()->info("Default logger message");
+
+    std::thread flood([&db]() {
+        for (int i = 0; i < 20000; ++i) db->info("Database message {}", i);
+    });
+    for (int i = 0; i < 100; ++i) {
+        net->warn("Network message {}", i);
+    }
+    net->flush();
+    flood.join();
+    db->flush();
+    Logger::get()->flush();
+
+    auto count = [](const std::filesystem::path& path, const std::string& text) {
+        std::ifstream file(path);
+        size_t lines = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            EXPECT_THAT(line, testing::HasSubstr(text));
+            lines++;
+        }
+        return lines;
+    };
+
+    EXPECT_EQ(count(dir / "db.log", "Database message"), 20000u);
+    EXPECT_EQ(count(dir / "net.log", "Network message"), 100u);
+    EXPECT_EQ(count(test_log_file_, "Default logger message"), 1u);
+
+    db.reset();
+    net.reset();
+    Logger::_reset();
+    EXPECT_THROW(Logger::get("db"), std::runtime_error);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, NamedLoggersReportTheirOwnSuppressions) {
+    auto dir = std::filesystem::temp_directory_path() / "logger_named_suppressions";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    Config db_config = config_;
+    db_config.log_file_name = (dir / "db.log").string();
+    db_config._queue = nullptr;
+    db_config.suppression_report_ms = 50;
+    Config net_config = db_config;
+    net_config.log_file_name = (dir / "net.log").string();
+
+    auto db = Logger::create("db_suppressions", db_config);
+    auto net = Logger::create("net_suppressions", net_config);
+
+    int db_line = 0;
+    int net_line = 0;
+    for (int i = 0; i < 100; ++i) {
+        db_line = __LINE__ + 1;
+        MRLOG_EVERY_N(db, 10, WARN, "db {}", i);
+        net_line = __LINE__ + 1;
+        MRLOG_FIRST_N(net, 1, WARN, "net {}", i);
+    }
+
+    // The idle workers wake up for the reports
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    db->flush();
+    net->flush();
+    Logger::get()->flush();
+
+    auto read = [](const std::filesystem::path& path) {
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(file, line);) lines.push_back(line);
+        return lines;
+    };
+    auto count = [](const std::vector<std::string>& lines, const std::string& text) {
+        return std::count_if(lines.begin(), lines.end(), [&](const auto& line) { return line.find(text) != std::string::npos; });
+    };
+
+    std::string file = std::filesystem::path(__FILE__).filename().string();
+    auto db_lines = read(dir / "db.log");
+    auto net_lines = read(dir / "net.log");
+    EXPECT_EQ(count(db_lines, fmt::format("[MrLogger] suppressed 90 similar messages at {}:{}", file, db_line)), 1);
+    EXPECT_EQ(count(db_lines, "suppressed"), 1);
+    EXPECT_EQ(count(net_lines, fmt::format("[MrLogger] suppressed 99 similar messages at {}:{}", file, net_line)), 1);
+    EXPECT_EQ(count(net_lines, "suppressed"), 1);
+    EXPECT_EQ(count(readLogFile(), "suppressed"), 0);
+
+    db.reset();
+    net.reset();
+    Logger::_reset();
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, OverflowDropNewest) {
+    Logger::_reset();
+
+    auto queue = std::make_shared<PausableQueue>();
+    Config custom_config = config_;
+    custom_config._queue = queue;
+    custom_config.max_queued_messages = 10;
+    custom_config.overflow_policy = OverflowPolicy::DROP_NEWEST;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 100; ++i) {
+        logger->info("Overflow message {}", i);
+    }
+    EXPECT_EQ(queue->size(), 10u);
+    EXPECT_EQ(logger->droppedMessages(), 90u);
+    EXPECT_EQ(logger->droppedMessages(SEVERITY_LEVEL::INFO), 90u);
+
+    queue->paused = false;
+    logger->flush();
+
+    // The queued messages, then the report of the ones dropped after them
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 11u);
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_THAT(lines[i], testing::EndsWith("Overflow message " + std::to_string(i)));
+    }
+    EXPECT_THAT(lines[10], testing::HasSubstr("[WARN]"));
+    EXPECT_THAT(lines[10], testing::HasSubstr("90 messages dropped because the log queue was full (90 INFO)"));
+}
+
+TEST_F(LoggerIntegrationTest, OverflowDropOldest) {
+    Logger::_reset();
+
+    auto queue = std::make_shared<PausableQueue>();
+    Config custom_config = config_;
+    custom_config._queue = queue;
+    custom_config.max_queued_messages = 10;
+    custom_config.overflow_policy = OverflowPolicy::DROP_OLDEST;
+    Logger::init(custom_config);
+
+    // Twice the limit is queued, the 5 beyond that are dropped right away
+    auto logger = Logger::get();
+    for (int i = 0; i < 25; ++i) {
+        logger->warn("Overflow message {}", i);
+    }
+    EXPECT_EQ(queue->size(), 20u);
+    EXPECT_EQ(logger->droppedMessages(), 5u);
+
+    // The worker drops the 10 oldest of the queued ones
+    queue->paused = false;
+    logger->flush();
+    EXPECT_EQ(logger->droppedMessages(SEVERITY_LEVEL::WARN), 15u);
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 11u);
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_THAT(lines[i], testing::EndsWith("Overflow message " + std::to_string(i + 10)));
+    }
+    EXPECT_THAT(lines[10], testing::HasSubstr("15 messages dropped because the log queue was full (15 WARN)"));
+}
+
+TEST_F(LoggerIntegrationTest, OverflowDropBelowErrorKeepsErrors) {
+    Logger::_reset();
+
+    auto queue = std::make_shared<PausableQueue>();
+    Config custom_config = config_;
+    custom_config._queue = queue;
+    custom_config.max_queued_messages = 4;
+    custom_config.overflow_policy = OverflowPolicy::DROP_BELOW_ERROR;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 6; ++i) {
+        logger->info("Info message {}", i);
+    }
+    logger->warn("Warn message");
+
+    // An ERROR waits for room instead
+    std::atomic<bool> logged{false};
+    std::thread producer([&]() {
+        logger->error("Error message");
+        logged = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(logged.load());
+
+    queue->paused = false;
+    producer.join();
+    logger->flush();
+
+    EXPECT_EQ(logger->droppedMessages(SEVERITY_LEVEL::INFO), 2u);
+    EXPECT_EQ(logger->droppedMessages(SEVERITY_LEVEL::WARN), 1u);
+    EXPECT_EQ(logger->droppedMessages(SEVERITY_LEVEL::ERROR), 0u);
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 6u);
+    EXPECT_THAT(lines[4], testing::HasSubstr("3 messages dropped because the log queue was full (2 INFO, 1 WARN)"));
+    EXPECT_THAT(lines[5], testing::EndsWith("Error message"));
+}
+
+TEST_F(LoggerIntegrationTest, OverflowBlockWaitsForRoom) {
+    Logger::_reset();
+
+    auto queue = std::make_shared<PausableQueue>();
+    Config custom_config = config_;
+    custom_config._queue = queue;
+    custom_config.max_queued_messages = 5;
+    custom_config.overflow_policy = OverflowPolicy::BLOCK;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    std::atomic<int> logged{0};
+    std::thread producer([&]() {
+        for (int i = 0; i < 50; ++i) {
+            logger->info("Blocking message {}", i);
+            logged++;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(logged.load(), 5);
+    EXPECT_EQ(queue->size(), 5u);
+
+    queue->paused = false;
+    producer.join();
+    logger->flush();
+
+    EXPECT_EQ(logger->droppedMessages(), 0u);
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 50u);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EXPECT_THAT(lines[i], testing::EndsWith("Blocking message " + std::to_string(i)));
+    }
+}
+
+TEST_F(LoggerIntegrationTest, OverflowBlockTimeoutDrops) {
+    Logger::_reset();
+
+    auto queue = std::make_shared<PausableQueue>();
+    Config custom_config = config_;
+    custom_config._queue = queue;
+    custom_config.max_queued_messages = 2;
+    custom_config.overflow_policy = OverflowPolicy::BLOCK_TIMEOUT;
+    custom_config.overflow_timeout_ms = 20;
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    logger->info("Timeout message 0");
+    logger->info("Timeout message 1");
+
+    auto start = std::chrono::steady_clock::now();
+    logger->info("Timeout message 2");
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(logger->droppedMessages(), 1u);
+
+    queue->paused = false;
+    logger->flush();
+
+    auto lines = readLogFile();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_THAT(lines[2], testing::HasSubstr("1 messages dropped"));
+}
+
+TEST_F(LoggerIntegrationTest, StatsCountThePipeline) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    Stats before = logger->stats();
+    EXPECT_EQ(before.messages_enqueued, 0u);
+    EXPECT_EQ(before.write_latency.count(), 0u);
+
+    const size_t total = 500;
+    for (size_t i = 0; i < total; ++i) {
+        logger->info("Stats message {}", i);
+    }
+    logger->flush();
+
+    Stats stats = logger->stats();
+    EXPECT_EQ(stats.messages_enqueued, total);
+    EXPECT_EQ(stats.messages_written, total);
+    EXPECT_EQ(stats.messages_dropped, 0u);
+    EXPECT_EQ(stats.queue_depth, 0u);
+    EXPECT_EQ(stats.bytes_written, std::filesystem::file_size(test_log_file_));
+    EXPECT_GT(stats.writes, 0u);
+    EXPECT_GE(stats.buffers_written, stats.writes);
+    EXPECT_GE(stats.coalescingRatio(), 1.0);
+    EXPECT_EQ(stats.write_latency.count(), stats.writes);
+    EXPECT_GT(stats.buffer_pool_hits + stats.buffer_pool_misses, 0u);
+    EXPECT_EQ(stats.rotations, 0u);
+}
+
+TEST_F(LoggerIntegrationTest, LargeMessagesAreWrittenWhole) {
+    std::string payload;
+    for (int i = 0; payload.size() < 300 * 1024; ++i) payload += std::to_string(i) + ",";
+
+    for (bool register_buffers : {false, true}) {
+        Logger::_reset();
+        std::filesystem::remove(test_log_file_);
+
+        Config custom_config = config_;
+        custom_config.register_buffers = register_buffers;
+        custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+        Logger::init(custom_config);
+
+        auto logger = Logger::get();
+        logger->info("Before the dump");
+        logger->info("Dump: {}", payload);
+        logger->info("After the dump");
+        logger->flush();
+
+        auto lines = readLogFile();
+        ASSERT_EQ(lines.size(), 3u) << "register_buffers = " << register_buffers;
+        EXPECT_THAT(lines[0], testing::HasSubstr("Before the dump"));
+        EXPECT_THAT(lines[1], testing::EndsWith("Dump: " + payload));
+        EXPECT_THAT(lines[2], testing::HasSubstr("After the dump"));
+    }
+}
+
+TEST_F(LoggerIntegrationTest, EveryClockStampsWallTime) {
+    for (auto source : {ClockSource::SYSTEM, ClockSource::REALTIME_COARSE, ClockSource::TSC}) {
+        Logger::_reset();
+        std::filesystem::remove(test_log_file_);
+
+        Config custom_config = config_;
+        custom_config.clock = source;
+        custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+        Logger::init(custom_config);
+
+        // Rendered like the line timestamps, which compare as text
+        auto before = fmt::format("{}", std::chrono::system_clock::now() - std::chrono::seconds(1));
+        auto logger = Logger::get();
+        for (int i = 0; i < 50; ++i) {
+            logger->info("Clock message {}", i);
+        }
+        logger->flush();
+        auto after = fmt::format("{}", std::chrono::system_clock::now() + std::chrono::seconds(1));
+
+        auto lines = readLogFile();
+        ASSERT_EQ(lines.size(), 50u) << "clock " << static_cast<int>(source);
+        for (const auto& line : lines) {
+            auto timestamp = line.substr(1, line.find(']') - 1);
+            EXPECT_GE(timestamp, before) << line;
+            EXPECT_LE(timestamp, after) << line;
+        }
+    }
+}
+
+TEST_F(LoggerIntegrationTest, WarmedUpPoolIsTrimmedWhileIdle) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.buffer_pool_initial_size = 4;
+    custom_config.buffer_pool_trim_ms = 10;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    logger->warmUp();
+    for (int i = 0; i < 100; ++i) {
+        logger->info("Warm message {}", i);
+    }
+    logger->flush();
+    EXPECT_EQ(readLogFile().size(), 100u);
+
+    // The idle worker wakes up for the trims on its own
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (logger->stats().buffer_pool_trimmed == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GT(logger->stats().buffer_pool_trimmed, 0u);
+}
+
+TEST_F(LoggerIntegrationTest, StatsCountRotations) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_stats_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "stats.log").string();
+    custom_config.max_log_size_bytes = 4096;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+
+    auto logger = Logger::get();
+    for (int i = 0; i < 1000; ++i) {
+        logger->info("Rotating stats message {}", i);
+        if (i % 100 == 99) logger->flush();
+    }
+    logger->flush();
+    uint64_t rotations = logger->stats().rotations;
+    Logger::_reset();
+
+    size_t files = 0;
+    for ([[maybe_unused]] const auto& entry : std::filesystem::directory_iterator(dir)) files++;
+    // Plus the pre-opened standby file, if its open completed
+    EXPECT_GT(rotations, 0u);
+    EXPECT_GE(files, rotations + 1);
+    EXPECT_LE(files, rotations + 2);
+
+    std::filesystem::remove_all(dir);
+}
+
+
+TEST_F(LoggerIntegrationTest, ShardedWorkersWritePerShardFiles) {
+    Logger::_reset();
+
+    auto dir = std::filesystem::temp_directory_path() / "logger_sharded";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    Config custom_config = config_;
+    custom_config.log_file_name = (dir / "sharded.log").string();
+    custom_config.worker_count = 3;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    const int threads = 4;
+    const int per_thread = 2000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&logger, t]() {
+            for (int i = 0; i < per_thread; ++i) logger->info("Shard message {} {}", t, i);
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    logger->flush();
+
+    Stats stats = logger->stats();
+    EXPECT_EQ(stats.messages_written, static_cast<uint64_t>(threads * per_thread));
+    EXPECT_EQ(stats.queue_depth, 0u);
+
+    // Every thread sticks to one shard, so its messages are in order within one file
+    std::vector<int> next(threads, 0);
+    std::vector<int> file_of(threads, -1);
+    uint64_t bytes = 0;
+    for (int shard = 0; shard < 3; ++shard) {
+        auto path = dir / (shard == 0 ? "sharded.log" : "sharded." + std::to_string(shard) + ".log");
+        ASSERT_TRUE(std::filesystem::exists(path)) << path;
+        bytes += std::filesystem::file_size(path);
+
+        std::ifstream file(path);
+        std::string line;
+        size_t lines = 0;
+        while (std::getline(file, line)) {
+            auto pos = line.find("Shard message ");
+            ASSERT_NE(pos, std::string::npos) << line;
+            int t = 0, i = 0;
+            std::istringstream(line.substr(pos + 14)) >> t >> i;
+            ASSERT_GE(t, 0);
+            ASSERT_LT(t, threads);
+            if (file_of[t] == -1) file_of[t] = shard;
+            EXPECT_EQ(file_of[t], shard);
+            EXPECT_EQ(i, next[t]++);
+            lines++;
+        }
+        EXPECT_GT(lines, 0u) << path;
+    }
+    for (int t = 0; t < threads; ++t) EXPECT_EQ(next[t], per_thread);
+    EXPECT_EQ(stats.bytes_written, bytes);
+
+    Logger::_reset();
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerIntegrationTest, ShardedWorkersShareOneFile) {
+    Logger::_reset();
+
+    Config custom_config = config_;
+    custom_config.max_log_size_bytes = 4096;  // Ignored, a shared file is never rotated
+    custom_config.worker_count = 2;
+    custom_config.shard_output = ShardOutput::SHARED_FILE;
+    custom_config._queue = std::make_shared<Queue::StdQueue<WriteRequest>>();
+    Logger::init(custom_config);
+    auto logger = Logger::get();
+
+    const int threads = 4;
+    const int per_thread = 2000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&logger, t]() {
+            for (int i = 0; i < per_thread; ++i) logger->info("Shared message {} {}", t, i);
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    logger->flush();
+    EXPECT_EQ(logger->stats().rotations, 0u);
+
+    // Whole writes land one after the other, no line is torn by the other worker
+    std::vector<int> next(threads, 0);
+    for (const auto& line : readLogFile()) {
+        auto pos = line.find("Shared message ");
+        ASSERT_NE(pos, std::string::npos) << line;
+        int t = 0, i = 0;
+        std::istringstream(line.substr(pos + 15)) >> t >> i;
+        ASSERT_GE(t, 0);
+        ASSERT_LT(t, threads);
+        EXPECT_EQ(i, next[t]++);
+    }
+    for (int t = 0; t < threads; ++t) EXPECT_EQ(next[t], per_thread);
+}
+
+TEST_F(LoggerIntegrationTest, SharedFileRejectsUnsupportedModes) {
+    Logger::_reset();
+
+    Config direct = config_;
+    direct.worker_count = 2;
+    direct.shard_output = ShardOutput::SHARED_FILE;
+    direct.direct_io = true;
+    EXPECT_THROW(Logger::create("shared_direct", direct), std::invalid_argument);
+
+    Config binary = config_;
+    binary.worker_count = 2;
+    binary.shard_output = ShardOutput::SHARED_FILE;
+    binary.encoding = LogEncoding::BINARY;
+    EXPECT_THROW(Logger::create("shared_binary", binary), std::invalid_argument);
+
+    Config mapped = config_;
+    mapped.worker_count = 2;
+    mapped.shard_output = ShardOutput::SHARED_FILE;
+    mapped.backend = IO::Backend::MMAP;
+    EXPECT_THROW(Logger::create("shared_mapped", mapped), std::invalid_argument);
+}
+
+}
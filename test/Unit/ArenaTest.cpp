@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <MR/Memory/Arena.hpp>
+#include <cstdint>
+#include <cstring>
+
+namespace MR::Memory::Test {
+
+TEST(ArenaTest, SizeIsRoundedToHugePages) {
+    Arena arena(Arena::HUGE_PAGE_SIZE + 1, false);
+
+    ASSERT_NE(arena.data(), nullptr);
+    EXPECT_EQ(arena.size(), 2 * Arena::HUGE_PAGE_SIZE);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(arena.data()) % 4096, 0u);
+    EXPECT_EQ(arena.lockError(), 0);
+}
+
+TEST(ArenaTest, WholeRegionIsWritable) {
+    Arena arena(3 * 1024 * 1024, false);
+
+    std::memset(arena.data(), 0x5a, arena.size());
+    EXPECT_EQ(arena.data()[0], 0x5a);
+    EXPECT_EQ(arena.data()[arena.size() - 1], 0x5a);
+}
+
+TEST(ArenaTest, LockIsBestEffort) {
+    Arena arena(1024, true);
+
+    // Either locked or the errno of mlock (RLIMIT_MEMLOCK), never a failed construction
+    ASSERT_NE(arena.data(), nullptr);
+    EXPECT_LE(arena.lockError(), 0);
+    arena.data()[0] = 1;
+}
+
+TEST(ArenaTest, NumaBindingIsBestEffort) {
+    Arena arena(1024, false, 0);
+
+    // Bound to node 0 or the errno of mbind (no NUMA support), never a failed construction
+    ASSERT_NE(arena.data(), nullptr);
+    EXPECT_LE(arena.numaError(), 0);
+    arena.data()[0] = 1;
+
+    Arena unbound(1024, false);
+    EXPECT_EQ(unbound.numaError(), 0);
+}
+
+}
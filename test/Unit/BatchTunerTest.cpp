@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Logger/BatchTuner.hpp>
+
+#include <chrono>
+
+namespace MR::Logger::Test {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+BatchTuner::Bounds bounds() {
+    return BatchTuner::Bounds{
+        .min_batch_size = 1,
+        .max_batch_size = 32,
+        .min_coalesce_size = 1,
+        .max_coalesce_size = 32,
+        .max_delay = 500us
+    };
+}
+
+// Feeds `messages` per millisecond for `windows` windows, in_flight operations out of 256
+BatchTuner::Clock::time_point feed(BatchTuner& tuner, BatchTuner::Clock::time_point now,
+                                   size_t messages, int windows, size_t in_flight = 0) {
+    for (int i = 0; i < windows; ++i) {
+        now += BatchTuner::WINDOW;
+        tuner.record(messages, in_flight, 256, now);
+    }
+    return now;
+}
+
+}
+
+TEST(BatchTunerTest, LightTrafficIsWrittenRightAway) {
+    auto now = BatchTuner::Clock::now();
+    BatchTuner tuner(bounds(), now);
+
+    // One message per millisecond: less than one more within 500us
+    feed(tuner, now, 1, 10);
+    EXPECT_EQ(tuner.coalesceSize(), 1u);
+    EXPECT_EQ(tuner.batchSize(), 1u);
+    EXPECT_FALSE(tuner.hold(1, 0ns));
+}
+
+TEST(BatchTunerTest, HeavyTrafficIsHeldUpToTheBudget) {
+    auto now = BatchTuner::Clock::now();
+    BatchTuner tuner(bounds(), now);
+
+    // 20 messages per millisecond: 10 expected within 500us
+    feed(tuner, now, 20, 10);
+    EXPECT_EQ(tuner.coalesceSize(), 10u);
+    EXPECT_EQ(tuner.batchSize(), 1u);
+    EXPECT_TRUE(tuner.hold(3, 100us));
+    EXPECT_FALSE(tuner.hold(10, 100us));   // Full
+    EXPECT_FALSE(tuner.hold(3, 500us));    // Due
+
+    // Far more than the bounds allow
+    feed(tuner, now + 10ms, 10000, 1);
+    EXPECT_EQ(tuner.coalesceSize(), 32u);
+    EXPECT_EQ(tuner.batchSize(), 32u);
+}
+
+TEST(BatchTunerTest, BusyRingGetsTheLargestBatches) {
+    auto now = BatchTuner::Clock::now();
+    BatchTuner tuner(bounds(), now);
+
+    feed(tuner, now, 1, 10, 200);
+    EXPECT_EQ(tuner.batchSize(), 32u);
+    EXPECT_EQ(tuner.coalesceSize(), 1u);
+}
+
+TEST(BatchTunerTest, CompletionLatencyShrinksTheBudget) {
+    auto now = BatchTuner::Clock::now();
+    BatchTuner tuner(bounds(), now);
+
+    tuner.recordCompletion(400us);
+    feed(tuner, now, 20, 10);
+    EXPECT_EQ(tuner.holdBudget(), 100us);
+    EXPECT_EQ(tuner.coalesceSize(), 2u);
+
+    // A device slower than the deadline: nothing is held
+    tuner.recordCompletion(5ms);
+    feed(tuner, now + 10ms, 20, 1);
+    EXPECT_EQ(tuner.holdBudget(), 0ns);
+    EXPECT_EQ(tuner.coalesceSize(), 1u);
+    EXPECT_FALSE(tuner.hold(1, 0ns));
+}
+
+TEST(BatchTunerTest, RateDropsAfterAnIdlePeriod) {
+    auto now = BatchTuner::Clock::now();
+    BatchTuner tuner(bounds(), now);
+
+    now = feed(tuner, now, 10000, 5);
+    EXPECT_EQ(tuner.coalesceSize(), 32u);
+
+    // The worker slept for a second, then one message arrived
+    now += 1s;
+    tuner.record(1, 0, 256, now);
+    EXPECT_EQ(tuner.coalesceSize(), 1u);
+    EXPECT_LT(tuner.rate(), 10.0);
+}
+
+}
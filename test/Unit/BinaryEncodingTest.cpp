@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/IO/BinaryEncoder.hpp>
+#include <MR/IO/BinaryDecoder.hpp>
+#include <MR/IO/WritePreparer.hpp>
+#include <MR/Memory/BufferPool.hpp>
+#include <MR/Logger/WriteRequest.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace MR::IO::Test {
+
+struct Point {
+    int x;
+    int y;
+};
+
+}
+
+template <>
+struct fmt::formatter<MR::IO::Test::Point> : fmt::formatter<std::string_view> {
+    auto format(const MR::IO::Test::Point& p, format_context& ctx) const {
+        return fmt::format_to(ctx.out(), "({}, {})", p.x, p.y);
+    }
+};
+
+template <>
+struct MR::Logger::is_deferrable<MR::IO::Test::Point> : std::true_type {};
+
+namespace MR::IO::Test {
+
+using namespace std::chrono_literals;
+
+class BinaryEncodingTest : public ::testing::Test {
+protected:
+    template <typename... Args>
+    static Logger::WriteRequest makeEvent(Logger::SEVERITY_LEVEL level, fmt::format_string<Args...> format, const Args&... args) {
+        return Logger::WriteRequest{
+            .level = level,
+            .data = {},
+            .threadId = std::this_thread::get_id(),
+            .timestamp = std::chrono::system_clock::now(),
+            .sequence_number = 7,
+            .deferred = Logger::DeferredFormat::capture(fmt::string_view(format), args...)
+        };
+    }
+
+    static Logger::WriteRequest makeText(Logger::SEVERITY_LEVEL level, std::string data) {
+        return Logger::WriteRequest{
+            .level = level,
+            .data = std::move(data),
+            .threadId = std::this_thread::get_id(),
+            .timestamp = std::chrono::system_clock::now(),
+            .sequence_number = 8,
+            .deferred = {}
+        };
+    }
+
+    WritePreparer makePreparer(bool binary) {
+        return WritePreparer(
+            WritePreparer::Config{.coalesce_size = 1, .binary = binary},
+            pool_,
+            [](const char*, const std::string&) {});
+    }
+
+    static std::string render(WritePreparer& preparer, Logger::WriteRequest& request) {
+        std::string out(4096, '\0');
+        out.resize(preparer.formatInto(request, out.data(), out.size()));
+        return out;
+    }
+
+    std::string decodeAll(const std::string& binary) {
+        BinaryDecoder decoder;
+        std::string out;
+        EXPECT_EQ(decoder.decode(binary, out), binary.size());
+        EXPECT_EQ(decoder.error(), "");
+        return out;
+    }
+
+    Memory::BufferPool pool_;
+};
+
+TEST_F(BinaryEncodingTest, DecodedOutputMatchesTextFormat) {
+    auto text = makePreparer(false);
+    auto binary = makePreparer(true);
+
+    std::vector<Logger::WriteRequest> requests;
+    requests.push_back(makeEvent(Logger::SEVERITY_LEVEL::INFO, "ints {} {} {} {}", -5, 42u, int64_t{-1} << 40, uint64_t{18446744073709551615ull}));
+    requests.push_back(makeEvent(Logger::SEVERITY_LEVEL::WARN, "specs {:x} {:>6} {:.3f} {:e}", 255, short{-12}, 3.14159, 2.5f));
+    requests.push_back(makeEvent(Logger::SEVERITY_LEVEL::ERROR, "small {} {} {} {}", true, 'c', int8_t{-3}, uint8_t{200}));
+    requests.push_back(makeEvent(Logger::SEVERITY_LEVEL::DEBUG, "no arguments"));
+    requests.push_back(makeText(Logger::SEVERITY_LEVEL::INFO, "preformatted with {braces}"));
+    requests.push_back(makeEvent(Logger::SEVERITY_LEVEL::INFO, "user type {}", Point{1, 2}));
+    requests.push_back(makeEvent(Logger::SEVERITY_LEVEL::INFO, "ints {} {} {} {}", 1, 2u, int64_t{3}, uint64_t{4}));
+
+    std::string expected, encoded;
+    for (auto& request : requests) {
+        expected += render(text, request);
+        encoded += render(binary, request);
+    }
+
+    EXPECT_EQ(decodeAll(encoded), expected);
+}
+
+TEST_F(BinaryEncodingTest, DictionaryEntriesAreWrittenOnce) {
+    BinaryEncoder encoder;
+    char buffer[512];
+
+    auto first = makeEvent(Logger::SEVERITY_LEVEL::INFO, "request {} took {} us", 12345, 67.5);
+    size_t first_size = encoder.encode(first, buffer, sizeof(buffer));
+
+    auto second = makeEvent(Logger::SEVERITY_LEVEL::INFO, "request {} took {} us", 12346, 68.5);
+    second.timestamp = first.timestamp + 1500ns;
+    size_t second_size = encoder.encode(second, buffer, sizeof(buffer));
+
+    // Header, format and thread entries only precede the first event
+    EXPECT_GT(first_size, Binary::HEADER_SIZE + std::string_view("request {} took {} us").size());
+    // tag + id + delta + thread + level (+ seq) + 12 bytes of arguments
+    EXPECT_LE(second_size, 1u + 1 + 2 + 1 + 1 + 1 + sizeof(int) + sizeof(double));
+
+    auto text = makeText(Logger::SEVERITY_LEVEL::INFO, "plain");
+    size_t text_size = encoder.encode(text, buffer, sizeof(buffer));
+    EXPECT_LT(text_size, 32u);
+}
+
+TEST_F(BinaryEncodingTest, TruncatedRecordIsNotCommitted) {
+    BinaryEncoder encoder;
+
+    auto request = makeEvent(Logger::SEVERITY_LEVEL::INFO, "value {}", 99);
+    char small[8];
+    size_t needed = encoder.encode(request, small, sizeof(small));
+    ASSERT_GE(needed, sizeof(small));
+
+    // The retry has to carry the header and dictionary entries again
+    std::string encoded(needed + 1, '\0');
+    EXPECT_EQ(encoder.encode(request, encoded.data(), encoded.size()), needed);
+    encoded.resize(needed);
+
+    EXPECT_THAT(decodeAll(encoded), testing::HasSubstr("]: value 99\n"));
+}
+
+TEST_F(BinaryEncodingTest, ResetStartsAnIndependentFile) {
+    BinaryEncoder encoder;
+    char buffer[512];
+
+    auto first = makeEvent(Logger::SEVERITY_LEVEL::INFO, "file {}", 1);
+    encoder.encode(first, buffer, sizeof(buffer));
+
+    encoder.reset();
+    auto second = makeEvent(Logger::SEVERITY_LEVEL::INFO, "file {}", 2);
+    size_t size = encoder.encode(second, buffer, sizeof(buffer));
+
+    // Decodable on its own, like a rotated file
+    EXPECT_THAT(decodeAll(std::string(buffer, size)), testing::HasSubstr("]: file 2\n"));
+}
+
+TEST_F(BinaryEncodingTest, TimestampsMayGoBackwards) {
+    auto text = makePreparer(false);
+    auto binary = makePreparer(true);
+
+    auto base = std::chrono::system_clock::now();
+    std::string expected, encoded;
+    for (std::chrono::nanoseconds offset : {0ns, 5000000ns, -3000000000ns, 3600000000000ns, 1ns}) {
+        auto request = makeEvent(Logger::SEVERITY_LEVEL::INFO, "at {}", 1);
+        request.timestamp = base + std::chrono::duration_cast<std::chrono::system_clock::duration>(offset);
+        expected += render(text, request);
+        encoded += render(binary, request);
+    }
+
+    EXPECT_EQ(decodeAll(encoded), expected);
+}
+
+TEST_F(BinaryEncodingTest, DecoderAcceptsArbitraryChunks) {
+    auto binary = makePreparer(true);
+    std::string encoded;
+    for (int i = 0; i < 20; ++i) {
+        auto request = i % 3 == 0 ? makeText(Logger::SEVERITY_LEVEL::WARN, "text " + std::to_string(i))
+                                  : makeEvent(Logger::SEVERITY_LEVEL::INFO, "event {} {}", i, i * 0.5);
+        encoded += render(binary, request);
+    }
+    std::string expected = decodeAll(encoded);
+
+    // Fed one byte at a time, consumed bytes are dropped like mrlogger-decode does
+    BinaryDecoder decoder;
+    std::string pending, out;
+    for (char c : encoded) {
+        pending += c;
+        pending.erase(0, decoder.decode(pending, out));
+    }
+
+    EXPECT_EQ(decoder.error(), "");
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(out, expected);
+    EXPECT_EQ(decoder.messages(), 20u);
+}
+
+TEST_F(BinaryEncodingTest, PaddingAndAppendedHeadersAreSkipped) {
+    BinaryEncoder first_logger, second_logger;
+    char buffer[512];
+
+    auto first = makeEvent(Logger::SEVERITY_LEVEL::INFO, "first run {}", 1);
+    std::string encoded(buffer, first_logger.encode(first, buffer, sizeof(buffer)));
+    encoded += std::string(100, '\0');  // Zero padded direct I/O tail block
+
+    auto second = makeEvent(Logger::SEVERITY_LEVEL::INFO, "second run {}", 2);
+    encoded += std::string(buffer, second_logger.encode(second, buffer, sizeof(buffer)));
+
+    std::string decoded = decodeAll(encoded);
+    EXPECT_THAT(decoded, testing::HasSubstr("]: first run 1\n"));
+    EXPECT_THAT(decoded, testing::HasSubstr("]: second run 2\n"));
+}
+
+TEST_F(BinaryEncodingTest, DecoderRejectsTextLogs) {
+    BinaryDecoder decoder;
+    std::string out;
+
+    decoder.decode("[2025-01-01 00:00:00] [INFO] [Thread: 1]: hello\n", out);
+
+    EXPECT_THAT(decoder.error(), testing::HasSubstr("not a MR::Logger binary log"));
+    EXPECT_TRUE(out.empty());
+}
+
+}
@@ -5,6 +5,7 @@
 #include <vector>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 
 namespace MR::Memory::Test {
 
@@ -166,6 +167,22 @@ TEST_F(BufferPoolTest, ExhaustLargePool) {
     EXPECT_EQ(pool_->getAvailableBuffers(), BufferPool::SMALL_POOL_SIZE + BufferPool::MEDIUM_POOL_SIZE);
 }
 
+TEST_F(BufferPoolTest, CountsAcquiresAndMisses) {
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    for (size_t i = 0; i < BufferPool::SMALL_POOL_SIZE + 3; ++i) {
+        buffers.push_back(pool_->acquire(512));
+    }
+    buffers.push_back(pool_->acquire(BufferPool::LARGE_BUFFER_SIZE + 1));
+
+    EXPECT_EQ(pool_->acquireCount(), BufferPool::SMALL_POOL_SIZE + 4);
+    EXPECT_EQ(pool_->missCount(), 4u);
+
+    // Released buffers are hits again
+    pool_->release(std::move(buffers.front()));
+    auto reused = pool_->acquire(512);
+    EXPECT_EQ(pool_->missCount(), 4u);
+}
+
 TEST_F(BufferPoolTest, AcquireReleasePattern) {
     for (int iteration = 0; iteration < 10; ++iteration) {
         std::vector<std::unique_ptr<Buffer>> buffers;
@@ -185,6 +202,246 @@ TEST_F(BufferPoolTest, AcquireReleasePattern) {
     }
 }
 
+TEST_F(BufferPoolTest, AlignedPoolAlignsEveryBuffer) {
+    BufferPool aligned(4096);
+
+    std::vector<std::unique_ptr<Buffer>> held;
+    for (size_t size : {100, 2000, 10000, 50000}) {
+        held.push_back(aligned.acquire(size));
+    }
+    // Fallback allocations once a pool is exhausted
+    for (size_t i = 0; i < BufferPool::LARGE_POOL_SIZE + 1; ++i) {
+        held.push_back(aligned.acquire(BufferPool::LARGE_BUFFER_SIZE));
+    }
+
+    for (const auto& buffer : held) {
+        ASSERT_NE(buffer->data, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer->data) % 4096, 0u);
+    }
+}
+
+TEST_F(BufferPoolTest, PrepareFixedBuffersAssignsUniqueIndexes) {
+    auto iovecs = pool_->prepareFixedBuffers();
+    ASSERT_EQ(iovecs.size(), pool_->getTotalBuffers());
+
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<bool> seen(iovecs.size(), false);
+    for (size_t i = 0; i < BufferPool::SMALL_POOL_SIZE; ++i) {
+        auto buffer = pool_->acquire(512);
+        ASSERT_GE(buffer->buf_index, 0);
+        ASSERT_LT(static_cast<size_t>(buffer->buf_index), iovecs.size());
+        EXPECT_FALSE(seen[buffer->buf_index]);
+        seen[buffer->buf_index] = true;
+
+        const auto& iov = iovecs[buffer->buf_index];
+        EXPECT_EQ(iov.iov_base, buffer->data);
+        EXPECT_EQ(iov.iov_len, buffer->capacity);
+        buffers.push_back(std::move(buffer));
+    }
+}
+
+TEST_F(BufferPoolTest, FixedPoolKeepsRegisteredBuffersOverFallbacks) {
+    pool_->prepareFixedBuffers();
+
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    for (size_t i = 0; i < BufferPool::SMALL_POOL_SIZE + 5; ++i) {
+        buffers.push_back(pool_->acquire(512));
+    }
+
+    // Fallback buffers are not registered and release them first
+    for (size_t i = BufferPool::SMALL_POOL_SIZE; i < buffers.size(); ++i) {
+        EXPECT_EQ(buffers[i]->buf_index, -1);
+        pool_->release(std::move(buffers[i]));
+    }
+    EXPECT_EQ(pool_->getAvailableBuffers(), BufferPool::MEDIUM_POOL_SIZE + BufferPool::LARGE_POOL_SIZE);
+
+    for (size_t i = 0; i < BufferPool::SMALL_POOL_SIZE; ++i) {
+        pool_->release(std::move(buffers[i]));
+    }
+    EXPECT_EQ(pool_->getAvailableBuffers(), pool_->getTotalBuffers());
+
+    auto buffer = pool_->acquire(512);
+    EXPECT_GE(buffer->buf_index, 0);
+}
+
+TEST_F(BufferPoolTest, ClearFixedBuffersResetsIndexes) {
+    pool_->prepareFixedBuffers();
+    pool_->clearFixedBuffers();
+
+    auto buffer = pool_->acquire(512);
+    EXPECT_EQ(buffer->buf_index, -1);
+}
+
+TEST_F(BufferPoolTest, PrepareFixedBuffersWhileInUseThrows) {
+    auto buffer = pool_->acquire(512);
+    EXPECT_THROW(pool_->prepareFixedBuffers(), std::logic_error);
+}
+
+TEST_F(BufferPoolTest, ConfiguredSizesAreHonored) {
+    BufferPool configured(BufferPool::Config{
+        .small_buffer_size = 256,
+        .medium_buffer_size = 512,
+        .large_buffer_size = 2048,
+        .small_pool_size = 3,
+        .medium_pool_size = 2,
+        .large_pool_size = 1
+    });
+    EXPECT_EQ(configured.getTotalBuffers(), 6u);
+    EXPECT_EQ(configured.getAvailableBuffers(), 6u);
+
+    auto small = configured.acquire(200);
+    auto medium = configured.acquire(300);
+    auto large = configured.acquire(1000);
+    auto fallback = configured.acquire(1500);
+    auto oversized = configured.acquire(4096);
+    EXPECT_EQ(small->capacity, 256u);
+    EXPECT_EQ(medium->capacity, 512u);
+    EXPECT_EQ(large->capacity, 2048u);
+    EXPECT_EQ(fallback->capacity, 2048u);
+    EXPECT_EQ(oversized->capacity, 4096u);
+    EXPECT_EQ(configured.getAvailableBuffers(), 3u);
+
+    // Only one large slot, the fallback is freed instead of pooled
+    configured.release(std::move(large));
+    configured.release(std::move(fallback));
+    configured.release(std::move(oversized));
+    EXPECT_EQ(configured.getAvailableBuffers(), 4u);
+}
+
+TEST_F(BufferPoolTest, UnorderedSizesThrow) {
+    EXPECT_THROW(BufferPool(BufferPool::Config{.small_buffer_size = 4096, .medium_buffer_size = 4096}), std::invalid_argument);
+    EXPECT_THROW(BufferPool(BufferPool::Config{.small_buffer_size = 0}), std::invalid_argument);
+}
+
+TEST_F(BufferPoolTest, EmptyPoolsAlwaysAllocate) {
+    BufferPool unpooled(BufferPool::Config{.small_pool_size = 0, .medium_pool_size = 0, .large_pool_size = 0});
+    EXPECT_EQ(unpooled.getTotalBuffers(), 0u);
+
+    auto buffer = unpooled.acquire(100);
+    EXPECT_EQ(buffer->capacity, BufferPool::SMALL_BUFFER_SIZE);
+    unpooled.release(std::move(buffer));
+    EXPECT_EQ(unpooled.getAvailableBuffers(), 0u);
+}
+
+TEST_F(BufferPoolTest, ArenaHoldsEveryPooledBuffer) {
+    BufferPool pooled(BufferPool::Config{.alignment = 4096, .arena = true});
+    ASSERT_NE(pooled.arena(), nullptr);
+    const char* begin = pooled.arena()->data();
+    const char* end = begin + pooled.arena()->size();
+
+    std::vector<std::unique_ptr<Buffer>> held;
+    for (size_t i = 0; i < BufferPool::SMALL_POOL_SIZE; ++i) held.push_back(pooled.acquire(100));
+    for (size_t i = 0; i < BufferPool::LARGE_POOL_SIZE; ++i) held.push_back(pooled.acquire(10000));
+
+    for (const auto& buffer : held) {
+        const char* data = buffer->as_char();
+        EXPECT_FALSE(buffer->owned);
+        EXPECT_GE(data, begin);
+        EXPECT_LE(data + buffer->capacity, end);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 4096, 0u);
+    }
+
+    // Exhausted, the fallback owns its memory
+    auto fallback = pooled.acquire(100);
+    EXPECT_TRUE(fallback->owned);
+
+    // Dropping an arena buffer must not free arena memory
+    held.pop_back();
+    for (auto& buffer : held) pooled.release(std::move(buffer));
+    EXPECT_EQ(pooled.getAvailableBuffers(), pooled.getTotalBuffers() - 1);
+}
+
+TEST_F(BufferPoolTest, ArenaRegistersAsOneFixedBuffer) {
+    BufferPool pooled(BufferPool::Config{.arena = true});
+    ASSERT_NE(pooled.arena(), nullptr);
+
+    auto iovecs = pooled.prepareFixedBuffers();
+    ASSERT_EQ(iovecs.size(), 1u);
+    EXPECT_EQ(iovecs[0].iov_base, pooled.arena()->data());
+    EXPECT_EQ(iovecs[0].iov_len, pooled.arena()->size());
+
+    auto small = pooled.acquire(100);
+    auto large = pooled.acquire(10000);
+    EXPECT_EQ(small->buf_index, 0);
+    EXPECT_EQ(large->buf_index, 0);
+}
+
+TEST_F(BufferPoolTest, LazyPoolGrowsToItsSize) {
+    BufferPool lazy(BufferPool::Config{.small_pool_size = 8, .medium_pool_size = 4, .large_pool_size = 2,
+                                       .initial_buffers = 2});
+    EXPECT_EQ(lazy.getTotalBuffers(), 14u);
+    EXPECT_EQ(lazy.getAvailableBuffers(), 6u);
+
+    // Past the initial buffers acquires allocate, their releases are cached up to the pool size
+    std::vector<std::unique_ptr<Buffer>> held;
+    for (int i = 0; i < 10; ++i) held.push_back(lazy.acquire(100));
+    EXPECT_EQ(lazy.missCount(), 8u);
+    for (auto& buffer : held) lazy.release(std::move(buffer));
+    EXPECT_EQ(lazy.getAvailableBuffers(), 8u + 2u + 2u);
+
+    held.clear();
+    for (int i = 0; i < 8; ++i) held.push_back(lazy.acquire(100));
+    EXPECT_EQ(lazy.missCount(), 8u);
+}
+
+TEST_F(BufferPoolTest, TrimKeepsDecayingHighWaterMark) {
+    BufferPool lazy(BufferPool::Config{.small_pool_size = 64, .medium_pool_size = 0, .large_pool_size = 0,
+                                       .initial_buffers = 4});
+
+    std::vector<std::unique_ptr<Buffer>> held;
+    for (int i = 0; i < 40; ++i) held.push_back(lazy.acquire(100));
+    for (auto& buffer : held) lazy.release(std::move(buffer));
+    EXPECT_EQ(lazy.getAvailableBuffers(), 40u);
+
+    // The burst itself is kept once, then half of it per trim, never below the initial buffers
+    EXPECT_TRUE(lazy.trimmable());
+    EXPECT_EQ(lazy.trim(), 0u);
+    EXPECT_EQ(lazy.trim(), 20u);
+    EXPECT_EQ(lazy.getAvailableBuffers(), 20u);
+    EXPECT_EQ(lazy.trim(), 10u);
+    EXPECT_EQ(lazy.trim(), 5u);
+    EXPECT_EQ(lazy.trim(), 1u);
+    EXPECT_EQ(lazy.getAvailableBuffers(), 4u);
+    lazy.trim();
+    EXPECT_EQ(lazy.getAvailableBuffers(), 4u);
+    EXPECT_FALSE(lazy.trimmable());
+
+    // Buffers in use count towards what is kept
+    held.clear();
+    for (int i = 0; i < 3; ++i) held.push_back(lazy.acquire(100));
+    lazy.trim();
+    EXPECT_EQ(lazy.getAvailableBuffers(), 1u);
+}
+
+TEST_F(BufferPoolTest, WarmUpFillsEveryClass) {
+    BufferPool lazy(BufferPool::Config{.small_pool_size = 8, .medium_pool_size = 4, .large_pool_size = 2,
+                                       .initial_buffers = 1});
+    auto held = lazy.acquire(100);
+
+    lazy.warmUp();
+    EXPECT_EQ(lazy.getAvailableBuffers(), 7u + 4u + 2u);
+
+    // Counted as peak use, the first trim keeps the warmed buffers
+    EXPECT_EQ(lazy.trim(), 0u);
+    EXPECT_GT(lazy.trim(), 0u);
+}
+
+TEST_F(BufferPoolTest, FixedAndArenaPoolsAreNeverTrimmed) {
+    BufferPool fixed(BufferPool::Config{.small_pool_size = 8, .medium_pool_size = 4, .large_pool_size = 2,
+                                        .initial_buffers = 1});
+    // Registration needs every buffer up front
+    EXPECT_EQ(fixed.prepareFixedBuffers().size(), 14u);
+    EXPECT_FALSE(fixed.trimmable());
+    EXPECT_EQ(fixed.trim(), 0u);
+    EXPECT_EQ(fixed.getAvailableBuffers(), 14u);
+
+    BufferPool arena(BufferPool::Config{.initial_buffers = 1, .arena = true});
+    ASSERT_NE(arena.arena(), nullptr);
+    EXPECT_EQ(arena.getAvailableBuffers(), arena.getTotalBuffers());
+    EXPECT_FALSE(arena.trimmable());
+    EXPECT_EQ(arena.trim(), 0u);
+}
+
 class BufferPoolRaceConditionTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -387,4 +644,33 @@ TEST_F(BufferPoolRaceConditionTest, ConcurrentGetAvailableBuffers) {
     EXPECT_EQ(pool_->getAvailableBuffers(), expected_total);
 }
 
+TEST_F(BufferPoolRaceConditionTest, PooledBufferIsNeverSharedUnderContention) {
+    // Far fewer slots than threads, so slots are popped and pushed back all the time
+    BufferPool small(BufferPool::Config{.small_pool_size = 4, .medium_pool_size = 0, .large_pool_size = 0});
+    const int num_threads = 8;
+    const int cycles_per_thread = 20000;
+    std::atomic<int> corrupted{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < cycles_per_thread; ++i) {
+                auto buffer = small.acquire(64);
+                auto* marker = static_cast<int*>(buffer->data);
+                *marker = t;
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+                if (*marker != t) corrupted++;
+                small.release(std::move(buffer));
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(corrupted.load(), 0);
+    EXPECT_EQ(small.getAvailableBuffers(), 4u);
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Logger/Clock.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace MR::Logger::Test {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// How far a stamp turned into wall time lies from the system clock read right after it
+std::chrono::nanoseconds lag(Clock& clock) {
+    std::vector<WriteRequest> requests(1);
+    requests[0].timestamp = clock.stamp();
+    clock.toWallTime(requests);
+    auto now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now - requests[0].timestamp);
+}
+
+}
+
+TEST(ClockTest, SystemStampsAreWallTime) {
+    Clock clock(ClockSource::SYSTEM);
+    EXPECT_EQ(clock.source(), ClockSource::SYSTEM);
+    auto delta = lag(clock);
+    EXPECT_GE(delta, 0ns);
+    EXPECT_LT(delta, 10ms);
+}
+
+TEST(ClockTest, CoarseStampsTrailByAtMostATick) {
+    Clock clock(ClockSource::REALTIME_COARSE);
+    EXPECT_EQ(clock.source(), ClockSource::REALTIME_COARSE);
+    auto delta = lag(clock);
+    EXPECT_GT(delta, -1ms);
+    EXPECT_LT(delta, 20ms);
+}
+
+TEST(ClockTest, TscTicksBecomeWallTime) {
+    Clock clock(ClockSource::TSC);
+    if (clock.source() != ClockSource::TSC) GTEST_SKIP() << "No invariant TSC";
+
+    EXPECT_LT(std::chrono::abs(lag(clock)), 1ms);
+
+    // Converted in one batch, later stamps stay later
+    std::vector<WriteRequest> requests(3);
+    for (auto& request : requests) {
+        request.timestamp = clock.stamp();
+        std::this_thread::sleep_for(2ms);
+    }
+    clock.toWallTime(requests);
+    EXPECT_GE(requests[1].timestamp - requests[0].timestamp, 2ms);
+    EXPECT_GE(requests[2].timestamp - requests[1].timestamp, 2ms);
+}
+
+TEST(ClockTest, TscStaysCloseAcrossCalibrations) {
+    Clock clock(ClockSource::TSC);
+    if (clock.source() != ClockSource::TSC) GTEST_SKIP() << "No invariant TSC";
+
+    // A stamp taken before a calibration is converted with the one after it
+    std::vector<WriteRequest> requests(1);
+    requests[0].timestamp = clock.stamp();
+    auto taken = std::chrono::system_clock::now();
+    std::this_thread::sleep_for(50ms);
+    clock.calibrate();
+    clock.toWallTime(requests);
+    EXPECT_LT(std::chrono::abs(requests[0].timestamp - taken), 1ms);
+
+    std::this_thread::sleep_for(50ms);
+    clock.calibrate();
+    EXPECT_LT(std::chrono::abs(lag(clock)), 1ms);
+}
+
+}
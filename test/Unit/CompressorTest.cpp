@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/IO/Compressor.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef MRLOGGER_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace MR::IO::Test {
+
+class CompressorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = std::filesystem::temp_directory_path() / "compressor_test";
+        std::filesystem::remove_all(test_dir_);
+        std::filesystem::create_directories(test_dir_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir_);
+    }
+
+    static std::string logLines(size_t count) {
+        std::string content;
+        for (size_t i = 0; i < count; ++i) {
+            content += "[INFO] [Thread 42] Compressible message " + std::to_string(i) + "\n";
+        }
+        return content;
+    }
+
+    void createFile(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+
+    static std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+#ifdef MRLOGGER_HAS_ZSTD
+    // Decompresses every frame of data
+    static std::string decompress(const std::string& data) {
+        ZSTD_DCtx* ctx = ZSTD_createDCtx();
+        std::string result;
+        std::vector<char> out(ZSTD_DStreamOutSize());
+        ZSTD_inBuffer input{data.data(), data.size(), 0};
+        while (input.pos < input.size) {
+            ZSTD_outBuffer output{out.data(), out.size(), 0};
+            size_t status = ZSTD_decompressStream(ctx, &output, &input);
+            if (ZSTD_isError(status)) break;
+            result.append(out.data(), output.pos);
+        }
+        ZSTD_freeDCtx(ctx);
+        return result;
+    }
+#endif
+
+    std::filesystem::path test_dir_;
+};
+
+TEST_F(CompressorTest, WithoutZstdCompressFileKeepsOriginal) {
+    if (compressionAvailable()) GTEST_SKIP() << "built with zstd";
+
+    auto path = test_dir_ / "app1.log";
+    createFile(path, logLines(10));
+
+    EXPECT_THAT(BackgroundCompressor::compressFile(path.string(), 3), testing::HasSubstr("without zstd"));
+    EXPECT_TRUE(std::filesystem::exists(path));
+    EXPECT_FALSE(std::filesystem::exists(test_dir_ / "app1.log.zst"));
+}
+
+TEST_F(CompressorTest, WithoutZstdFrameCompressorFails) {
+    if (compressionAvailable()) GTEST_SKIP() << "built with zstd";
+
+    FrameCompressor compressor(3);
+    std::string input = logLines(10);
+    std::vector<char> out(FrameCompressor::bound(input.size()));
+
+    EXPECT_EQ(compressor.compress(input.data(), input.size(), out.data(), out.size()), 0u);
+}
+
+#ifdef MRLOGGER_HAS_ZSTD
+TEST_F(CompressorTest, CompressFileReplacesOriginal) {
+    auto path = test_dir_ / "app1.log";
+    std::string content = logLines(50000);
+    createFile(path, content);
+
+    EXPECT_EQ(BackgroundCompressor::compressFile(path.string(), 3), "");
+
+    EXPECT_FALSE(std::filesystem::exists(path));
+    auto compressed = readFile(test_dir_ / "app1.log.zst");
+    EXPECT_LT(compressed.size(), content.size() / 4);
+    EXPECT_EQ(decompress(compressed), content);
+}
+
+TEST_F(CompressorTest, CompressFileKeepsAnExistingArchive) {
+    auto path = test_dir_ / "app1.log";
+    createFile(path, logLines(10));
+    createFile(test_dir_ / "app1.log.zst", "previous archive");
+
+    EXPECT_THAT(BackgroundCompressor::compressFile(path.string(), 3), testing::HasSubstr("already exists"));
+    EXPECT_EQ(readFile(test_dir_ / "app1.log.zst"), "previous archive");
+    EXPECT_EQ(readFile(path), logLines(10));
+}
+
+TEST_F(CompressorTest, CompressEmptyFile) {
+    auto path = test_dir_ / "empty1.log";
+    createFile(path, "");
+
+    EXPECT_EQ(BackgroundCompressor::compressFile(path.string(), 3), "");
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_EQ(decompress(readFile(test_dir_ / "empty1.log.zst")), "");
+}
+
+TEST_F(CompressorTest, CompressMissingFileFails) {
+    auto path = test_dir_ / "missing1.log";
+
+    EXPECT_THAT(BackgroundCompressor::compressFile(path.string(), 3), testing::HasSubstr("Failed to open"));
+    EXPECT_FALSE(std::filesystem::exists(test_dir_ / "missing1.log.zst"));
+}
+
+TEST_F(CompressorTest, StopRequestedKeepsOriginal) {
+    auto path = test_dir_ / "app1.log";
+    std::string content = logLines(1000);
+    createFile(path, content);
+
+    std::stop_source stop;
+    stop.request_stop();
+    EXPECT_THAT(BackgroundCompressor::compressFile(path.string(), 3, stop.get_token()), testing::HasSubstr("Interrupted"));
+
+    EXPECT_EQ(readFile(path), content);
+    EXPECT_FALSE(std::filesystem::exists(test_dir_ / "app1.log.zst"));
+}
+
+TEST_F(CompressorTest, FramesConcatenateToTheInput) {
+    FrameCompressor compressor(1);
+    std::string first = logLines(100);
+    std::string second = logLines(7);
+
+    std::string stream;
+    for (const std::string* input : {&first, &second}) {
+        std::vector<char> out(FrameCompressor::bound(input->size()));
+        size_t size = compressor.compress(input->data(), input->size(), out.data(), out.size());
+        ASSERT_GT(size, 0u);
+        stream.append(out.data(), size);
+    }
+
+    EXPECT_EQ(decompress(stream), first + second);
+}
+
+TEST_F(CompressorTest, BackgroundCompressorDrainsBacklog) {
+    std::vector<std::string> errors;
+    BackgroundCompressor compressor(3, [&errors](const char*, const std::string& msg) { errors.push_back(msg); });
+
+    std::string content = logLines(2000);
+    for (int i = 1; i <= 3; ++i) {
+        auto path = test_dir_ / ("app" + std::to_string(i) + ".log");
+        createFile(path, content);
+        compressor.enqueue(path.string());
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (compressor.backlog().files > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    EXPECT_EQ(compressor.backlog().files, 0u);
+    EXPECT_EQ(compressor.backlog().bytes, 0u);
+    EXPECT_TRUE(errors.empty());
+    for (int i = 1; i <= 3; ++i) {
+        EXPECT_FALSE(std::filesystem::exists(test_dir_ / ("app" + std::to_string(i) + ".log")));
+        EXPECT_EQ(decompress(readFile(test_dir_ / ("app" + std::to_string(i) + ".log.zst"))), content);
+    }
+}
+#endif
+
+}
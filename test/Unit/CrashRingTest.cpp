@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/IO/CrashRing.hpp>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace MR::IO::Test {
+
+class CrashRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ring_file_ = std::filesystem::temp_directory_path() / "crashring_test.ring";
+        std::filesystem::remove(ring_file_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(ring_file_);
+    }
+
+    static uint64_t append(CrashRing& ring, uint16_t sink, const std::string& data) {
+        return ring.append(sink, data.data(), data.size());
+    }
+
+    std::filesystem::path ring_file_;
+};
+
+TEST_F(CrashRingTest, NewFileHasNothingToRecover) {
+    CrashRing ring(ring_file_.string(), 8192);
+
+    EXPECT_TRUE(ring.recovered().empty());
+    EXPECT_EQ(ring.capacity(), 8192u);
+    EXPECT_EQ(ring.pendingBytes(), 0u);
+}
+
+TEST_F(CrashRingTest, PendingRecordsAreRecoveredInOrder) {
+    {
+        CrashRing ring(ring_file_.string(), 8192);
+        uint64_t first = append(ring, 0, "first line\n");
+        uint64_t second = append(ring, 1, "second line\n");
+        append(ring, 0, "third line\n");
+        ASSERT_NE(first, CrashRing::NO_RECORD);
+        ASSERT_NE(second, CrashRing::NO_RECORD);
+
+        ring.complete(second);  // Out of order, the first one still holds the tail
+        EXPECT_GT(ring.pendingBytes(), 0u);
+    }
+
+    CrashRing reopened(ring_file_.string(), 8192);
+    auto& recovered = reopened.recovered();
+    ASSERT_EQ(recovered.size(), 2u);
+    EXPECT_EQ(recovered[0].sink, 0u);
+    EXPECT_EQ(recovered[0].data, "first line\n");
+    EXPECT_EQ(recovered[1].data, "third line\n");
+
+    // Recovered once, the ring starts empty
+    EXPECT_EQ(reopened.pendingBytes(), 0u);
+    EXPECT_TRUE(CrashRing(ring_file_.string(), 8192).recovered().empty());
+}
+
+TEST_F(CrashRingTest, CompletedRecordsFreeTheirSpace) {
+    CrashRing ring(ring_file_.string(), 4096);
+    std::string data(1000, 'x');
+
+    // Several laps around the area, a record that doesn't fit at the end starts over at 0
+    for (int i = 0; i < 40; ++i) {
+        uint64_t record = append(ring, 0, data + std::to_string(i));
+        ASSERT_NE(record, CrashRing::NO_RECORD) << i;
+        ring.complete(record);
+        EXPECT_EQ(ring.pendingBytes(), 0u);
+    }
+}
+
+TEST_F(CrashRingTest, FullRingRejectsRecords) {
+    CrashRing ring(ring_file_.string(), 4096);
+    std::string data(1500, 'y');
+
+    uint64_t first = append(ring, 0, data);
+    uint64_t second = append(ring, 0, data);
+    ASSERT_NE(first, CrashRing::NO_RECORD);
+    ASSERT_NE(second, CrashRing::NO_RECORD);
+    EXPECT_EQ(append(ring, 0, data), CrashRing::NO_RECORD);
+    EXPECT_EQ(append(ring, 0, std::string(5000, 'z')), CrashRing::NO_RECORD);
+
+    ring.complete(first);
+    EXPECT_NE(append(ring, 0, data), CrashRing::NO_RECORD);
+}
+
+TEST_F(CrashRingTest, RecordsSurviveAKilledProcess) {
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        CrashRing ring(ring_file_.string(), 8192);
+        append(ring, 2, "lost in the crash\n");
+        ::kill(::getpid(), SIGKILL);
+        ::_exit(0);
+    }
+
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFSIGNALED(status));
+
+    CrashRing ring(ring_file_.string(), 8192);
+    ASSERT_EQ(ring.recovered().size(), 1u);
+    EXPECT_EQ(ring.recovered()[0].sink, 2u);
+    EXPECT_EQ(ring.recovered()[0].data, "lost in the crash\n");
+}
+
+TEST_F(CrashRingTest, GarbageFileIsIgnored) {
+    {
+        std::ofstream file(ring_file_, std::ios::binary);
+        file << std::string(10000, '\xff');
+    }
+
+    CrashRing ring(ring_file_.string(), 8192);
+    EXPECT_TRUE(ring.recovered().empty());
+    EXPECT_NE(append(ring, 0, "fresh\n"), CrashRing::NO_RECORD);
+}
+
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Logger/DeferredFormat.hpp>
+#include <fmt/format.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace MR::Logger::Test {
+
+enum class Color { RED, GREEN };
+
+struct Point {
+    int x;
+    int y;
+};
+
+}
+
+template <>
+struct fmt::formatter<MR::Logger::Test::Color> : fmt::formatter<std::string_view> {
+    auto format(MR::Logger::Test::Color c, format_context& ctx) const {
+        return fmt::formatter<std::string_view>::format(c == MR::Logger::Test::Color::RED ? "red" : "green", ctx);
+    }
+};
+
+template <>
+struct fmt::formatter<MR::Logger::Test::Point> : fmt::formatter<std::string_view> {
+    auto format(const MR::Logger::Test::Point& p, format_context& ctx) const {
+        return fmt::format_to(ctx.out(), "({}, {})", p.x, p.y);
+    }
+};
+
+template <>
+struct MR::Logger::is_deferrable<MR::Logger::Test::Point> : std::true_type {};
+
+namespace MR::Logger::Test {
+
+class DeferredFormatTest : public ::testing::Test {
+protected:
+    std::string render(const DeferredFormat& deferred) {
+        char buffer[256];
+        size_t size = deferred.format(buffer, sizeof(buffer));
+        return std::string(buffer, std::min(size, sizeof(buffer)));
+    }
+};
+
+TEST_F(DeferredFormatTest, DefaultConstructedIsEmpty) {
+    DeferredFormat deferred;
+    EXPECT_FALSE(deferred);
+}
+
+TEST_F(DeferredFormatTest, MatchesEagerFormatting) {
+    auto deferred = DeferredFormat::capture("id={} ratio={:.2f} ok={} c={}", 42, 3.14159, true, 'x');
+
+    ASSERT_TRUE(deferred);
+    EXPECT_EQ(render(deferred), fmt::format("id={} ratio={:.2f} ok={} c={}", 42, 3.14159, true, 'x'));
+}
+
+TEST_F(DeferredFormatTest, MixedAlignmentArguments) {
+    uint8_t small = 7;
+    uint64_t big = 1234567890123ull;
+    int16_t medium = -12;
+
+    auto deferred = DeferredFormat::capture("{} {} {} {}", small, big, medium, 2.5f);
+
+    EXPECT_EQ(render(deferred), "7 1234567890123 -12 2.5");
+}
+
+TEST_F(DeferredFormatTest, NoArguments) {
+    auto deferred = DeferredFormat::capture("plain text");
+    EXPECT_EQ(render(deferred), "plain text");
+}
+
+TEST_F(DeferredFormatTest, EnumsAndOptInTypes) {
+    auto deferred = DeferredFormat::capture("{} at {}", Color::GREEN, Point{3, 4});
+    EXPECT_EQ(render(deferred), "green at (3, 4)");
+}
+
+TEST_F(DeferredFormatTest, CapturedValuesAreCopies) {
+    int value = 1;
+    auto deferred = DeferredFormat::capture("{}", value);
+    value = 2;
+
+    EXPECT_EQ(render(deferred), "1");
+}
+
+TEST_F(DeferredFormatTest, TruncatedOutputReportsFullSize) {
+    auto deferred = DeferredFormat::capture("{}-{}", 123456, 789);
+
+    char buffer[4];
+    size_t size = deferred.format(buffer, sizeof(buffer));
+
+    EXPECT_EQ(size, 10u);
+    EXPECT_EQ(std::string_view(buffer, sizeof(buffer)), "1234");
+}
+
+TEST_F(DeferredFormatTest, FitsRejectsNonOwningAndOversizedArguments) {
+    EXPECT_TRUE((DeferredFormat::fits<int, double, bool>));
+    EXPECT_TRUE((DeferredFormat::fits<>));
+    EXPECT_FALSE((DeferredFormat::fits<std::string>));
+    EXPECT_FALSE((DeferredFormat::fits<const char*>));
+    EXPECT_FALSE((DeferredFormat::fits<std::string_view>));
+    EXPECT_FALSE((DeferredFormat::fits<uint64_t, uint64_t, uint64_t, uint64_t,
+                                       uint64_t, uint64_t, uint64_t, uint64_t, uint64_t>));
+}
+
+}
@@ -193,6 +193,20 @@ TEST_F(FileRotaterTest, RotationSkipsExistingFiles) {
     EXPECT_EQ(content3, "new_content");
 }
 
+TEST_F(FileRotaterTest, RotationSkipsCompressedAndIndexedFiles) {
+    FileRotater rotater(test_file_.string(), 100);
+
+    // What CompressionMode::ROTATED and index_interval_bytes leave of earlier rotations
+    createFile(test_dir_ / "test1.log.zst", "archive1");
+    createFile(test_dir_ / "test2.log.idx", "index2");
+
+    createFile(test_file_, "new_content");
+    EXPECT_EQ(rotater.rotate(), (test_dir_ / "test3.log").string());
+    EXPECT_EQ(rotater.beginRotation(), (test_dir_ / "test4.log").string());
+    EXPECT_FALSE(fileExists(test_dir_ / "test1.log"));
+    EXPECT_FALSE(fileExists(test_dir_ / "test2.log"));
+}
+
 TEST_F(FileRotaterTest, GetCurrentFilenameConsistent) {
     std::string filename = test_file_.string();
     FileRotater rotater(filename, 100);
@@ -251,4 +265,40 @@ TEST_F(FileRotaterTest, FilenameStartingWithDot) {
     EXPECT_FALSE(fileExists(hidden_file));
 }
 
-}
\ No newline at end of file
+TEST_F(FileRotaterTest, BeginRotationReservesIncreasingNames) {
+    FileRotater rotater(test_file_.string(), 100);
+
+    rotater.updateCurrentSize(150);
+    // Nothing is renamed yet, the cached counter still never hands out a name twice
+    EXPECT_EQ(rotater.beginRotation(), (test_dir_ / "test1.log").string());
+    EXPECT_FALSE(rotater.shouldRotate());
+    EXPECT_EQ(rotater.beginRotation(), (test_dir_ / "test2.log").string());
+}
+
+TEST_F(FileRotaterTest, BeginRotationSkipsExistingFiles) {
+    createFile(test_dir_ / "test1.log", "existing1");
+    createFile(test_dir_ / "test2.log", "existing2");
+    FileRotater rotater(test_file_.string(), 100);
+
+    EXPECT_EQ(rotater.beginRotation(), (test_dir_ / "test3.log").string());
+    EXPECT_EQ(rotater.beginRotation(), (test_dir_ / "test4.log").string());
+}
+
+TEST_F(FileRotaterTest, StandbyFilename) {
+    FileRotater rotater(test_file_.string(), 100);
+
+    EXPECT_EQ(rotater.getStandbyFilename(), test_file_.string() + ".next");
+}
+
+TEST_F(FileRotaterTest, ShouldPrepareStandbyAtHalfTheLimit) {
+    FileRotater rotater(test_file_.string(), 100);
+
+    rotater.updateCurrentSize(49);
+    EXPECT_FALSE(rotater.shouldPrepareStandby());
+
+    rotater.updateCurrentSize(1);
+    EXPECT_TRUE(rotater.shouldPrepareStandby());
+    EXPECT_FALSE(rotater.shouldRotate());
+}
+
+}
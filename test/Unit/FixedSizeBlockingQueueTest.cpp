@@ -261,6 +261,54 @@ TEST_F(FixedSizeBlockingQueueTest, EmptyCheck) {
     EXPECT_TRUE(queue_->empty());
 }
 
+TEST_F(FixedSizeBlockingQueueTest, TryPopBatchDrainsInFIFOOrder) {
+    for (int i = 0; i < 5; ++i) {
+        queue_->push(i);
+    }
+
+    std::vector<int> out(3);
+    EXPECT_EQ(queue_->tryPopBatch(out), 3u);
+    EXPECT_THAT(out, ::testing::ElementsAre(0, 1, 2));
+    EXPECT_EQ(queue_->size(), 2);
+
+    EXPECT_EQ(queue_->tryPopBatch(out), 2u);
+    EXPECT_EQ(out[0], 3);
+    EXPECT_EQ(out[1], 4);
+    EXPECT_TRUE(queue_->empty());
+}
+
+TEST_F(FixedSizeBlockingQueueTest, TryPopBatchOnEmptyQueue) {
+    std::vector<int> out(4);
+    EXPECT_EQ(queue_->tryPopBatch(out), 0u);
+}
+
+TEST_F(FixedSizeBlockingQueueTest, TryPopBatchUnblocksWaitingPushers) {
+    for (int i = 0; i < 10; ++i) {
+        queue_->push(i);
+    }
+
+    std::atomic<int> completed{0};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 3; ++t) {
+        producers.emplace_back([&]() {
+            queue_->push(100);
+            completed++;
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(completed, 0);
+
+    std::vector<int> out(3);
+    EXPECT_EQ(queue_->tryPopBatch(out), 3u);
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    EXPECT_EQ(completed, 3);
+    EXPECT_EQ(queue_->size(), 10);
+}
+
 class FixedSizeBlockingQueueConcurrencyTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Logger/FlushTracker.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace MR::Logger::Test {
+
+TEST(FlushTrackerTest, InOrderTicketsAdvanceRightAway) {
+    FlushTracker tracker;
+    EXPECT_EQ(tracker.poppedUpTo(), 0u);
+
+    for (uint64_t ticket = 1; ticket <= 200; ++ticket) tracker.popped(ticket);
+    EXPECT_EQ(tracker.poppedUpTo(), 200u);
+
+    // Lines of the worker itself are not counted
+    tracker.popped(0);
+    EXPECT_EQ(tracker.poppedUpTo(), 200u);
+}
+
+TEST(FlushTrackerTest, OutOfOrderTicketsWaitForTheGap) {
+    FlushTracker tracker;
+    tracker.popped(1);
+    for (uint64_t ticket = 3; ticket <= 300; ++ticket) tracker.popped(ticket);
+    EXPECT_EQ(tracker.poppedUpTo(), 1u);
+
+    tracker.popped(2);
+    EXPECT_EQ(tracker.poppedUpTo(), 300u);
+
+    // Duplicates and tickets far ahead
+    tracker.popped(2);
+    tracker.popped(1000);
+    EXPECT_EQ(tracker.poppedUpTo(), 300u);
+}
+
+TEST(FlushTrackerTest, ShuffledTicketsEndContiguous) {
+    std::vector<uint64_t> tickets(10000);
+    std::iota(tickets.begin(), tickets.end(), 1);
+    std::shuffle(tickets.begin(), tickets.end(), std::mt19937(42));
+
+    FlushTracker tracker;
+    for (uint64_t ticket : tickets) {
+        tracker.popped(ticket);
+        ASSERT_LE(tracker.poppedUpTo(), 10000u);
+    }
+    EXPECT_EQ(tracker.poppedUpTo(), 10000u);
+}
+
+TEST(FlushTrackerTest, EpochsCompleteInOrder) {
+    FlushTracker tracker;
+
+    // Iteration 1: tickets 1-10 in two writes
+    for (uint64_t ticket = 1; ticket <= 10; ++ticket) tracker.popped(ticket);
+    uint64_t first = tracker.taskStarted();
+    uint64_t second = tracker.taskStarted();
+    tracker.seal(false);
+    EXPECT_EQ(tracker.flushed(), 0u);
+
+    // Iteration 2: tickets 11-20 in one write, which completes first
+    for (uint64_t ticket = 11; ticket <= 20; ++ticket) tracker.popped(ticket);
+    uint64_t third = tracker.taskStarted();
+    tracker.seal(false);
+    tracker.taskDone(third);
+    EXPECT_EQ(tracker.flushed(), 0u);
+
+    tracker.taskDone(second);
+    EXPECT_EQ(tracker.flushed(), 0u);
+    tracker.taskDone(first);
+    EXPECT_EQ(tracker.flushed(), 20u);
+}
+
+TEST(FlushTrackerTest, MessagesWithoutTasksFollowTheLastEpoch) {
+    FlushTracker tracker;
+
+    // Nothing in flight: popped is written
+    for (uint64_t ticket = 1; ticket <= 5; ++ticket) tracker.popped(ticket);
+    tracker.seal(false);
+    EXPECT_EQ(tracker.flushed(), 5u);
+
+    uint64_t write = tracker.taskStarted();
+    tracker.popped(6);
+    tracker.seal(false);
+
+    // Filtered by every sink, no task of its own
+    tracker.popped(7);
+    tracker.seal(false);
+    EXPECT_EQ(tracker.flushed(), 5u);
+
+    tracker.taskDone(write);
+    EXPECT_EQ(tracker.flushed(), 7u);
+}
+
+TEST(FlushTrackerTest, HeldBackEpochStaysOpen) {
+    FlushTracker tracker;
+
+    // A direct I/O tail block keeps ticket 1-3 staged
+    for (uint64_t ticket = 1; ticket <= 3; ++ticket) tracker.popped(ticket);
+    tracker.seal(true);
+    EXPECT_EQ(tracker.flushed(), 0u);
+
+    // Written with the next iteration, the task completes before the seal
+    tracker.popped(4);
+    uint64_t write = tracker.taskStarted();
+    tracker.taskDone(write);
+    EXPECT_EQ(tracker.flushed(), 0u);
+    tracker.seal(false);
+    EXPECT_EQ(tracker.flushed(), 4u);
+}
+
+}
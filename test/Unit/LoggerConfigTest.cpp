@@ -302,4 +302,190 @@ TEST_F(LoggerConfigTest, ExactlyEightTimesBatchSize_NoWarning) {
     EXPECT_EQ(countWarnings("less than 8x batch_size"), 0);
 }
 
+TEST_F(LoggerConfigTest, SinkDefaultsAreMerged) {
+    auto sink_file = std::filesystem::temp_directory_path() / "logger_config_test_sink.log";
+    auto config = makeConfig();
+    config.sinks = {{.file_name = sink_file.string()}};
+
+    EXPECT_NO_THROW(Logger::init(config));
+
+    auto final_config = Logger::getConfig();
+    EXPECT_EQ(final_config.log_file_severities, ALL_SEVERITIES);
+    ASSERT_EQ(final_config.sinks.size(), 1u);
+    EXPECT_EQ(final_config.sinks[0].severities, ALL_SEVERITIES);
+    EXPECT_EQ(final_config.sinks[0].max_log_size_bytes, final_config.max_log_size_bytes);
+
+    Logger::_reset();
+    std::filesystem::remove(sink_file);
+}
+
+TEST_F(LoggerConfigTest, DuplicateSinkFileName_ThrowsException) {
+    auto config = makeConfig();
+    config.sinks = {{.file_name = test_log_file_.string(), .severities = severitiesFrom(SEVERITY_LEVEL::ERROR)}};
+
+    EXPECT_THROW({
+        Logger::init(config);
+    }, std::invalid_argument);
+}
+
+TEST_F(LoggerConfigTest, UnroutedSeverity_Warning) {
+    auto config = makeConfig();
+    config.log_file_severities = severitiesFrom(SEVERITY_LEVEL::WARN);
+
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(countWarnings("no log file receives"), 3);
+}
+
+TEST_F(LoggerConfigTest, UnorderedBufferSizes_ThrowsException) {
+    auto config = makeConfig();
+    config.small_buffer_size = 8192;  // Larger than the default medium_buffer_size
+
+    EXPECT_THROW({
+        Logger::init(config);
+    }, std::invalid_argument);
+}
+
+TEST_F(LoggerConfigTest, StagingBufferSize) {
+    auto config = makeConfig();
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(Logger::getConfig().staging_buffer_size, 16384u);
+    EXPECT_EQ(countWarnings("staging_buffer_size"), 0);
+    Logger::_reset();
+
+    // Larger than the large pool buffers: works, but every batch allocates
+    config = makeConfig();
+    config.staging_buffer_size = 65536;
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(Logger::getConfig().staging_buffer_size, 65536u);
+    EXPECT_EQ(countWarnings("exceeds large_buffer_size"), 1);
+}
+
+TEST_F(LoggerConfigTest, OverflowPolicy) {
+    auto config = makeConfig();
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(Logger::getConfig().max_queued_messages, 0u);
+    EXPECT_EQ(Logger::getConfig().overflow_policy, OverflowPolicy::BLOCK);
+    EXPECT_EQ(Logger::getConfig().overflow_timeout_ms, 10u);
+    Logger::_reset();
+
+    config = makeConfig();
+    config.max_queued_messages = 1000;
+    config.overflow_policy = OverflowPolicy::BLOCK_TIMEOUT;
+    config.overflow_timeout_ms = 50;
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(Logger::getConfig().max_queued_messages, 1000u);
+    EXPECT_EQ(Logger::getConfig().overflow_policy, OverflowPolicy::BLOCK_TIMEOUT);
+    EXPECT_EQ(Logger::getConfig().overflow_timeout_ms, 50u);
+}
+
+TEST_F(LoggerConfigTest, WorkerCount) {
+    auto config = makeConfig();
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(Logger::getConfig().worker_count, 1u);
+    EXPECT_EQ(Logger::getConfig().shard_output, ShardOutput::PER_SHARD_FILES);
+    Logger::_reset();
+
+    // Shards sharing a file never rotate it
+    auto sink_file = std::filesystem::temp_directory_path() / "logger_config_test_shared.log";
+    config = makeConfig();
+    config.worker_count = 2;
+    config.shard_output = ShardOutput::SHARED_FILE;
+    config.sinks = {{.file_name = sink_file.string(), .max_log_size_bytes = 4096}};
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(Logger::getConfig().worker_count, 2u);
+    EXPECT_EQ(Logger::getConfig().max_log_size_bytes, SIZE_MAX);
+    EXPECT_EQ(Logger::getConfig().sinks[0].max_log_size_bytes, SIZE_MAX);
+    Logger::_reset();
+    std::filesystem::remove(sink_file);
+}
+
+TEST_F(LoggerConfigTest, WorkerPlacement) {
+    auto config = makeConfig();
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_TRUE(Logger::getConfig().worker_cpus.empty());
+    EXPECT_EQ(Logger::getConfig().numa_node, -1);
+    EXPECT_EQ(Logger::getConfig().worker_scheduling, Thread::Scheduling::NORMAL);
+    Logger::_reset();
+
+    config = makeConfig();
+    config.worker_cpus = {0};
+    config.worker_scheduling = Thread::Scheduling::BATCH;
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_EQ(Logger::getConfig().worker_cpus, std::vector<int>{0});
+    EXPECT_EQ(Logger::getConfig().worker_scheduling, Thread::Scheduling::BATCH);
+    Logger::_reset();
+
+    config = makeConfig();
+    config.worker_cpus = {0, -2};
+    EXPECT_THROW(Logger::init(config), std::invalid_argument);
+}
+
+TEST_F(LoggerConfigTest, WorkerPlacementPerShard) {
+    auto expectedNode = [](int cpu) { return Thread::numaNodeCount() < 2 ? -1 : Thread::numaNodeOf(cpu); };
+
+    // Every shard gets its own slice, its SQ thread the last CPU of it. A shared file
+    // leaves no per shard files behind
+    auto config = makeConfig();
+    config.worker_count = 2;
+    config.shard_output = ShardOutput::SHARED_FILE;
+    config.worker_cpus = {0, 1, 2, 3, 4};
+    EXPECT_NO_THROW(Logger::init(config));
+    auto front = Logger::get()->_workerPlacement(0);
+    auto second = Logger::get()->_workerPlacement(1);
+    EXPECT_EQ(front.cpus, (std::vector<int>{0, 1}));
+    EXPECT_EQ(front.sqpoll_cpu, 1);
+    EXPECT_EQ(front.numa_node, expectedNode(0));
+    EXPECT_EQ(second.cpus, (std::vector<int>{2, 3, 4}));
+    EXPECT_EQ(second.sqpoll_cpu, 4);
+    EXPECT_EQ(second.numa_node, expectedNode(2));
+    EXPECT_THROW(Logger::get()->_workerPlacement(2), std::out_of_range);
+    EXPECT_EQ(Logger::getConfig().worker_cpus, (std::vector<int>{0, 1, 2, 3, 4}));
+    Logger::_reset();
+
+    config = makeConfig();
+    config.worker_count = 3;
+    config.shard_output = ShardOutput::SHARED_FILE;
+    config.worker_cpus = {5, 6, 7};
+    EXPECT_NO_THROW(Logger::init(config));
+    for (size_t shard = 0; shard < 3; ++shard) {
+        auto placement = Logger::get()->_workerPlacement(shard);
+        int cpu = 5 + static_cast<int>(shard);
+        EXPECT_EQ(placement.cpus, std::vector<int>{cpu});
+        EXPECT_EQ(placement.sqpoll_cpu, cpu);
+    }
+    Logger::_reset();
+
+    config = makeConfig();
+    config.worker_count = 3;
+    config.worker_cpus = {0, 1};
+    EXPECT_THROW(Logger::init(config), std::invalid_argument);
+
+    config = makeConfig();
+    config.worker_count = 2;
+    config.ring_mode = IO::RingMode::SQPOLL;
+    config.sqpoll_cpu = 0;
+    EXPECT_THROW(Logger::init(config), std::invalid_argument);
+}
+
+TEST_F(LoggerConfigTest, Autotune) {
+    auto config = makeConfig();
+    EXPECT_NO_THROW(Logger::init(config));
+    EXPECT_FALSE(Logger::getConfig().autotune);
+    EXPECT_EQ(Logger::getConfig().autotune_max_delay_us, 500u);
+    EXPECT_EQ(Logger::getConfig().autotune_min_batch_size, 1u);
+    EXPECT_EQ(Logger::getConfig().autotune_min_coalesce_size, 1u);
+    Logger::_reset();
+
+    config = makeConfig(8, 128, 0);
+    config.autotune = true;
+    config.autotune_min_batch_size = 16;
+    EXPECT_THROW(Logger::init(config), std::invalid_argument);
+    Logger::_reset();
+
+    config = makeConfig(8, 128, 4);
+    config.autotune = true;
+    config.autotune_min_coalesce_size = 6;
+    EXPECT_THROW(Logger::init(config), std::invalid_argument);
+}
+
 }
@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Queue/MPSCRingQueue.hpp>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace MR::Queue::Test {
+
+class MPSCRingQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        queue_ = std::make_unique<MPSCRingQueue<int>>(16);
+    }
+
+    void TearDown() override {
+        queue_->shutdown();
+        queue_.reset();
+    }
+
+    std::unique_ptr<MPSCRingQueue<int>> queue_;
+};
+
+TEST_F(MPSCRingQueueTest, ConstructorInitialization) {
+    EXPECT_TRUE(queue_->empty());
+    EXPECT_EQ(queue_->size(), 0);
+    EXPECT_EQ(queue_->capacity(), 16);
+}
+
+TEST_F(MPSCRingQueueTest, CapacityRoundedUpToPowerOfTwo) {
+    MPSCRingQueue<int> queue(100);
+    EXPECT_EQ(queue.capacity(), 128);
+}
+
+TEST_F(MPSCRingQueueTest, ZeroCapacityThrows) {
+    EXPECT_THROW(MPSCRingQueue<int>(0), std::invalid_argument);
+}
+
+TEST_F(MPSCRingQueueTest, PushAndTryPopSingleElement) {
+    queue_->push(42);
+
+    EXPECT_FALSE(queue_->empty());
+    EXPECT_EQ(queue_->size(), 1);
+
+    auto result = queue_->tryPop();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 42);
+
+    EXPECT_TRUE(queue_->empty());
+    EXPECT_EQ(queue_->size(), 0);
+}
+
+TEST_F(MPSCRingQueueTest, TryPopOnEmptyQueue) {
+    auto result = queue_->tryPop();
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST_F(MPSCRingQueueTest, FIFOOrderingWithWraparound) {
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 16; ++i) {
+            queue_->push(round * 100 + i);
+        }
+        EXPECT_EQ(queue_->size(), 16);
+
+        for (int i = 0; i < 16; ++i) {
+            auto result = queue_->tryPop();
+            ASSERT_TRUE(result.has_value());
+            EXPECT_EQ(result.value(), round * 100 + i);
+        }
+        EXPECT_TRUE(queue_->empty());
+    }
+}
+
+TEST_F(MPSCRingQueueTest, TryPopBatchAcrossWraparound) {
+    for (int i = 0; i < 12; ++i) {
+        queue_->push(i);
+    }
+    for (int i = 0; i < 12; ++i) {
+        queue_->tryPop();
+    }
+    for (int i = 0; i < 10; ++i) {
+        queue_->push(i);
+    }
+
+    std::vector<int> out(16);
+    ASSERT_EQ(queue_->tryPopBatch(out), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(out[i], i);
+    }
+    EXPECT_TRUE(queue_->empty());
+    EXPECT_EQ(queue_->tryPopBatch(out), 0u);
+}
+
+TEST_F(MPSCRingQueueTest, MoveOnlyPayloadSurvives) {
+    MPSCRingQueue<std::string> queue(4);
+    std::string message(256, 'x');
+
+    queue.push(std::move(message));
+
+    auto result = queue.tryPop();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->size(), 256);
+}
+
+TEST_F(MPSCRingQueueTest, PushBlocksWhenQueueFull) {
+    for (int i = 0; i < 16; ++i) {
+        queue_->push(i);
+    }
+
+    std::atomic<bool> push_completed{false};
+
+    std::thread producer([&]() {
+        queue_->push(999);
+        push_completed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(push_completed);
+
+    auto result = queue_->tryPop();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 0);
+
+    producer.join();
+    EXPECT_TRUE(push_completed);
+    EXPECT_EQ(queue_->size(), 16);
+}
+
+TEST_F(MPSCRingQueueTest, ShutdownUnblocksWaitingPush) {
+    for (int i = 0; i < 16; ++i) {
+        queue_->push(i);
+    }
+
+    std::atomic<bool> returned{false};
+
+    std::thread producer([&]() {
+        queue_->push(999);
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(returned);
+
+    queue_->shutdown();
+
+    producer.join();
+    EXPECT_TRUE(returned);
+}
+
+TEST_F(MPSCRingQueueTest, ShutdownUnblocksWaitingPop) {
+    std::atomic<bool> returned{false};
+
+    std::thread consumer([&]() {
+        auto result = queue_->pop();
+        EXPECT_FALSE(result.has_value());
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(returned);
+
+    queue_->shutdown();
+
+    consumer.join();
+    EXPECT_TRUE(returned);
+}
+
+TEST_F(MPSCRingQueueTest, PushAfterShutdownDoesNothing) {
+    queue_->shutdown();
+
+    queue_->push(42);
+
+    EXPECT_TRUE(queue_->empty());
+}
+
+TEST_F(MPSCRingQueueTest, PopDrainsRemainingElementsAfterShutdown) {
+    queue_->push(1);
+    queue_->push(2);
+    queue_->shutdown();
+
+    EXPECT_EQ(queue_->pop().value(), 1);
+    EXPECT_EQ(queue_->pop().value(), 2);
+    EXPECT_FALSE(queue_->pop().has_value());
+}
+
+class MPSCRingQueueConcurrencyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        queue_ = std::make_unique<MPSCRingQueue<int>>(64);
+    }
+
+    void TearDown() override {
+        queue_->shutdown();
+        queue_.reset();
+    }
+
+    std::unique_ptr<MPSCRingQueue<int>> queue_;
+};
+
+TEST_F(MPSCRingQueueConcurrencyTest, ManyProducersSingleConsumer) {
+    const int num_producers = 8;
+    const int elements_per_producer = 20000;
+    std::vector<std::thread> producers;
+
+    for (int t = 0; t < num_producers; ++t) {
+        producers.emplace_back([&, t]() {
+            for (int i = 0; i < elements_per_producer; ++i) {
+                queue_->push(t * elements_per_producer + i);
+            }
+        });
+    }
+
+    // Per-producer FIFO must hold even though producers interleave
+    std::vector<int> last_seen(num_producers, -1);
+    int popped = 0;
+    bool ordered = true;
+
+    while (popped < num_producers * elements_per_producer) {
+        auto result = queue_->tryPop();
+        if (!result.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        int producer = result.value() / elements_per_producer;
+        int index = result.value() % elements_per_producer;
+        if (index <= last_seen[producer]) ordered = false;
+        last_seen[producer] = index;
+        popped++;
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(popped, num_producers * elements_per_producer);
+    EXPECT_TRUE(queue_->empty());
+}
+
+TEST_F(MPSCRingQueueConcurrencyTest, BlockingPopConsumer) {
+    const int num_producers = 4;
+    const int elements_per_producer = 5000;
+    std::vector<std::thread> producers;
+    std::atomic<long long> sum{0};
+
+    std::thread consumer([&]() {
+        for (int i = 0; i < num_producers * elements_per_producer; ++i) {
+            auto result = queue_->pop();
+            ASSERT_TRUE(result.has_value());
+            sum += result.value();
+        }
+    });
+
+    for (int t = 0; t < num_producers; ++t) {
+        producers.emplace_back([&]() {
+            for (int i = 1; i <= elements_per_producer; ++i) {
+                queue_->push(i);
+            }
+        });
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    consumer.join();
+
+    long long expected = static_cast<long long>(num_producers) * elements_per_producer * (elements_per_producer + 1) / 2;
+    EXPECT_EQ(sum.load(), expected);
+}
+
+}
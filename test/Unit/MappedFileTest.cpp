@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/IO/MappedFile.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace MR::IO::Test {
+
+class MappedFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_file_ = std::filesystem::temp_directory_path() / "mappedfile_test.log";
+        std::filesystem::remove(test_file_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(test_file_);
+    }
+
+    static void append(MappedFile& mapped, const std::string& data) {
+        char* destination = mapped.reserve(data.size());
+        ASSERT_NE(destination, nullptr);
+        std::memcpy(destination, data.data(), data.size());
+        mapped.commit(data.size());
+    }
+
+    std::string readFile() {
+        std::ifstream file(test_file_, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    std::filesystem::path test_file_;
+};
+
+TEST_F(MappedFileTest, ChunkSizeIsPageAligned) {
+    MappedFile mapped(1000);
+
+    EXPECT_GE(mapped.chunkSize(), 1000u);
+    EXPECT_EQ(mapped.chunkSize() % 4096, 0u);
+}
+
+TEST_F(MappedFileTest, AppendsAcrossChunks) {
+    WriteOnlyFile file(test_file_.string(), FileMode::MAPPED);
+    MappedFile mapped(4096);
+    mapped.open(file);
+
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        std::string line = "Mapped line " + std::to_string(i) + "\n";
+        append(mapped, line);
+        expected += line;
+    }
+    EXPECT_EQ(mapped.size(), expected.size());
+    mapped.close();
+
+    EXPECT_EQ(readFile(), expected);
+}
+
+TEST_F(MappedFileTest, ReserveLargerThanChunk) {
+    WriteOnlyFile file(test_file_.string(), FileMode::MAPPED);
+    MappedFile mapped(4096);
+    mapped.open(file);
+
+    append(mapped, "head\n");
+    std::string large(3 * 4096 + 17, 'x');
+    append(mapped, large);
+    mapped.close();
+
+    EXPECT_EQ(readFile(), "head\n" + large);
+}
+
+TEST_F(MappedFileTest, OpenContinuesExistingFile) {
+    {
+        std::ofstream existing(test_file_, std::ios::binary);
+        existing << "existing\n";
+    }
+
+    WriteOnlyFile file(test_file_.string(), FileMode::MAPPED);
+    MappedFile mapped(4096);
+    mapped.open(file);
+    EXPECT_EQ(mapped.size(), 9u);
+
+    append(mapped, "appended\n");
+    mapped.close();
+
+    EXPECT_EQ(readFile(), "existing\nappended\n");
+}
+
+TEST_F(MappedFileTest, TrimCutsPreallocatedSpace) {
+    WriteOnlyFile file(test_file_.string(), FileMode::MAPPED);
+    MappedFile mapped(8192);
+    mapped.open(file);
+
+    append(mapped, "short\n");
+    EXPECT_EQ(file.size(), 8192u);
+
+    EXPECT_EQ(mapped.trim(), 0);
+    EXPECT_EQ(file.size(), 6u);
+
+    // Writing again grows the file before touching the mapping past EOF
+    append(mapped, "again\n");
+    EXPECT_EQ(mapped.trim(), 0);
+    EXPECT_EQ(readFile(), "short\nagain\n");
+}
+
+TEST_F(MappedFileTest, SyncAfterWindowMoved) {
+    WriteOnlyFile file(test_file_.string(), FileMode::MAPPED);
+    MappedFile mapped(4096);
+    mapped.open(file);
+
+    append(mapped, "synced\n");
+    EXPECT_EQ(mapped.sync(), 0);
+
+    // Unsynced data spans an unmapped window
+    append(mapped, std::string(5000, 'y'));
+    append(mapped, std::string(5000, 'z'));
+    EXPECT_EQ(mapped.sync(), 0);
+    EXPECT_EQ(mapped.sync(), 0);
+}
+
+TEST_F(MappedFileTest, ReserveWithoutOpenFails) {
+    MappedFile mapped;
+
+    EXPECT_EQ(mapped.reserve(16), nullptr);
+    EXPECT_EQ(mapped.sync(), 0);
+    EXPECT_EQ(mapped.trim(), 0);
+}
+
+}
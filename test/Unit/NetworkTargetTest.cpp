@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/IO/NetworkTarget.hpp>
+
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace MR::IO::Test {
+
+TEST(NetworkTargetTest, TcpFrameHeaderIsBigEndian) {
+    auto header = tcpFrameHeader(0x01020304u);
+    EXPECT_EQ(header[0], 0x01);
+    EXPECT_EQ(header[1], 0x02);
+    EXPECT_EQ(header[2], 0x03);
+    EXPECT_EQ(header[3], 0x04);
+
+    auto small = tcpFrameHeader(17);
+    EXPECT_EQ(small[0], 0);
+    EXPECT_EQ(small[3], 17);
+}
+
+TEST(NetworkTargetTest, SyslogPriority) {
+    EXPECT_EQ(syslogPriority(1, 6), "<14>");
+    EXPECT_EQ(syslogPriority(16, 3), "<131>");
+    EXPECT_EQ(syslogPriority(0, 0), "<0>");
+}
+
+TEST(NetworkTargetTest, SplitsBuffersIntoLines) {
+    std::vector<std::string> lines;
+    forEachLine("first\nsecond\n\nthird", [&lines](std::string_view line) { lines.emplace_back(line); });
+    EXPECT_THAT(lines, testing::ElementsAre("first", "second", "third"));
+
+    EXPECT_EQ(countLines("a\nb\n"), 2u);
+    EXPECT_EQ(countLines(""), 0u);
+    EXPECT_EQ(countLines("\n\n"), 0u);
+}
+
+TEST(NetworkTargetTest, ResolvesOnce) {
+    NetworkTarget tcp("127.0.0.1", 5140, SOCK_STREAM);
+    EXPECT_TRUE(tcp.stream());
+    EXPECT_EQ(tcp.name(), "127.0.0.1:5140");
+    ASSERT_EQ(tcp.address()->sa_family, AF_INET);
+    EXPECT_EQ(ntohs(reinterpret_cast<const sockaddr_in*>(tcp.address())->sin_port), 5140);
+
+    int fd = tcp.openSocket();
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    NetworkTarget udp("localhost", 514, SOCK_DGRAM);
+    EXPECT_FALSE(udp.stream());
+    EXPECT_GT(udp.addressLength(), 0u);
+
+    EXPECT_THROW(NetworkTarget("nonexistent.invalid", 514, SOCK_DGRAM), std::runtime_error);
+}
+
+}
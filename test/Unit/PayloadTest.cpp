@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Logger/Payload.hpp>
+
+#include <string>
+#include <utility>
+
+namespace MR::Logger::Test {
+
+TEST(PayloadTest, ShortTextStaysInline) {
+    Payload empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(std::string_view(empty), "");
+
+    Payload payload("a log message longer than the 15 bytes std::string keeps inline");
+    EXPECT_FALSE(payload.spilled());
+    EXPECT_EQ(payload, "a log message longer than the 15 bytes std::string keeps inline");
+
+    std::string exact(Payload::INLINE_CAPACITY, 'x');
+    Payload full(exact);
+    EXPECT_FALSE(full.spilled());
+    EXPECT_EQ(full.size(), Payload::INLINE_CAPACITY);
+    EXPECT_EQ(full, exact);
+}
+
+TEST(PayloadTest, LongTextSpills) {
+    std::string text(Payload::INLINE_CAPACITY + 1, 'y');
+    Payload payload(text);
+    EXPECT_TRUE(payload.spilled());
+    EXPECT_EQ(payload, text);
+}
+
+TEST(PayloadTest, FormatsInPlaceAndSpillsWhenTooLong) {
+    Payload short_line = Payload::format("Request {} took {}us", 42, 1.5);
+    EXPECT_FALSE(short_line.spilled());
+    EXPECT_EQ(short_line, "Request 42 took 1.5us");
+
+    std::string argument(Payload::INLINE_CAPACITY, 'z');
+    Payload long_line = Payload::format("[{}]", argument);
+    EXPECT_TRUE(long_line.spilled());
+    EXPECT_EQ(long_line, "[" + argument + "]");
+    EXPECT_EQ(fmt::format("<{}>", long_line), "<[" + argument + "]>");
+}
+
+TEST(PayloadTest, CopyAndMove) {
+    std::string long_text(Payload::INLINE_CAPACITY * 2, 'l');
+    for (const std::string& text : {std::string("inline text"), long_text}) {
+        Payload original(text);
+
+        Payload copy(original);
+        EXPECT_EQ(copy, text);
+        EXPECT_EQ(original, text);
+
+        Payload moved(std::move(original));
+        EXPECT_EQ(moved, text);
+        EXPECT_TRUE(original.empty());
+
+        Payload assigned("something else");
+        assigned = std::move(moved);
+        EXPECT_EQ(assigned, text);
+        EXPECT_TRUE(moved.empty());
+
+        assigned = copy;
+        EXPECT_EQ(assigned, text);
+        EXPECT_EQ(assigned.spilled(), text.size() > Payload::INLINE_CAPACITY);
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <MR/Thread/Placement.hpp>
+#include <cerrno>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+
+namespace MR::Thread::Test {
+
+TEST(PlacementTest, PinsOnlyTheCallingThread) {
+    cpu_set_t before;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(before), &before), 0);
+    int cpu = -1;
+    for (int i = 0; i < CPU_SETSIZE && cpu < 0; ++i) {
+        if (CPU_ISSET(i, &before)) cpu = i;
+    }
+    ASSERT_GE(cpu, 0);
+
+    std::thread pinned([cpu]() {
+        std::vector<int> cpus{cpu};
+        EXPECT_EQ(pinCurrentThread(cpus), 0);
+
+        cpu_set_t after;
+        ASSERT_EQ(sched_getaffinity(0, sizeof(after), &after), 0);
+        EXPECT_EQ(CPU_COUNT(&after), 1);
+        EXPECT_TRUE(CPU_ISSET(cpu, &after));
+    });
+    pinned.join();
+
+    cpu_set_t unchanged;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(unchanged), &unchanged), 0);
+    EXPECT_TRUE(CPU_EQUAL(&before, &unchanged));
+}
+
+TEST(PlacementTest, RejectsInvalidCpus) {
+    std::vector<int> negative{-1};
+    EXPECT_EQ(pinCurrentThread(negative), -EINVAL);
+    EXPECT_EQ(pinCurrentThread({}), 0);
+}
+
+TEST(PlacementTest, LowersTheSchedulingPolicy) {
+    std::thread batch([]() {
+        EXPECT_EQ(setCurrentScheduling(Scheduling::NORMAL), 0);
+        EXPECT_EQ(sched_getscheduler(0), SCHED_OTHER);
+
+        // Lowering the policy needs no privileges
+        EXPECT_EQ(setCurrentScheduling(Scheduling::BATCH), 0);
+        EXPECT_EQ(sched_getscheduler(0), SCHED_BATCH);
+    });
+    batch.join();
+    EXPECT_EQ(sched_getscheduler(0), SCHED_OTHER);
+}
+
+TEST(PlacementTest, NumaNodes) {
+    // Without NUMA in the kernel (or sysfs) both are unknown, otherwise CPU 0 is on a node
+    int nodes = numaNodeCount();
+    int node = numaNodeOf(0);
+    EXPECT_GE(nodes, 0);
+    if (nodes > 0) {
+        EXPECT_GE(node, 0);
+        EXPECT_LT(node, nodes);
+    }
+    EXPECT_EQ(numaNodeOf(-1), -1);
+}
+
+}
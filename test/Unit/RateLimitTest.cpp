@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <MR/Logger/RateLimit.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace MR::Logger::Test {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+  // Stands in for the logger the statements log to
+  const int LOGGER = 0;
+
+  bool isEnrolled(const CallSite& wanted) {
+    for (const CallSite* site = CallSite::first(); site; site = site->next()) {
+      if (site == &wanted) return true;
+    }
+    return false;
+  }
+
+}
+
+TEST(RateLimitTest, EveryNAdmitsTheFirstOfEachPeriod) {
+  static EveryN site{"src/dir/file.cpp", 12, SEVERITY_LEVEL::WARN, 3};
+
+  std::vector<bool> admitted;
+  for (int i = 0; i < 7; ++i) admitted.push_back(site.admit(&LOGGER));
+  EXPECT_EQ(admitted, (std::vector<bool>{true, false, false, true, false, false, true}));
+  EXPECT_EQ(site.suppressed(), 4u);
+
+  EXPECT_EQ(site.file(), "file.cpp");
+  EXPECT_EQ(site.line(), 12);
+  EXPECT_EQ(site.level(), SEVERITY_LEVEL::WARN);
+}
+
+TEST(RateLimitTest, FirstNStopsAfterTheLimit) {
+  static FirstN site{"file.cpp", 1, SEVERITY_LEVEL::ERROR, 2};
+
+  EXPECT_TRUE(site.admit(&LOGGER));
+  EXPECT_TRUE(site.admit(&LOGGER));
+  EXPECT_FALSE(isEnrolled(site));  // Nothing suppressed yet
+
+  for (int i = 0; i < 5; ++i) EXPECT_FALSE(site.admit(&LOGGER));
+  EXPECT_EQ(site.suppressed(), 5u);
+  EXPECT_TRUE(isEnrolled(site));
+}
+
+TEST(RateLimitTest, EveryIntervalAdmitsOncePerInterval) {
+  static EveryInterval site{"file.cpp", 1, SEVERITY_LEVEL::INFO, 50ms};
+
+  EXPECT_TRUE(site.admit(&LOGGER));
+  EXPECT_FALSE(site.admit(&LOGGER));
+  EXPECT_FALSE(site.admit(&LOGGER));
+  std::this_thread::sleep_for(60ms);
+  EXPECT_TRUE(site.admit(&LOGGER));
+  EXPECT_EQ(site.suppressed(), 2u);
+}
+
+TEST(RateLimitTest, SuppressionsAreTakenOnce) {
+  static EveryN site{"file.cpp", 1, SEVERITY_LEVEL::INFO, 10};
+
+  for (int i = 0; i < 25; ++i) site.admit(&LOGGER);  // 3 admitted
+  EXPECT_TRUE(site.hasUnreported());
+  EXPECT_EQ(site.takeUnreported(), 22u);
+  EXPECT_FALSE(site.hasUnreported());
+  EXPECT_EQ(site.takeUnreported(), 0u);
+
+  site.admit(&LOGGER);
+  EXPECT_EQ(site.takeUnreported(), 1u);
+}
+
+TEST(RateLimitTest, OwnerIsTheLoggerOfTheLastSuppressedCall) {
+  static FirstN site{"file.cpp", 1, SEVERITY_LEVEL::INFO, 1};
+  const int other = 0;
+
+  EXPECT_TRUE(site.admit(&other));
+  EXPECT_EQ(site.owner(), nullptr);  // Admitted calls don't claim the site
+  EXPECT_FALSE(site.admit(&LOGGER));
+  EXPECT_EQ(site.owner(), &LOGGER);
+  EXPECT_FALSE(site.admit(&other));
+  EXPECT_EQ(site.owner(), &other);
+}
+
+TEST(RateLimitTest, ConcurrentCallsAreCountedExactly) {
+  static EveryN site{"file.cpp", 1, SEVERITY_LEVEL::INFO, 100};
+
+  constexpr int THREADS = 4;
+  constexpr int CALLS = 10000;
+  std::atomic<uint64_t> admitted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < CALLS; ++i) {
+        if (site.admit(&LOGGER)) admitted.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(admitted.load(), THREADS * CALLS / 100u);
+  EXPECT_EQ(site.suppressed(), THREADS * CALLS - admitted.load());
+}
+
+}
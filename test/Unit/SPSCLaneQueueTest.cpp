@@ -0,0 +1,395 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Queue/SPSCLaneQueue.hpp>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <latch>
+
+namespace MR::Queue::Test {
+
+struct Stamped {
+    uint64_t timestamp = 0;
+    int producer = 0;
+};
+
+class SPSCLaneQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        queue_ = std::make_unique<SPSCLaneQueue<int>>(16, 4);
+    }
+
+    void TearDown() override {
+        queue_->shutdown();
+        queue_.reset();
+    }
+
+    std::unique_ptr<SPSCLaneQueue<int>> queue_;
+};
+
+TEST_F(SPSCLaneQueueTest, ConstructorInitialization) {
+    EXPECT_TRUE(queue_->empty());
+    EXPECT_EQ(queue_->size(), 0);
+    EXPECT_EQ(queue_->laneCount(), 0);
+}
+
+TEST_F(SPSCLaneQueueTest, ZeroLaneCapacityThrows) {
+    EXPECT_THROW(SPSCLaneQueue<int>(0), std::invalid_argument);
+}
+
+TEST_F(SPSCLaneQueueTest, FirstPushRegistersLane) {
+    queue_->push(1);
+    queue_->push(2);
+
+    EXPECT_EQ(queue_->laneCount(), 1);
+    EXPECT_EQ(queue_->size(), 2);
+
+    std::thread other([&]() { queue_->push(3); });
+    other.join();
+
+    EXPECT_EQ(queue_->laneCount(), 2);
+    EXPECT_EQ(queue_->size(), 3);
+}
+
+TEST_F(SPSCLaneQueueTest, TryPopOnEmptyQueue) {
+    auto result = queue_->tryPop();
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST_F(SPSCLaneQueueTest, FIFOOrderingWithWraparound) {
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 16; ++i) {
+            queue_->push(round * 100 + i);
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            auto result = queue_->tryPop();
+            ASSERT_TRUE(result.has_value());
+            EXPECT_EQ(result.value(), round * 100 + i);
+        }
+        EXPECT_TRUE(queue_->empty());
+    }
+}
+
+TEST_F(SPSCLaneQueueTest, SeparateQueuesUseSeparateLanes) {
+    SPSCLaneQueue<int> other(16);
+
+    queue_->push(1);
+    other.push(2);
+
+    EXPECT_EQ(queue_->tryPop().value(), 1);
+    EXPECT_EQ(other.tryPop().value(), 2);
+    EXPECT_FALSE(queue_->tryPop().has_value());
+    EXPECT_FALSE(other.tryPop().has_value());
+}
+
+TEST_F(SPSCLaneQueueTest, RoundRobinAcrossLanesWithoutTimestamp) {
+    // a keeps its lane until b pushed, otherwise b would reuse it
+    std::latch b_pushed{1};
+    std::thread a([&]() { for (int i = 0; i < 3; ++i) queue_->push(10 + i); b_pushed.wait(); });
+    while (queue_->size() < 3) std::this_thread::yield();
+    std::thread b([&]() { for (int i = 0; i < 3; ++i) queue_->push(20 + i); });
+    b.join();
+    b_pushed.count_down();
+    a.join();
+
+    std::vector<int> popped;
+    while (auto item = queue_->tryPop()) {
+        popped.push_back(*item);
+    }
+
+    EXPECT_THAT(popped, ::testing::ElementsAre(10, 20, 11, 21, 12, 22));
+}
+
+TEST_F(SPSCLaneQueueTest, TryPopBatchDrainsEveryLane) {
+    // a keeps its lane until b pushed, otherwise b would reuse it
+    std::latch b_pushed{1};
+    std::thread a([&]() { for (int i = 0; i < 3; ++i) queue_->push(10 + i); b_pushed.wait(); });
+    while (queue_->size() < 3) std::this_thread::yield();
+    std::thread b([&]() { for (int i = 0; i < 3; ++i) queue_->push(20 + i); });
+    b.join();
+    b_pushed.count_down();
+    a.join();
+
+    std::vector<int> out(4);
+    EXPECT_EQ(queue_->tryPopBatch(out), 4u);
+    EXPECT_THAT(out, ::testing::ElementsAre(10, 11, 12, 20));
+
+    EXPECT_EQ(queue_->tryPopBatch(out), 2u);
+    EXPECT_EQ(out[0], 21);
+    EXPECT_EQ(out[1], 22);
+    EXPECT_TRUE(queue_->empty());
+}
+
+TEST_F(SPSCLaneQueueTest, ThreadsBeyondMaxLanesShareOverflowLane) {
+    std::vector<std::thread> producers;
+    std::latch pushed{8};
+    for (int t = 0; t < 8; ++t) {
+        producers.emplace_back([&, t]() { queue_->push(t); pushed.arrive_and_wait(); });
+    }
+    for (auto& thread : producers) {
+        thread.join();
+    }
+
+    EXPECT_EQ(queue_->laneCount(), 4);
+    EXPECT_EQ(queue_->size(), 8);
+
+    std::vector<int> popped;
+    while (auto item = queue_->tryPop()) {
+        popped.push_back(*item);
+    }
+    std::sort(popped.begin(), popped.end());
+    EXPECT_THAT(popped, ::testing::ElementsAre(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+TEST_F(SPSCLaneQueueTest, ExitedThreadsGiveTheirLanesBack) {
+    // More threads than lanes over time, never more than two at once. Reused lanes still
+    // hold what the previous threads left, it is only popped every few rounds
+    std::vector<int> own;
+    for (int t = 0; t < 20; ++t) {
+        std::thread first([&, t]() { queue_->push(2 * t); queue_->push(2 * t + 1); });
+        std::thread second([&, t]() { queue_->push(100 + t); });
+        first.join();
+        second.join();
+
+        if (t % 4 != 3) continue;
+        while (auto item = queue_->tryPop()) {
+            if (*item < 100) own.push_back(*item);
+        }
+    }
+    EXPECT_LE(queue_->laneCount(), 2);
+    ASSERT_EQ(own.size(), 40u);
+    for (int t = 0; t < 20; ++t) {
+        EXPECT_LT(std::find(own.begin(), own.end(), 2 * t), std::find(own.begin(), own.end(), 2 * t + 1));
+    }
+}
+
+TEST_F(SPSCLaneQueueTest, OverflowThreadKeepsItsLaneAfterOthersExit) {
+    std::latch filled{4};
+    std::latch release{1};
+    std::vector<std::thread> holders;
+    for (int t = 0; t < 4; ++t) {
+        holders.emplace_back([&, t]() { queue_->push(t); filled.count_down(); release.wait(); });
+    }
+    filled.wait();
+
+    // Every lane is taken, this thread overflows and stays there once the holders exit
+    queue_->push(10);
+    release.count_down();
+    for (auto& thread : holders) thread.join();
+    queue_->push(11);
+    EXPECT_EQ(queue_->laneCount(), 4);
+
+    std::vector<int> popped;
+    while (auto item = queue_->tryPop()) popped.push_back(*item);
+    EXPECT_EQ(popped.size(), 6u);
+    EXPECT_LT(std::find(popped.begin(), popped.end(), 10), std::find(popped.begin(), popped.end(), 11));
+    EXPECT_NE(std::find(popped.begin(), popped.end(), 11), popped.end());
+}
+
+TEST_F(SPSCLaneQueueTest, OneThreadKeepsOneLanePerQueue) {
+    // More queues than any fixed size cache, pushed to in turns
+    constexpr int QUEUES = 20;
+    std::vector<std::unique_ptr<SPSCLaneQueue<int>>> queues;
+    for (int q = 0; q < QUEUES; ++q) queues.push_back(std::make_unique<SPSCLaneQueue<int>>(16, 4));
+
+    for (int round = 0; round < 5; ++round) {
+        for (auto& queue : queues) queue->push(round);
+    }
+
+    for (auto& queue : queues) {
+        EXPECT_EQ(queue->laneCount(), 1);
+        std::vector<int> popped;
+        while (auto item = queue->tryPop()) popped.push_back(*item);
+        EXPECT_THAT(popped, ::testing::ElementsAre(0, 1, 2, 3, 4));
+    }
+
+    // The entries of destroyed queues are dropped on the next registration
+    queues.clear();
+    SPSCLaneQueue<int> later(16, 4);
+    later.push(1);
+    EXPECT_EQ(later.laneCount(), 1);
+}
+
+TEST_F(SPSCLaneQueueTest, PushBlocksWhenLaneFull) {
+    std::atomic<bool> push_completed{false};
+
+    std::thread producer([&]() {
+        for (int i = 0; i < 17; ++i) {
+            queue_->push(i);
+        }
+        push_completed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(push_completed);
+
+    auto result = queue_->tryPop();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 0);
+
+    producer.join();
+    EXPECT_TRUE(push_completed);
+    EXPECT_EQ(queue_->size(), 16);
+}
+
+TEST_F(SPSCLaneQueueTest, ShutdownUnblocksWaitingPop) {
+    std::atomic<bool> returned{false};
+
+    std::thread consumer([&]() {
+        auto result = queue_->pop();
+        EXPECT_FALSE(result.has_value());
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(returned);
+
+    queue_->shutdown();
+
+    consumer.join();
+    EXPECT_TRUE(returned);
+}
+
+TEST_F(SPSCLaneQueueTest, PopDrainsRemainingElementsAfterShutdown) {
+    queue_->push(1);
+    queue_->push(2);
+    queue_->shutdown();
+
+    EXPECT_EQ(queue_->pop().value(), 1);
+    EXPECT_EQ(queue_->pop().value(), 2);
+    EXPECT_FALSE(queue_->pop().has_value());
+}
+
+TEST(SPSCLaneQueueMergeTest, MergesLanesByTimestamp) {
+    SPSCLaneQueue<Stamped> queue(1024);
+    std::atomic<uint64_t> clock{1};
+    const int num_producers = 4;
+    const int elements_per_producer = 200;
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < num_producers; ++t) {
+        producers.emplace_back([&, t]() {
+            for (int i = 0; i < elements_per_producer; ++i) {
+                queue.push(Stamped{clock.fetch_add(1), t});
+            }
+        });
+    }
+    for (auto& thread : producers) {
+        thread.join();
+    }
+
+    // With every lane fully published the merge yields global timestamp order
+    uint64_t last = 0;
+    int popped = 0;
+    while (auto item = queue.tryPop()) {
+        EXPECT_GT(item->timestamp, last);
+        last = item->timestamp;
+        popped++;
+    }
+    EXPECT_EQ(popped, num_producers * elements_per_producer);
+}
+
+TEST(SPSCLaneQueueMergeTest, TryPopBatchMergesLanesByTimestamp) {
+    SPSCLaneQueue<Stamped> queue(64);
+    std::atomic<uint64_t> clock{1};
+    const int num_producers = 4;
+    const int elements_per_producer = 500;
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < num_producers; ++t) {
+        producers.emplace_back([&, t]() {
+            for (int i = 0; i < elements_per_producer; ++i) {
+                queue.push(Stamped{clock.fetch_add(1), t});
+            }
+        });
+    }
+
+    // Batches race with the producers, each one is in timestamp order and no producer is reordered
+    std::vector<Stamped> batch(7);
+    std::vector<uint64_t> last_of(num_producers, 0);
+    int popped = 0;
+    while (popped < num_producers * elements_per_producer) {
+        size_t n = queue.tryPopBatch(batch);
+        for (size_t i = 0; i < n; ++i) {
+            if (i > 0) {
+                EXPECT_GT(batch[i].timestamp, batch[i - 1].timestamp);
+            }
+            EXPECT_GT(batch[i].timestamp, last_of[batch[i].producer]);
+            last_of[batch[i].producer] = batch[i].timestamp;
+        }
+        popped += static_cast<int>(n);
+        if (n == 0) std::this_thread::yield();
+    }
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    EXPECT_TRUE(queue.empty());
+
+    // With every lane fully published a batch yields global timestamp order
+    for (int i = 0; i < 10; ++i) queue.push(Stamped{clock.fetch_add(1), 0});
+    std::thread other([&]() { for (int i = 0; i < 10; ++i) queue.push(Stamped{clock.fetch_add(1), 1}); });
+    other.join();
+    std::vector<Stamped> all(32);
+    ASSERT_EQ(queue.tryPopBatch(all), 20u);
+    for (size_t i = 1; i < 20; ++i) EXPECT_GT(all[i].timestamp, all[i - 1].timestamp);
+}
+
+class SPSCLaneQueueConcurrencyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        queue_ = std::make_unique<SPSCLaneQueue<int>>(64);
+    }
+
+    void TearDown() override {
+        queue_->shutdown();
+        queue_.reset();
+    }
+
+    std::unique_ptr<SPSCLaneQueue<int>> queue_;
+};
+
+TEST_F(SPSCLaneQueueConcurrencyTest, ManyProducersSingleConsumer) {
+    const int num_producers = 8;
+    const int elements_per_producer = 20000;
+    std::vector<std::thread> producers;
+
+    for (int t = 0; t < num_producers; ++t) {
+        producers.emplace_back([&, t]() {
+            for (int i = 0; i < elements_per_producer; ++i) {
+                queue_->push(t * elements_per_producer + i);
+            }
+        });
+    }
+
+    std::vector<int> last_seen(num_producers, -1);
+    int popped = 0;
+    bool ordered = true;
+
+    while (popped < num_producers * elements_per_producer) {
+        auto result = queue_->tryPop();
+        if (!result.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        int producer = result.value() / elements_per_producer;
+        int index = result.value() % elements_per_producer;
+        if (index <= last_seen[producer]) ordered = false;
+        last_seen[producer] = index;
+        popped++;
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(popped, num_producers * elements_per_producer);
+    EXPECT_TRUE(queue_->empty());
+}
+
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Logger/SeverityLevel.hpp>
+
+namespace MR::Logger::Test {
+
+TEST(SeverityLevelTest, LevelsAreOrderedBySeverity) {
+    EXPECT_LT(SEVERITY_LEVEL::TRACE, SEVERITY_LEVEL::DEBUG);
+    EXPECT_LT(SEVERITY_LEVEL::DEBUG, SEVERITY_LEVEL::INFO);
+    EXPECT_LT(SEVERITY_LEVEL::INFO, SEVERITY_LEVEL::WARN);
+    EXPECT_LT(SEVERITY_LEVEL::WARN, SEVERITY_LEVEL::ERROR);
+}
+
+TEST(SeverityLevelTest, StringRepresentation) {
+    EXPECT_EQ(sevLvlToStr(SEVERITY_LEVEL::TRACE), "TRACE");
+    EXPECT_EQ(sevLvlToStr(SEVERITY_LEVEL::DEBUG), "DEBUG");
+    EXPECT_EQ(sevLvlToStr(SEVERITY_LEVEL::INFO), "INFO");
+    EXPECT_EQ(sevLvlToStr(SEVERITY_LEVEL::WARN), "WARN");
+    EXPECT_EQ(sevLvlToStr(SEVERITY_LEVEL::ERROR), "ERROR");
+}
+
+TEST(SeverityLevelTest, NameTableIsConstexpr) {
+    static_assert(sevLvlName(SEVERITY_LEVEL::WARN) == "WARN");
+    EXPECT_EQ(sevLvlName(static_cast<SEVERITY_LEVEL>(42)), "UNKNOWN LEVEL");
+}
+
+TEST(SeverityLevelTest, CompileTimeFloorMatchesBuildOption) {
+    static_assert(COMPILE_TIME_MIN_SEVERITY == static_cast<SEVERITY_LEVEL>(MRLOGGER_MIN_SEVERITY));
+    static_assert(isCompiledIn(SEVERITY_LEVEL::ERROR));
+
+    EXPECT_EQ(isCompiledIn(SEVERITY_LEVEL::TRACE), MRLOGGER_MIN_SEVERITY == 0);
+}
+
+TEST(SeverityLevelTest, SeverityMasks) {
+    static_assert(severityMask() == 0);
+    static_assert(severityMask(SEVERITY_LEVEL::TRACE, SEVERITY_LEVEL::ERROR) == 0b10001);
+    static_assert(severitiesFrom(SEVERITY_LEVEL::TRACE) == ALL_SEVERITIES);
+    static_assert(severitiesFrom(SEVERITY_LEVEL::WARN) == severityMask(SEVERITY_LEVEL::WARN, SEVERITY_LEVEL::ERROR));
+
+    SeverityMask below_error = ALL_SEVERITIES & ~severitiesFrom(SEVERITY_LEVEL::ERROR);
+    EXPECT_TRUE(below_error & severityBit(SEVERITY_LEVEL::WARN));
+    EXPECT_FALSE(below_error & severityBit(SEVERITY_LEVEL::ERROR));
+}
+
+}
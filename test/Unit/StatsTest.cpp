@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/Logger/Stats.hpp>
+
+namespace MR::Logger::Test {
+
+using namespace std::chrono_literals;
+
+TEST(StatsTest, HistogramBucketsArePowersOfTwoMicroseconds) {
+    EXPECT_EQ(LatencyHistogram::bucketOf(0ns), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(999ns), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(1us), 1u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(3us), 2u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(4us), 3u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(-5us), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(1h), LatencyHistogram::BUCKETS - 1);
+
+    for (size_t i = 0; i + 1 < LatencyHistogram::BUCKETS; ++i) {
+        EXPECT_LT(LatencyHistogram::bucketOf(LatencyHistogram::upperBound(i) - 1ns), i + 1);
+        EXPECT_EQ(LatencyHistogram::bucketOf(LatencyHistogram::upperBound(i)), i + 1);
+    }
+}
+
+TEST(StatsTest, PercentilesReportBucketUpperBounds) {
+    LatencyRecorder recorder;
+    EXPECT_EQ(recorder.snapshot().percentile(0.5), 0us);
+
+    for (int i = 0; i < 90; ++i) recorder.record(10us);    // [8, 16) us
+    for (int i = 0; i < 10; ++i) recorder.record(600us);   // [512, 1024) us
+
+    LatencyHistogram histogram = recorder.snapshot();
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.percentile(0.0), 16us);
+    EXPECT_EQ(histogram.percentile(0.5), 16us);
+    EXPECT_EQ(histogram.percentile(0.95), 1024us);
+    EXPECT_EQ(histogram.percentile(1.0), 1024us);
+}
+
+TEST(StatsTest, CoalescingRatio) {
+    Stats stats;
+    EXPECT_EQ(stats.coalescingRatio(), 0.0);
+
+    stats.messages_written = 100;
+    stats.buffers_written = 4;
+    EXPECT_DOUBLE_EQ(stats.coalescingRatio(), 25.0);
+}
+
+TEST(StatsTest, CounterAccumulates) {
+    StatCounter counter;
+    counter.add();
+    counter.add(41);
+    EXPECT_EQ(counter.load(), 42u);
+}
+
+}
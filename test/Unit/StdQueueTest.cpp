@@ -160,6 +160,27 @@ TEST_F(StdQueueTest, EmptyCheck) {
     EXPECT_TRUE(queue_->empty());
 }
 
+TEST_F(StdQueueTest, TryPopBatchDrainsInFIFOOrder) {
+    for (int i = 0; i < 5; ++i) {
+        queue_->push(i);
+    }
+
+    std::vector<int> out(3);
+    EXPECT_EQ(queue_->tryPopBatch(out), 3u);
+    EXPECT_THAT(out, ::testing::ElementsAre(0, 1, 2));
+    EXPECT_EQ(queue_->size(), 2);
+
+    EXPECT_EQ(queue_->tryPopBatch(out), 2u);
+    EXPECT_EQ(out[0], 3);
+    EXPECT_EQ(out[1], 4);
+    EXPECT_TRUE(queue_->empty());
+}
+
+TEST_F(StdQueueTest, TryPopBatchOnEmptyQueue) {
+    std::vector<int> out(4);
+    EXPECT_EQ(queue_->tryPopBatch(out), 0u);
+}
+
 class StdQueueConcurrencyTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <MR/Logger/DeferredFormat.hpp>
+#include <MR/Logger/Payload.hpp>
+#include <MR/Logger/Structured.hpp>
+#include <MR/IO/Escape.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace MR::Logger::Test {
+
+enum class Mode : uint8_t { OFF, ON };
+
+struct Endpoint {
+    int port;
+};
+
+}
+
+template <>
+struct fmt::formatter<MR::Logger::Test::Endpoint> : fmt::formatter<std::string_view> {
+    auto format(const MR::Logger::Test::Endpoint& e, format_context& ctx) const {
+        return fmt::format_to(ctx.out(), "host:{}", e.port);
+    }
+};
+
+namespace MR::Logger::Test {
+
+class StructuredTest : public ::testing::Test {
+protected:
+    std::string render(const DeferredFormat& deferred, std::string_view strings) {
+        char buffer[512];
+        size_t size = deferred.format(buffer, sizeof(buffer), strings);
+        return std::string(buffer, std::min(size, sizeof(buffer)));
+    }
+
+    std::string json(const DeferredFormat& deferred, std::string_view strings) {
+        Field fields[DeferredFormat::MAX_FIELDS];
+        size_t count = deferred.fields(strings, fields);
+
+        char buffer[512];
+        IO::LineWriter out{buffer, sizeof(buffer)};
+        appendJsonFields(std::span<const Field>(fields, count), out);
+        return std::string(buffer, std::min(out.total, sizeof(buffer)));
+    }
+
+    static std::string escaped(std::string_view text) {
+        std::string buffer(text.size() * 6, '\0');
+        IO::LineWriter out{buffer.data(), buffer.size()};
+        IO::appendJsonEscaped(text, out);
+        buffer.resize(out.total);
+        return buffer;
+    }
+};
+
+TEST_F(StructuredTest, KvKeepsArithmeticAndViewsStrings) {
+    std::string route = "/api/users";
+
+    static_assert(std::is_same_v<decltype(kv("a", 1)), KeyValue<int>>);
+    static_assert(std::is_same_v<decltype(kv("a", Mode::ON)), KeyValue<Mode>>);
+    static_assert(std::is_same_v<decltype(kv("a", route)), KeyValue<std::string_view>>);
+    static_assert(std::is_same_v<decltype(kv("a", "literal")), KeyValue<std::string_view>>);
+    static_assert(std::is_same_v<decltype(kv("a", Endpoint{80})), KeyValue<std::string>>);
+
+    EXPECT_EQ(kv("route", route).value.data(), route.data());
+    EXPECT_EQ(kv("peer", Endpoint{80}).value, "host:80");
+
+    const char* missing = nullptr;
+    EXPECT_TRUE(kv("name", missing).value.empty());
+}
+
+TEST_F(StructuredTest, CaptureRendersMessageAndLogfmtFields) {
+    Payload strings;
+    std::string route = "/api/users";
+    auto deferred = DeferredFormat::captureFields("request done", strings,
+        kv("latency_us", 125), kv("route", route), kv("ok", true), kv("ratio", 0.5));
+
+    ASSERT_TRUE(deferred);
+    EXPECT_TRUE(deferred.isStructured());
+    EXPECT_FALSE(deferred.isEncodable());
+    EXPECT_EQ(strings, "request done" + route);
+    EXPECT_FALSE(strings.spilled());
+    EXPECT_EQ(render(deferred, strings), "request done latency_us=125 route=/api/users ok=true ratio=0.5");
+
+    // Plain captures have no fields
+    EXPECT_FALSE(DeferredFormat::capture("{}", 1).isStructured());
+}
+
+TEST_F(StructuredTest, CaptureOwnsTheMessageAndTheStrings) {
+    Payload strings;
+    char message[16] = "from a buffer";
+    std::string value(100, 'v');
+    auto deferred = DeferredFormat::captureFields(message, strings, kv("value", value));
+
+    std::memcpy(message, "overwritten!!", 14);
+    value.assign(100, 'x');
+    EXPECT_EQ(deferred.message(strings), "from a buffer");
+    EXPECT_EQ(render(deferred, strings), "from a buffer value=" + std::string(100, 'v'));
+
+    // Captures longer than the inline area spill to the heap
+    std::string longer(300, 'l');
+    auto spilled = DeferredFormat::captureFields("long", strings, kv("value", longer), kv("n", 1));
+    EXPECT_TRUE(strings.spilled());
+    EXPECT_EQ(strings.size(), 304u);
+    EXPECT_EQ(render(spilled, strings), "long value=" + longer + " n=1");
+}
+
+TEST_F(StructuredTest, FieldsKeepTheirTypes) {
+    Payload strings;
+    auto deferred = DeferredFormat::captureFields("types", strings,
+        kv("i", int64_t{-7}), kv("u", std::numeric_limits<uint64_t>::max()), kv("m", Mode::ON), kv("c", 'x'));
+
+    Field fields[DeferredFormat::MAX_FIELDS];
+    ASSERT_EQ(deferred.fields(strings, fields), 4u);
+    EXPECT_EQ(fields[0].key, "i");
+    EXPECT_EQ(fields[0].type, FieldType::INT);
+    EXPECT_EQ(fields[0].integer, -7);
+    EXPECT_EQ(fields[1].type, FieldType::UINT);
+    EXPECT_EQ(fields[1].unsigned_integer, std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(fields[2].type, FieldType::UINT);
+    EXPECT_EQ(fields[2].unsigned_integer, 1u);
+    EXPECT_EQ(fields[3].type, FieldType::STRING);
+    EXPECT_EQ(fields[3].text, "x");
+}
+
+TEST_F(StructuredTest, LogfmtQuotesOnlyWhenNeeded) {
+    Payload strings;
+    auto deferred = DeferredFormat::captureFields("m", strings,
+        kv("plain", "abc"), kv("spaced", "a b"), kv("empty", ""), kv("quoted", "say \"hi\"=\n"));
+
+    EXPECT_EQ(render(deferred, strings), R"(m plain=abc spaced="a b" empty="" quoted="say \"hi\"=\n")");
+}
+
+TEST_F(StructuredTest, JsonFieldsAreTypedMembers) {
+    Payload strings;
+    auto deferred = DeferredFormat::captureFields("m", strings,
+        kv("n", 3u), kv("s", "tab\there"), kv("f", std::nan("")), kv("b", false));
+
+    EXPECT_EQ(json(deferred, strings), R"(,"n":3,"s":"tab\there","f":null,"b":false)");
+}
+
+TEST_F(StructuredTest, EscapingFindsSpecialsAtEveryOffset) {
+    // The scan runs a word at a time, every position of the word and the tail has to be caught
+    for (size_t length = 1; length <= 24; ++length) {
+        for (size_t at = 0; at < length; ++at) {
+            std::string text(length, 'a');
+            text[at] = '"';
+            std::string expected = std::string(at, 'a') + "\\\"" + std::string(length - at - 1, 'a');
+            EXPECT_EQ(escaped(text), expected) << "length " << length << " at " << at;
+
+            text[at] = '\x1f';
+            EXPECT_EQ(escaped(text), std::string(at, 'a') + "\\u001f" + std::string(length - at - 1, 'a'));
+        }
+    }
+
+    // Bytes above 0x7f (UTF-8) pass through unchanged
+    EXPECT_EQ(escaped("grüße, 日本"), "grüße, 日本");
+}
+
+TEST_F(StructuredTest, TooManyFieldsFallBackToEagerLogfmt) {
+    static_assert(DeferredFormat::fields_fit<int, int, int, int>);
+    static_assert(!DeferredFormat::fields_fit<int, int, int, int, int>);
+    static_assert(!DeferredFormat::fields_fit<>);
+
+    EXPECT_EQ(formatLogfmt("five", kv("a", 1), kv("b", 2), kv("c", 3), kv("d", "x y"), kv("e", 5.25)),
+              R"(five a=1 b=2 c=3 d="x y" e=5.25)");
+}
+
+}
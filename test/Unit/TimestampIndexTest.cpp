@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <MR/IO/TimestampIndex.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace MR::IO::Test {
+
+using namespace std::chrono_literals;
+
+static std::chrono::system_clock::time_point at(std::chrono::seconds since_epoch) {
+    return std::chrono::system_clock::time_point{since_epoch};
+}
+
+TEST(TimestampIndexTest, BuilderAddsAnEntryPerInterval) {
+    IndexBuilder builder(100);
+    builder.start(0, true);
+
+    builder.append(60, 3, at(1s));   // 0: entry
+    builder.append(60, 2, at(2s));   // 60: within the interval
+    builder.append(60, 1, at(3s));   // 120: entry
+    builder.append(10, 1, {});       // 180: no timestamp, skipped
+    builder.append(50, 1, at(5s));   // 190: within the interval of 120
+    builder.append(50, 1, at(6s));   // 240: entry
+
+    auto entries = readIndex(builder.pending());
+    ASSERT_TRUE(entries.has_value());
+    ASSERT_EQ(entries->size(), 3u);
+    EXPECT_EQ((*entries)[0].offset, 0u);
+    EXPECT_EQ((*entries)[0].message, 0u);
+    EXPECT_EQ((*entries)[1].offset, 120u);
+    EXPECT_EQ((*entries)[1].message, 5u);
+    EXPECT_EQ((*entries)[1].timestamp_ns, std::chrono::nanoseconds(3s).count());
+    EXPECT_EQ((*entries)[2].offset, 240u);
+    EXPECT_EQ((*entries)[2].message, 8u);
+
+    // A file with an index already continues it without a second header
+    builder.clearPending();
+    builder.start(5000, false);
+    builder.append(10, 1, at(7s));
+    EXPECT_EQ(builder.pending().size(), sizeof(IndexEntry));
+}
+
+TEST(TimestampIndexTest, ReadIndexValidates) {
+    EXPECT_FALSE(readIndex("").has_value());
+    EXPECT_FALSE(readIndex("not an index at all").has_value());
+
+    std::string bytes(INDEX_MAGIC);
+    EXPECT_TRUE(readIndex(bytes)->empty());
+
+    // The partly written last entry of a killed process
+    bytes.append(sizeof(IndexEntry) + 5, '\0');
+    EXPECT_EQ(readIndex(bytes)->size(), 1u);
+}
+
+TEST(TimestampIndexTest, TextBounds) {
+    EXPECT_FALSE(beforeFrom("2026-10-14 10:05:00", ""));
+    EXPECT_TRUE(beforeFrom("2026-10-14 10:04:59", "2026-10-14 10:05"));
+    EXPECT_FALSE(beforeFrom("2026-10-14 10:05:00", "2026-10-14 10:05"));
+
+    EXPECT_FALSE(afterUntil("2026-10-14 10:05:59.999", "2026-10-14 10:05"));
+    EXPECT_TRUE(afterUntil("2026-10-14 10:06:00", "2026-10-14 10:05"));
+    EXPECT_FALSE(afterUntil("2030-01-01 00:00:00", ""));
+}
+
+TEST(TimestampIndexTest, RangeStartsBeforeAndEndsAfterTheBounds) {
+    std::vector<IndexEntry> entries;
+    for (int i = 0; i < 10; ++i) {
+        entries.push_back({.offset = static_cast<uint64_t>(1000 + i * 100),
+                           .timestamp_ns = std::chrono::nanoseconds(std::chrono::seconds(1000 + i * 10)).count(),
+                           .message = static_cast<uint64_t>(i * 5)});
+    }
+    auto text = [&](size_t i) { return renderTimestamp(entries[i].timestamp_ns); };
+
+    auto all = indexRange(entries, 2000, "", "");
+    EXPECT_EQ(all.begin, 0u);
+    EXPECT_EQ(all.end, 2000u);
+
+    // Entry 4 may still hold lines of entry 5's second
+    auto middle = indexRange(entries, 2000, text(5), text(6));
+    EXPECT_EQ(middle.begin, entries[4].offset);
+    EXPECT_EQ(middle.end, entries[7].offset);
+
+    // Before the first entry: from the start of the file, bytes that predate the index included
+    auto early = indexRange(entries, 2000, "1970", text(0));
+    EXPECT_EQ(early.begin, 0u);
+    EXPECT_EQ(early.end, entries[1].offset);
+
+    auto late = indexRange(entries, 2000, "9999", "");
+    EXPECT_EQ(late.begin, entries[9].offset);
+    EXPECT_EQ(late.end, 2000u);
+
+    // Entries past the end of a file that lost its last writes
+    auto truncated = indexRange(entries, 1250, text(8), "");
+    EXPECT_EQ(truncated.begin, 1250u);
+    EXPECT_EQ(truncated.end, 1250u);
+}
+
+}
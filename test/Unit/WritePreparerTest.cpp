@@ -0,0 +1,459 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <MR/IO/WritePreparer.hpp>
+#include <MR/IO/PrefixCache.hpp>
+#include <MR/Memory/BufferPool.hpp>
+#include <MR/Logger/WriteRequest.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <fmt/std.h>
+#include <fmt/chrono.h>
+
+namespace MR::IO::Test {
+
+using namespace std::chrono_literals;
+
+class PrefixCacheTest : public ::testing::Test {
+protected:
+    static std::chrono::system_clock::time_point makeTime(std::chrono::nanoseconds since_epoch) {
+        return std::chrono::system_clock::time_point{
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(since_epoch)};
+    }
+
+    PrefixCache cache_;
+};
+
+TEST_F(PrefixCacheTest, TimestampMatchesFmt) {
+    auto tp = std::chrono::system_clock::now();
+    EXPECT_EQ(cache_.timestamp(tp), fmt::format("{}", tp));
+}
+
+TEST_F(PrefixCacheTest, SubSecondPatchWithinSameSecond) {
+    auto base = makeTime(1700000000s);
+
+    for (std::chrono::nanoseconds offset : {0ns, 1ns, 999999999ns, 123456789ns, 500000000ns, 7000ns}) {
+        auto tp = base + std::chrono::duration_cast<std::chrono::system_clock::duration>(offset);
+        EXPECT_EQ(cache_.timestamp(tp), fmt::format("{}", tp));
+    }
+}
+
+TEST_F(PrefixCacheTest, SecondRolloverAndBackwardsJump) {
+    auto base = makeTime(1700000000s + 999999999ns);
+
+    for (auto tp : {base, base + 1ns, base + 1h, base - 1h, base}) {
+        EXPECT_EQ(cache_.timestamp(tp), fmt::format("{}", tp));
+    }
+}
+
+TEST_F(PrefixCacheTest, ThreadIdMatchesFmt) {
+    auto main_id = std::this_thread::get_id();
+    std::thread::id other_id;
+    std::thread other([&]() { other_id = std::this_thread::get_id(); });
+    other.join();
+
+    EXPECT_EQ(cache_.thread(main_id), fmt::format("{}", main_id));
+    EXPECT_EQ(cache_.thread(other_id), fmt::format("{}", other_id));
+    EXPECT_EQ(cache_.thread(main_id), fmt::format("{}", main_id));
+}
+
+class WritePreparerTest : public ::testing::Test {
+protected:
+    WritePreparer makePreparer(uint16_t coalesce_size, bool sync_errors = false, size_t block_size = 0,
+                               size_t staging_buffer_size = 16384) {
+        return WritePreparer(
+            WritePreparer::Config{
+                .coalesce_size = coalesce_size,
+                .staging_buffer_size = staging_buffer_size,
+                .sync_errors = sync_errors,
+                .block_size = block_size
+            },
+            pool_,
+            [this](const char*, const std::string& msg) { errors_.push_back(msg); });
+    }
+
+    static Logger::WriteRequest makeRequest(Logger::SEVERITY_LEVEL level, std::string data, uint64_t seq = 0) {
+        return Logger::WriteRequest{
+            .level = level,
+            .data = std::move(data),
+            .threadId = std::this_thread::get_id(),
+            .timestamp = std::chrono::system_clock::now(),
+            .sequence_number = seq,
+            .deferred = {}
+        };
+    }
+
+    // The line format produced before the prefix cache existed
+    static std::string reference(const Logger::WriteRequest& r) {
+#ifdef LOGGER_TEST_SEQUENCE_TRACKING
+        return fmt::format("[{}] [{}] [Thread: {}] [Seq: {}]: {}\n",
+            r.timestamp, Logger::sevLvlToStr(r.level), r.threadId, r.sequence_number, r.data);
+#else
+        return fmt::format("[{}] [{}] [Thread: {}]: {}\n",
+            r.timestamp, Logger::sevLvlToStr(r.level), r.threadId, r.data);
+#endif
+    }
+
+    // The bytes of a buffer and everything chained to it
+    static std::string chainText(const Memory::Buffer* buffer) {
+        std::string text;
+        for (; buffer; buffer = buffer->next.get()) text.append(buffer->as_char(), buffer->size);
+        return text;
+    }
+
+    Memory::BufferPool pool_;
+    std::vector<std::string> errors_;
+};
+
+TEST_F(WritePreparerTest, IndividualWriteMatchesReferenceFormat) {
+    auto preparer = makePreparer(0);
+
+    for (auto level : {Logger::SEVERITY_LEVEL::TRACE, Logger::SEVERITY_LEVEL::INFO, Logger::SEVERITY_LEVEL::ERROR}) {
+        auto request = makeRequest(level, "payload text", 42);
+        std::string expected = reference(request);
+
+        auto prepared = preparer.prepareWrite(std::move(request));
+        ASSERT_NE(prepared.buffer, nullptr);
+        EXPECT_EQ(std::string(prepared.buffer->as_char(), prepared.buffer->size), expected);
+    }
+    EXPECT_TRUE(errors_.empty());
+}
+
+TEST_F(WritePreparerTest, CoalescedWritesMatchReferenceFormat) {
+    auto preparer = makePreparer(3);
+    std::string expected;
+
+    for (int i = 0; i < 3; ++i) {
+        auto request = makeRequest(Logger::SEVERITY_LEVEL::WARN, "message " + std::to_string(i), i);
+        expected += reference(request);
+
+        auto prepared = preparer.prepareWrite(std::move(request));
+        if (i < 2) {
+            EXPECT_EQ(prepared.buffer, nullptr);
+        } else {
+            ASSERT_NE(prepared.buffer, nullptr);
+            EXPECT_EQ(std::string(prepared.buffer->as_char(), prepared.buffer->size), expected);
+        }
+    }
+}
+
+TEST_F(WritePreparerTest, StagingBufferIsWrittenAsIs) {
+    auto preparer = makePreparer(32);
+
+    preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::INFO, "tiny"));
+    auto flushed = preparer.flushStaged();
+    ASSERT_TRUE(flushed.has_value());
+
+    // The large pool buffer the message was formatted into, not a small right-sized copy
+    EXPECT_EQ(flushed.value()->capacity, Memory::BufferPool::LARGE_BUFFER_SIZE);
+    EXPECT_FALSE(preparer.hasStaged());
+    pool_.release(std::move(flushed.value()));
+
+    // The next message stages into a fresh pool buffer
+    size_t available = pool_.getAvailableBuffers();
+    preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::INFO, "again"));
+    EXPECT_EQ(pool_.getAvailableBuffers(), available - 1);
+}
+
+TEST_F(WritePreparerTest, OverflowingMessageStartsNextBatch) {
+    auto preparer = makePreparer(32, false, 0, 1024);
+    std::string expected;
+    std::string written;
+
+    for (int i = 0; i < 40; ++i) {
+        auto request = makeRequest(Logger::SEVERITY_LEVEL::INFO, std::string(150, 'a' + i % 26), i);
+        expected += reference(request);
+
+        auto prepared = preparer.prepareWrite(std::move(request));
+        if (prepared.buffer) {
+            EXPECT_LT(prepared.buffer->size, 1024u);
+            written.append(prepared.buffer->as_char(), prepared.buffer->size);
+        }
+    }
+
+    auto rest = preparer.flushStaged();
+    ASSERT_TRUE(rest.has_value());
+    written.append(rest.value()->as_char(), rest.value()->size);
+
+    EXPECT_EQ(written, expected);
+    EXPECT_TRUE(errors_.empty());
+}
+
+TEST_F(WritePreparerTest, OversizedMessageGoesOutWithStagedOnes) {
+    auto preparer = makePreparer(32, false, 0, 1024);
+
+    auto small = makeRequest(Logger::SEVERITY_LEVEL::INFO, "before");
+    auto large = makeRequest(Logger::SEVERITY_LEVEL::INFO, std::string(5000, 'x'));
+    std::string expected = reference(small) + reference(large);
+
+    EXPECT_EQ(preparer.prepareWrite(std::move(small)).buffer, nullptr);
+    auto prepared = preparer.prepareWrite(std::move(large));
+    ASSERT_NE(prepared.buffer, nullptr);
+    EXPECT_EQ(std::string(prepared.buffer->as_char(), prepared.buffer->size), expected);
+    EXPECT_FALSE(preparer.hasStaged());
+
+    // Staging is usable again afterwards
+    auto next = makeRequest(Logger::SEVERITY_LEVEL::INFO, "after");
+    std::string line = reference(next);
+    preparer.prepareWrite(std::move(next));
+    auto flushed = preparer.flushStaged();
+    ASSERT_TRUE(flushed.has_value());
+    EXPECT_EQ(std::string(flushed.value()->as_char(), flushed.value()->size), line);
+}
+
+TEST_F(WritePreparerTest, LargeMessageIsChainedOverPooledBuffers) {
+    auto preparer = makePreparer(0, true);
+    auto request = makeRequest(Logger::SEVERITY_LEVEL::ERROR, std::string(300 * 1024, 'd'));
+    std::string expected = reference(request);
+    uint64_t misses = pool_.missCount();
+
+    auto prepared = preparer.prepareWrite(std::move(request));
+    ASSERT_NE(prepared.buffer, nullptr);
+    EXPECT_EQ(chainText(prepared.buffer.get()), expected);
+    EXPECT_EQ(pool_.missCount(), misses);
+
+    // Only the first part counts the message, only the last one syncs
+    size_t parts = 0;
+    for (const auto* part = prepared.buffer.get(); part; part = part->next.get(), ++parts) {
+        EXPECT_EQ(part->capacity, Memory::BufferPool::LARGE_BUFFER_SIZE);
+        EXPECT_EQ(part->messages, part == prepared.buffer.get() ? 1u : 0u);
+        EXPECT_EQ(part->sync, part->next == nullptr);
+        EXPECT_EQ(part->enqueued_at, prepared.buffer->enqueued_at);
+    }
+    EXPECT_EQ(parts, (expected.size() + Memory::BufferPool::LARGE_BUFFER_SIZE - 1) / Memory::BufferPool::LARGE_BUFFER_SIZE);
+
+    // The whole chain goes back to the pool
+    size_t available = pool_.getAvailableBuffers();
+    pool_.release(std::move(prepared.buffer));
+    EXPECT_EQ(pool_.getAvailableBuffers(), available + parts);
+    EXPECT_TRUE(errors_.empty());
+}
+
+TEST_F(WritePreparerTest, LargeMessageFollowsStagedOnesInTheChain) {
+    auto preparer = makePreparer(32);
+
+    auto small = makeRequest(Logger::SEVERITY_LEVEL::INFO, "before");
+    auto large = makeRequest(Logger::SEVERITY_LEVEL::INFO, std::string(100 * 1024, 'y'));
+    std::string staged = reference(small);
+    std::string expected = staged + reference(large);
+
+    EXPECT_EQ(preparer.prepareWrite(std::move(small)).buffer, nullptr);
+    auto prepared = preparer.prepareWrite(std::move(large));
+    ASSERT_NE(prepared.buffer, nullptr);
+    EXPECT_TRUE(prepared.should_flush_batch);
+    EXPECT_EQ(std::string(prepared.buffer->as_char(), prepared.buffer->size), staged);
+    EXPECT_EQ(prepared.buffer->messages, 1u);
+    ASSERT_NE(prepared.buffer->next, nullptr);
+    EXPECT_EQ(prepared.buffer->next->messages, 1u);
+    EXPECT_EQ(chainText(prepared.buffer.get()), expected);
+    EXPECT_FALSE(preparer.hasStaged());
+}
+
+TEST_F(WritePreparerTest, SyncErrorsMarksIndividualErrorWrites) {
+    auto preparer = makePreparer(0, true);
+
+    auto info = preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::INFO, "info"));
+    ASSERT_NE(info.buffer, nullptr);
+    EXPECT_FALSE(info.buffer->sync);
+
+    auto error = preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::ERROR, "error"));
+    ASSERT_NE(error.buffer, nullptr);
+    EXPECT_TRUE(error.buffer->sync);
+}
+
+TEST_F(WritePreparerTest, SyncErrorsFlushesStagedErrorImmediately) {
+    auto preparer = makePreparer(32, true);
+
+    auto info = preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::INFO, "info"));
+    EXPECT_EQ(info.buffer, nullptr);
+
+    auto error = preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::ERROR, "error"));
+    ASSERT_NE(error.buffer, nullptr);
+    EXPECT_TRUE(error.buffer->sync);
+    EXPECT_TRUE(error.should_flush_batch);
+    EXPECT_FALSE(preparer.hasStaged());
+
+    // The flag does not stick to the next staged batch
+    preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::WARN, "warn"));
+    auto flushed = preparer.flushStaged();
+    ASSERT_TRUE(flushed.has_value());
+    EXPECT_FALSE(flushed.value()->sync);
+}
+
+TEST_F(WritePreparerTest, ErrorsNotMarkedWithoutSyncErrors) {
+    auto preparer = makePreparer(0);
+
+    auto error = preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::ERROR, "error"));
+    ASSERT_NE(error.buffer, nullptr);
+    EXPECT_FALSE(error.buffer->sync);
+}
+
+TEST_F(WritePreparerTest, BlockModeKeepsPartialBlockStaged) {
+    auto preparer = makePreparer(32, false, 4096);
+
+    auto request = makeRequest(Logger::SEVERITY_LEVEL::INFO, "short message");
+    std::string line = reference(request);
+    EXPECT_EQ(preparer.prepareWrite(std::move(request)).buffer, nullptr);
+
+    // Less than a block staged: nothing to write on a regular flush
+    EXPECT_FALSE(preparer.flushStaged().has_value());
+    EXPECT_TRUE(preparer.hasUnwritten());
+
+    // The tail goes out zero padded but stays staged
+    auto tail = preparer.flushStaged(true);
+    ASSERT_TRUE(tail.has_value());
+    EXPECT_EQ(tail.value()->size, 4096u);
+    EXPECT_EQ(tail.value()->padding, 4096u - line.size());
+    EXPECT_EQ(std::string(tail.value()->as_char(), line.size()), line);
+    EXPECT_EQ(tail.value()->as_char()[line.size()], '\0');
+    EXPECT_TRUE(preparer.hasStaged());
+    EXPECT_FALSE(preparer.hasUnwritten());
+    EXPECT_FALSE(preparer.flushStaged(true).has_value());
+}
+
+TEST_F(WritePreparerTest, BlockModeWritesWholeBlocksOnly) {
+    auto preparer = makePreparer(1000, false, 4096);
+    std::string expected;
+
+    for (int i = 0; i < 100; ++i) {
+        auto request = makeRequest(Logger::SEVERITY_LEVEL::WARN, "block message " + std::to_string(i), i);
+        expected += reference(request);
+        EXPECT_EQ(preparer.prepareWrite(std::move(request)).buffer, nullptr);
+    }
+    ASSERT_GT(expected.size(), 4096u);
+
+    auto blocks = preparer.flushStaged();
+    ASSERT_TRUE(blocks.has_value());
+    size_t full = expected.size() / 4096 * 4096;
+    EXPECT_EQ(blocks.value()->size, full);
+    EXPECT_EQ(blocks.value()->padding, 0u);
+    EXPECT_EQ(std::string(blocks.value()->as_char(), full), expected.substr(0, full));
+
+    // The remainder is carried over to the start of the staging buffer
+    auto tail = preparer.flushStaged(true);
+    ASSERT_TRUE(tail.has_value());
+    EXPECT_EQ(std::string(tail.value()->as_char(), expected.size() - full), expected.substr(full));
+}
+
+TEST_F(WritePreparerTest, BlockModeOversizedMessage) {
+    auto preparer = makePreparer(32, false, 4096);
+
+    auto small = makeRequest(Logger::SEVERITY_LEVEL::INFO, "before");
+    auto large = makeRequest(Logger::SEVERITY_LEVEL::INFO, std::string(20000, 'x'));
+    std::string expected = reference(small) + reference(large);
+
+    preparer.prepareWrite(std::move(small));
+    auto prepared = preparer.prepareWrite(std::move(large));
+    ASSERT_NE(prepared.buffer, nullptr);
+
+    size_t full = expected.size() / 4096 * 4096;
+    EXPECT_EQ(prepared.buffer->size, full);
+    EXPECT_EQ(std::string(prepared.buffer->as_char(), full), expected.substr(0, full));
+
+    auto tail = preparer.flushStaged(true);
+    ASSERT_TRUE(tail.has_value());
+    EXPECT_EQ(std::string(tail.value()->as_char(), expected.size() - full), expected.substr(full));
+}
+
+TEST_F(WritePreparerTest, BlockModePreloadedBytesAreRewritten) {
+    auto preparer = makePreparer(32, false, 4096);
+    preparer.preloadStaged("existing line\n");
+    EXPECT_FALSE(preparer.hasUnwritten());
+    EXPECT_FALSE(preparer.flushStaged(true).has_value());
+
+    auto request = makeRequest(Logger::SEVERITY_LEVEL::INFO, "appended");
+    std::string expected = "existing line\n" + reference(request);
+    preparer.prepareWrite(std::move(request));
+
+    auto tail = preparer.flushStaged(true);
+    ASSERT_TRUE(tail.has_value());
+    EXPECT_EQ(std::string(tail.value()->as_char(), expected.size()), expected);
+}
+
+TEST_F(WritePreparerTest, CompiledLayoutRendersOnlyItsFields) {
+    auto preparer = WritePreparer(
+        WritePreparer::Config{.coalesce_size = 0, .layout = makeLayout<"%L|%m|%e|%q|100%%">()},
+        pool_, [this](const char*, const std::string& msg) { errors_.push_back(msg); });
+
+    auto request = makeRequest(Logger::SEVERITY_LEVEL::WARN, "payload", 7);
+    auto epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(request.timestamp.time_since_epoch()).count();
+
+    auto prepared = preparer.prepareWrite(std::move(request));
+    ASSERT_NE(prepared.buffer, nullptr);
+    EXPECT_EQ(std::string(prepared.buffer->as_char(), prepared.buffer->size),
+              fmt::format("WARN|payload|{}|7|100%\n", epoch));
+}
+
+TEST_F(WritePreparerTest, CompiledLayoutTruncatesLikeFormatToN) {
+    auto preparer = WritePreparer(
+        WritePreparer::Config{.coalesce_size = 0, .layout = makeLayout<"%T %t %m">()},
+        pool_, [this](const char*, const std::string& msg) { errors_.push_back(msg); });
+
+    auto request = makeRequest(Logger::SEVERITY_LEVEL::INFO, "long payload");
+    std::string expected = fmt::format("{} {} long payload\n", request.timestamp, request.threadId);
+
+    char small[8];
+    EXPECT_EQ(preparer.formatInto(request, small, sizeof(small)), expected.size());
+    EXPECT_EQ(std::string(small), expected.substr(0, sizeof(small) - 1));
+}
+
+TEST_F(WritePreparerTest, JsonLayoutEscapesMessages) {
+    auto preparer = WritePreparer(
+        WritePreparer::Config{.coalesce_size = 0, .layout = JSON_LAYOUT},
+        pool_, [this](const char*, const std::string& msg) { errors_.push_back(msg); });
+
+    auto request = makeRequest(Logger::SEVERITY_LEVEL::ERROR, "say \"hi\"\\\n\x01");
+    std::string expected = fmt::format(R"({{"time":"{}","level":"ERROR","thread":"{}","message":"say \"hi\"\\\n\u0001"}})" "\n",
+                                       request.timestamp, request.threadId);
+    auto prepared = preparer.prepareWrite(std::move(request));
+    ASSERT_NE(prepared.buffer, nullptr);
+    EXPECT_EQ(std::string(prepared.buffer->as_char(), prepared.buffer->size), expected);
+
+    // Deferred messages are formatted before they are escaped, also when larger than the scratch space
+    const char* format = "{:>40} \"{}\"";
+    auto deferred = makeRequest(Logger::SEVERITY_LEVEL::INFO, "");
+    deferred.deferred = Logger::DeferredFormat::capture(fmt::string_view(format), 42, 1.5);
+    auto small = preparer.prepareWrite(std::move(deferred));
+    ASSERT_NE(small.buffer, nullptr);
+    EXPECT_THAT(std::string(small.buffer->as_char(), small.buffer->size),
+                testing::EndsWith("\"message\":\"" + std::string(38, ' ') + R"(42 \"1.5\""})" "\n"));
+    EXPECT_TRUE(errors_.empty());
+}
+
+TEST_F(WritePreparerTest, JsonLayoutWritesStructuredFieldsAsMembers) {
+    auto preparer = WritePreparer(
+        WritePreparer::Config{.coalesce_size = 0, .layout = JSON_LAYOUT},
+        pool_, [this](const char*, const std::string& msg) { errors_.push_back(msg); });
+
+    Logger::Payload strings;
+    auto request = makeRequest(Logger::SEVERITY_LEVEL::INFO, "");
+    request.deferred = Logger::DeferredFormat::captureFields("request \"done\"", strings,
+        Logger::kv("latency_us", 125), Logger::kv("route", "/a b"));
+    request.data = std::move(strings);
+    std::string expected = fmt::format(
+        R"({{"time":"{}","level":"INFO","thread":"{}","message":"request \"done\"","latency_us":125,"route":"/a b"}})" "\n",
+        request.timestamp, request.threadId);
+
+    auto prepared = preparer.prepareWrite(std::move(request));
+    ASSERT_NE(prepared.buffer, nullptr);
+    EXPECT_EQ(std::string(prepared.buffer->as_char(), prepared.buffer->size), expected);
+    EXPECT_TRUE(errors_.empty());
+}
+
+TEST_F(WritePreparerTest, LargeMessageKeepsItsLayout) {
+    auto preparer = WritePreparer(
+        WritePreparer::Config{.coalesce_size = 0, .layout = makeLayout<"%L|%m">()},
+        pool_, [this](const char*, const std::string& msg) { errors_.push_back(msg); });
+
+    std::string text(50 * 1024, 'z');
+    text[20000] = '|';
+    auto prepared = preparer.prepareWrite(makeRequest(Logger::SEVERITY_LEVEL::WARN, text));
+    ASSERT_NE(prepared.buffer, nullptr);
+    EXPECT_NE(prepared.buffer->next, nullptr);
+    EXPECT_EQ(chainText(prepared.buffer.get()), "WARN|" + text + "\n");
+}
+
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <MR/Coroutine/WriteTask.hpp>
+#include <MR/Coroutine/FramePool.hpp>
+#include <coroutine>
+#include <stdexcept>
+#include <vector>
+
+namespace MR::Coroutine::Test {
+
+// Suspends every awaiting coroutine until resumeAll()
+struct Gate {
+    std::vector<std::coroutine_handle<>> waiting;
+
+    auto wait() {
+        struct Awaiter {
+            Gate& gate;
+            bool await_ready() { return false; }
+            void await_suspend(std::coroutine_handle<> h) { gate.waiting.push_back(h); }
+            void await_resume() {}
+        };
+        return Awaiter{*this};
+    }
+
+    void resumeAll() {
+        auto handles = std::move(waiting);
+        waiting.clear();
+        for (auto h : handles) h.resume();
+    }
+};
+
+// Counts how many frames are alive
+struct Alive {
+    int& count;
+    explicit Alive(int& c) : count(c) { ++count; }
+    ~Alive() { --count; }
+};
+
+WriteTask waitFor(Gate& gate, int& alive, bool fail = false) {
+    Alive guard{alive};
+    co_await gate.wait();
+    if (fail) throw std::runtime_error("task failed");
+}
+
+WriteTask finishImmediately() {
+    co_return;
+}
+
+TEST(FramePoolTest, FramesAreServedFromBlocksUntilExhausted) {
+    FramePool pool(2);
+    FramePool* previous = std::exchange(FramePool::current(), &pool);
+
+    void* first = FramePool::allocateFrame(100);
+    void* second = FramePool::allocateFrame(100);
+    EXPECT_EQ(pool.available(), 0u);
+
+    // Exhausted and oversized frames come from the heap
+    void* heap = FramePool::allocateFrame(100);
+    void* large = FramePool::allocateFrame(FramePool::DEFAULT_BLOCK_SIZE + 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(heap) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0u);
+
+    FramePool::deallocateFrame(heap);
+    FramePool::deallocateFrame(large);
+    FramePool::deallocateFrame(second);
+    EXPECT_EQ(pool.available(), 1u);
+
+    // LIFO: the block just freed is handed out again
+    EXPECT_EQ(FramePool::allocateFrame(200), second);
+
+    FramePool::current() = nullptr;
+    FramePool::deallocateFrame(first);  // Freed into its pool, whichever pool is installed
+    EXPECT_EQ(pool.available(), 1u);
+
+    FramePool::current() = &pool;
+    FramePool::deallocateFrame(second);
+    EXPECT_EQ(pool.available(), 2u);
+    FramePool::current() = previous;
+}
+
+TEST(TaskListTest, ReapsOnlyFinishedTasks) {
+    Gate first_gate;
+    Gate second_gate;
+    int alive = 0;
+
+    TaskList tasks(8);
+    tasks.adopt(waitFor(first_gate, alive));
+    tasks.adopt(waitFor(first_gate, alive));
+    tasks.adopt(waitFor(second_gate, alive));
+    EXPECT_EQ(tasks.size(), 3u);
+    EXPECT_EQ(alive, 3);
+    EXPECT_EQ(tasks.framePool().available(), 5u);
+
+    size_t reaped = tasks.reap([](const std::exception_ptr&) {});
+    EXPECT_EQ(reaped, 0u);
+
+    first_gate.resumeAll();
+    reaped = tasks.reap([](const std::exception_ptr& e) { EXPECT_FALSE(e); });
+    EXPECT_EQ(reaped, 2u);
+    EXPECT_EQ(tasks.size(), 1u);
+    EXPECT_EQ(alive, 1);
+    EXPECT_EQ(tasks.framePool().available(), 7u);
+
+    second_gate.resumeAll();
+    EXPECT_EQ(tasks.reap([](const std::exception_ptr&) {}), 1u);
+    EXPECT_TRUE(tasks.empty());
+    EXPECT_EQ(tasks.framePool().available(), 8u);
+}
+
+TEST(TaskListTest, ExceptionIsHandedToReap) {
+    Gate gate;
+    int alive = 0;
+
+    TaskList tasks(4);
+    tasks.adopt(waitFor(gate, alive, true));
+    gate.resumeAll();
+
+    std::vector<std::exception_ptr> exceptions;
+    tasks.reap([&](const std::exception_ptr& e) { exceptions.push_back(e); });
+    ASSERT_EQ(exceptions.size(), 1u);
+    EXPECT_THROW(std::rethrow_exception(exceptions[0]), std::runtime_error);
+}
+
+TEST(TaskListTest, TaskFinishedBeforeAdoptIsReaped) {
+    TaskList tasks(4);
+    tasks.adopt(finishImmediately());
+
+    EXPECT_EQ(tasks.size(), 1u);
+    EXPECT_EQ(tasks.reap([](const std::exception_ptr&) {}), 1u);
+    EXPECT_TRUE(tasks.empty());
+}
+
+TEST(TaskListTest, DestroysRunningTasksAndUninstallsPool) {
+    Gate gate;
+    int alive = 0;
+    FramePool* previous = FramePool::current();
+
+    {
+        TaskList tasks(4);
+        EXPECT_NE(FramePool::current(), previous);
+        tasks.adopt(waitFor(gate, alive));
+        tasks.adopt(waitFor(gate, alive));
+        EXPECT_EQ(alive, 2);
+    }
+
+    EXPECT_EQ(alive, 0);
+    EXPECT_EQ(FramePool::current(), previous);
+}
+
+}